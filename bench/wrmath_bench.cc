@@ -0,0 +1,1237 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <wrmath/math.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/orientation.h>
+#include <wrmath/geom/map.h>
+#include <wrmath/geom/dualquaternion.h>
+#include <wrmath/geom/pointcloud.h>
+#include <wrmath/geom/quaternionarray.h>
+#include <wrmath/geom/stats.h>
+#include <wrmath/geom/compare.h>
+#include <wrmath/geom/renormalize.h>
+#include <wrmath/geom/rotator.h>
+#include <wrmath/geom/rotationaveraging.h>
+#include <wrmath/geom/wahba.h>
+#include <wrmath/filter/calibration.h>
+#include <wrmath/filter/madgwick.h>
+#include <wrmath/filter/prefilter.h>
+#include <wrmath/filter/sync.h>
+#include <wrmath/filter/window.h>
+#include <wrmath/io/codec.h>
+#include <wrmath/io/format.h>
+#include <wrmath/io/half.h>
+
+using namespace wr;
+
+
+// The float and double entry points that aren't templates are wrapped
+// so that every benchmark can be instantiated for both types.
+
+template <typename T>
+static geom::Quaternion<T>	FromEuler(geom::Vector<T, 3> euler);
+
+template <>
+geom::Quaternion<float>
+FromEuler(geom::Vector<float, 3> euler)
+{
+	return geom::quaternionf_from_euler(euler);
+}
+
+template <>
+geom::Quaternion<double>
+FromEuler(geom::Vector<double, 3> euler)
+{
+	return geom::quaterniond_from_euler(euler);
+}
+
+
+template <typename T>
+static T	Heading2(geom::Vector<T, 2> vec);
+
+template <>
+float
+Heading2(geom::Vector<float, 2> vec)
+{
+	return geom::Heading2f(vec);
+}
+
+template <>
+double
+Heading2(geom::Vector<double, 2> vec)
+{
+	return geom::Heading2d(vec);
+}
+
+
+template <typename T>
+static T	Heading3(geom::Vector<T, 3> vec);
+
+template <>
+float
+Heading3(geom::Vector<float, 3> vec)
+{
+	return geom::Heading3f(vec);
+}
+
+template <>
+double
+Heading3(geom::Vector<double, 3> vec)
+{
+	return geom::Heading3d(vec);
+}
+
+
+// Test inputs are generated deterministically so that runs are
+// comparable.
+
+template <typename T>
+static geom::Vector<T, 3>
+testVector(size_t i)
+{
+	return geom::Vector<T, 3>{(T)std::sin(i * 0.1) + (T)1.5,
+				  (T)std::cos(i * 0.2),
+				  (T)std::sin(i * 0.3) - (T)0.5};
+}
+
+
+template <typename T>
+static geom::Quaternion<T>
+testQuaternion(size_t i)
+{
+	return geom::quaternion(testVector<T>(i), (T)(0.01 * (i % 314)));
+}
+
+
+template <typename T>
+static std::vector<T>
+testQuaternionArray(size_t count)
+{
+	std::vector<T>	q(count * 4);
+
+	for (size_t i = 0; i < count; i++) {
+		geom::Vector<T, 4>	v = testQuaternion<T>(i).asVector();
+
+		for (size_t j = 0; j < 4; j++) {
+			q[(i * 4) + j] = v[j];
+		}
+	}
+	return q;
+}
+
+
+/*
+ * Construction.
+ */
+
+template <typename T>
+static void
+BM_VectorDefault(benchmark::State &state)
+{
+	for (auto _ : state) {
+		geom::Vector<T, 3>	v;
+		benchmark::DoNotOptimize(v);
+	}
+}
+BENCHMARK_TEMPLATE(BM_VectorDefault, float);
+BENCHMARK_TEMPLATE(BM_VectorDefault, double);
+
+
+template <typename T>
+static void
+BM_VectorInitializerList(benchmark::State &state)
+{
+	T	x = 1.0;
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(x);
+		geom::Vector<T, 3>	v {x, x, x};
+		benchmark::DoNotOptimize(v);
+	}
+}
+BENCHMARK_TEMPLATE(BM_VectorInitializerList, float);
+BENCHMARK_TEMPLATE(BM_VectorInitializerList, double);
+
+
+template <typename T>
+static void
+BM_QuaternionDefault(benchmark::State &state)
+{
+	for (auto _ : state) {
+		geom::Quaternion<T>	q;
+		benchmark::DoNotOptimize(q);
+	}
+}
+BENCHMARK_TEMPLATE(BM_QuaternionDefault, float);
+BENCHMARK_TEMPLATE(BM_QuaternionDefault, double);
+
+
+template <typename T>
+static void
+BM_QuaternionAxisAngle(benchmark::State &state)
+{
+	geom::Vector<T, 3>	axis = testVector<T>(1);
+	T			angle = 0.5;
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(angle);
+		geom::Quaternion<T>	q = geom::quaternion(axis, angle);
+		benchmark::DoNotOptimize(q);
+	}
+}
+BENCHMARK_TEMPLATE(BM_QuaternionAxisAngle, float);
+BENCHMARK_TEMPLATE(BM_QuaternionAxisAngle, double);
+
+
+/*
+ * Vector arithmetic.
+ */
+
+template <typename T>
+static void
+BM_VectorAdd(benchmark::State &state)
+{
+	geom::Vector<T, 3>	a = testVector<T>(1);
+	geom::Vector<T, 3>	b = testVector<T>(2);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(a);
+		benchmark::DoNotOptimize(a + b);
+	}
+}
+BENCHMARK_TEMPLATE(BM_VectorAdd, float);
+BENCHMARK_TEMPLATE(BM_VectorAdd, double);
+
+
+template <typename T>
+static void
+BM_VectorScale(benchmark::State &state)
+{
+	geom::Vector<T, 3>	a = testVector<T>(1);
+	T			k = 2.5;
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(a);
+		benchmark::DoNotOptimize(a * k);
+	}
+}
+BENCHMARK_TEMPLATE(BM_VectorScale, float);
+BENCHMARK_TEMPLATE(BM_VectorScale, double);
+
+
+template <typename T>
+static void
+BM_VectorDot(benchmark::State &state)
+{
+	geom::Vector<T, 3>	a = testVector<T>(1);
+	geom::Vector<T, 3>	b = testVector<T>(2);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(a);
+		benchmark::DoNotOptimize(a * b);
+	}
+}
+BENCHMARK_TEMPLATE(BM_VectorDot, float);
+BENCHMARK_TEMPLATE(BM_VectorDot, double);
+
+
+template <typename T>
+static void
+BM_VectorCross(benchmark::State &state)
+{
+	geom::Vector<T, 3>	a = testVector<T>(1);
+	geom::Vector<T, 3>	b = testVector<T>(2);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(a);
+		benchmark::DoNotOptimize(a.cross(b));
+	}
+}
+BENCHMARK_TEMPLATE(BM_VectorCross, float);
+BENCHMARK_TEMPLATE(BM_VectorCross, double);
+
+
+template <typename T>
+static void
+BM_VectorUnitVector(benchmark::State &state)
+{
+	geom::Vector<T, 3>	a = testVector<T>(1);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(a);
+		benchmark::DoNotOptimize(a.unitVector());
+	}
+}
+BENCHMARK_TEMPLATE(BM_VectorUnitVector, float);
+BENCHMARK_TEMPLATE(BM_VectorUnitVector, double);
+
+
+template <typename T>
+static void
+BM_VectorProjectOrthogonal(benchmark::State &state)
+{
+	geom::Vector<T, 3>	a = testVector<T>(1);
+	geom::Vector<T, 3>	b = testVector<T>(2);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(a);
+		benchmark::DoNotOptimize(a.projectOrthogonal(b));
+	}
+}
+BENCHMARK_TEMPLATE(BM_VectorProjectOrthogonal, float);
+BENCHMARK_TEMPLATE(BM_VectorProjectOrthogonal, double);
+
+
+/*
+ * Quaternion arithmetic.
+ */
+
+template <typename T>
+static void
+BM_QuaternionProduct(benchmark::State &state)
+{
+	geom::Quaternion<T>	p = testQuaternion<T>(1);
+	geom::Quaternion<T>	q = testQuaternion<T>(2);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(p * q);
+	}
+}
+BENCHMARK_TEMPLATE(BM_QuaternionProduct, float);
+BENCHMARK_TEMPLATE(BM_QuaternionProduct, double);
+
+
+template <typename T>
+static void
+BM_QuaternionInverse(benchmark::State &state)
+{
+	geom::Quaternion<T>	p = testQuaternion<T>(1);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(p.inverse());
+	}
+}
+BENCHMARK_TEMPLATE(BM_QuaternionInverse, float);
+BENCHMARK_TEMPLATE(BM_QuaternionInverse, double);
+
+
+template <typename T>
+static void
+BM_QuaternionRotate(benchmark::State &state)
+{
+	geom::Quaternion<T>	p = testQuaternion<T>(1);
+	geom::Vector<T, 3>	v = testVector<T>(2);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(p.rotate(v));
+	}
+}
+BENCHMARK_TEMPLATE(BM_QuaternionRotate, float);
+BENCHMARK_TEMPLATE(BM_QuaternionRotate, double);
+
+
+template <typename T>
+static void
+BM_ShortestSLERP(benchmark::State &state)
+{
+	geom::Quaternion<T>	p = testQuaternion<T>(1);
+	geom::Quaternion<T>	q = testQuaternion<T>(40);
+	T			t = 0.3;
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(t);
+		benchmark::DoNotOptimize(geom::ShortestSLERP(p, q, t));
+	}
+}
+BENCHMARK_TEMPLATE(BM_ShortestSLERP, float);
+BENCHMARK_TEMPLATE(BM_ShortestSLERP, double);
+
+
+template <typename T>
+static void
+BM_QuaternionToEuler(benchmark::State &state)
+{
+	geom::Quaternion<T>	p = testQuaternion<T>(1);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(p.euler());
+	}
+}
+BENCHMARK_TEMPLATE(BM_QuaternionToEuler, float);
+BENCHMARK_TEMPLATE(BM_QuaternionToEuler, double);
+
+
+template <typename T>
+static void
+BM_QuaternionFromEuler(benchmark::State &state)
+{
+	geom::Vector<T, 3>	euler = testQuaternion<T>(1).euler();
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(euler);
+		benchmark::DoNotOptimize(FromEuler<T>(euler));
+	}
+}
+BENCHMARK_TEMPLATE(BM_QuaternionFromEuler, float);
+BENCHMARK_TEMPLATE(BM_QuaternionFromEuler, double);
+
+
+/*
+ * Orientation.
+ */
+
+template <typename T>
+static void
+BM_Heading2(benchmark::State &state)
+{
+	geom::Vector<T, 2>	v {2.0, 1.0};
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(v);
+		benchmark::DoNotOptimize(Heading2<T>(v));
+	}
+}
+BENCHMARK_TEMPLATE(BM_Heading2, float);
+BENCHMARK_TEMPLATE(BM_Heading2, double);
+
+
+template <typename T>
+static void
+BM_Heading3(benchmark::State &state)
+{
+	geom::Vector<T, 3>	v = testVector<T>(1);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(v);
+		benchmark::DoNotOptimize(Heading3<T>(v));
+	}
+}
+BENCHMARK_TEMPLATE(BM_Heading3, float);
+BENCHMARK_TEMPLATE(BM_Heading3, double);
+
+
+/*
+ * Filters.
+ */
+
+template <typename T>
+static void
+BM_MadgwickUpdate(benchmark::State &state)
+{
+	filter::Madgwick<T>	mf;
+	geom::Vector<T, 3>	gyro {0.174533, 0.0, 0.0};
+	T			delta = 0.00917;
+
+	for (auto _ : state) {
+		mf.updateAngularOrientation(gyro, delta);
+		benchmark::DoNotOptimize(mf);
+	}
+}
+BENCHMARK_TEMPLATE(BM_MadgwickUpdate, float);
+BENCHMARK_TEMPLATE(BM_MadgwickUpdate, double);
+
+
+template <typename T>
+static void
+BM_MadgwickUpdateBiasEstimator(benchmark::State &state)
+{
+	filter::Madgwick<T>		mf;
+	filter::GyroBiasEstimator<T>	est;
+	geom::Vector<T, 3>		gyro {0.174533, 0.0, 0.0};
+	T				delta = 0.00917;
+
+	mf.setBiasEstimator(&est);
+	for (auto _ : state) {
+		mf.updateAngularOrientation(gyro, delta);
+		benchmark::DoNotOptimize(mf);
+	}
+}
+BENCHMARK_TEMPLATE(BM_MadgwickUpdateBiasEstimator, float);
+BENCHMARK_TEMPLATE(BM_MadgwickUpdateBiasEstimator, double);
+
+
+/*
+ * Batch APIs. These are parameterised on the number of elements, and
+ * report items per second.
+ */
+
+template <typename T>
+static void
+BM_BatchRotate(benchmark::State &state)
+{
+	size_t				count = state.range(0);
+	geom::Quaternion<T>		p = testQuaternion<T>(1);
+	std::vector<geom::Vector<T, 3>>	in;
+	std::vector<geom::Vector<T, 3>>	out(count);
+
+	for (size_t i = 0; i < count; i++) {
+		in.push_back(testVector<T>(i));
+	}
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < count; i++) {
+			out[i] = p.rotate(in[i]);
+		}
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchRotate, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchRotate, double)->Range(1 << 10, 1 << 16);
+
+
+template <typename T>
+static void
+BM_BatchRotator(benchmark::State &state)
+{
+	size_t			count = state.range(0);
+	geom::Rotator<T>	r(testQuaternion<T>(1));
+	std::vector<T>		in(count * 3);
+	std::vector<T>		out(count * 3);
+
+	for (size_t i = 0; i < count; i++) {
+		geom::Vector<T, 3>	v = testVector<T>(i);
+
+		for (size_t k = 0; k < 3; k++) {
+			in[(i * 3) + k] = v[k];
+		}
+	}
+
+	for (auto _ : state) {
+		r.rotate(in.data(), out.data(), count);
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchRotator, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchRotator, double)->Range(1 << 10, 1 << 16);
+
+
+template <typename T>
+static void
+BM_BatchDualQuaternionTransform(benchmark::State &state)
+{
+	size_t				count = state.range(0);
+	geom::DualQuaternion<T>		dq(testQuaternion<T>(1), testVector<T>(2));
+	std::vector<T>			in(count * 3);
+	std::vector<T>			out(count * 3);
+
+	for (size_t i = 0; i < in.size(); i++) {
+		in[i] = (T)std::sin(i * 0.1);
+	}
+
+	for (auto _ : state) {
+		geom::TransformPoints(dq, in.data(), out.data(), count);
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchDualQuaternionTransform, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchDualQuaternionTransform, double)->Range(1 << 10, 1 << 16);
+
+
+template <typename T>
+static void
+BM_BatchPointTransform(benchmark::State &state)
+{
+	size_t			count = state.range(0);
+	geom::PointTransform<T>	xf(testQuaternion<T>(1), testVector<T>(2));
+	geom::PointCloudOptions	opts;
+	std::vector<T>		in(count * 3);
+	std::vector<T>		out(count * 3);
+
+	for (size_t i = 0; i < in.size(); i++) {
+		in[i] = (T)std::sin(i * 0.1);
+	}
+
+	opts.streamingStores = state.range(1) != 0;
+	for (auto _ : state) {
+		xf.apply(in.data(), out.data(), count, opts);
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchPointTransform, float)->Ranges({{1 << 10, 1 << 20}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_BatchPointTransform, double)->Ranges({{1 << 10, 1 << 20}, {0, 1}});
+
+
+template <typename T>
+static void
+BM_BatchCentroidNaive(benchmark::State &state)
+{
+	size_t				count = state.range(0);
+	std::vector<geom::Vector<T, 3>>	in;
+
+	for (size_t i = 0; i < count; i++) {
+		in.push_back(testVector<T>(i));
+	}
+
+	for (auto _ : state) {
+		geom::Vector<T, 3>	sum {0, 0, 0};
+
+		for (size_t i = 0; i < count; i++) {
+			sum = sum + in[i];
+		}
+		benchmark::DoNotOptimize(sum / (T)count);
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchCentroidNaive, float)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_BatchCentroidNaive, double)->Range(1 << 10, 1 << 20);
+
+
+template <typename T>
+static void
+BM_BatchCentroid(benchmark::State &state)
+{
+	size_t				count = state.range(0);
+	std::vector<geom::Vector<T, 3>>	in;
+
+	for (size_t i = 0; i < count; i++) {
+		in.push_back(testVector<T>(i));
+	}
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(geom::Centroid(in.data(), count));
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchCentroid, float)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_BatchCentroid, double)->Range(1 << 10, 1 << 20);
+
+
+template <typename T>
+static void
+BM_BatchCovariance(benchmark::State &state)
+{
+	size_t		count = state.range(0);
+	std::vector<T>	in(count * 3);
+	T		cov[9];
+
+	for (size_t i = 0; i < in.size(); i++) {
+		in[i] = (T)std::sin(i * 0.1);
+	}
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(geom::Covariance<3>(in.data(), count, cov));
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchCovariance, float)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_BatchCovariance, double)->Range(1 << 10, 1 << 20);
+
+
+template <typename T>
+static void
+BM_BatchQuaternionEqual(benchmark::State &state)
+{
+	size_t				count = state.range(0);
+	std::vector<geom::Quaternion<T>>	a, b;
+	std::vector<bool>		equal(count);
+
+	for (size_t i = 0; i < count; i++) {
+		a.push_back(testQuaternion<T>(i));
+		b.push_back(a.back() + geom::Quaternion<T>{0, 0, (T)(0.0002 * std::sin(i * i)), 0});
+	}
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < count; i++) {
+			equal[i] = a[i] == b[i];
+		}
+		benchmark::DoNotOptimize(equal);
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchQuaternionEqual, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchQuaternionEqual, double)->Range(1 << 10, 1 << 16);
+
+
+template <typename T>
+static void
+BM_BatchEqualMask(benchmark::State &state)
+{
+	size_t			count = state.range(0);
+	std::vector<T>		a = testQuaternionArray<T>(count);
+	std::vector<T>		b = a;
+	std::vector<uint64_t>	mask(math::MaskWords(count));
+	T			eps;
+
+	math::DefaultEpsilon(eps);
+	for (size_t i = 0; i < count; i++) {
+		b[(i * 4) + 2] += (T)(0.0002 * std::sin(i * i));
+	}
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(math::EqualMask(a.data(), b.data(), count, 4,
+		    math::Tolerance<T>::Absolute(eps), mask.data()));
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchEqualMask, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchEqualMask, double)->Range(1 << 10, 1 << 16);
+
+
+template <typename T>
+static void
+BM_BatchMapDot(benchmark::State &state)
+{
+	size_t		count = state.range(0);
+	std::vector<T>	buf(count * 3);
+	T		sum;
+
+	for (size_t i = 0; i < buf.size(); i++) {
+		buf[i] = (T)std::sin(i * 0.1);
+	}
+
+	geom::VectorArrayMap<T, 3>	arr(buf.data(), count);
+	for (auto _ : state) {
+		sum = 0;
+		for (size_t i = 1; i < count; i++) {
+			sum += arr[i] * arr[i - 1];
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchMapDot, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchMapDot, double)->Range(1 << 10, 1 << 16);
+
+
+template <typename T>
+static void
+BM_BatchSmallestThreePack(benchmark::State &state)
+{
+	size_t			count = state.range(0);
+	io::SmallestThree	codec = io::SmallestThree32();
+	std::vector<T>		q = testQuaternionArray<T>(count);
+	std::vector<uint8_t>	packed(count * codec.size());
+
+	for (auto _ : state) {
+		codec.pack(q.data(), count, packed.data());
+		benchmark::DoNotOptimize(packed.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchSmallestThreePack, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchSmallestThreePack, double)->Range(1 << 10, 1 << 16);
+
+
+template <typename T>
+static void
+BM_BatchSmallestThreeUnpack(benchmark::State &state)
+{
+	size_t			count = state.range(0);
+	io::SmallestThree	codec = io::SmallestThree32();
+	std::vector<T>		q = testQuaternionArray<T>(count);
+	std::vector<uint8_t>	packed(count * codec.size());
+
+	codec.pack(q.data(), count, packed.data());
+	for (auto _ : state) {
+		codec.unpack(packed.data(), count, q.data());
+		benchmark::DoNotOptimize(q.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchSmallestThreeUnpack, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchSmallestThreeUnpack, double)->Range(1 << 10, 1 << 16);
+
+
+static void
+BM_BatchHalfWiden(benchmark::State &state)
+{
+	size_t			count = state.range(0);
+	std::vector<uint16_t>	h(count * 4, 0x3c00);
+	std::vector<float>	f(count * 4);
+
+	for (auto _ : state) {
+		io::WidenHalf(h.data(), f.data(), h.size());
+		benchmark::DoNotOptimize(f.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_BatchHalfWiden)->Range(1 << 10, 1 << 16);
+
+
+static void
+BM_BatchHalfNarrow(benchmark::State &state)
+{
+	size_t			count = state.range(0);
+	std::vector<float>	f = testQuaternionArray<float>(count);
+	std::vector<uint16_t>	h(count * 4);
+
+	for (auto _ : state) {
+		io::NarrowHalf(f.data(), h.data(), f.size());
+		benchmark::DoNotOptimize(h.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_BatchHalfNarrow)->Range(1 << 10, 1 << 16);
+
+
+template <typename T>
+static void
+BM_BatchFormatStream(benchmark::State &state)
+{
+	size_t			count = state.range(0);
+	std::vector<T>		q = testQuaternionArray<T>(count);
+	std::ostringstream	out;
+
+	for (auto _ : state) {
+		out.str("");
+		for (size_t i = 0; i < count; i++) {
+			geom::Quaternion<T>	r(geom::Vector<T, 3>{q[4*i+1], q[4*i+2], q[4*i+3]}, q[4*i]);
+
+			out << r << '\n';
+		}
+		benchmark::DoNotOptimize(out.tellp());
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchFormatStream, float)->Range(1 << 10, 1 << 14);
+BENCHMARK_TEMPLATE(BM_BatchFormatStream, double)->Range(1 << 10, 1 << 14);
+
+
+template <typename T>
+static void
+BM_BatchFormat(benchmark::State &state)
+{
+	size_t			count = state.range(0);
+	std::vector<T>		q = testQuaternionArray<T>(count);
+	std::vector<char>	buf(count * 4 * io::FormatScalarMax);
+
+	for (auto _ : state) {
+		char	*end;
+
+		io::FormatBatch(buf.data(), buf.data() + buf.size(), q.data(), count, 4, &end);
+		benchmark::DoNotOptimize(end);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchFormat, float)->Range(1 << 10, 1 << 14);
+BENCHMARK_TEMPLATE(BM_BatchFormat, double)->Range(1 << 10, 1 << 14);
+
+
+// The Wahba benchmarks solve count problems of four observations each,
+// in one thread, with the solver given by the second argument.
+template <typename T>
+static void
+BM_BatchWahba(benchmark::State &state)
+{
+	size_t			count = state.range(0);
+	geom::WahbaMethod	method = static_cast<geom::WahbaMethod>(state.range(1));
+	parallel::ThreadPool	pool(1);
+	std::vector<T>		body(count * 12), ref(count * 12), q(count * 4);
+
+	for (size_t i = 0; i < count * 4; i++) {
+		geom::Vector<T, 3>	r = testVector<T>(i);
+		geom::Vector<T, 3>	b = testVector<T>(i + 1);
+
+		for (size_t k = 0; k < 3; k++) {
+			ref[(i * 3) + k] = r[k];
+			body[(i * 3) + k] = b[k];
+		}
+	}
+
+	for (auto _ : state) {
+		geom::SolveWahba(method, body.data(), ref.data(), (const T *)nullptr,
+				 4, count, q.data(), &pool);
+		benchmark::DoNotOptimize(q.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchWahba, float)->ArgsProduct({{1 << 10, 1 << 14}, {0, 1, 2}});
+BENCHMARK_TEMPLATE(BM_BatchWahba, double)->ArgsProduct({{1 << 10, 1 << 14}, {0, 1, 2}});
+
+
+template <typename T>
+static void
+BM_BatchMagnetometerCalibration(benchmark::State &state)
+{
+	size_t					count = state.range(0);
+	std::vector<T>				raw(count * 3);
+	filter::MagnetometerCalibration<T>	cal;
+
+	for (size_t i = 0; i < count; i++) {
+		geom::Vector<T, 3>	v = testVector<T>(i);
+
+		for (size_t k = 0; k < 3; k++) {
+			raw[(i * 3) + k] = (v[k] * 50) + (T)(k * 10);
+		}
+	}
+
+	for (auto _ : state) {
+		cal.reset();
+		cal.addSamples(raw.data(), count);
+		benchmark::DoNotOptimize(cal.solve());
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchMagnetometerCalibration, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchMagnetometerCalibration, double)->Range(1 << 10, 1 << 16);
+
+
+// The synchronizer benchmark pushes count milliseconds of 1 kHz
+// gyroscope, 250 Hz accelerometer and 50 Hz magnetometer data, draining
+// 200 Hz output as it goes.
+template <typename T>
+static void
+BM_BatchSensorSync(benchmark::State &state)
+{
+	const int64_t				ms = 1000000;
+	size_t					count = state.range(0);
+	std::vector<T>				raw(count * 3);
+	std::vector<filter::SyncedSample<T>>	out(64);
+
+	for (size_t i = 0; i < count; i++) {
+		geom::Vector<T, 3>	v = testVector<T>(i);
+
+		for (size_t k = 0; k < 3; k++) {
+			raw[(i * 3) + k] = v[k];
+		}
+	}
+
+	for (auto _ : state) {
+		filter::SensorSynchronizer<T>	sync(5 * ms);
+		size_t				total = 0;
+
+		for (size_t i = 0; i < count; i++) {
+			int64_t	t = static_cast<int64_t>(i) * ms;
+
+			sync.pushGyro(t, &raw[i * 3]);
+			if (i % 4 == 0) {
+				sync.pushAccel(t, &raw[i * 3]);
+			}
+			if (i % 20 == 0) {
+				sync.pushMag(t, &raw[i * 3]);
+			}
+			if (i % 20 == 0) {
+				total += sync.drain(out.data(), out.size());
+			}
+		}
+		benchmark::DoNotOptimize(total);
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchSensorSync, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchSensorSync, double)->Range(1 << 10, 1 << 16);
+
+
+// The pre-filter benchmarks run a low-pass and a notch on twelve
+// channels, x, y and z of four sensors, one channel at a time as the
+// scalar baseline and all at once through a BiquadBank.
+template <typename T>
+static void
+BM_BatchBiquadScalar(benchmark::State &state)
+{
+	const size_t		C = 12;
+	size_t			frames = state.range(0);
+	filter::Biquad<T>	s[2] = {filter::LowPassBiquad<T>(30, 1000),
+					filter::NotchBiquad<T>(120, 1000, 5)};
+	std::vector<T>		z((C * 4), 0);
+	std::vector<T>		data(frames * C);
+
+	for (size_t i = 0; i < data.size(); i++) {
+		data[i] = (T)std::sin(i * 0.1);
+	}
+
+	for (auto _ : state) {
+		for (size_t c = 0; c < C; c++) {
+			for (size_t f = 0; f < frames; f++) {
+				T	v = data[(f * C) + c];
+
+				for (size_t k = 0; k < 2; k++) {
+					T	*zk = &z[(c * 4) + (k * 2)];
+					T	y = (s[k].b0 * v) + zk[0];
+
+					zk[0] = (s[k].b1 * v) - (s[k].a1 * y) + zk[1];
+					zk[1] = (s[k].b2 * v) - (s[k].a2 * y);
+					v = y;
+				}
+				data[(f * C) + c] = v;
+			}
+		}
+		benchmark::DoNotOptimize(data.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * frames * C);
+}
+BENCHMARK_TEMPLATE(BM_BatchBiquadScalar, float)->Range(1 << 10, 1 << 14);
+BENCHMARK_TEMPLATE(BM_BatchBiquadScalar, double)->Range(1 << 10, 1 << 14);
+
+
+template <typename T>
+static void
+BM_BatchBiquadBank(benchmark::State &state)
+{
+	const size_t		C = 12;
+	size_t			frames = state.range(0);
+	filter::BiquadBank<T>	bank(C, 2);
+	std::vector<T>		data(frames * C);
+
+	bank.setStage(0, filter::LowPassBiquad<T>(30, 1000));
+	bank.setStage(1, filter::NotchBiquad<T>(120, 1000, 5));
+	for (size_t i = 0; i < data.size(); i++) {
+		data[i] = (T)std::sin(i * 0.1);
+	}
+
+	for (auto _ : state) {
+		bank.process(data.data(), data.data(), frames);
+		benchmark::DoNotOptimize(data.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * frames * C);
+}
+BENCHMARK_TEMPLATE(BM_BatchBiquadBank, float)->Range(1 << 10, 1 << 14);
+BENCHMARK_TEMPLATE(BM_BatchBiquadBank, double)->Range(1 << 10, 1 << 14);
+
+
+template <typename T>
+static void
+BM_BatchFIRBank(benchmark::State &state)
+{
+	const size_t	C = 12;
+	size_t		frames = state.range(0);
+	T		h[15];
+	std::vector<T>	data(frames * C);
+
+	filter::LowPassFIR<T>(15, 50, 1000, h);
+	filter::FIRBank<T>	bank(C, h, 15);
+	for (size_t i = 0; i < data.size(); i++) {
+		data[i] = (T)std::sin(i * 0.1);
+	}
+
+	for (auto _ : state) {
+		bank.process(data.data(), data.data(), frames);
+		benchmark::DoNotOptimize(data.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * frames * C);
+}
+BENCHMARK_TEMPLATE(BM_BatchFIRBank, float)->Range(1 << 10, 1 << 14);
+BENCHMARK_TEMPLATE(BM_BatchFIRBank, double)->Range(1 << 10, 1 << 14);
+
+
+// The sliding window benchmarks feed 4096 samples through windows of
+// the given size, rescanning the window for each sample as the baseline.
+template <typename T>
+static void
+BM_SlidingWindowNaive(benchmark::State &state)
+{
+	const size_t			count = 4096;
+	size_t				window = state.range(0);
+	std::vector<geom::Vector<T, 3>>	in;
+	std::vector<T>			scratch(window);
+
+	for (size_t i = 0; i < count; i++) {
+		in.push_back(testVector<T>(i));
+	}
+
+	for (auto _ : state) {
+		for (size_t i = window; i < count; i++) {
+			T	mean[3], median[3];
+
+			for (size_t k = 0; k < 3; k++) {
+				T	sum = 0;
+
+				for (size_t j = 0; j < window; j++) {
+					scratch[j] = in[i - j][k];
+					sum += scratch[j];
+				}
+				mean[k] = sum / (T)window;
+				std::nth_element(scratch.begin(), scratch.begin() + (window / 2), scratch.end());
+				median[k] = scratch[window / 2];
+			}
+			benchmark::DoNotOptimize(mean);
+			benchmark::DoNotOptimize(median);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * (count - window));
+}
+BENCHMARK_TEMPLATE(BM_SlidingWindowNaive, float)->Range(16, 256);
+BENCHMARK_TEMPLATE(BM_SlidingWindowNaive, double)->Range(16, 256);
+
+
+template <typename T>
+static void
+BM_SlidingWindow(benchmark::State &state)
+{
+	const size_t			count = 4096;
+	size_t				window = state.range(0);
+	std::vector<geom::Vector<T, 3>>	in;
+
+	for (size_t i = 0; i < count; i++) {
+		in.push_back(testVector<T>(i));
+	}
+
+	for (auto _ : state) {
+		filter::SlidingMoments<T, 3>	moments(window);
+		filter::SlidingMedian<T, 3>	median(window);
+
+		for (size_t i = 0; i < count; i++) {
+			moments.push(in[i]);
+			median.push(in[i]);
+			if (i >= window) {
+				benchmark::DoNotOptimize(moments.mean());
+				benchmark::DoNotOptimize(median.median());
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * (count - window));
+}
+BENCHMARK_TEMPLATE(BM_SlidingWindow, float)->Range(16, 256);
+BENCHMARK_TEMPLATE(BM_SlidingWindow, double)->Range(16, 256);
+
+
+// The renormalization benchmarks scale slightly denormalised
+// quaternions back to unit length, exactly and with the first-order
+// step where it's accurate enough.
+template <typename T>
+static void
+BM_BatchUnitQuaternion(benchmark::State &state)
+{
+	size_t				count = state.range(0);
+	std::vector<geom::Quaternion<T>>	q;
+
+	for (size_t i = 0; i < count; i++) {
+		q.push_back(testQuaternion<T>(i) * (T)1.0001);
+	}
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < count; i++) {
+			q[i] = (q[i] * (T)1.0001).unitQuaternion();
+		}
+		benchmark::DoNotOptimize(q.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchUnitQuaternion, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchUnitQuaternion, double)->Range(1 << 10, 1 << 16);
+
+
+template <typename T>
+static void
+BM_BatchRenormalize(benchmark::State &state)
+{
+	size_t		count = state.range(0);
+	std::vector<T>	q = testQuaternionArray<T>(count);
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < q.size(); i++) {
+			q[i] *= (T)1.0001;
+		}
+		geom::RenormalizeArray(q.data(), count, (T)1e-2);
+		benchmark::DoNotOptimize(q.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchRenormalize, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchRenormalize, double)->Range(1 << 10, 1 << 16);
+
+
+// The quaternion array benchmarks compose each quaternion in an array
+// with a fixed mount correction, with the quaternion operator and with
+// the array kernel on one thread.
+template <typename T>
+static void
+BM_BatchQuaternionComposeOperator(benchmark::State &state)
+{
+	size_t				count = state.range(0);
+	geom::Quaternion<T>		mount = testQuaternion<T>(1);
+	std::vector<geom::Quaternion<T>>	in, out(count);
+
+	for (size_t i = 0; i < count; i++) {
+		in.push_back(testQuaternion<T>(i));
+	}
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < count; i++) {
+			out[i] = in[i] * mount;
+		}
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchQuaternionComposeOperator, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchQuaternionComposeOperator, double)->Range(1 << 10, 1 << 16);
+
+
+template <typename T>
+static void
+BM_BatchQuaternionCompose(benchmark::State &state)
+{
+	size_t			count = state.range(0);
+	parallel::ThreadPool	pool(1);
+	std::vector<T>		in = testQuaternionArray<T>(count);
+	std::vector<T>		mount = testQuaternionArray<T>(2);
+	std::vector<T>		out(count * 4);
+
+	for (auto _ : state) {
+		geom::QuaternionMultiplyRight(in.data(), mount.data() + 4, out.data(), count, &pool);
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_BatchQuaternionCompose, float)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BatchQuaternionCompose, double)->Range(1 << 10, 1 << 16);
+
+
+/*
+ * Rotation averaging over a rig-calibration-sized graph: a chain
+ * through every node plus three more edges per node, solved on the
+ * default pool.
+ */
+template <typename T>
+static void
+BM_RotationAveraging(benchmark::State &state)
+{
+	size_t			nodes = state.range(0);
+	geom::RotationGraph<T>	graph(nodes);
+
+	for (size_t i = 0; i < nodes; i++) {
+		size_t	next[4] = {i + 1, (i * 7) + 3, (i * 13) + 5, (i * 31) + 11};
+
+		for (size_t k = 0; k < 4; k++) {
+			size_t	j = next[k] % nodes;
+
+			if (j != i) {
+				graph.addEdge(i, j, testQuaternion<T>(i).conjugate() * testQuaternion<T>(j));
+			}
+		}
+	}
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(graph.solve());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * graph.edges());
+}
+BENCHMARK_TEMPLATE(BM_RotationAveraging, float)->Range(1 << 6, 1 << 12);
+BENCHMARK_TEMPLATE(BM_RotationAveraging, double)->Range(1 << 6, 1 << 12);
+
+
+BENCHMARK_MAIN();
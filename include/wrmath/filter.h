@@ -2,7 +2,13 @@
 #define __WRMATH_FILTER_H
 
 
+#include <wrmath/filter/calibration.h>
+#include <wrmath/filter/gyrobias.h>
+#include <wrmath/filter/latency.h>
 #include <wrmath/filter/madgwick.h>
+#include <wrmath/filter/prefilter.h>
+#include <wrmath/filter/sync.h>
+#include <wrmath/filter/window.h>
 
 
-#endif __WRMATH_FILTER_H
+#endif // __WRMATH_FILTER_H
@@ -0,0 +1,503 @@
+/// \file calibration.h
+/// \brief Streaming hard- and soft-iron magnetometer calibration.
+///
+/// A magnetometer rotated through every orientation in a constant field
+/// should report points on a sphere centred on the origin. Hard-iron
+/// effects (magnetised parts near the sensor) shift the centre, and
+/// soft-iron effects (nearby ferrous material, sensor scale and axis
+/// errors) stretch the sphere into an ellipsoid. The calibration fits an
+/// ellipsoid to the raw samples and finds the offset c and matrix W
+/// such that W (m - c) lies on a sphere again.
+///
+/// The fit is the linear least-squares ellipsoid fit
+///
+///     a x² + b y² + c z² + 2f yz + 2g xz + 2h xy + 2p x + 2q y + 2r z = 1,
+///
+/// whose normal equations depend on the samples only through sums of
+/// their monomials up to degree four. MagnetometerCalibration keeps just
+/// those sums, so each sample costs a fixed 54 multiply-adds and no
+/// samples are stored; the fit is solved on demand from the sums.
+///
+/// Corrected samples can be passed to geom::Heading3f and
+/// geom::Heading3d, or used anywhere a magnetometer reading is.
+#ifndef __WRMATH_FILTER_CALIBRATION_H
+#define __WRMATH_FILTER_CALIBRATION_H
+
+
+#include <cmath>
+#include <cstddef>
+
+#include <wrmath/math/linalg.h>
+#include <wrmath/geom/vector.h>
+
+
+namespace wr {
+namespace filter {
+
+
+/// @brief MagnetometerCalibration fits hard- and soft-iron corrections
+/// to a stream of magnetometer samples.
+///
+/// Samples are scaled by the magnitude of the first sample before they
+/// are accumulated, which keeps the sums well conditioned whatever the
+/// units. A forgetting factor below 1 decays old samples
+/// exponentially, so the fit tracks a slowly changing environment.
+///
+/// solve fits the full ellipsoid, which needs samples spread over the
+/// whole sphere of orientations; solveHardIron fits a sphere, finding
+/// only the offset, and needs less coverage. Until one succeeds, apply
+/// returns samples unchanged.
+///
+/// \tparam T A floating point type; double is recommended, since the
+///           sums reach the fourth power of the samples.
+template <typename T>
+class MagnetometerCalibration {
+public:
+	/// Terms is the number of ellipsoid coefficients fitted.
+	static constexpr size_t	Terms = 9;
+
+
+	/// Start a calibration with no samples.
+	///
+	/// \param factor The weight kept by earlier samples each time one
+	///               is added, in (0, 1]; 1 never forgets.
+	explicit MagnetometerCalibration(T factor = 1) : forgetting(factor)
+	{
+		this->reset();
+	}
+
+
+	/// Discard all samples and the current calibration.
+	void
+	reset()
+	{
+		this->scale = 0;
+		this->weight = 0;
+		this->sampleCount = 0;
+		for (size_t i = 0; i < Terms * Terms; i++) {
+			this->DtD[i] = 0;
+		}
+		for (size_t i = 0; i < Terms; i++) {
+			this->Dt1[i] = 0;
+		}
+		for (size_t i = 0; i < 9; i++) {
+			this->W[i] = (i % 4) == 0 ? (T)1.0 : (T)0.0;
+		}
+		this->center[0] = this->center[1] = this->center[2] = 0;
+		this->field = 0;
+		this->error = 0;
+		this->solved = false;
+	}
+
+
+	/// Set the forgetting factor.
+	///
+	/// \param factor The weight kept by earlier samples each time one
+	///               is added, in (0, 1].
+	void	setForgetting(T factor) { this->forgetting = factor; }
+
+
+	/// Add a raw sample.
+	///
+	/// \param m A magnetometer reading.
+	void
+	addSample(const geom::Vector<T, 3> &m)
+	{
+		this->accumulate(m[0], m[1], m[2]);
+	}
+
+
+	/// Add an array of raw samples.
+	///
+	/// \param xyz count interleaved <x, y, z> readings.
+	/// \param count The number of readings.
+	void
+	addSamples(const T *xyz, size_t count)
+	{
+		for (size_t i = 0; i < count; i++) {
+			this->accumulate(xyz[i * 3], xyz[(i * 3) + 1], xyz[(i * 3) + 2]);
+		}
+	}
+
+
+	/// Return the number of samples added since the last reset.
+	///
+	/// \return The sample count.
+	size_t	samples() const { return this->sampleCount; }
+
+
+	/// Fit an ellipsoid to the samples and update the hard- and
+	/// soft-iron corrections. The corrected field has the same strength
+	/// as a sphere with the volume of the fitted ellipsoid.
+	///
+	/// \return False if the samples don't determine an ellipsoid, such
+	///         as when they all lie near a plane; the previous
+	///         calibration is kept.
+	bool
+	solve()
+	{
+		using std::pow;
+		using std::sqrt;
+
+		T	A[Terms * Terms];
+		T	theta[Terms];
+
+		if (this->sampleCount < Terms || !this->normalMatrix(A) ||
+		    !math::CholeskySolve<Terms>(A, this->Dt1, theta)) {
+			return false;
+		}
+
+		// The quadric is xᵀ M x + 2 uᵀ x = 1, or, about its centre
+		// c = -M⁻¹ u, (x - c)ᵀ M (x - c) = 1 - u · c.
+		T	M[9] = {
+			theta[0], theta[5], theta[4],
+			theta[5], theta[1], theta[3],
+			theta[4], theta[3], theta[2],
+		};
+		T	Minv[9];
+
+		if (!invert3(M, Minv)) {
+			return false;
+		}
+
+		T	c[3];
+
+		for (size_t j = 0; j < 3; j++) {
+			c[j] = -((Minv[j * 3] * theta[6]) + (Minv[(j * 3) + 1] * theta[7]) +
+				 (Minv[(j * 3) + 2] * theta[8]));
+		}
+
+		T	k = (T)1.0 - ((theta[6] * c[0]) + (theta[7] * c[1]) + (theta[8] * c[2]));
+
+		if (k == 0) {
+			return false;
+		}
+
+		// Back in sample units, the ellipsoid is (x - c)ᵀ A (x - c) = 1
+		// with A = M / (k s²). It's an ellipsoid only if A is positive
+		// definite; its semi-axes are 1/√λ for the eigenvalues λ.
+		T	s2 = this->scale * this->scale;
+		T	E[9];
+		T	lambda[3];
+		T	V[9];
+
+		for (size_t i = 0; i < 9; i++) {
+			E[i] = M[i] / (k * s2);
+		}
+		math::SymmetricEigen<3>(E, lambda, V);
+		if (!(lambda[2] > 0)) {
+			return false;
+		}
+
+		T	strength = pow(lambda[0] * lambda[1] * lambda[2], (T)(-1.0 / 6.0));
+		T	root[3] = {
+			sqrt(lambda[0]) * strength,
+			sqrt(lambda[1]) * strength,
+			sqrt(lambda[2]) * strength,
+		};
+
+		// W = V diag(√λ) Vᵀ, scaled to the field strength.
+		for (size_t i = 0; i < 3; i++) {
+			for (size_t j = 0; j < 3; j++) {
+				this->W[(i * 3) + j] = (V[i * 3] * root[0] * V[j * 3]) +
+						       (V[(i * 3) + 1] * root[1] * V[(j * 3) + 1]) +
+						       (V[(i * 3) + 2] * root[2] * V[(j * 3) + 2]);
+			}
+		}
+		for (size_t j = 0; j < 3; j++) {
+			this->center[j] = c[j] * this->scale;
+		}
+		this->field = strength;
+		this->error = this->residual(theta);
+		this->solved = true;
+		return true;
+	}
+
+
+	/// Fit a sphere to the samples, updating the hard-iron offset and
+	/// clearing any soft-iron correction.
+	///
+	/// \return False if the samples don't determine a sphere; the
+	///         previous calibration is kept.
+	bool
+	solveHardIron()
+	{
+		using std::sqrt;
+
+		// |x|² = 2 c · x + k, whose normal equations use the sums
+		// already kept: products of the linear terms, the cubic terms
+		// x_i |x|², and the count.
+		T	A[16];
+		T	b[4];
+		T	full[Terms * Terms];
+		T	sol[4];
+
+		if (this->sampleCount < 4 || !this->normalMatrix(full)) {
+			return false;
+		}
+
+		for (size_t i = 0; i < 3; i++) {
+			for (size_t j = 0; j < 3; j++) {
+				A[(i * 4) + j] = full[((6 + i) * Terms) + 6 + j];
+			}
+			A[(i * 4) + 3] = A[12 + i] = this->Dt1[6 + i];
+			b[i] = full[((6 + i) * Terms) + 0] + full[((6 + i) * Terms) + 1] +
+			       full[((6 + i) * Terms) + 2];
+		}
+		A[15] = this->weight;
+		b[3] = this->Dt1[0] + this->Dt1[1] + this->Dt1[2];
+
+		if (!math::CholeskySolve<4>(A, b, sol)) {
+			return false;
+		}
+
+		T	r2 = sol[3] + (sol[0] * sol[0]) + (sol[1] * sol[1]) + (sol[2] * sol[2]);
+
+		if (!(r2 > 0)) {
+			return false;
+		}
+
+		T	r = sqrt(r2);
+
+		// As an ellipsoid, the sphere has M = I / (r² - |c|²) and
+		// u = -c / (r² - |c|²), which gives the residual.
+		T	theta[Terms] = {
+			(T)1.0 / sol[3], (T)1.0 / sol[3], (T)1.0 / sol[3],
+			0, 0, 0,
+			-sol[0] / sol[3], -sol[1] / sol[3], -sol[2] / sol[3],
+		};
+
+		for (size_t i = 0; i < 9; i++) {
+			this->W[i] = (i % 4) == 0 ? (T)1.0 : (T)0.0;
+		}
+		for (size_t j = 0; j < 3; j++) {
+			this->center[j] = sol[j] * this->scale;
+		}
+		this->field = r * this->scale;
+		this->error = sol[3] == 0 ? 0 : this->residual(theta);
+		this->solved = true;
+		return true;
+	}
+
+
+	/// Return whether a fit has succeeded since the last reset.
+	///
+	/// \return True if the calibration has been solved.
+	bool	calibrated() const { return this->solved; }
+
+
+	/// Return the hard-iron offset, the centre of the fitted ellipsoid.
+	///
+	/// \return The offset in sample units.
+	geom::Vector<T, 3>
+	offset() const
+	{
+		return geom::Vector<T, 3>{this->center[0], this->center[1], this->center[2]};
+	}
+
+
+	/// Copy the soft-iron correction matrix W.
+	///
+	/// \param m Storage for the row-major 3x3 matrix.
+	void
+	softIron(T *m) const
+	{
+		for (size_t i = 0; i < 9; i++) {
+			m[i] = this->W[i];
+		}
+	}
+
+
+	/// Return the strength of the corrected field, in sample units.
+	///
+	/// \return The radius of the corrected sphere.
+	T	fieldStrength() const { return this->field; }
+
+
+	/// Return how well the last fit matches the samples, as roughly the
+	/// RMS relative deviation of the corrected field strength. It's
+	/// computed from the sums, so it can't resolve errors much below
+	/// the square root of the machine epsilon.
+	///
+	/// \return The fit error; 0.01 is about a 1% spread.
+	T	fitError() const { return this->error; }
+
+
+	/// Correct a raw sample.
+	///
+	/// \param raw A magnetometer reading.
+	/// \return W (raw - c).
+	geom::Vector<T, 3>
+	apply(const geom::Vector<T, 3> &raw) const
+	{
+		T	in[3] = {raw[0], raw[1], raw[2]};
+		T	out[3];
+
+		this->apply(in, out, 1);
+		return geom::Vector<T, 3>(out);
+	}
+
+
+	/// Correct an array of raw samples.
+	///
+	/// \param in count interleaved <x, y, z> readings.
+	/// \param out Storage for count corrected readings; it may be the
+	///            same as in.
+	/// \param count The number of readings.
+	void
+	apply(const T *in, T *out, size_t count) const
+	{
+		for (size_t i = 0; i < count; i++) {
+			T	d[3] = {
+				in[i * 3] - this->center[0],
+				in[(i * 3) + 1] - this->center[1],
+				in[(i * 3) + 2] - this->center[2],
+			};
+
+			for (size_t j = 0; j < 3; j++) {
+				out[(i * 3) + j] = (this->W[j * 3] * d[0]) +
+						   (this->W[(j * 3) + 1] * d[1]) +
+						   (this->W[(j * 3) + 2] * d[2]);
+			}
+		}
+	}
+
+private:
+	T	forgetting;
+	T	scale;
+	T	weight;
+	size_t	sampleCount;
+	T	DtD[Terms * Terms];	// Upper triangle only.
+	T	Dt1[Terms];
+	T	center[3];
+	T	W[9];
+	T	field;
+	T	error;
+	bool	solved;
+
+	void
+	accumulate(T x, T y, T z)
+	{
+		using std::sqrt;
+
+		if (this->scale == 0) {
+			T	n2 = (x * x) + (y * y) + (z * z);
+
+			if (!(n2 > 0)) {
+				return;
+			}
+			this->scale = sqrt(n2);
+		}
+
+		T	inv = (T)1.0 / this->scale;
+
+		x *= inv;
+		y *= inv;
+		z *= inv;
+
+		T	d[Terms] = {
+			x * x, y * y, z * z,
+			2 * y * z, 2 * x * z, 2 * x * y,
+			2 * x, 2 * y, 2 * z,
+		};
+
+		if (this->forgetting < 1) {
+			for (size_t i = 0; i < Terms; i++) {
+				for (size_t j = i; j < Terms; j++) {
+					this->DtD[(i * Terms) + j] *= this->forgetting;
+				}
+				this->Dt1[i] *= this->forgetting;
+			}
+			this->weight *= this->forgetting;
+		}
+
+		for (size_t i = 0; i < Terms; i++) {
+			for (size_t j = i; j < Terms; j++) {
+				this->DtD[(i * Terms) + j] += d[i] * d[j];
+			}
+			this->Dt1[i] += d[i];
+		}
+		this->weight += 1;
+		this->sampleCount++;
+	}
+
+	// normalMatrix fills in the full symmetric DᵀD.
+	bool
+	normalMatrix(T *A) const
+	{
+		if (!(this->weight > 0)) {
+			return false;
+		}
+		for (size_t i = 0; i < Terms; i++) {
+			for (size_t j = i; j < Terms; j++) {
+				A[(i * Terms) + j] = A[(j * Terms) + i] = this->DtD[(i * Terms) + j];
+			}
+		}
+		return true;
+	}
+
+	// residual returns half the RMS of d · θ - 1 over the samples, which
+	// is about the RMS relative error in the corrected radius since
+	// (1 + e)² - 1 ≈ 2e.
+	T
+	residual(const T *theta) const
+	{
+		using std::sqrt;
+
+		T	A[Terms * Terms];
+		T	r = this->weight;
+
+		this->normalMatrix(A);
+		for (size_t i = 0; i < Terms; i++) {
+			T	row = 0;
+
+			for (size_t j = 0; j < Terms; j++) {
+				row += A[(i * Terms) + j] * theta[j];
+			}
+			r += (theta[i] * row) - (2 * theta[i] * this->Dt1[i]);
+		}
+		return r > 0 ? sqrt(r / this->weight) / 2 : (T)0.0;
+	}
+
+	static bool
+	invert3(const T *m, T *inv)
+	{
+		T	c00 = (m[4] * m[8]) - (m[5] * m[7]);
+		T	c01 = (m[5] * m[6]) - (m[3] * m[8]);
+		T	c02 = (m[3] * m[7]) - (m[4] * m[6]);
+		T	det = (m[0] * c00) + (m[1] * c01) + (m[2] * c02);
+
+		if (det == 0) {
+			return false;
+		}
+
+		T	r = (T)1.0 / det;
+
+		inv[0] = c00 * r;
+		inv[1] = ((m[2] * m[7]) - (m[1] * m[8])) * r;
+		inv[2] = ((m[1] * m[5]) - (m[2] * m[4])) * r;
+		inv[3] = c01 * r;
+		inv[4] = ((m[0] * m[8]) - (m[2] * m[6])) * r;
+		inv[5] = ((m[2] * m[3]) - (m[0] * m[5])) * r;
+		inv[6] = c02 * r;
+		inv[7] = ((m[1] * m[6]) - (m[0] * m[7])) * r;
+		inv[8] = ((m[0] * m[4]) - (m[1] * m[3])) * r;
+		return true;
+	}
+};
+
+
+/// MagnetometerCalibrationd is a shorthand alias for a
+/// MagnetometerCalibration<double>.
+typedef MagnetometerCalibration<double>	MagnetometerCalibrationd;
+
+/// MagnetometerCalibrationf is a shorthand alias for a
+/// MagnetometerCalibration<float>.
+typedef MagnetometerCalibration<float>	MagnetometerCalibrationf;
+
+
+} // namespace filter
+} // namespace wr
+
+
+#endif // __WRMATH_FILTER_CALIBRATION_H
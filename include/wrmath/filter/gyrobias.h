@@ -0,0 +1,248 @@
+/// \file gyrobias.h
+/// \brief Online gyroscope bias estimation.
+///
+/// A MEMS gyroscope reports a slowly wandering offset even when it
+/// isn't turning, and integrating that offset makes an orientation
+/// filter drift. GyroBiasEstimator learns the offset while the sensor
+/// is still: it detects stationary periods from the recent mean and
+/// variance of the readings, and while stationary, it refines its bias
+/// estimate with a scalar Kalman filter on each axis, modelling the bias
+/// as a random walk.
+///
+/// Until the first stationary period, a steady reading is taken to be
+/// bias if it's no larger than the largest plausible offset, so a bias
+/// of any size up to that is learned from the first still window. After
+/// that, a steady reading only counts as stationary if it's close to
+/// the estimate, so a slow, steady turn isn't mistaken for a change in
+/// bias. Each reading costs a fixed handful of operations
+/// and nothing is stored but the filter state.
+///
+/// Attach an estimator to a Madgwick filter with setBiasEstimator to
+/// have every gyroscope update compensated.
+#ifndef __WRMATH_FILTER_GYROBIAS_H
+#define __WRMATH_FILTER_GYROBIAS_H
+
+
+#include <cmath>
+#include <cstddef>
+
+#include <wrmath/geom/vector.h>
+
+
+namespace wr {
+namespace filter {
+
+
+/// @brief GyroBiasOptions tunes a GyroBiasEstimator. Rates are in the
+/// gyroscope's units, normally rad/s, and times in the units of the
+/// time steps passed to update, normally seconds.
+template <typename T>
+struct GyroBiasOptions {
+	/// The time constant of the moving mean and variance used to
+	/// detect stationary periods.
+	T	smoothing;
+
+	/// The largest mean rate, on any axis, that can be bias. Before
+	/// the first stationary period, steady readings up to this are
+	/// taken to be bias.
+	T	maxBias;
+
+	/// Once the bias has been learned, the largest bias-corrected mean
+	/// rate, on any axis, that counts as stationary.
+	T	rateThreshold;
+
+	/// The largest variance of the readings, on any axis, that counts
+	/// as stationary.
+	T	varianceThreshold;
+
+	/// How long the readings must look stationary before the bias is
+	/// updated.
+	T	settleTime;
+
+	/// The variance of the gyroscope noise on each reading.
+	T	measurementNoise;
+
+	/// The growth of the bias variance per unit time: how fast the
+	/// bias is expected to wander.
+	T	processNoise;
+
+	/// The variance of the initial bias estimate of zero.
+	T	initialVariance;
+
+	/// The defaults suit a consumer MEMS gyroscope in rad/s sampled at
+	/// 100 Hz or more, with an offset of up to about 5°/s.
+	GyroBiasOptions() :
+	    smoothing(0.2), maxBias(0.1), rateThreshold(0.02), varianceThreshold(1e-4),
+	    settleTime(0.5), measurementNoise(1e-4), processNoise(1e-7),
+	    initialVariance(1e-3) {};
+};
+
+
+/// @brief GyroBiasEstimator tracks the bias of a three-axis gyroscope.
+///
+/// \tparam T A floating point type.
+template <typename T>
+class GyroBiasEstimator {
+public:
+	/// Start an estimator with a zero bias.
+	///
+	/// \param opts The tuning parameters.
+	explicit GyroBiasEstimator(const GyroBiasOptions<T> &opts = GyroBiasOptions<T>()) :
+	    options(opts)
+	{
+		this->reset();
+	}
+
+
+	/// Forget the bias and the stationary state.
+	void
+	reset()
+	{
+		for (size_t i = 0; i < 3; i++) {
+			this->estimate[i] = 0;
+			this->P[i] = this->options.initialVariance;
+			this->mean[i] = 0;
+			this->var[i] = 0;
+		}
+		this->stillTime = 0;
+		this->started = false;
+		this->still = false;
+		this->learned = false;
+	}
+
+
+	/// Set the bias estimate, such as one saved from a previous run.
+	/// Later stationary periods must then be close to it.
+	///
+	/// \param b The bias on each axis.
+	/// \param variance The variance of the estimate on each axis.
+	void
+	setBias(const geom::Vector<T, 3> &b, T variance)
+	{
+		for (size_t i = 0; i < 3; i++) {
+			this->estimate[i] = b[i];
+			this->P[i] = variance;
+		}
+		this->learned = true;
+	}
+
+
+	/// Feed a gyroscope reading to the estimator and return it with the
+	/// bias removed.
+	///
+	/// \param gyro The raw reading as ω_x, ω_y, ω_z.
+	/// \param delta The time since the previous reading.
+	/// \return The bias-compensated reading.
+	geom::Vector<T, 3>
+	update(const geom::Vector<T, 3> &gyro, T delta)
+	{
+		T	w[3] = {gyro[0], gyro[1], gyro[2]};
+		T	out[3];
+
+		this->update(w, delta, out);
+		return geom::Vector<T, 3>(out);
+	}
+
+
+	/// Feed a gyroscope reading to the estimator.
+	///
+	/// \param gyro The raw reading as three scalars.
+	/// \param delta The time since the previous reading.
+	/// \param out Storage for the bias-compensated reading; it may be
+	///            the same as gyro.
+	void
+	update(const T *gyro, T delta, T *out)
+	{
+		using std::abs;
+
+		if (!this->started) {
+			for (size_t i = 0; i < 3; i++) {
+				this->mean[i] = gyro[i];
+				this->var[i] = this->options.varianceThreshold;
+			}
+			this->started = true;
+		}
+
+		T	alpha = delta / (this->options.smoothing + delta);
+		bool	quiet = true;
+
+		for (size_t i = 0; i < 3; i++) {
+			T	d = gyro[i] - this->mean[i];
+
+			this->mean[i] += alpha * d;
+			this->var[i] += alpha * (((1 - alpha) * d * d) - this->var[i]);
+			quiet = quiet &&
+				this->var[i] < this->options.varianceThreshold &&
+				abs(this->mean[i]) < this->options.maxBias &&
+				(!this->learned ||
+				 abs(this->mean[i] - this->estimate[i]) < this->options.rateThreshold);
+		}
+
+		this->stillTime = quiet ? this->stillTime + delta : 0;
+		this->still = this->stillTime >= this->options.settleTime;
+		this->learned = this->learned || this->still;
+
+		for (size_t i = 0; i < 3; i++) {
+			this->P[i] += this->options.processNoise * delta;
+			if (this->still) {
+				T	K = this->P[i] / (this->P[i] + this->options.measurementNoise);
+
+				this->estimate[i] += K * (gyro[i] - this->estimate[i]);
+				this->P[i] *= 1 - K;
+			}
+			out[i] = gyro[i] - this->estimate[i];
+		}
+	}
+
+
+	/// Return whether the last reading was taken while stationary, so
+	/// that it updated the bias.
+	///
+	/// \return True if the sensor is stationary.
+	bool	stationary() const { return this->still; }
+
+
+	/// Return the current bias estimate.
+	///
+	/// \return The bias on each axis.
+	geom::Vector<T, 3>
+	bias() const
+	{
+		return geom::Vector<T, 3>{this->estimate[0], this->estimate[1], this->estimate[2]};
+	}
+
+
+	/// Return the variance of the bias estimate.
+	///
+	/// \return The variance on each axis.
+	geom::Vector<T, 3>
+	variance() const
+	{
+		return geom::Vector<T, 3>{this->P[0], this->P[1], this->P[2]};
+	}
+
+private:
+	GyroBiasOptions<T>	options;
+	T			estimate[3];
+	T			P[3];
+	T			mean[3];
+	T			var[3];
+	T			stillTime;
+	bool			started;
+	bool			still;
+	bool			learned;
+};
+
+
+/// GyroBiasEstimatord is a shorthand alias for a GyroBiasEstimator<double>.
+typedef GyroBiasEstimator<double>	GyroBiasEstimatord;
+
+/// GyroBiasEstimatorf is a shorthand alias for a GyroBiasEstimator<float>.
+typedef GyroBiasEstimator<float>	GyroBiasEstimatorf;
+
+
+} // namespace filter
+} // namespace wr
+
+
+#endif // __WRMATH_FILTER_GYROBIAS_H
@@ -0,0 +1,186 @@
+/// \file latency.h
+/// \brief Lock-free latency histograms for filter updates.
+///
+/// A LatencyHistogram records durations in nanoseconds into log-linear
+/// buckets, in the style of HdrHistogram: each power of two is split
+/// into 32 equal sub-buckets, so any recorded value is reported to
+/// within about 3% of its true value, from 1 ns up to about 18 minutes.
+///
+/// Recording is a handful of relaxed atomic operations and never
+/// blocks, so a histogram can be shared between threads and left on in
+/// production. Reading percentiles while other threads record gives an
+/// approximate snapshot.
+#ifndef __WRMATH_FILTER_LATENCY_H
+#define __WRMATH_FILTER_LATENCY_H
+
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+
+namespace wr {
+namespace filter {
+
+
+/// @brief LatencyHistogram is a fixed-size, lock-free histogram of
+/// durations in nanoseconds.
+class LatencyHistogram {
+public:
+	/// The number of sub-buckets per power of two is 2^SubBucketBits.
+	static constexpr unsigned	SubBucketBits = 5;
+
+	/// Values at or above 2^MaxValueBits nanoseconds are recorded in
+	/// the top bucket.
+	static constexpr unsigned	MaxValueBits = 40;
+
+	/// The total number of buckets.
+	static constexpr size_t		BucketCount =
+	    (MaxValueBits - SubBucketBits + 1) << SubBucketBits;
+
+	/// An empty histogram.
+	LatencyHistogram();
+
+	LatencyHistogram(const LatencyHistogram &) = delete;
+	LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+
+	/// Record a duration.
+	///
+	/// \param ns The duration in nanoseconds.
+	void		record(uint64_t ns);
+
+	/// Record a duration.
+	///
+	/// \param d The duration.
+	template <typename Rep, typename Period>
+	void
+	record(std::chrono::duration<Rep, Period> d)
+	{
+		auto	ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+
+		this->record(ns < 0 ? 0 : static_cast<uint64_t>(ns));
+	}
+
+
+	/// Return the number of recorded durations.
+	///
+	/// \return The number of calls to record since the last reset.
+	uint64_t	count() const;
+
+	/// Return the shortest recorded duration.
+	///
+	/// \return The minimum in nanoseconds, or 0 if nothing is recorded.
+	uint64_t	min() const;
+
+	/// Return the longest recorded duration.
+	///
+	/// \return The maximum in nanoseconds.
+	uint64_t	max() const;
+
+	/// Return the mean recorded duration.
+	///
+	/// \return The exact mean in nanoseconds, or 0 if nothing is
+	///         recorded.
+	double		mean() const;
+
+	/// Return the duration below which the given fraction of the
+	/// recorded durations fall. The result is the upper bound of the
+	/// bucket holding the percentile, capped at max().
+	///
+	/// \param p A fraction between 0 and 1, e.g. 0.99.
+	/// \return The percentile in nanoseconds, or 0 if nothing is
+	///         recorded.
+	uint64_t	percentile(double p) const;
+
+	/// Return the median duration.
+	uint64_t	p50() const { return this->percentile(0.5); }
+
+	/// Return the 99th percentile duration.
+	uint64_t	p99() const { return this->percentile(0.99); }
+
+	/// Return the 99.9th percentile duration.
+	uint64_t	p999() const { return this->percentile(0.999); }
+
+	/// Clear the histogram. Durations recorded concurrently with a
+	/// reset may be partially lost.
+	void		reset();
+
+
+	/// Return the bucket a value is recorded in.
+	///
+	/// \param ns A duration in nanoseconds.
+	/// \return The bucket index, less than BucketCount.
+	static size_t	bucket(uint64_t ns);
+
+	/// Return the smallest value recorded in a bucket.
+	///
+	/// \param i A bucket index.
+	/// \return The lower bound of the bucket in nanoseconds.
+	static uint64_t	bucketLower(size_t i);
+
+	/// Return the largest value recorded in a bucket.
+	///
+	/// \param i A bucket index.
+	/// \return The upper bound of the bucket in nanoseconds.
+	static uint64_t	bucketUpper(size_t i);
+
+
+	/// Write a one-line summary of the histogram.
+	///
+	/// \param outs An output stream.
+	/// \param h The histogram to summarise.
+	/// \return The output stream.
+	friend std::ostream &operator<<(std::ostream &outs, const LatencyHistogram &h);
+
+private:
+	std::atomic<uint64_t>	counts[BucketCount];
+	std::atomic<uint64_t>	total;
+	std::atomic<uint64_t>	sum;
+	std::atomic<uint64_t>	minimum;
+	std::atomic<uint64_t>	maximum;
+};
+
+
+/// @brief LatencyTimer records the time between its construction and
+/// destruction into a LatencyHistogram.
+///
+/// A null histogram disables the timer, so filters can keep a timer on
+/// every update and only pay for reading the clock when a histogram has
+/// been attached.
+class LatencyTimer {
+public:
+	/// Start timing.
+	///
+	/// \param h The histogram to record into, or nullptr.
+	explicit LatencyTimer(LatencyHistogram *h) : histogram(h)
+	{
+		if (this->histogram != nullptr) {
+			this->start = std::chrono::steady_clock::now();
+		}
+	}
+
+	LatencyTimer(const LatencyTimer &) = delete;
+	LatencyTimer &operator=(const LatencyTimer &) = delete;
+
+	/// Stop timing and record the duration.
+	~LatencyTimer()
+	{
+		if (this->histogram != nullptr) {
+			this->histogram->record(std::chrono::steady_clock::now() - this->start);
+		}
+	}
+
+private:
+	LatencyHistogram			*histogram;
+	std::chrono::steady_clock::time_point	 start;
+};
+
+
+} // namespace filter
+} // namespace wr
+
+
+#endif // __WRMATH_FILTER_LATENCY_H
@@ -6,8 +6,12 @@
 #define __WRMATH_FILTER_MADGWICK_H
 
 
+#include <wrmath/instrument.h>
+#include <wrmath/filter/gyrobias.h>
+#include <wrmath/filter/latency.h>
 #include <wrmath/geom/vector.h>
 #include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/renormalize.h>
 
 
 /// wr contains the wntrmute robotics code.
@@ -31,14 +35,17 @@ template <typename T>
 class Madgwick {
 public:
 	/// The Madgwick filter is initialised with an identity quaternion.
-	Madgwick() : deltaT(0.0), previousSensorFrame(), sensorFrame() {};
+	Madgwick() :
+		deltaT(0.0), previousSensorFrame(), sensorFrame(), latency(nullptr),
+		gyroBias(nullptr) {};
 
 
 	/// The Madgwick filter is initialised with a sensor frame.
 	///
 	/// \param sf A sensor frame; if zero, the sensor frame will be
 	///           initialised as an identity quaternion.
-	Madgwick(geom::Vector<T, 3> sf) : deltaT(0.0), previousSensorFrame()
+	Madgwick(geom::Vector<T, 3> sf) :
+		deltaT(0.0), previousSensorFrame(), latency(nullptr), gyroBias(nullptr)
 	{
 		if (!sf.isZero()) {
 			sensorFrame = geom::quaternion(sf, 0.0);
@@ -50,7 +57,8 @@ public:
 	///
 	/// \param sf A quaternion representing the current orientation.
 	Madgwick(geom::Quaternion<T> sf) :
-		deltaT(0.0), previousSensorFrame(), sensorFrame(sf) {};
+		deltaT(0.0), previousSensorFrame(), sensorFrame(sf), latency(nullptr),
+		gyroBias(nullptr) {};
 
 
 	/// Return the current orientation as measured by the filter.
@@ -72,6 +80,7 @@ public:
 	geom::Quaternion<T>
 	angularRate(const geom::Vector<T, 3> &gyro) const
 	{
+		WRMATH_COUNT("Madgwick::angularRate");
 		return (this->sensorFrame * 0.5) * geom::Quaternion<T>(gyro, 0.0);
 	}
 
@@ -82,13 +91,18 @@ public:
 	void
 	updateFrame(const geom::Quaternion<T> &sf, T delta)
 	{
+		WRMATH_COUNT("Madgwick::updateFrame");
 		this->previousSensorFrame = this->sensorFrame;
 		this->sensorFrame = sf;
 		this->deltaT = delta;
 	}
 
 
-	/// Update the sensor frame with a gyroscope reading.
+	/// Update the sensor frame with a gyroscope reading. If a bias
+	/// estimator is attached, the reading is passed through it and the
+	/// bias-compensated rate is integrated. If a latency histogram is
+	/// attached, the duration of the update is recorded. The sensor
+	/// frame is renormalized as the renormalization policy directs.
 	///
 	/// \param gyro A three-dimensional vector containing gyro readings
 	///             as w_x, w_y, w_z.
@@ -96,10 +110,35 @@ public:
 	void
 	updateAngularOrientation(const geom::Vector<T, 3> &gyro, T delta)
 	{
-		assert(!math::WithinTolerance(delta, 0.0, 0.001));
-		geom::Quaternion<T>	q = this->angularRate(gyro) * delta;
+		WRMATH_COUNT("Madgwick::updateAngularOrientation");
+		LatencyTimer	timer(this->latency);
+		assert(!math::WithinTolerance(delta, (T)0.0, (T)0.001));
 
-		this->updateFrame(this->sensorFrame + q, delta);
+		if (this->gyroBias != nullptr) {
+			this->integrate(this->gyroBias->update(gyro, delta), delta);
+		}
+		else {
+			this->integrate(gyro, delta);
+		}
+	}
+
+
+	/// Update the sensor frame with a gyroscope reading, removing a
+	/// known bias first. Any attached bias estimator is not used.
+	///
+	/// \param gyro A three-dimensional vector containing gyro readings
+	///             as w_x, w_y, w_z.
+	/// \param bias The gyroscope bias to subtract from the reading.
+	/// \param delta The time step between readings. It must not be zero.
+	void
+	updateAngularOrientation(const geom::Vector<T, 3> &gyro,
+				 const geom::Vector<T, 3> &bias, T delta)
+	{
+		WRMATH_COUNT("Madgwick::updateAngularOrientation");
+		LatencyTimer	timer(this->latency);
+		assert(!math::WithinTolerance(delta, (T)0.0, (T)0.001));
+
+		this->integrate(gyro - bias, delta);
 	}
 
 
@@ -109,13 +148,93 @@ public:
 	geom::Vector<T, 3>
 	euler()
 	{
+		WRMATH_COUNT("Madgwick::euler");
 		return this->sensorFrame.euler();
 	}
 
+
+	/// Attach a histogram that records the latency of each update.
+	/// The histogram is not owned by the filter and must outlive it;
+	/// several filters may share one.
+	///
+	/// \param h The histogram, or nullptr to stop recording.
+	void
+	setLatencyHistogram(LatencyHistogram *h)
+	{
+		this->latency = h;
+	}
+
+
+	/// Return the attached latency histogram.
+	///
+	/// \return The histogram, or nullptr if none is attached.
+	LatencyHistogram *
+	latencyHistogram() const
+	{
+		return this->latency;
+	}
+
+
+	/// Attach a gyroscope bias estimator, which will see every reading
+	/// passed to updateAngularOrientation and compensate it. The
+	/// estimator is not owned by the filter and must outlive it.
+	///
+	/// \param estimator The estimator, or nullptr to integrate raw
+	///                  readings.
+	void
+	setBiasEstimator(GyroBiasEstimator<T> *estimator)
+	{
+		this->gyroBias = estimator;
+	}
+
+
+	/// Return the attached bias estimator.
+	///
+	/// \return The estimator, or nullptr if none is attached.
+	GyroBiasEstimator<T> *
+	biasEstimator() const
+	{
+		return this->gyroBias;
+	}
+
+	/// Set the policy for renormalizing the sensor frame as gyroscope
+	/// readings are integrated. By default, it's renormalized every 16
+	/// updates, or sooner if its norm drifts; an interval and tolerance
+	/// of zero turn renormalization off.
+	///
+	/// \param opts The renormalization policy.
+	void
+	setRenormalization(const geom::RenormalizeOptions<T> &opts)
+	{
+		this->renormalizer.setOptions(opts);
+	}
+
+
+	/// Return the renormalizer, which counts the renormalizations done.
+	///
+	/// \return The renormalizer.
+	const geom::Renormalizer<T> &
+	renormalization() const
+	{
+		return this->renormalizer;
+	}
+
 private:
-	T			deltaT;
-	geom::Quaternion<T>	previousSensorFrame;
-	geom::Quaternion<T>	sensorFrame;
+	T			 deltaT;
+	geom::Quaternion<T>	 previousSensorFrame;
+	geom::Quaternion<T>	 sensorFrame;
+	LatencyHistogram	*latency;
+	GyroBiasEstimator<T>	*gyroBias;
+	geom::Renormalizer<T>	 renormalizer;
+
+	void
+	integrate(const geom::Vector<T, 3> &gyro, T delta)
+	{
+		geom::Quaternion<T>	q = this->angularRate(gyro) * delta;
+
+		this->updateFrame(this->sensorFrame + q, delta);
+		this->renormalizer.step(this->sensorFrame);
+	}
 };
 
 
@@ -0,0 +1,492 @@
+/// \file prefilter.h
+/// \brief Multi-channel IIR and FIR filter banks for conditioning sensor
+/// data before fusion.
+///
+/// Accelerometer and gyroscope readings are usually low-passed, and
+/// sometimes notched at a motor or vibration frequency, before they
+/// reach an orientation filter. The banks here filter many channels at
+/// once, such as x, y and z for each of several sensors. Samples arrive
+/// as frames of one value per channel, and the filter state is kept in
+/// structure-of-arrays form, one array per state variable indexed by
+/// channel, so the inner loops run across channels.
+///
+/// The design helpers follow Robert Bristow-Johnson's Audio EQ Cookbook
+/// for single biquads, cascading them for higher-order Butterworth
+/// low-pass filters, and use a Hamming-windowed sinc for FIR low-pass
+/// filters.
+#ifndef __WRMATH_FILTER_PREFILTER_H
+#define __WRMATH_FILTER_PREFILTER_H
+
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+
+namespace wr {
+namespace filter {
+
+
+/// @brief Biquad holds the normalised coefficients of a second-order
+/// section, y = (b0 + b1 z⁻¹ + b2 z⁻²) / (1 + a1 z⁻¹ + a2 z⁻²) x.
+template <typename T>
+struct Biquad {
+	T	b0;	///< The feedforward coefficients.
+	T	b1;
+	T	b2;
+	T	a1;	///< The feedback coefficients, with a0 = 1.
+	T	a2;
+
+	/// The default section passes its input through.
+	Biquad() : b0(1), b1(0), b2(0), a1(0), a2(0) {};
+
+	/// Build a section from its coefficients.
+	Biquad(T b0, T b1, T b2, T a1, T a2) :
+	    b0(b0), b1(b1), b2(b2), a1(a1), a2(a2) {};
+
+
+	/// Return the gain of the section for a constant input.
+	///
+	/// \return The DC gain.
+	T
+	dcGain() const
+	{
+		return (this->b0 + this->b1 + this->b2) / (1 + this->a1 + this->a2);
+	}
+
+
+	/// Return the magnitude of the section's frequency response.
+	///
+	/// \param frequency The frequency, in the same units as sampleRate.
+	/// \param sampleRate The sample rate.
+	/// \return The gain at the frequency.
+	T
+	gain(T frequency, T sampleRate) const
+	{
+		using std::cos;
+		using std::sin;
+		using std::sqrt;
+
+		T	w = (T)(2 * M_PI) * frequency / sampleRate;
+		T	c1 = cos(w), s1 = sin(w);
+		T	c2 = cos(2 * w), s2 = sin(2 * w);
+		T	nr = this->b0 + (this->b1 * c1) + (this->b2 * c2);
+		T	ni = (this->b1 * s1) + (this->b2 * s2);
+		T	dr = 1 + (this->a1 * c1) + (this->a2 * c2);
+		T	di = (this->a1 * s1) + (this->a2 * s2);
+
+		return sqrt(((nr * nr) + (ni * ni)) / ((dr * dr) + (di * di)));
+	}
+};
+
+
+/// Design a second-order low-pass section.
+///
+/// \param cutoff The -3 dB frequency when Q is 1/√2.
+/// \param sampleRate The sample rate; cutoff must be below half of it.
+/// \param Q The quality factor.
+/// \return The section.
+template <typename T>
+Biquad<T>
+LowPassBiquad(T cutoff, T sampleRate, T Q = (T)M_SQRT1_2)
+{
+	using std::cos;
+	using std::sin;
+
+	assert(cutoff > 0 && cutoff < sampleRate / 2);
+	assert(Q > 0);
+
+	T	w = (T)(2 * M_PI) * cutoff / sampleRate;
+	T	c = cos(w);
+	T	alpha = sin(w) / (2 * Q);
+	T	a0 = 1 + alpha;
+
+	return Biquad<T>(((1 - c) / 2) / a0, (1 - c) / a0, ((1 - c) / 2) / a0,
+			 (-2 * c) / a0, (1 - alpha) / a0);
+}
+
+
+/// Design a notch section, which removes a single frequency.
+///
+/// \param center The frequency to remove.
+/// \param sampleRate The sample rate; center must be below half of it.
+/// \param Q The quality factor; the notch is center / Q wide.
+/// \return The section.
+template <typename T>
+Biquad<T>
+NotchBiquad(T center, T sampleRate, T Q)
+{
+	using std::cos;
+	using std::sin;
+
+	assert(center > 0 && center < sampleRate / 2);
+	assert(Q > 0);
+
+	T	w = (T)(2 * M_PI) * center / sampleRate;
+	T	c = cos(w);
+	T	alpha = sin(w) / (2 * Q);
+	T	a0 = 1 + alpha;
+
+	return Biquad<T>(1 / a0, (-2 * c) / a0, 1 / a0, (-2 * c) / a0, (1 - alpha) / a0);
+}
+
+
+/// Design a Butterworth low-pass filter as a cascade of sections. An odd
+/// order ends with a first-order section.
+///
+/// \param order The filter order, at least 1.
+/// \param cutoff The -3 dB frequency.
+/// \param sampleRate The sample rate; cutoff must be below half of it.
+/// \param sections Storage for (order + 1) / 2 sections.
+/// \return The number of sections written.
+template <typename T>
+size_t
+ButterworthLowPass(size_t order, T cutoff, T sampleRate, Biquad<T> *sections)
+{
+	using std::cos;
+	using std::tan;
+
+	assert(order > 0);
+	assert(cutoff > 0 && cutoff < sampleRate / 2);
+
+	size_t	n = 0;
+
+	// The poles of a pair sit at an angle ψ from the negative real
+	// axis, giving Q = 1 / (2 cos ψ); an odd order puts one pole on the
+	// axis and shifts the rest by half a step.
+	for (size_t k = 0; k < order / 2; k++) {
+		T	psi = (T)M_PI * (T)((2 * k) + 1 + (order % 2)) / (T)(2 * order);
+		T	Q = 1 / (2 * cos(psi));
+
+		sections[n++] = LowPassBiquad(cutoff, sampleRate, Q);
+	}
+
+	if (order % 2 == 1) {
+		T	K = tan((T)M_PI * cutoff / sampleRate);
+
+		sections[n++] = Biquad<T>(K / (K + 1), K / (K + 1), 0, (K - 1) / (K + 1), 0);
+	}
+	return n;
+}
+
+
+/// Design a low-pass FIR filter as a Hamming-windowed sinc, with unity
+/// gain at DC. The filter delays its input by (taps - 1) / 2 samples.
+///
+/// \param taps The number of taps, at least 1.
+/// \param cutoff The cutoff frequency.
+/// \param sampleRate The sample rate; cutoff must be below half of it.
+/// \param h Storage for taps coefficients.
+template <typename T>
+void
+LowPassFIR(size_t taps, T cutoff, T sampleRate, T *h)
+{
+	using std::cos;
+	using std::sin;
+
+	assert(taps > 0);
+	assert(cutoff > 0 && cutoff < sampleRate / 2);
+
+	T	fc = cutoff / sampleRate;
+	T	mid = (T)(taps - 1) / 2;
+	T	sum = 0;
+
+	for (size_t i = 0; i < taps; i++) {
+		T	x = (T)i - mid;
+		T	s = x == 0 ? 2 * fc : sin((T)(2 * M_PI) * fc * x) / ((T)M_PI * x);
+		T	w = taps == 1 ? (T)1.0 :
+			    (T)0.54 - ((T)0.46 * cos((T)(2 * M_PI) * (T)i / (T)(taps - 1)));
+
+		h[i] = s * w;
+		sum += h[i];
+	}
+
+	for (size_t i = 0; i < taps; i++) {
+		h[i] /= sum;
+	}
+}
+
+
+/// @brief BiquadBank runs a cascade of biquad sections on many channels.
+///
+/// Every channel has its own coefficients and state for each stage, held
+/// in transposed direct form II, which behaves well in floating point.
+///
+/// \tparam T A floating point type.
+template <typename T>
+class BiquadBank {
+public:
+	/// Create a bank whose stages all pass their input through.
+	///
+	/// \param channels The number of channels in each frame.
+	/// \param stages The number of sections in the cascade.
+	BiquadBank(size_t channels, size_t stages) :
+	    nChannels(channels), nStages(stages),
+	    b0(channels * stages, 1), b1(channels * stages, 0), b2(channels * stages, 0),
+	    a1(channels * stages, 0), a2(channels * stages, 0),
+	    z1(channels * stages, 0), z2(channels * stages, 0)
+	{
+		assert(channels > 0);
+	}
+
+
+	/// Return the number of channels.
+	size_t	channels() const { return this->nChannels; }
+
+	/// Return the number of stages.
+	size_t	stages() const { return this->nStages; }
+
+
+	/// Set a stage's coefficients on every channel.
+	///
+	/// \param stage The stage index.
+	/// \param section The coefficients.
+	void
+	setStage(size_t stage, const Biquad<T> &section)
+	{
+		for (size_t c = 0; c < this->nChannels; c++) {
+			this->setStage(stage, c, section);
+		}
+	}
+
+
+	/// Set a stage's coefficients on one channel.
+	///
+	/// \param stage The stage index.
+	/// \param channel The channel index.
+	/// \param section The coefficients.
+	void
+	setStage(size_t stage, size_t channel, const Biquad<T> &section)
+	{
+		assert(stage < this->nStages);
+		assert(channel < this->nChannels);
+
+		size_t	i = (stage * this->nChannels) + channel;
+
+		this->b0[i] = section.b0;
+		this->b1[i] = section.b1;
+		this->b2[i] = section.b2;
+		this->a1[i] = section.a1;
+		this->a2[i] = section.a2;
+	}
+
+
+	/// Return a stage's coefficients on one channel.
+	///
+	/// \param stage The stage index.
+	/// \param channel The channel index.
+	/// \return The coefficients.
+	Biquad<T>
+	stage(size_t stage, size_t channel) const
+	{
+		size_t	i = (stage * this->nChannels) + channel;
+
+		return Biquad<T>(this->b0[i], this->b1[i], this->b2[i], this->a1[i], this->a2[i]);
+	}
+
+
+	/// Clear the filter state, as if every input so far had been zero.
+	void
+	reset()
+	{
+		for (size_t i = 0; i < this->z1.size(); i++) {
+			this->z1[i] = 0;
+			this->z2[i] = 0;
+		}
+	}
+
+
+	/// Set the filter state as if each channel had held a constant
+	/// value forever, which avoids a start-up transient on signals with
+	/// a large offset, such as an accelerometer measuring gravity.
+	///
+	/// \param frame One value per channel.
+	void
+	reset(const T *frame)
+	{
+		for (size_t c = 0; c < this->nChannels; c++) {
+			T	x = frame[c];
+
+			for (size_t s = 0; s < this->nStages; s++) {
+				size_t	i = (s * this->nChannels) + c;
+				T	y = x * (this->b0[i] + this->b1[i] + this->b2[i]) /
+					    (1 + this->a1[i] + this->a2[i]);
+
+				this->z1[i] = y - (this->b0[i] * x);
+				this->z2[i] = (this->b2[i] * x) - (this->a2[i] * y);
+				x = y;
+			}
+		}
+	}
+
+
+	/// Filter a block of frames.
+	///
+	/// \param in frames * channels() values, frame by frame.
+	/// \param out Storage for the filtered values; it may be in.
+	/// \param frames The number of frames.
+	void
+	process(const T *in, T *out, size_t frames)
+	{
+		size_t	C = this->nChannels;
+
+		for (size_t f = 0; f < frames; f++) {
+			const T	*x = in + (f * C);
+			T	*y = out + (f * C);
+
+			for (size_t c = 0; c < C; c++) {
+				y[c] = x[c];
+			}
+
+			for (size_t s = 0; s < this->nStages; s++) {
+				const T	*B0 = &this->b0[s * C];
+				const T	*B1 = &this->b1[s * C];
+				const T	*B2 = &this->b2[s * C];
+				const T	*A1 = &this->a1[s * C];
+				const T	*A2 = &this->a2[s * C];
+				T	*Z1 = &this->z1[s * C];
+				T	*Z2 = &this->z2[s * C];
+
+				for (size_t c = 0; c < C; c++) {
+					T	v = y[c];
+					T	r = (B0[c] * v) + Z1[c];
+
+					Z1[c] = (B1[c] * v) - (A1[c] * r) + Z2[c];
+					Z2[c] = (B2[c] * v) - (A2[c] * r);
+					y[c] = r;
+				}
+			}
+		}
+	}
+
+private:
+	size_t		nChannels;
+	size_t		nStages;
+	std::vector<T>	b0, b1, b2, a1, a2;
+	std::vector<T>	z1, z2;
+};
+
+
+/// @brief FIRBank runs one FIR filter on many channels.
+///
+/// Each channel keeps its own history of inputs, stored tap by tap so
+/// that one tap's products for all channels are contiguous.
+///
+/// \tparam T A floating point type.
+template <typename T>
+class FIRBank {
+public:
+	/// Create a bank.
+	///
+	/// \param channels The number of channels in each frame.
+	/// \param taps The filter coefficients, newest input first.
+	/// \param count The number of taps, at least 1.
+	FIRBank(size_t channels, const T *taps, size_t count) :
+	    nChannels(channels), h(taps, taps + count), history(channels * count, 0),
+	    pos(0)
+	{
+		assert(channels > 0);
+		assert(count > 0);
+	}
+
+
+	/// Return the number of channels.
+	size_t	channels() const { return this->nChannels; }
+
+	/// Return the number of taps.
+	size_t	taps() const { return this->h.size(); }
+
+
+	/// Clear the history, as if every input so far had been zero.
+	void
+	reset()
+	{
+		for (size_t i = 0; i < this->history.size(); i++) {
+			this->history[i] = 0;
+		}
+		this->pos = 0;
+	}
+
+
+	/// Fill the history as if each channel had held a constant value
+	/// forever.
+	///
+	/// \param frame One value per channel.
+	void
+	reset(const T *frame)
+	{
+		for (size_t k = 0; k < this->h.size(); k++) {
+			for (size_t c = 0; c < this->nChannels; c++) {
+				this->history[(k * this->nChannels) + c] = frame[c];
+			}
+		}
+		this->pos = 0;
+	}
+
+
+	/// Filter a block of frames.
+	///
+	/// \param in frames * channels() values, frame by frame.
+	/// \param out Storage for the filtered values; it may be in.
+	/// \param frames The number of frames.
+	void
+	process(const T *in, T *out, size_t frames)
+	{
+		size_t	C = this->nChannels;
+		size_t	N = this->h.size();
+
+		for (size_t f = 0; f < frames; f++) {
+			const T	*x = in + (f * C);
+			T	*y = out + (f * C);
+			T	*slot = &this->history[this->pos * C];
+
+			for (size_t c = 0; c < C; c++) {
+				slot[c] = x[c];
+				y[c] = 0;
+			}
+
+			// Tap k multiplies the input k frames ago, found by
+			// stepping back through the history ring.
+			size_t	j = this->pos;
+
+			for (size_t k = 0; k < N; k++) {
+				const T	*past = &this->history[j * C];
+				T	hk = this->h[k];
+
+				for (size_t c = 0; c < C; c++) {
+					y[c] += hk * past[c];
+				}
+				j = j == 0 ? N - 1 : j - 1;
+			}
+
+			this->pos = this->pos + 1 == N ? 0 : this->pos + 1;
+		}
+	}
+
+private:
+	size_t		nChannels;
+	std::vector<T>	h;
+	std::vector<T>	history;
+	size_t		pos;
+};
+
+
+/// BiquadBankd is a shorthand alias for a BiquadBank<double>.
+typedef BiquadBank<double>	BiquadBankd;
+
+/// BiquadBankf is a shorthand alias for a BiquadBank<float>.
+typedef BiquadBank<float>	BiquadBankf;
+
+/// FIRBankd is a shorthand alias for a FIRBank<double>.
+typedef FIRBank<double>		FIRBankd;
+
+/// FIRBankf is a shorthand alias for a FIRBank<float>.
+typedef FIRBank<float>		FIRBankf;
+
+
+} // namespace filter
+} // namespace wr
+
+
+#endif // __WRMATH_FILTER_PREFILTER_H
@@ -0,0 +1,516 @@
+/// \file sync.h
+/// \brief Time alignment of sensor streams sampled at different rates.
+///
+/// An IMU's gyroscope, accelerometer and magnetometer usually run at
+/// different rates, with jitter, and their samples rarely share a
+/// timestamp. SensorSynchronizer resamples all three onto a common
+/// clock at a fixed period, producing the time-aligned tuples that an
+/// orientation filter such as Madgwick expects.
+///
+/// Each stream is held in a SampleBuffer, a ring buffer whose storage
+/// is allocated once, when it's created; pushing and resampling never
+/// allocate. Once full, a buffer drops its oldest sample, so a stalled
+/// stream can't grow memory without bound. Resampling many output times
+/// at once walks each buffer a single time.
+///
+/// Timestamps are int64_t nanoseconds, as in wrmath/io/log.h, and must
+/// increase within each stream.
+#ifndef __WRMATH_FILTER_SYNC_H
+#define __WRMATH_FILTER_SYNC_H
+
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <wrmath/geom/vector.h>
+
+
+namespace wr {
+namespace filter {
+
+
+/// Interpolation selects how a SampleBuffer estimates values between
+/// samples.
+enum class Interpolation {
+	Linear,	///< Componentwise linear interpolation.
+	SLERP,	///< Spherical interpolation of unit quaternions <w, x, y, z>.
+};
+
+
+/// @brief SampleBuffer is a bounded, timestamped ring buffer of
+/// N-component samples that can be resampled at arbitrary times.
+///
+/// \tparam T The sample component type.
+/// \tparam N The number of components per sample; SLERP needs 4.
+template <typename T, size_t N>
+class SampleBuffer {
+public:
+	/// Create an empty buffer.
+	///
+	/// \param capacity The most samples held at once; at least 2.
+	/// \param mode How to interpolate between samples.
+	explicit SampleBuffer(size_t capacity, Interpolation mode = Interpolation::Linear) :
+	    times(capacity), values(capacity * N), mode(mode), head(0), count(0),
+	    droppedCount(0)
+	{
+		assert(capacity >= 2);
+		assert(mode == Interpolation::Linear || N == 4);
+	}
+
+
+	/// Return the number of samples held.
+	///
+	/// \return The number of samples.
+	size_t	size() const { return this->count; }
+
+	/// Return the most samples the buffer holds.
+	///
+	/// \return The capacity.
+	size_t	capacity() const { return this->times.size(); }
+
+	/// Return the number of samples dropped to make room, or rejected
+	/// as out of order.
+	///
+	/// \return The number of dropped samples.
+	size_t	dropped() const { return this->droppedCount; }
+
+	/// Return the time of the oldest sample; the buffer must not be
+	/// empty.
+	int64_t	oldest() const { return this->times[this->head]; }
+
+	/// Return the time of the newest sample; the buffer must not be
+	/// empty.
+	int64_t	newest() const { return this->times[this->slot(this->count - 1)]; }
+
+
+	/// Discard every sample.
+	void
+	clear()
+	{
+		this->head = 0;
+		this->count = 0;
+	}
+
+
+	/// Add a sample, dropping the oldest if the buffer is full.
+	///
+	/// \param t The sample time; it must be after the newest sample.
+	/// \param v N components.
+	/// \return False if the sample was out of order and ignored.
+	bool
+	push(int64_t t, const T *v)
+	{
+		if (this->count > 0 && t <= this->newest()) {
+			this->droppedCount++;
+			return false;
+		}
+
+		if (this->count == this->capacity()) {
+			this->head = this->slot(1);
+			this->count--;
+			this->droppedCount++;
+		}
+
+		size_t	s = this->slot(this->count);
+
+		this->times[s] = t;
+		for (size_t k = 0; k < N; k++) {
+			this->values[(s * N) + k] = v[k];
+		}
+		this->count++;
+		return true;
+	}
+
+
+	/// Return whether the buffer can interpolate at time t, which must
+	/// lie between its oldest and newest samples.
+	///
+	/// \param t A time.
+	/// \return True if t is covered.
+	bool
+	covers(int64_t t) const
+	{
+		return this->count > 0 && t >= this->oldest() && t <= this->newest();
+	}
+
+
+	/// Estimate the value at a single time.
+	///
+	/// \param t A time covered by the buffer.
+	/// \param out Storage for N components.
+	/// \return False if t isn't covered, in which case out is unchanged.
+	bool
+	interpolate(int64_t t, T *out) const
+	{
+		return this->interpolate(&t, 1, out) == 1;
+	}
+
+
+	/// Estimate the values at an increasing sequence of times, walking
+	/// the buffer once.
+	///
+	/// \param t count increasing times.
+	/// \param n The number of times.
+	/// \param out Storage for n * N components.
+	/// \return The number of leading times that were covered and
+	///         written; the rest are unchanged.
+	size_t
+	interpolate(const int64_t *t, size_t n, T *out) const
+	{
+		size_t	i = 0;
+
+		if (this->count == 0) {
+			return 0;
+		}
+
+		size_t	j = 0;	// Index of the sample at or before t[i].
+
+		for (; i < n; i++) {
+			if (t[i] < this->oldest() || t[i] > this->newest()) {
+				break;
+			}
+			while (j + 1 < this->count && this->time(j + 1) <= t[i]) {
+				j++;
+			}
+
+			const T	*a = this->value(j);
+
+			if (j + 1 == this->count) {
+				for (size_t k = 0; k < N; k++) {
+					out[(i * N) + k] = a[k];
+				}
+				continue;
+			}
+
+			const T	*b = this->value(j + 1);
+			T	frac = static_cast<T>(t[i] - this->time(j)) /
+				       static_cast<T>(this->time(j + 1) - this->time(j));
+
+			if (this->mode == Interpolation::SLERP) {
+				slerp(a, b, frac, out + (i * N));
+				continue;
+			}
+			for (size_t k = 0; k < N; k++) {
+				out[(i * N) + k] = a[k] + ((b[k] - a[k]) * frac);
+			}
+		}
+		return i;
+	}
+
+
+	/// Discard samples that are no longer needed to interpolate at t or
+	/// later, keeping the newest sample at or before t.
+	///
+	/// \param t A time.
+	void
+	discardBefore(int64_t t)
+	{
+		while (this->count > 1 && this->time(1) <= t) {
+			this->head = this->slot(1);
+			this->count--;
+		}
+	}
+
+private:
+	std::vector<int64_t>	times;
+	std::vector<T>		values;
+	Interpolation		mode;
+	size_t			head;
+	size_t			count;
+	size_t			droppedCount;
+
+	size_t
+	slot(size_t i) const
+	{
+		size_t	s = this->head + i;
+
+		return s < this->times.size() ? s : s - this->times.size();
+	}
+
+	int64_t	 time(size_t i) const { return this->times[this->slot(i)]; }
+	const T	*value(size_t i) const { return &this->values[this->slot(i) * N]; }
+
+	// slerp interpolates along the shorter arc, falling back to a
+	// normalised linear interpolation for nearly equal quaternions.
+	static void
+	slerp(const T *a, const T *b, T frac, T *out)
+	{
+		using std::acos;
+		using std::sin;
+		using std::sqrt;
+
+		T	d = (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]) + (a[3] * b[3]);
+		T	sign = d < 0 ? (T)-1.0 : (T)1.0;
+		T	wa, wb;
+
+		d *= sign;
+		if (d > (T)0.9995) {
+			wa = 1 - frac;
+			wb = frac;
+		}
+		else {
+			T	theta = acos(d);
+			T	s = (T)1.0 / sin(theta);
+
+			wa = sin((1 - frac) * theta) * s;
+			wb = sin(frac * theta) * s;
+		}
+		wb *= sign;
+
+		T	n = 0;
+
+		for (size_t k = 0; k < 4; k++) {
+			out[k] = (wa * a[k]) + (wb * b[k]);
+			n += out[k] * out[k];
+		}
+		n = (T)1.0 / sqrt(n);
+		for (size_t k = 0; k < 4; k++) {
+			out[k] *= n;
+		}
+	}
+};
+
+
+/// @brief SyncedSample is one time-aligned set of IMU readings.
+template <typename T>
+struct SyncedSample {
+	int64_t	time;		///< The sample time in nanoseconds.
+	T	gyro[3];	///< The angular rate.
+	T	accel[3];	///< The acceleration.
+	T	mag[3];		///< The magnetic field, if magnetometer is set.
+	bool	magnetometer;	///< Whether mag holds a reading.
+
+	/// Return the angular rate as a Vector.
+	geom::Vector<T, 3>	gyroscope() const { return geom::Vector<T, 3>(this->gyro); }
+
+	/// Return the acceleration as a Vector.
+	geom::Vector<T, 3>	accelerometer() const { return geom::Vector<T, 3>(this->accel); }
+
+	/// Return the magnetic field as a Vector.
+	geom::Vector<T, 3>	magneticField() const { return geom::Vector<T, 3>(this->mag); }
+};
+
+
+/// @brief SensorSynchronizer resamples gyroscope, accelerometer and
+/// optionally magnetometer streams onto a common fixed-rate clock.
+///
+/// Output times start at the first time all streams have data and
+/// advance by the period. A tuple is emitted once every stream has a
+/// sample at or after its time, so the output lags the slowest stream
+/// by up to one of its sample intervals. If a stream falls so far
+/// behind that the samples needed for an output time have been dropped,
+/// the output clock skips forward and the skipped times are counted.
+///
+/// \tparam T The sample component type.
+template <typename T>
+class SensorSynchronizer {
+public:
+	/// SyncBatch is the number of outputs resampled together by drain.
+	static constexpr size_t	SyncBatch = 64;
+
+
+	/// Create a synchronizer.
+	///
+	/// \param period The output period in nanoseconds.
+	/// \param capacity The number of samples buffered per stream.
+	/// \param useMagnetometer Whether to wait for and resample a
+	///                        magnetometer stream.
+	SensorSynchronizer(int64_t period, size_t capacity = 64, bool useMagnetometer = true) :
+	    gyro(capacity), accel(capacity), mag(capacity), period(period),
+	    nextTime(0), started(false), useMag(useMagnetometer), skippedCount(0)
+	{
+		assert(period > 0);
+	}
+
+
+	/// Add a gyroscope sample.
+	///
+	/// \param t The sample time in nanoseconds.
+	/// \param v The angular rate.
+	/// \return False if the sample was out of order and ignored.
+	bool	pushGyro(int64_t t, const T *v) { return this->gyro.push(t, v); }
+
+	/// Add an accelerometer sample.
+	///
+	/// \param t The sample time in nanoseconds.
+	/// \param v The acceleration.
+	/// \return False if the sample was out of order and ignored.
+	bool	pushAccel(int64_t t, const T *v) { return this->accel.push(t, v); }
+
+	/// Add a magnetometer sample.
+	///
+	/// \param t The sample time in nanoseconds.
+	/// \param v The magnetic field.
+	/// \return False if the sample was out of order and ignored.
+	bool	pushMag(int64_t t, const T *v) { return this->mag.push(t, v); }
+
+	/// Add a gyroscope sample.
+	bool	pushGyro(int64_t t, const geom::Vector<T, 3> &v) { return this->pushVector(this->gyro, t, v); }
+
+	/// Add an accelerometer sample.
+	bool	pushAccel(int64_t t, const geom::Vector<T, 3> &v) { return this->pushVector(this->accel, t, v); }
+
+	/// Add a magnetometer sample.
+	bool	pushMag(int64_t t, const geom::Vector<T, 3> &v) { return this->pushVector(this->mag, t, v); }
+
+
+	/// Return the output period.
+	///
+	/// \return The period in nanoseconds.
+	int64_t	outputPeriod() const { return this->period; }
+
+	/// Return the number of output times skipped because a stream fell
+	/// too far behind.
+	///
+	/// \return The number of skipped outputs.
+	size_t	skipped() const { return this->skippedCount; }
+
+	/// Return the buffer for the gyroscope stream.
+	const SampleBuffer<T, 3>	&gyroBuffer() const { return this->gyro; }
+
+	/// Return the buffer for the accelerometer stream.
+	const SampleBuffer<T, 3>	&accelBuffer() const { return this->accel; }
+
+	/// Return the buffer for the magnetometer stream.
+	const SampleBuffer<T, 3>	&magBuffer() const { return this->mag; }
+
+
+	/// Return the next aligned sample, if every stream has reached it.
+	///
+	/// \param out Set to the sample.
+	/// \return True if a sample was written.
+	bool	next(SyncedSample<T> &out) { return this->drain(&out, 1) == 1; }
+
+
+	/// Emit as many aligned samples as every stream allows.
+	///
+	/// \param out Storage for up to max samples.
+	/// \param max The most samples to write.
+	/// \return The number of samples written.
+	size_t
+	drain(SyncedSample<T> *out, size_t max)
+	{
+		if (!this->align()) {
+			return 0;
+		}
+
+		int64_t	last = this->gyro.newest() < this->accel.newest() ?
+				   this->gyro.newest() : this->accel.newest();
+
+		if (this->useMag && this->mag.newest() < last) {
+			last = this->mag.newest();
+		}
+		if (last < this->nextTime) {
+			return 0;
+		}
+
+		size_t	ready = static_cast<size_t>((last - this->nextTime) / this->period) + 1;
+		size_t	n = ready < max ? ready : max;
+		size_t	written = 0;
+		int64_t	times[SyncBatch];
+		T	g[SyncBatch * 3], a[SyncBatch * 3], m[SyncBatch * 3];
+
+		while (written < n) {
+			size_t	batch = n - written < SyncBatch ? n - written : SyncBatch;
+
+			for (size_t i = 0; i < batch; i++) {
+				times[i] = this->nextTime + (static_cast<int64_t>(i) * this->period);
+			}
+
+			// Every time is covered, by the checks above.
+			this->gyro.interpolate(times, batch, g);
+			this->accel.interpolate(times, batch, a);
+			if (this->useMag) {
+				this->mag.interpolate(times, batch, m);
+			}
+
+			for (size_t i = 0; i < batch; i++) {
+				SyncedSample<T>	&s = out[written + i];
+
+				s.time = times[i];
+				s.magnetometer = this->useMag;
+				for (size_t k = 0; k < 3; k++) {
+					s.gyro[k] = g[(i * 3) + k];
+					s.accel[k] = a[(i * 3) + k];
+					s.mag[k] = this->useMag ? m[(i * 3) + k] : (T)0.0;
+				}
+			}
+
+			written += batch;
+			this->nextTime += static_cast<int64_t>(batch) * this->period;
+			this->gyro.discardBefore(this->nextTime);
+			this->accel.discardBefore(this->nextTime);
+			this->mag.discardBefore(this->nextTime);
+		}
+		return written;
+	}
+
+private:
+	SampleBuffer<T, 3>	gyro;
+	SampleBuffer<T, 3>	accel;
+	SampleBuffer<T, 3>	mag;
+	int64_t			period;
+	int64_t			nextTime;
+	bool			started;
+	bool			useMag;
+	size_t			skippedCount;
+
+	static bool
+	pushVector(SampleBuffer<T, 3> &buf, int64_t t, const geom::Vector<T, 3> &v)
+	{
+		T	arr[3] = {v[0], v[1], v[2]};
+
+		return buf.push(t, arr);
+	}
+
+	// align starts the output clock once every stream has data, and
+	// skips it forward past any samples that have been dropped.
+	bool
+	align()
+	{
+		if (this->gyro.size() == 0 || this->accel.size() == 0 ||
+		    (this->useMag && this->mag.size() == 0)) {
+			return false;
+		}
+
+		int64_t	first = this->gyro.oldest() > this->accel.oldest() ?
+				    this->gyro.oldest() : this->accel.oldest();
+
+		if (this->useMag && this->mag.oldest() > first) {
+			first = this->mag.oldest();
+		}
+
+		if (!this->started) {
+			this->nextTime = first;
+			this->started = true;
+		}
+		else if (this->nextTime < first) {
+			int64_t	steps = (first - this->nextTime + this->period - 1) / this->period;
+
+			this->nextTime += steps * this->period;
+			this->skippedCount += static_cast<size_t>(steps);
+		}
+		return true;
+	}
+};
+
+
+template <typename T>
+constexpr size_t	SensorSynchronizer<T>::SyncBatch;
+
+
+/// SensorSynchronizerd is a shorthand alias for a SensorSynchronizer<double>.
+typedef SensorSynchronizer<double>	SensorSynchronizerd;
+
+/// SensorSynchronizerf is a shorthand alias for a SensorSynchronizer<float>.
+typedef SensorSynchronizer<float>	SensorSynchronizerf;
+
+
+} // namespace filter
+} // namespace wr
+
+
+#endif // __WRMATH_FILTER_SYNC_H
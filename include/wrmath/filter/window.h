@@ -0,0 +1,620 @@
+/// \file window.h
+/// \brief Statistics over a sliding window of vector samples.
+///
+/// These track the mean, variance, extrema and median of the last few
+/// samples of a stream, as used for stationary detection, vibration
+/// monitoring and outlier rejection, without rescanning the window on
+/// every sample. Each keeps its samples in storage allocated once, when
+/// it's created, and updates in constant or logarithmic time:
+///
+/// - SlidingMoments updates the mean and variance in O(1), replacing
+///   the oldest sample's contribution with the newest's.
+/// - SlidingExtrema keeps a monotonic deque per component, for O(1)
+///   amortised minimum and maximum.
+/// - SlidingMedian keeps a max-heap of the lower half and a min-heap of
+///   the upper half of each component, with every sample's position
+///   indexed so that the oldest can be removed in O(log n).
+///
+/// Each component of the vectors is treated independently.
+#ifndef __WRMATH_FILTER_WINDOW_H
+#define __WRMATH_FILTER_WINDOW_H
+
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <wrmath/geom/vector.h>
+
+
+namespace wr {
+namespace filter {
+
+
+/// @brief SlidingMoments tracks the mean and variance of the last
+/// window samples.
+///
+/// Replacing samples one at a time slowly accumulates rounding error,
+/// so the sums are recomputed exactly from the window once every window
+/// samples, which keeps the amortised cost constant.
+///
+/// \tparam T A floating point type.
+/// \tparam N The number of components per sample.
+template <typename T, size_t N>
+class SlidingMoments {
+public:
+	/// Create an empty window.
+	///
+	/// \param window The number of samples covered, at least 1.
+	explicit SlidingMoments(size_t window) :
+	    samples(window * N), window(window)
+	{
+		assert(window > 0);
+		this->reset();
+	}
+
+
+	/// Discard every sample.
+	void
+	reset()
+	{
+		for (size_t k = 0; k < N; k++) {
+			this->avg[k] = 0;
+			this->m2[k] = 0;
+		}
+		this->count = 0;
+		this->next = 0;
+		this->replaced = 0;
+	}
+
+
+	/// Return the number of samples in the window.
+	size_t	size() const { return this->count; }
+
+	/// Return whether the window holds window samples.
+	bool	full() const { return this->count == this->window; }
+
+
+	/// Add a sample, dropping the oldest if the window is full.
+	///
+	/// \param x N components.
+	void
+	push(const T *x)
+	{
+		T	*slot = &this->samples[this->next * N];
+
+		if (this->count < this->window) {
+			this->count++;
+			for (size_t k = 0; k < N; k++) {
+				T	d = x[k] - this->avg[k];
+
+				this->avg[k] += d / (T)this->count;
+				this->m2[k] += d * (x[k] - this->avg[k]);
+				slot[k] = x[k];
+			}
+		}
+		else {
+			for (size_t k = 0; k < N; k++) {
+				T	old = slot[k];
+				T	prev = this->avg[k];
+
+				this->avg[k] += (x[k] - old) / (T)this->count;
+				this->m2[k] += (x[k] - old) * (x[k] - this->avg[k] + old - prev);
+				if (this->m2[k] < 0) {
+					this->m2[k] = 0;
+				}
+				slot[k] = x[k];
+			}
+
+			if (++this->replaced == this->window) {
+				this->recompute();
+			}
+		}
+
+		this->next = this->next + 1 == this->window ? 0 : this->next + 1;
+	}
+
+
+	/// Add a sample, dropping the oldest if the window is full.
+	///
+	/// \param x The sample.
+	void
+	push(const geom::Vector<T, N> &x)
+	{
+		T	arr[N];
+
+		for (size_t k = 0; k < N; k++) {
+			arr[k] = x[k];
+		}
+		this->push(arr);
+	}
+
+
+	/// Return the mean of the window.
+	///
+	/// \return The mean of each component, or zero if empty.
+	geom::Vector<T, N>
+	mean() const
+	{
+		T	v[N];
+
+		for (size_t k = 0; k < N; k++) {
+			v[k] = this->avg[k];
+		}
+		return geom::Vector<T, N>(v);
+	}
+
+
+	/// Return the sample variance of the window.
+	///
+	/// \return The unbiased variance of each component, or zero if
+	///         there are fewer than two samples.
+	geom::Vector<T, N>
+	variance() const
+	{
+		T	v[N];
+
+		for (size_t k = 0; k < N; k++) {
+			v[k] = this->count > 1 ? this->m2[k] / (T)(this->count - 1) : (T)0.0;
+		}
+		return geom::Vector<T, N>(v);
+	}
+
+private:
+	std::vector<T>	samples;
+	size_t		window;
+	size_t		count;
+	size_t		next;
+	size_t		replaced;
+	T		avg[N];
+	T		m2[N];
+
+	void
+	recompute()
+	{
+		for (size_t k = 0; k < N; k++) {
+			T	s = 0;
+
+			for (size_t i = 0; i < this->count; i++) {
+				s += this->samples[(i * N) + k];
+			}
+			this->avg[k] = s / (T)this->count;
+
+			T	q = 0;
+
+			for (size_t i = 0; i < this->count; i++) {
+				T	d = this->samples[(i * N) + k] - this->avg[k];
+
+				q += d * d;
+			}
+			this->m2[k] = q;
+		}
+		this->replaced = 0;
+	}
+};
+
+
+/// @brief SlidingExtrema tracks the minimum and maximum of the last
+/// window samples.
+///
+/// Each component keeps two monotonic deques of the samples that could
+/// still become the extreme: a new sample evicts every older one it
+/// dominates, so each sample is added and removed at most once.
+///
+/// \tparam T A floating point type.
+/// \tparam N The number of components per sample.
+template <typename T, size_t N>
+class SlidingExtrema {
+public:
+	/// Create an empty window.
+	///
+	/// \param window The number of samples covered, at least 1.
+	explicit SlidingExtrema(size_t window) :
+	    window(window), lowSeq(window * N), lowVal(window * N),
+	    highSeq(window * N), highVal(window * N)
+	{
+		assert(window > 0);
+		this->reset();
+	}
+
+
+	/// Discard every sample.
+	void
+	reset()
+	{
+		for (size_t k = 0; k < N; k++) {
+			this->lowHead[k] = 0;
+			this->lowSize[k] = 0;
+			this->highHead[k] = 0;
+			this->highSize[k] = 0;
+		}
+		this->seq = 0;
+	}
+
+
+	/// Return the number of samples in the window.
+	size_t	size() const { return this->seq < this->window ? (size_t)this->seq : this->window; }
+
+
+	/// Add a sample, dropping the oldest if the window is full.
+	///
+	/// \param x N components.
+	void
+	push(const T *x)
+	{
+		size_t	base = 0;
+
+		for (size_t k = 0; k < N; k++, base += this->window) {
+			this->pushDeque(&this->lowSeq[base], &this->lowVal[base],
+					this->lowHead[k], this->lowSize[k], x[k], false);
+			this->pushDeque(&this->highSeq[base], &this->highVal[base],
+					this->highHead[k], this->highSize[k], x[k], true);
+		}
+		this->seq++;
+	}
+
+
+	/// Add a sample, dropping the oldest if the window is full.
+	///
+	/// \param x The sample.
+	void
+	push(const geom::Vector<T, N> &x)
+	{
+		T	arr[N];
+
+		for (size_t k = 0; k < N; k++) {
+			arr[k] = x[k];
+		}
+		this->push(arr);
+	}
+
+
+	/// Return the minimum of the window; it must not be empty.
+	///
+	/// \return The minimum of each component.
+	geom::Vector<T, N>
+	min() const
+	{
+		T	v[N];
+
+		assert(this->seq > 0);
+		for (size_t k = 0; k < N; k++) {
+			v[k] = this->lowVal[(k * this->window) + this->lowHead[k]];
+		}
+		return geom::Vector<T, N>(v);
+	}
+
+
+	/// Return the maximum of the window; it must not be empty.
+	///
+	/// \return The maximum of each component.
+	geom::Vector<T, N>
+	max() const
+	{
+		T	v[N];
+
+		assert(this->seq > 0);
+		for (size_t k = 0; k < N; k++) {
+			v[k] = this->highVal[(k * this->window) + this->highHead[k]];
+		}
+		return geom::Vector<T, N>(v);
+	}
+
+private:
+	size_t			window;
+	uint64_t		seq;
+	std::vector<uint64_t>	lowSeq;
+	std::vector<T>		lowVal;
+	std::vector<uint64_t>	highSeq;
+	std::vector<T>		highVal;
+	size_t			lowHead[N], lowSize[N];
+	size_t			highHead[N], highSize[N];
+
+	// pushDeque adds x to one ring-buffer deque, whose values run from
+	// the extreme at its head to the newest sample at its tail.
+	void
+	pushDeque(uint64_t *seqs, T *vals, size_t &head, size_t &size, T x, bool high)
+	{
+		size_t	w = this->window;
+
+		// Expire the head if it has left the window.
+		if (size > 0 && seqs[head] + w <= this->seq) {
+			head = head + 1 == w ? 0 : head + 1;
+			size--;
+		}
+
+		// Drop samples from the tail that x dominates.
+		while (size > 0) {
+			size_t	tail = head + size - 1;
+
+			tail = tail >= w ? tail - w : tail;
+			if (high ? vals[tail] > x : vals[tail] < x) {
+				break;
+			}
+			size--;
+		}
+
+		size_t	slot = head + size;
+
+		slot = slot >= w ? slot - w : slot;
+		seqs[slot] = this->seq;
+		vals[slot] = x;
+		size++;
+	}
+};
+
+
+/// @brief SlidingMedian tracks the median of the last window samples.
+///
+/// Each component splits the window between a max-heap holding the
+/// lower half and a min-heap holding the upper half, with the lower
+/// half never smaller. Every sample records which heap holds it and
+/// where, so when it leaves the window it can be removed directly.
+///
+/// \tparam T A floating point type.
+/// \tparam N The number of components per sample.
+template <typename T, size_t N>
+class SlidingMedian {
+public:
+	/// Create an empty window.
+	///
+	/// \param window The number of samples covered, at least 1.
+	explicit SlidingMedian(size_t window) :
+	    window(window), values(window * N), heaps(window * N * 2),
+	    side(window * N), position(window * N)
+	{
+		assert(window > 0);
+		this->reset();
+	}
+
+
+	/// Discard every sample.
+	void
+	reset()
+	{
+		for (size_t k = 0; k < N; k++) {
+			this->sizes[k][0] = 0;
+			this->sizes[k][1] = 0;
+		}
+		this->count = 0;
+		this->next = 0;
+	}
+
+
+	/// Return the number of samples in the window.
+	size_t	size() const { return this->count; }
+
+
+	/// Add a sample, dropping the oldest if the window is full.
+	///
+	/// \param x N components.
+	void
+	push(const T *x)
+	{
+		size_t	s = this->next;
+
+		for (size_t k = 0; k < N; k++) {
+			if (this->count == this->window) {
+				this->remove(k, s);
+			}
+			this->insert(k, s, x[k]);
+		}
+
+		if (this->count < this->window) {
+			this->count++;
+		}
+		this->next = this->next + 1 == this->window ? 0 : this->next + 1;
+	}
+
+
+	/// Add a sample, dropping the oldest if the window is full.
+	///
+	/// \param x The sample.
+	void
+	push(const geom::Vector<T, N> &x)
+	{
+		T	arr[N];
+
+		for (size_t k = 0; k < N; k++) {
+			arr[k] = x[k];
+		}
+		this->push(arr);
+	}
+
+
+	/// Return the median of the window; it must not be empty. With an
+	/// even number of samples, it's the mean of the middle two.
+	///
+	/// \return The median of each component.
+	geom::Vector<T, N>
+	median() const
+	{
+		T	v[N];
+
+		assert(this->count > 0);
+		for (size_t k = 0; k < N; k++) {
+			T	lo = this->top(k, Low);
+
+			v[k] = this->sizes[k][Low] > this->sizes[k][High] ?
+			       lo : (lo + this->top(k, High)) / 2;
+		}
+		return geom::Vector<T, N>(v);
+	}
+
+private:
+	static const size_t	Low = 0;	// The max-heap of the lower half.
+	static const size_t	High = 1;	// The min-heap of the upper half.
+
+	size_t			window;
+	size_t			count;
+	size_t			next;
+	std::vector<T>		values;		// values[k * window + slot]
+	std::vector<size_t>	heaps;		// Slots, for each component and side.
+	std::vector<uint8_t>	side;		// The heap holding each slot.
+	std::vector<size_t>	position;	// The index of each slot in its heap.
+	size_t			sizes[N][2];
+
+	size_t	*heap(size_t k, size_t h) { return &this->heaps[((k * 2) + h) * this->window]; }
+	T	 value(size_t k, size_t slot) const { return this->values[(k * this->window) + slot]; }
+
+	T
+	top(size_t k, size_t h) const
+	{
+		return this->value(k, this->heaps[((k * 2) + h) * this->window]);
+	}
+
+	// above reports whether slot a belongs above slot b in heap h.
+	bool
+	above(size_t k, size_t h, size_t a, size_t b) const
+	{
+		return h == Low ? this->value(k, a) > this->value(k, b) :
+				  this->value(k, a) < this->value(k, b);
+	}
+
+	void
+	place(size_t k, size_t h, size_t i, size_t slot)
+	{
+		this->heap(k, h)[i] = slot;
+		this->side[(k * this->window) + slot] = (uint8_t)h;
+		this->position[(k * this->window) + slot] = i;
+	}
+
+	void
+	siftUp(size_t k, size_t h, size_t i)
+	{
+		size_t	*H = this->heap(k, h);
+		size_t	slot = H[i];
+
+		while (i > 0) {
+			size_t	parent = (i - 1) / 2;
+
+			if (!this->above(k, h, slot, H[parent])) {
+				break;
+			}
+			this->place(k, h, i, H[parent]);
+			i = parent;
+		}
+		this->place(k, h, i, slot);
+	}
+
+	void
+	siftDown(size_t k, size_t h, size_t i)
+	{
+		size_t	*H = this->heap(k, h);
+		size_t	n = this->sizes[k][h];
+		size_t	slot = H[i];
+
+		for (;;) {
+			size_t	child = (2 * i) + 1;
+
+			if (child >= n) {
+				break;
+			}
+			if (child + 1 < n && this->above(k, h, H[child + 1], H[child])) {
+				child++;
+			}
+			if (!this->above(k, h, H[child], slot)) {
+				break;
+			}
+			this->place(k, h, i, H[child]);
+			i = child;
+		}
+		this->place(k, h, i, slot);
+	}
+
+	void
+	pushHeap(size_t k, size_t h, size_t slot)
+	{
+		size_t	i = this->sizes[k][h]++;
+
+		this->place(k, h, i, slot);
+		this->siftUp(k, h, i);
+	}
+
+	// removeAt takes the slot at index i out of heap h.
+	void
+	removeAt(size_t k, size_t h, size_t i)
+	{
+		size_t	*H = this->heap(k, h);
+		size_t	last = --this->sizes[k][h];
+
+		if (i == last) {
+			return;
+		}
+
+		// The last entry fills the hole, then moves whichever way
+		// the heap order needs.
+		size_t	moved = H[last];
+
+		this->place(k, h, i, moved);
+		this->siftUp(k, h, i);
+		this->siftDown(k, h, this->position[(k * this->window) + moved]);
+	}
+
+	// rebalance restores |Low| = |High| or |Low| = |High| + 1.
+	void
+	rebalance(size_t k)
+	{
+		while (this->sizes[k][Low] > this->sizes[k][High] + 1) {
+			size_t	slot = this->heap(k, Low)[0];
+
+			this->removeAt(k, Low, 0);
+			this->pushHeap(k, High, slot);
+		}
+		while (this->sizes[k][High] > this->sizes[k][Low]) {
+			size_t	slot = this->heap(k, High)[0];
+
+			this->removeAt(k, High, 0);
+			this->pushHeap(k, Low, slot);
+		}
+	}
+
+	void
+	insert(size_t k, size_t slot, T x)
+	{
+		this->values[(k * this->window) + slot] = x;
+		if (this->sizes[k][Low] == 0 || x <= this->top(k, Low)) {
+			this->pushHeap(k, Low, slot);
+		}
+		else {
+			this->pushHeap(k, High, slot);
+		}
+		this->rebalance(k);
+	}
+
+	void
+	remove(size_t k, size_t slot)
+	{
+		size_t	i = (k * this->window) + slot;
+
+		this->removeAt(k, this->side[i], this->position[i]);
+		this->rebalance(k);
+	}
+};
+
+
+/// SlidingMoments3d tracks the moments of a stream of Vector3d.
+typedef SlidingMoments<double, 3>	SlidingMoments3d;
+
+/// SlidingMoments3f tracks the moments of a stream of Vector3f.
+typedef SlidingMoments<float, 3>	SlidingMoments3f;
+
+/// SlidingExtrema3d tracks the extrema of a stream of Vector3d.
+typedef SlidingExtrema<double, 3>	SlidingExtrema3d;
+
+/// SlidingExtrema3f tracks the extrema of a stream of Vector3f.
+typedef SlidingExtrema<float, 3>	SlidingExtrema3f;
+
+/// SlidingMedian3d tracks the median of a stream of Vector3d.
+typedef SlidingMedian<double, 3>	SlidingMedian3d;
+
+/// SlidingMedian3f tracks the median of a stream of Vector3f.
+typedef SlidingMedian<float, 3>		SlidingMedian3f;
+
+
+} // namespace filter
+} // namespace wr
+
+
+#endif // __WRMATH_FILTER_WINDOW_H
@@ -0,0 +1,410 @@
+/// \file chain.h
+/// \brief Forward kinematics over a tree of rigid joints.
+///
+/// A KinematicChain is a tree of joints, each with a rotation and a
+/// translation relative to its parent. The chain keeps the world pose
+/// of every joint and, when joints change, recomputes only the joints
+/// below them.
+///
+/// Joint rotations are expected to be unit quaternions, and follow the
+/// convention of Quaternion::rotate: a joint's world rotation q is its
+/// local rotation composed with its parent's world rotation, and a point
+/// p in a joint's frame is at q* p q + worldTranslation in the world
+/// frame, with p as a pure quaternion.
+#ifndef __WRMATH_GEOM_CHAIN_H
+#define __WRMATH_GEOM_CHAIN_H
+
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+
+
+namespace wr {
+namespace geom {
+
+
+/// @brief KinematicChain computes the world poses of a tree of joints.
+///
+/// Joints are stored in flat arrays in the order they were added, and a
+/// joint's parent must be added before it, so a single forward pass
+/// visits every parent before its children. Each pose is seven
+/// contiguous scalars, <w, x, y, z> for the rotation followed by
+/// <x, y, z> for the translation.
+///
+/// Changing a joint marks it dirty; the next call to update, or to one
+/// of the world pose accessors, recomputes that joint and everything
+/// below it, and nothing else.
+///
+/// \tparam T A floating point type.
+template <typename T>
+class KinematicChain {
+public:
+	/// NoParent is the parent index of a root joint.
+	static constexpr size_t	NoParent = std::numeric_limits<size_t>::max();
+
+	/// The number of scalars in a stored pose.
+	static constexpr size_t	PoseSize = 7;
+
+	/// An empty chain.
+	KinematicChain() : firstDirty(0) {};
+
+
+	/// Reserve storage for a number of joints.
+	///
+	/// @param n The expected number of joints.
+	void
+	reserve(size_t n)
+	{
+		this->parents.reserve(n);
+		this->dirty.reserve(n);
+		this->local.reserve(n * PoseSize);
+		this->world.reserve(n * PoseSize);
+	}
+
+
+	/// Add a joint to the chain.
+	///
+	/// @param parent The index of the parent joint, which must already
+	///               be in the chain, or NoParent for a root joint.
+	/// @param rotation The rotation relative to the parent.
+	/// @param translation The position of the joint in its parent's
+	///                    frame.
+	/// @return The index of the new joint.
+	size_t
+	addJoint(size_t parent, const Quaternion<T> &rotation,
+		 const Vector<T, 3> &translation)
+	{
+		assert(parent == NoParent || parent < this->size());
+
+		size_t	i = this->size();
+
+		this->parents.push_back(parent);
+		this->dirty.push_back(1);
+		this->local.resize(this->local.size() + PoseSize);
+		this->world.resize(this->world.size() + PoseSize);
+		this->setLocal(i, rotation, translation);
+		return i;
+	}
+
+
+	/// Return the number of joints.
+	///
+	/// @return The number of joints in the chain.
+	size_t	size() const { return this->parents.size(); }
+
+	/// Return the parent of a joint.
+	///
+	/// @param i A joint index.
+	/// @return The parent index, or NoParent for a root joint.
+	size_t	parent(size_t i) const { return this->parents[i]; }
+
+
+	/// Set a joint's rotation relative to its parent.
+	///
+	/// @param i A joint index.
+	/// @param rotation The new local rotation.
+	void
+	setRotation(size_t i, const Quaternion<T> &rotation)
+	{
+		assert(i < this->size());
+
+		Vector<T, 3>	axis = rotation.axis();
+		T		*p = &this->local[i * PoseSize];
+
+		p[0] = rotation.angle();
+		p[1] = axis[0];
+		p[2] = axis[1];
+		p[3] = axis[2];
+		this->markDirty(i);
+	}
+
+
+	/// Set a joint's position in its parent's frame.
+	///
+	/// @param i A joint index.
+	/// @param translation The new local translation.
+	void
+	setTranslation(size_t i, const Vector<T, 3> &translation)
+	{
+		assert(i < this->size());
+
+		T	*p = &this->local[i * PoseSize];
+
+		p[4] = translation[0];
+		p[5] = translation[1];
+		p[6] = translation[2];
+		this->markDirty(i);
+	}
+
+
+	/// Set a joint's local rotation and translation.
+	///
+	/// @param i A joint index.
+	/// @param rotation The new local rotation.
+	/// @param translation The new local translation.
+	void
+	setLocal(size_t i, const Quaternion<T> &rotation,
+		 const Vector<T, 3> &translation)
+	{
+		this->setRotation(i, rotation);
+		this->setTranslation(i, translation);
+	}
+
+
+	/// Return a joint's rotation relative to its parent.
+	///
+	/// @param i A joint index.
+	/// @return The local rotation.
+	Quaternion<T>
+	rotation(size_t i) const
+	{
+		return quaternionAt(&this->local[i * PoseSize]);
+	}
+
+
+	/// Return a joint's position in its parent's frame.
+	///
+	/// @param i A joint index.
+	/// @return The local translation.
+	Vector<T, 3>
+	translation(size_t i) const
+	{
+		return Vector<T, 3>(&this->local[(i * PoseSize) + 4]);
+	}
+
+
+	/// Return a joint's rotation in the world frame, updating the
+	/// chain first if needed.
+	///
+	/// @param i A joint index.
+	/// @return The world rotation.
+	Quaternion<T>
+	worldRotation(size_t i)
+	{
+		this->update();
+		return quaternionAt(&this->world[i * PoseSize]);
+	}
+
+
+	/// Return a joint's position in the world frame, updating the chain
+	/// first if needed.
+	///
+	/// @param i A joint index.
+	/// @return The world translation.
+	Vector<T, 3>
+	worldTranslation(size_t i)
+	{
+		this->update();
+		return Vector<T, 3>(&this->world[(i * PoseSize) + 4]);
+	}
+
+
+	/// Transform a point from a joint's frame into the world frame,
+	/// updating the chain first if needed.
+	///
+	/// @param i A joint index.
+	/// @param point A point in the joint's frame.
+	/// @return The point in the world frame.
+	Vector<T, 3>
+	transform(size_t i, const Vector<T, 3> &point)
+	{
+		T	p[3] = {point[0], point[1], point[2]};
+		T	out[3];
+
+		this->update();
+		applyPose(&this->world[i * PoseSize], p, out);
+		return Vector<T, 3>(out);
+	}
+
+
+	/// Return the world poses of every joint, updating the chain first
+	/// if needed.
+	///
+	/// @return size() poses of PoseSize scalars each.
+	const T *
+	worldPoses()
+	{
+		this->update();
+		return this->world.data();
+	}
+
+
+	/// Recompute the world pose of every dirty joint and every joint
+	/// below one.
+	///
+	/// @return The number of joints recomputed.
+	size_t
+	update()
+	{
+		size_t	n = this->size();
+		size_t	updated = 0;
+
+		for (size_t i = this->firstDirty; i < n; i++) {
+			size_t	p = this->parents[i];
+
+			if (p != NoParent && this->dirty[p]) {
+				this->dirty[i] = 1;
+			}
+			if (!this->dirty[i]) {
+				continue;
+			}
+
+			const T	*parentPose = p == NoParent ? nullptr :
+						  &this->world[p * PoseSize];
+			composePose(parentPose, &this->local[i * PoseSize],
+				    &this->world[i * PoseSize]);
+			updated++;
+		}
+
+		// Dirty flags are only cleared once the whole pass is done,
+		// since children read their parent's flag.
+		for (size_t i = this->firstDirty; i < n; i++) {
+			this->dirty[i] = 0;
+		}
+		this->firstDirty = n;
+		return updated;
+	}
+
+
+	/// Evaluate the world poses of the chain for many configurations.
+	/// Each configuration supplies every joint's local rotation; the
+	/// local translations are the chain's own. The chain itself is not
+	/// changed.
+	///
+	/// @param rotations configurations * size() local rotations as
+	///                  <w, x, y, z>, one configuration after another.
+	/// @param poses Storage for configurations * size() world poses of
+	///              PoseSize scalars.
+	/// @param configurations The number of configurations.
+	void
+	evaluate(const T *rotations, T *poses, size_t configurations) const
+	{
+		size_t	n = this->size();
+		T	joint[PoseSize];
+
+		for (size_t c = 0; c < configurations; c++) {
+			const T	*rot = rotations + (c * n * 4);
+			T	*out = poses + (c * n * PoseSize);
+
+			for (size_t i = 0; i < n; i++) {
+				size_t	p = this->parents[i];
+
+				joint[0] = rot[(i * 4) + 0];
+				joint[1] = rot[(i * 4) + 1];
+				joint[2] = rot[(i * 4) + 2];
+				joint[3] = rot[(i * 4) + 3];
+				joint[4] = this->local[(i * PoseSize) + 4];
+				joint[5] = this->local[(i * PoseSize) + 5];
+				joint[6] = this->local[(i * PoseSize) + 6];
+				composePose(p == NoParent ? nullptr : out + (p * PoseSize),
+					    joint, out + (i * PoseSize));
+			}
+		}
+	}
+
+private:
+	std::vector<size_t>	parents;
+	std::vector<uint8_t>	dirty;
+	std::vector<T>		local;
+	std::vector<T>		world;
+	size_t			firstDirty;
+
+
+	void
+	markDirty(size_t i)
+	{
+		this->dirty[i] = 1;
+		if (i < this->firstDirty) {
+			this->firstDirty = i;
+		}
+	}
+
+
+	static Quaternion<T>
+	quaternionAt(const T *q)
+	{
+		return Quaternion<T>{q[0], q[1], q[2], q[3]};
+	}
+
+
+	// Rotate v by q, computing q* v q directly as v - 2w(u × v) + 2u × (u × v) for q = <w, u>.
+	static void
+	rotateBy(const T *q, const T *v, T *out)
+	{
+		T	c[3] = {
+			(q[2] * v[2]) - (q[3] * v[1]),
+			(q[3] * v[0]) - (q[1] * v[2]),
+			(q[1] * v[1]) - (q[2] * v[0]),
+		};
+		T	cc[3] = {
+			(q[2] * c[2]) - (q[3] * c[1]),
+			(q[3] * c[0]) - (q[1] * c[2]),
+			(q[1] * c[1]) - (q[2] * c[0]),
+		};
+
+		for (int k = 0; k < 3; k++) {
+			out[k] = v[k] + (2 * ((cc[k]) - (q[0] * c[k])));
+		}
+	}
+
+
+	// Apply a pose to a point: rotate, then translate.
+	static void
+	applyPose(const T *pose, const T *p, T *out)
+	{
+		rotateBy(pose, p, out);
+		out[0] += pose[4];
+		out[1] += pose[5];
+		out[2] += pose[6];
+	}
+
+
+	// Compose a joint's local pose with its parent's world pose; a null
+	// parent is the identity.
+	static void
+	composePose(const T *parent, const T *joint, T *out)
+	{
+		if (parent == nullptr) {
+			for (size_t k = 0; k < PoseSize; k++) {
+				out[k] = joint[k];
+			}
+			return;
+		}
+
+		// out rotation = joint * parent, as in Quaternion::operator*.
+		const T	*a = joint;
+		const T	*b = parent;
+
+		out[0] = (a[0] * b[0]) - (a[1] * b[1]) - (a[2] * b[2]) - (a[3] * b[3]);
+		out[1] = (b[1] * a[0]) + (a[1] * b[0]) + ((a[2] * b[3]) - (a[3] * b[2]));
+		out[2] = (b[2] * a[0]) + (a[2] * b[0]) + ((a[3] * b[1]) - (a[1] * b[3]));
+		out[3] = (b[3] * a[0]) + (a[3] * b[0]) + ((a[1] * b[2]) - (a[2] * b[1]));
+		applyPose(parent, joint + 4, out + 4);
+	}
+};
+
+template <typename T>
+constexpr size_t KinematicChain<T>::NoParent;
+
+template <typename T>
+constexpr size_t KinematicChain<T>::PoseSize;
+
+
+/// KinematicChaind is a shorthand alias for a KinematicChain<double>.
+typedef KinematicChain<double>	KinematicChaind;
+
+/// KinematicChainf is a shorthand alias for a KinematicChain<float>.
+typedef KinematicChain<float>	KinematicChainf;
+
+
+} // namespace geom
+} // namespace wr
+
+
+#endif // __WRMATH_GEOM_CHAIN_H
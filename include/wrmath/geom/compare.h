@@ -0,0 +1,183 @@
+/// \file compare.h
+/// \brief Batch versions of the Vector and Quaternion predicates.
+///
+/// Each function tests an interleaved array of N-dimensional vectors
+/// against the same condition as the corresponding Vector method, using
+/// the branch-free mask building in wrmath/math/compare.h. Quaternions
+/// stored as <w, x, y, z> can be compared like Quaternion::operator==
+/// with math::EqualMask and a width of 4, or with EqualMask below and
+/// N = 4.
+#ifndef __WRMATH_GEOM_COMPARE_H
+#define __WRMATH_GEOM_COMPARE_H
+
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <wrmath/math.h>
+#include <wrmath/math/compare.h>
+
+
+namespace wr {
+namespace geom {
+
+
+/// Compare two arrays of vectors, as Vector::operator== does with an
+/// absolute tolerance, or with a relative or ULP tolerance.
+///
+/// @param a count vectors of N scalars.
+/// @param b count vectors of N scalars.
+/// @param count The number of vectors.
+/// @param tol The tolerance.
+/// @param mask Storage for math::MaskWords(count) words.
+/// @return The number of equal pairs.
+template <size_t N, typename T>
+size_t
+EqualMask(const T *a, const T *b, size_t count, const math::Tolerance<T> &tol,
+	  uint64_t *mask)
+{
+	return math::EqualMask(a, b, count, N, tol, mask);
+}
+
+
+/// Test an array of vectors for zero, as Vector::isZero does.
+///
+/// @param v count vectors of N scalars.
+/// @param count The number of vectors.
+/// @param eps The absolute tolerance for each component.
+/// @param mask Storage for math::MaskWords(count) words.
+/// @return The number of zero vectors.
+template <size_t N, typename T>
+size_t
+ZeroMask(const T *v, size_t count, T eps, uint64_t *mask)
+{
+	return math::BuildMask(count, mask, [=](size_t i) {
+		using std::abs;
+
+		unsigned	ok = 1;
+
+		for (size_t k = 0; k < N; k++) {
+			ok &= static_cast<unsigned>(abs(v[(i * N) + k]) < eps);
+		}
+		return ok;
+	});
+}
+
+
+/// Test an array of vectors for unit length, as Vector::isUnitVector
+/// does.
+///
+/// @param v count vectors of N scalars.
+/// @param count The number of vectors.
+/// @param eps The absolute tolerance on the length.
+/// @param mask Storage for math::MaskWords(count) words.
+/// @return The number of unit vectors.
+template <size_t N, typename T>
+size_t
+UnitMask(const T *v, size_t count, T eps, uint64_t *mask)
+{
+	return math::BuildMask(count, mask, [=](size_t i) {
+		using std::abs;
+		using std::sqrt;
+
+		T	m2 = 0;
+
+		for (size_t k = 0; k < N; k++) {
+			m2 += v[(i * N) + k] * v[(i * N) + k];
+		}
+		return static_cast<unsigned>(abs(sqrt(m2) - (T)1.0) < eps);
+	});
+}
+
+
+/// Test pairs of vectors for being parallel, as Vector::isParallel does:
+/// a pair is parallel if either vector is zero or the angle between them
+/// is less than eps. The angle is tested through its sine, as
+/// |a ∧ b|² < sin²(eps) |a|² |b|² with a · b > 0, without calling acos.
+/// The cosine can't be used for this: for small eps it rounds to one in
+/// single precision, which no pair can exceed.
+///
+/// @param a count vectors of N scalars.
+/// @param b count vectors of N scalars.
+/// @param count The number of vectors.
+/// @param eps The tolerance on the angle, in radians.
+/// @param mask Storage for math::MaskWords(count) words.
+/// @return The number of parallel pairs.
+template <size_t N, typename T>
+size_t
+ParallelMask(const T *a, const T *b, size_t count, T eps, uint64_t *mask)
+{
+	using std::sin;
+
+	T	sinEps = sin(eps);
+	T	sin2Eps = sinEps * sinEps;
+
+	return math::BuildMask(count, mask, [=](size_t i) {
+		using std::abs;
+
+		const T		*x = a + (i * N);
+		const T		*y = b + (i * N);
+		unsigned	 zeroA = 1, zeroB = 1;
+		T		 a2 = 0, b2 = 0, ab = 0, wedge2 = 0;
+
+		for (size_t k = 0; k < N; k++) {
+			zeroA &= static_cast<unsigned>(abs(x[k]) < eps);
+			zeroB &= static_cast<unsigned>(abs(y[k]) < eps);
+			a2 += x[k] * x[k];
+			b2 += y[k] * y[k];
+			ab += x[k] * y[k];
+
+			// |a ∧ b|² sums the squared 2x2 minors; in three
+			// dimensions it's |a × b|².
+			for (size_t j = 0; j < k; j++) {
+				T	m = (x[j] * y[k]) - (x[k] * y[j]);
+
+				wedge2 += m * m;
+			}
+		}
+		return zeroA | zeroB |
+		       (static_cast<unsigned>(ab > 0) &
+			static_cast<unsigned>(wedge2 < sin2Eps * a2 * b2));
+	});
+}
+
+
+/// Test pairs of vectors for being orthogonal, as Vector::isOrthogonal
+/// does: a pair is orthogonal if either vector is zero or their dot
+/// product is within eps of zero.
+///
+/// @param a count vectors of N scalars.
+/// @param b count vectors of N scalars.
+/// @param count The number of vectors.
+/// @param eps The absolute tolerance.
+/// @param mask Storage for math::MaskWords(count) words.
+/// @return The number of orthogonal pairs.
+template <size_t N, typename T>
+size_t
+OrthogonalMask(const T *a, const T *b, size_t count, T eps, uint64_t *mask)
+{
+	return math::BuildMask(count, mask, [=](size_t i) {
+		using std::abs;
+
+		unsigned	zeroA = 1, zeroB = 1;
+		T		ab = 0;
+
+		for (size_t k = 0; k < N; k++) {
+			T	x = a[(i * N) + k];
+			T	y = b[(i * N) + k];
+
+			zeroA &= static_cast<unsigned>(abs(x) < eps);
+			zeroB &= static_cast<unsigned>(abs(y) < eps);
+			ab += x * y;
+		}
+		return zeroA | zeroB | static_cast<unsigned>(abs(ab) < eps);
+	});
+}
+
+
+} // namespace geom
+} // namespace wr
+
+
+#endif // __WRMATH_GEOM_COMPARE_H
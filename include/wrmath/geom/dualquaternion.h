@@ -0,0 +1,611 @@
+/// \file dualquaternion.h
+/// \brief Dual quaternions for rigid-body transforms.
+///
+/// A unit dual quaternion r + εd combines a rotation and a translation
+/// into a single value that composes, inverts and interpolates as one.
+/// The rotation part follows the convention of Quaternion: a point p is
+/// transformed to r* p r + t, and the product A * B applies A first and
+/// then B, as Quaternion::operator* does for rotations. With that
+/// convention the dual part is d = -½ r t.
+///
+/// The eight components are stored as plain scalars, <w, x, y, z> of the
+/// real part followed by <w, x, y, z> of the dual part, so arrays of
+/// DualQuaternion can be passed to the batch functions, or reinterpreted
+/// as arrays of scalars. The dual part isn't held in a Quaternion, since
+/// its scalar part grows with the translation and Quaternion would wrap
+/// it as an angle.
+#ifndef __WRMATH_GEOM_DUALQUATERNION_H
+#define __WRMATH_GEOM_DUALQUATERNION_H
+
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+
+#include <wrmath/math.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+
+
+namespace wr {
+namespace geom {
+
+
+/// @brief DualQuaternion is a rigid-body transform made of a rotation
+/// and a translation.
+///
+/// \tparam T A floating point type.
+template <typename T>
+class DualQuaternion {
+public:
+	/// The default DualQuaternion is the identity transform.
+	DualQuaternion() : q{1, 0, 0, 0, 0, 0, 0, 0} {};
+
+
+	/// Construct a transform that rotates and then translates.
+	///
+	/// @param rotation A unit quaternion.
+	/// @param translation The translation applied after the rotation.
+	DualQuaternion(const Quaternion<T> &rotation, const Vector<T, 3> &translation)
+	{
+		Vector<T, 3>	axis = rotation.axis();
+		T		t[4] = {0, translation[0], translation[1], translation[2]};
+
+		this->q[0] = rotation.angle();
+		this->q[1] = axis[0];
+		this->q[2] = axis[1];
+		this->q[3] = axis[2];
+		product(this->q, t, this->q + 4);
+		for (int i = 4; i < 8; i++) {
+			this->q[i] *= (T)-0.5;
+		}
+	}
+
+
+	/// Construct a dual quaternion from its components.
+	///
+	/// @param values Eight scalars: the real part as <w, x, y, z>
+	///               followed by the dual part.
+	explicit DualQuaternion(const T *values)
+	{
+		for (int i = 0; i < 8; i++) {
+			this->q[i] = values[i];
+		}
+	}
+
+
+	/// Return component i, in <rw, rx, ry, rz, dw, dx, dy, dz> order.
+	///
+	/// @param i The component index.
+	/// @return The component.
+	T	operator[](size_t i) const { return this->q[i]; }
+
+	/// Return the components.
+	///
+	/// @return Eight scalars, the real part followed by the dual part.
+	const T	*data() const { return this->q; }
+
+
+	/// Return the rotation, which is the real part.
+	///
+	/// @return The rotation quaternion.
+	Quaternion<T>
+	rotation() const
+	{
+		return Quaternion<T>{this->q[0], this->q[1], this->q[2], this->q[3]};
+	}
+
+
+	/// Return the translation, which is -2 r* d.
+	///
+	/// @return The translation vector.
+	Vector<T, 3>
+	translation() const
+	{
+		T	rc[4] = {this->q[0], -this->q[1], -this->q[2], -this->q[3]};
+		T	t[4];
+
+		product(rc, this->q + 4, t);
+		return Vector<T, 3>{t[1] * (T)-2.0, t[2] * (T)-2.0, t[3] * (T)-2.0};
+	}
+
+
+	/// Transform a point: rotate it, then translate it.
+	///
+	/// @param p A point.
+	/// @return The transformed point.
+	Vector<T, 3>
+	transform(const Vector<T, 3> &p) const
+	{
+		T	coef[12];
+		T	in[3] = {p[0], p[1], p[2]};
+		T	out[3];
+
+		this->coefficients(coef);
+		apply(coef, in, out);
+		return Vector<T, 3>(out);
+	}
+
+
+	/// Rotate a direction, ignoring the translation.
+	///
+	/// @param v A direction vector.
+	/// @return The rotated vector.
+	Vector<T, 3>
+	transformVector(const Vector<T, 3> &v) const
+	{
+		T	coef[12];
+		T	in[3] = {v[0], v[1], v[2]};
+		T	out[3];
+
+		this->coefficients(coef);
+		coef[9] = coef[10] = coef[11] = 0;
+		apply(coef, in, out);
+		return Vector<T, 3>(out);
+	}
+
+
+	/// Return the conjugate of both parts, r* + εd*. For a unit dual
+	/// quaternion this is the inverse.
+	///
+	/// @return The conjugate.
+	DualQuaternion
+	conjugate() const
+	{
+		DualQuaternion	c(*this);
+
+		for (int i = 1; i < 8; i++) {
+			if (i != 4) {
+				c.q[i] = -c.q[i];
+			}
+		}
+		return c;
+	}
+
+
+	/// Return the inverse transform.
+	///
+	/// @return The inverse of this unit dual quaternion.
+	DualQuaternion
+	inverse() const
+	{
+		return this->conjugate();
+	}
+
+
+	/// Normalise the dual quaternion, so that the real part is a unit
+	/// quaternion and the dual part is orthogonal to it.
+	///
+	/// @return The nearest unit dual quaternion.
+	DualQuaternion
+	unitDualQuaternion() const
+	{
+		DualQuaternion	u(*this);
+
+		normalise(u.q);
+		return u;
+	}
+
+
+	/// Determine whether this is a unit dual quaternion.
+	///
+	/// @return True if the real part has unit norm and the dual part is
+	///         orthogonal to it, within the default tolerance.
+	bool
+	isUnitDualQuaternion() const
+	{
+		T	eps;
+
+		math::DefaultEpsilon(eps);
+		return math::WithinTolerance(dot4(this->q, this->q), (T)1.0, eps) &&
+		       math::WithinTolerance(dot4(this->q, this->q + 4), (T)0.0, eps);
+	}
+
+
+	/// Compose two transforms: the result applies this transform and
+	/// then the other.
+	///
+	/// @param other The transform to apply second.
+	/// @return The composed transform.
+	DualQuaternion
+	operator*(const DualQuaternion &other) const
+	{
+		DualQuaternion	r;
+
+		compose(this->q, other.q, r.q);
+		return r;
+	}
+
+
+	/// Scale every component.
+	///
+	/// @param k The scale factor.
+	/// @return The scaled dual quaternion.
+	DualQuaternion
+	operator*(T k) const
+	{
+		DualQuaternion	r(*this);
+
+		for (int i = 0; i < 8; i++) {
+			r.q[i] *= k;
+		}
+		return r;
+	}
+
+
+	/// Add componentwise.
+	///
+	/// @param other The dual quaternion to add.
+	/// @return The sum.
+	DualQuaternion
+	operator+(const DualQuaternion &other) const
+	{
+		DualQuaternion	r(*this);
+
+		for (int i = 0; i < 8; i++) {
+			r.q[i] += other.q[i];
+		}
+		return r;
+	}
+
+
+	/// Compare two dual quaternions componentwise within the default
+	/// tolerance. Note that A and -A are the same transform but are
+	/// not equal.
+	///
+	/// @param other The dual quaternion to compare with.
+	/// @return True if every component is within tolerance.
+	bool
+	operator==(const DualQuaternion &other) const
+	{
+		T	eps;
+
+		math::DefaultEpsilon(eps);
+		for (int i = 0; i < 8; i++) {
+			if (!math::WithinTolerance(this->q[i], other.q[i], eps)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	/// Compare two dual quaternions componentwise within the default
+	/// tolerance.
+	///
+	/// @param other The dual quaternion to compare with.
+	/// @return True if any component differs.
+	bool
+	operator!=(const DualQuaternion &other) const
+	{
+		return !(*this == other);
+	}
+
+
+	/// Write the dual quaternion to an output stream.
+	///
+	/// @param outs An output stream.
+	/// @param dq The dual quaternion to write.
+	/// @return The output stream.
+	friend std::ostream &
+	operator<<(std::ostream &outs, const DualQuaternion<T> &dq)
+	{
+		outs << dq.rotation() << " + ε" << Quaternion<T>{dq.q[4], dq.q[5], dq.q[6], dq.q[7]};
+		return outs;
+	}
+
+
+	/// Compute the rotation matrix and translation of the transform as
+	/// twelve coefficients, the row-major 3x3 matrix followed by the
+	/// translation, for applying to many points.
+	///
+	/// @param coef Storage for twelve scalars.
+	void
+	coefficients(T *coef) const
+	{
+		const T		*r = this->q;
+		T		xx = r[1] * r[1], yy = r[2] * r[2], zz = r[3] * r[3];
+		T		xy = r[1] * r[2], xz = r[1] * r[3], yz = r[2] * r[3];
+		T		wx = r[0] * r[1], wy = r[0] * r[2], wz = r[0] * r[3];
+		Vector<T, 3>	t = this->translation();
+
+		// The matrix of p -> r* p r.
+		coef[0] = 1 - 2 * (yy + zz);
+		coef[1] = 2 * (xy + wz);
+		coef[2] = 2 * (xz - wy);
+		coef[3] = 2 * (xy - wz);
+		coef[4] = 1 - 2 * (xx + zz);
+		coef[5] = 2 * (yz + wx);
+		coef[6] = 2 * (xz + wy);
+		coef[7] = 2 * (yz - wx);
+		coef[8] = 1 - 2 * (xx + yy);
+		coef[9] = t[0];
+		coef[10] = t[1];
+		coef[11] = t[2];
+	}
+
+
+	/// Apply transform coefficients to a point.
+	///
+	/// @param coef Coefficients from coefficients().
+	/// @param p A point as three scalars.
+	/// @param out Storage for the transformed point.
+	static void
+	apply(const T *coef, const T *p, T *out)
+	{
+		out[0] = (coef[0] * p[0]) + (coef[1] * p[1]) + (coef[2] * p[2]) + coef[9];
+		out[1] = (coef[3] * p[0]) + (coef[4] * p[1]) + (coef[5] * p[2]) + coef[10];
+		out[2] = (coef[6] * p[0]) + (coef[7] * p[1]) + (coef[8] * p[2]) + coef[11];
+	}
+
+
+	/// Compose two dual quaternions stored as eight scalars each.
+	///
+	/// @param a The transform to apply first.
+	/// @param b The transform to apply second.
+	/// @param out Storage for the product a * b.
+	static void
+	compose(const T *a, const T *b, T *out)
+	{
+		T	rd[4], dr[4];
+
+		product(a, b + 4, rd);
+		product(a + 4, b, dr);
+		product(a, b, out);
+		for (int i = 0; i < 4; i++) {
+			out[i + 4] = rd[i] + dr[i];
+		}
+	}
+
+
+	/// Normalise a dual quaternion stored as eight scalars.
+	///
+	/// @param dq The dual quaternion to normalise in place.
+	static void
+	normalise(T *dq)
+	{
+		using std::sqrt;
+
+		T	n = sqrt(dot4(dq, dq));
+
+		for (int i = 0; i < 8; i++) {
+			dq[i] /= n;
+		}
+
+		T	rd = dot4(dq, dq + 4);
+
+		for (int i = 0; i < 4; i++) {
+			dq[i + 4] -= rd * dq[i];
+		}
+	}
+
+private:
+	T	q[8];
+
+
+	// Hamilton product of two quaternions stored as <w, x, y, z>.
+	static void
+	product(const T *a, const T *b, T *out)
+	{
+		T	w = (a[0] * b[0]) - (a[1] * b[1]) - (a[2] * b[2]) - (a[3] * b[3]);
+		T	x = (a[0] * b[1]) + (b[0] * a[1]) + ((a[2] * b[3]) - (a[3] * b[2]));
+		T	y = (a[0] * b[2]) + (b[0] * a[2]) + ((a[3] * b[1]) - (a[1] * b[3]));
+		T	z = (a[0] * b[3]) + (b[0] * a[3]) + ((a[1] * b[2]) - (a[2] * b[1]));
+
+		out[0] = w;
+		out[1] = x;
+		out[2] = y;
+		out[3] = z;
+	}
+
+
+	static T
+	dot4(const T *a, const T *b)
+	{
+		return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]) + (a[3] * b[3]);
+	}
+
+	template <typename U>
+	friend DualQuaternion<U>	ScLERP(const DualQuaternion<U> &, const DualQuaternion<U> &, U);
+};
+
+
+/// DualQuaterniond is a shorthand alias for a DualQuaternion<double>.
+typedef DualQuaternion<double>	DualQuaterniond;
+
+/// DualQuaternionf is a shorthand alias for a DualQuaternion<float>.
+typedef DualQuaternion<float>	DualQuaternionf;
+
+
+/// Screw linear interpolation between two unit dual quaternions. The
+/// result moves along the screw motion from a to b at constant rotation
+/// and translation speed, taking the shortest rotation.
+///
+/// @param a The transform at t = 0.
+/// @param b The transform at t = 1.
+/// @param t The interpolation parameter, between 0 and 1.
+/// @return The interpolated transform.
+template <typename T>
+DualQuaternion<T>
+ScLERP(const DualQuaternion<T> &a, const DualQuaternion<T> &b, T t)
+{
+	using std::atan2;
+	using std::cos;
+	using std::sin;
+	using std::sqrt;
+
+	// a * d = b, so d = a^-1 * b, and the result is a * d^t.
+	DualQuaternion<T>	d = a.inverse() * b;
+	T			*r = d.q;
+	T			*e = d.q + 4;
+
+	if (r[0] < 0) {
+		d = d * (T)-1.0;
+	}
+
+	// d = (cos(θ/2), sin(θ/2) l) + ε(-(δ/2) sin(θ/2),
+	//     (δ/2) cos(θ/2) l + sin(θ/2) m) for a screw about l with
+	// moment m, angle θ and pitch δ; raising it to t scales θ and δ.
+	T	c = r[0];
+	T	s = sqrt((r[1] * r[1]) + (r[2] * r[2]) + (r[3] * r[3]));
+	T	theta = 2 * atan2(s, c);
+
+	// The pitch and moment are found by dividing the dual part by s,
+	// which amplifies its rounding error by 1/s. Below about the square
+	// root of the precision that error outweighs the curvature of the
+	// screw, so the rotation is scaled on its own and the translation
+	// linearly.
+	if (s <= sqrt(std::numeric_limits<T>::epsilon()) * sqrt((c * c) + (s * s))) {
+		Vector<T, 3>	translation = d.translation() * t;
+		T		k = s > 0 ? sin(t * theta / 2) / s : t;
+		T		ct = cos(t * theta / 2);
+
+		return a * DualQuaternion<T>(
+		    Quaternion<T>{ct, r[1] * k, r[2] * k, r[3] * k}, translation);
+	}
+
+	T	l[3] = {r[1] / s, r[2] / s, r[3] / s};
+	T	delta = -2 * e[0] / s;
+	T	m[3];
+
+	for (int i = 0; i < 3; i++) {
+		m[i] = (e[i + 1] - ((delta / 2) * c * l[i])) / s;
+	}
+
+	T	st = sin(t * theta / 2);
+	T	ct = cos(t * theta / 2);
+	T	dt = t * delta;
+
+	r[0] = ct;
+	e[0] = -(dt / 2) * st;
+	for (int i = 0; i < 3; i++) {
+		r[i + 1] = st * l[i];
+		e[i + 1] = ((dt / 2) * ct * l[i]) + (st * m[i]);
+	}
+	return a * d;
+}
+
+
+/// Dual quaternion linear blending: the normalised weighted sum of a
+/// set of unit dual quaternions, with each one flipped if necessary to
+/// lie in the same hemisphere as the first.
+///
+/// @param dqs n unit dual quaternions.
+/// @param weights n weights.
+/// @param n The number of dual quaternions; it must not be zero.
+/// @return The blended transform.
+template <typename T>
+DualQuaternion<T>
+DLB(const DualQuaternion<T> *dqs, const T *weights, size_t n)
+{
+	assert(n > 0);
+
+	T	sum[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	const T	*first = dqs[0].data();
+
+	for (size_t i = 0; i < n; i++) {
+		const T	*p = dqs[i].data();
+		T	dp = (p[0] * first[0]) + (p[1] * first[1]) +
+			     (p[2] * first[2]) + (p[3] * first[3]);
+		T	w = dp < 0 ? -weights[i] : weights[i];
+
+		for (int k = 0; k < 8; k++) {
+			sum[k] += w * p[k];
+		}
+	}
+
+	DualQuaternion<T>::normalise(sum);
+	return DualQuaternion<T>(sum);
+}
+
+
+/// Blend transforms for many outputs, as in skinning: output i is the
+/// DLB of the given number of influences, each selecting a transform by
+/// index with a weight.
+///
+/// @param transforms The transforms to blend.
+/// @param indices count * influences transform indices.
+/// @param weights count * influences weights.
+/// @param influences The number of influences per output.
+/// @param out Storage for count blended transforms.
+/// @param count The number of outputs.
+template <typename T>
+void
+DLB(const DualQuaternion<T> *transforms, const uint32_t *indices,
+    const T *weights, size_t influences, DualQuaternion<T> *out, size_t count)
+{
+	assert(influences > 0);
+
+	for (size_t i = 0; i < count; i++) {
+		const uint32_t	*idx = indices + (i * influences);
+		const T		*wts = weights + (i * influences);
+		const T		*first = transforms[idx[0]].data();
+		T		sum[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+		for (size_t j = 0; j < influences; j++) {
+			const T	*p = transforms[idx[j]].data();
+			T	dp = (p[0] * first[0]) + (p[1] * first[1]) +
+				     (p[2] * first[2]) + (p[3] * first[3]);
+			T	w = dp < 0 ? -wts[j] : wts[j];
+
+			for (int k = 0; k < 8; k++) {
+				sum[k] += w * p[k];
+			}
+		}
+
+		DualQuaternion<T>::normalise(sum);
+		out[i] = DualQuaternion<T>(sum);
+	}
+}
+
+
+/// Transform an array of points by one transform.
+///
+/// @param dq A unit dual quaternion.
+/// @param in count points as interleaved <x, y, z>.
+/// @param out Storage for count points; it may be the same as in.
+/// @param count The number of points.
+template <typename T>
+void
+TransformPoints(const DualQuaternion<T> &dq, const T *in, T *out, size_t count)
+{
+	T	coef[12];
+
+	dq.coefficients(coef);
+	for (size_t i = 0; i < count; i++) {
+		T	p[3] = {in[i * 3], in[(i * 3) + 1], in[(i * 3) + 2]};
+
+		DualQuaternion<T>::apply(coef, p, out + (i * 3));
+	}
+}
+
+
+/// Compose two arrays of transforms elementwise, so that out[i] applies
+/// a[i] and then b[i].
+///
+/// @param a count transforms to apply first.
+/// @param b count transforms to apply second.
+/// @param out Storage for count transforms.
+/// @param count The number of transforms.
+template <typename T>
+void
+Compose(const DualQuaternion<T> *a, const DualQuaternion<T> *b,
+	DualQuaternion<T> *out, size_t count)
+{
+	T	r[8];
+
+	for (size_t i = 0; i < count; i++) {
+		DualQuaternion<T>::compose(a[i].data(), b[i].data(), r);
+		out[i] = DualQuaternion<T>(r);
+	}
+}
+
+
+} // namespace geom
+} // namespace wr
+
+
+#endif // __WRMATH_GEOM_DUALQUATERNION_H
@@ -0,0 +1,248 @@
+/// \file frame.h
+/// \brief Batched orthonormalisation and frame construction.
+///
+/// These functions work on contiguous arrays of interleaved scalars and
+/// normalise each vector once: every basis vector is scaled by its
+/// reciprocal length as soon as it is found, and later projections use
+/// the stored unit vector rather than normalising the basis again as
+/// Vector::projectParallel does.
+///
+/// A frame is stored as nine scalars, the three unit axes x, y and z one
+/// after another; read as a row-major matrix, it maps world coordinates
+/// into the frame.
+#ifndef __WRMATH_GEOM_FRAME_H
+#define __WRMATH_GEOM_FRAME_H
+
+
+#include <cmath>
+#include <cstddef>
+
+#include <wrmath/math.h>
+#include <wrmath/geom/vector.h>
+
+
+namespace wr {
+namespace geom {
+
+
+/// Orthonormalise a set of N-dimensional vectors with the modified
+/// Gram-Schmidt process. Vector i of the result is the unit vector along
+/// the part of input vector i orthogonal to the vectors before it.
+/// Vectors that depend on earlier ones, to within the default tolerance
+/// relative to their length, are written as zero vectors.
+///
+/// @param in count vectors of N scalars.
+/// @param out Storage for count vectors; it may be the same as in.
+/// @param count The number of vectors.
+/// @return The rank, the number of non-zero output vectors.
+template <size_t N, typename T>
+size_t
+GramSchmidt(const T *in, T *out, size_t count)
+{
+	using std::sqrt;
+
+	T	eps;
+	size_t	rank = 0;
+
+	math::DefaultEpsilon(eps);
+	for (size_t i = 0; i < count; i++) {
+		T	*v = out + (i * N);
+		T	length2 = 0;
+
+		for (size_t k = 0; k < N; k++) {
+			v[k] = in[(i * N) + k];
+			length2 += v[k] * v[k];
+		}
+
+		// Subtract the projection onto each earlier unit vector, one
+		// at a time, which is what makes the process stable.
+		for (size_t j = 0; j < i; j++) {
+			const T	*u = out + (j * N);
+			T	d = 0;
+
+			for (size_t k = 0; k < N; k++) {
+				d += v[k] * u[k];
+			}
+			for (size_t k = 0; k < N; k++) {
+				v[k] -= d * u[k];
+			}
+		}
+
+		T	r2 = 0;
+
+		for (size_t k = 0; k < N; k++) {
+			r2 += v[k] * v[k];
+		}
+
+		T	scale = 0;
+
+		if (r2 > eps * eps * length2 && r2 > 0) {
+			scale = (T)1.0 / sqrt(r2);
+			rank++;
+		}
+		for (size_t k = 0; k < N; k++) {
+			v[k] *= scale;
+		}
+	}
+
+	return rank;
+}
+
+
+/// Orthonormalise many sets of N-dimensional vectors, such as per-point
+/// tangent bases, each as GramSchmidt does.
+///
+/// @param in sets * perSet vectors of N scalars, one set after another.
+/// @param out Storage for the same number of vectors; it may be the
+///            same as in.
+/// @param sets The number of sets.
+/// @param perSet The number of vectors in each set.
+/// @return The number of sets with full rank.
+template <size_t N, typename T>
+size_t
+GramSchmidt(const T *in, T *out, size_t sets, size_t perSet)
+{
+	size_t	full = 0;
+	size_t	stride = perSet * N;
+
+	for (size_t s = 0; s < sets; s++) {
+		if (GramSchmidt<N>(in + (s * stride), out + (s * stride), perSet) == perSet) {
+			full++;
+		}
+	}
+	return full;
+}
+
+
+/// Build a right-handed orthonormal frame from a direction and a hint.
+/// The x axis lies along v, the y axis is the part of the hint
+/// orthogonal to v, and z = x × y. If the hint is zero or parallel to
+/// v, a perpendicular direction is chosen instead, following Duff et
+/// al., "Building an Orthonormal Basis, Revisited" (2017).
+///
+/// @param v The direction of the x axis; it must not be zero.
+/// @param hint A vector giving the direction of the y axis, or nullptr
+///             to have one chosen.
+/// @param frame Storage for nine scalars: the x, y and z axes.
+/// @return False if v is zero, in which case the frame is the identity.
+template <typename T>
+bool
+OrthonormalFrame(const T *v, const T *hint, T *frame)
+{
+	using std::sqrt;
+
+	T	eps;
+	T	*x = frame, *y = frame + 3, *z = frame + 6;
+	T	n2 = (v[0] * v[0]) + (v[1] * v[1]) + (v[2] * v[2]);
+
+	math::DefaultEpsilon(eps);
+	if (!(n2 > 0)) {
+		for (size_t k = 0; k < 9; k++) {
+			frame[k] = (k % 4) == 0 ? (T)1.0 : (T)0.0;
+		}
+		return false;
+	}
+
+	T	inv = (T)1.0 / sqrt(n2);
+
+	x[0] = v[0] * inv;
+	x[1] = v[1] * inv;
+	x[2] = v[2] * inv;
+
+	T	r2 = 0;
+
+	if (hint != nullptr) {
+		T	h2 = (hint[0] * hint[0]) + (hint[1] * hint[1]) + (hint[2] * hint[2]);
+		T	d = (hint[0] * x[0]) + (hint[1] * x[1]) + (hint[2] * x[2]);
+
+		for (size_t k = 0; k < 3; k++) {
+			y[k] = hint[k] - (d * x[k]);
+		}
+		r2 = (y[0] * y[0]) + (y[1] * y[1]) + (y[2] * y[2]);
+		if (!(r2 > eps * eps * h2)) {
+			r2 = 0;
+		}
+	}
+
+	if (r2 > 0) {
+		T	yinv = (T)1.0 / sqrt(r2);
+
+		y[0] *= yinv;
+		y[1] *= yinv;
+		y[2] *= yinv;
+	}
+	else {
+		// Duff et al.'s branch-free basis, from the unit x axis.
+		T	sign = x[2] < 0 ? (T)-1.0 : (T)1.0;
+		T	a = (T)-1.0 / (sign + x[2]);
+		T	b = x[0] * x[1] * a;
+
+		y[0] = b;
+		y[1] = sign + (x[1] * x[1] * a);
+		y[2] = -x[1];
+	}
+
+	z[0] = (x[1] * y[2]) - (x[2] * y[1]);
+	z[1] = (x[2] * y[0]) - (x[0] * y[2]);
+	z[2] = (x[0] * y[1]) - (x[1] * y[0]);
+	return true;
+}
+
+
+/// Build a right-handed orthonormal frame from a direction and a hint,
+/// as Vectors.
+///
+/// @param v The direction of the x axis; it must not be zero.
+/// @param hint A vector giving the direction of the y axis.
+/// @param x The x axis.
+/// @param y The y axis.
+/// @param z The z axis.
+/// @return False if v is zero, in which case the frame is the identity.
+template <typename T>
+bool
+OrthonormalFrame(const Vector<T, 3> &v, const Vector<T, 3> &hint,
+		 Vector<T, 3> &x, Vector<T, 3> &y, Vector<T, 3> &z)
+{
+	T	vin[3] = {v[0], v[1], v[2]};
+	T	hin[3] = {hint[0], hint[1], hint[2]};
+	T	frame[9];
+	bool	ok = OrthonormalFrame(vin, hin, frame);
+
+	x = Vector<T, 3>(frame);
+	y = Vector<T, 3>(frame + 3);
+	z = Vector<T, 3>(frame + 6);
+	return ok;
+}
+
+
+/// Build frames for an array of directions, such as the normals of a
+/// mesh, each as OrthonormalFrame does.
+///
+/// @param vectors count directions of three scalars.
+/// @param hints count hints of three scalars, or nullptr to have the y
+///              axes chosen.
+/// @param frames Storage for count frames of nine scalars.
+/// @param count The number of frames.
+/// @return The number of frames built from non-zero directions.
+template <typename T>
+size_t
+OrthonormalFrames(const T *vectors, const T *hints, T *frames, size_t count)
+{
+	size_t	built = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		const T	*hint = hints == nullptr ? nullptr : hints + (i * 3);
+
+		if (OrthonormalFrame(vectors + (i * 3), hint, frames + (i * 9))) {
+			built++;
+		}
+	}
+	return built;
+}
+
+
+} // namespace geom
+} // namespace wr
+
+
+#endif // __WRMATH_GEOM_FRAME_H
@@ -0,0 +1,744 @@
+/// \file map.h
+/// \brief Non-owning vector and quaternion views over external memory.
+///
+/// Maps let the Vector and Quaternion read-only API operate directly on
+/// caller-owned buffers, such as sensor DMA buffers, shared memory or
+/// wr::io::LogBlock views, without copying each element into a Vector.
+/// A map never owns or modifies the memory it refers to, and is only
+/// valid while that memory is.
+///
+/// Each map is described by a base pointer and a component stride, the
+/// distance in elements between consecutive components. The array maps
+/// add a record stride, the distance between consecutive vectors, which
+/// covers the common layouts:
+///
+/// | layout                         | record stride | component stride |
+/// |--------------------------------|---------------|------------------|
+/// | interleaved <x, y, z, x, ...>  | N             | 1                |
+/// | records with extra fields      | record size   | 1                |
+/// | SoA <x, x, ..., y, y, ...>     | 1             | count            |
+///
+/// Operations that produce a new vector or quaternion, such as cross or
+/// unitVector, return an owning Vector or Quaternion.
+#ifndef __WRMATH_GEOM_MAP_H
+#define __WRMATH_GEOM_MAP_H
+
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
+
+#include <wrmath/math.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+
+
+namespace wr {
+namespace geom {
+
+
+/// @brief VectorMap is a read-only view of an N-dimensional vector in
+/// external memory.
+///
+/// \tparam T The element type.
+/// \tparam N The dimension of the vector.
+template <typename T, size_t N>
+class VectorMap {
+public:
+	/// Map a vector whose components are stride elements apart.
+	///
+	/// @param data A pointer to the first component.
+	/// @param stride The distance in elements between components.
+	explicit VectorMap(const T *data, ptrdiff_t stride = 1) :
+		base(data), stride(stride)
+	{
+		wr::math::DefaultEpsilon(this->epsilon);
+	}
+
+
+	/// Set the tolerance for equality checks.
+	/// @param eps is the maximum difference between this vector and
+	///            another.
+	void
+	setEpsilon(T eps)
+	{
+		this->epsilon = eps;
+	}
+
+
+	/// Return the value of component i.
+	/// @param i The component index.
+	/// @return The value of the vector component at i.
+	const T&
+	operator[](size_t i) const
+	{
+		return this->base[static_cast<ptrdiff_t>(i) * this->stride];
+	}
+
+
+	/// Copy the mapped vector into a Vector.
+	/// @return An owning copy of the vector.
+	Vector<T, N>
+	vector() const
+	{
+		T	tmp[N];
+
+		for (size_t i = 0; i < N; i++) {
+			tmp[i] = (*this)[i];
+		}
+		return Vector<T, N>(tmp);
+	}
+
+
+	/// Compute the length of the vector.
+	/// @return The length of the vector.
+	T
+	magnitude() const
+	{
+		using std::sqrt;
+
+		return sqrt(*this * *this);
+	}
+
+
+	/// Determine whether this is a zero vector.
+	/// @return true if the vector is zero.
+	bool
+	isZero() const
+	{
+		for (size_t i = 0; i < N; i++) {
+			if (!wr::math::WithinTolerance((*this)[i], (T)0.0, this->epsilon)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	/// Obtain the unit vector for this vector.
+	/// @return The unit vector
+	Vector<T, N>
+	unitVector() const
+	{
+		return *this / this->magnitude();
+	}
+
+
+	/// Determine if this is a unit vector, e.g. if its length is 1.
+	/// @return true if the vector is a unit vector.
+	bool
+	isUnitVector() const
+	{
+		return wr::math::WithinTolerance(this->magnitude(), (T)1.0, this->epsilon);
+	}
+
+
+	/// Compute the angle between this and another vector.
+	/// @param other Another vector.
+	/// @return The angle in radians between the two vectors.
+	template <typename V>
+	T
+	angle(const V &other) const
+	{
+		assert(!this->isZero());
+
+		// Rounding can push the cosine of parallel vectors just past
+		// ±1, where acos is NaN.
+		T	d = (*this * other) / (this->magnitude() * other.magnitude());
+		d = d > (T)1.0 ? (T)1.0 : d < (T)-1.0 ? (T)-1.0 : d;
+
+		return std::acos(d);
+	}
+
+
+	/// Determine whether two vectors are parallel.
+	/// @param other Another vector or map.
+	/// @return True if the angle between the vectors is zero.
+	template <typename V>
+	bool
+	isParallel(const V &other) const
+	{
+		if (this->isZero() || other.isZero()) {
+			return true;
+		}
+
+		// As in Vector::isParallel, the angle is tested through its
+		// sine, which stays resolvable in single precision.
+		T	a2 = 0, b2 = 0, ab = 0, wedge2 = 0;
+
+		for (size_t k = 0; k < N; k++) {
+			a2 += (*this)[k] * (*this)[k];
+			b2 += other[k] * other[k];
+			ab += (*this)[k] * other[k];
+			for (size_t j = 0; j < k; j++) {
+				T	m = ((*this)[j] * other[k]) - ((*this)[k] * other[j]);
+
+				wedge2 += m * m;
+			}
+		}
+
+		T	sinEps = std::sin(this->epsilon);
+
+		return ab > 0 && wedge2 < sinEps * sinEps * a2 * b2;
+	}
+
+
+	/// Determine if two vectors are orthogonal.
+	/// @param other Another vector or map.
+	/// @return True if the two vectors are orthogonal.
+	template <typename V>
+	bool
+	isOrthogonal(const V &other) const
+	{
+		if (this->isZero() || other.isZero()) {
+			return true;
+		}
+
+		return wr::math::WithinTolerance(*this * other, (T)0.0, this->epsilon);
+	}
+
+
+	/// Project this vector onto some basis vector.
+	/// @param basis The basis vector or map to be projected onto.
+	/// @return The projection of this onto the basis vector.
+	template <typename V>
+	Vector<T, N>
+	projectParallel(const V &basis) const
+	{
+		T	k = (*this * basis) / (basis * basis);
+		T	tmp[N];
+
+		for (size_t i = 0; i < N; i++) {
+			tmp[i] = basis[i] * k;
+		}
+		return Vector<T, N>(tmp);
+	}
+
+
+	/// Project this vector perpendicularly onto some basis vector.
+	/// @param basis The basis vector or map to be projected onto.
+	/// @return The rejection of this from the basis vector.
+	template <typename V>
+	Vector<T, N>
+	projectOrthogonal(const V &basis) const
+	{
+		return *this - this->projectParallel(basis);
+	}
+
+
+	/// Compute the cross product with another three-dimensional vector.
+	/// @param other Another 3D vector or map.
+	/// @return The cross product vector.
+	template <typename V>
+	Vector<T, N>
+	cross(const V &other) const
+	{
+		static_assert(N == 3, "the cross product is only defined in R3");
+		const VectorMap	&a = *this;
+
+		return Vector<T, N>{
+			(a[1] * other[2]) - (other[1] * a[2]),
+			-((a[0] * other[2]) - (other[0] * a[2])),
+			(a[0] * other[1]) - (other[0] * a[1])
+		};
+	}
+
+
+	/// Compute the dot product with another vector.
+	/// @param other A Vector or VectorMap.
+	/// @return The dot product of the two vectors.
+	template <typename V>
+	typename std::enable_if<!std::is_convertible<V, T>::value, T>::type
+	operator*(const V &other) const
+	{
+		T	result = 0;
+
+		for (size_t i = 0; i < N; i++) {
+			result += ((*this)[i] * other[i]);
+		}
+		return result;
+	}
+
+
+	/// Perform scalar multiplication.
+	/// @param k The scaling value.
+	/// @return A new vector that is this vector scaled by k.
+	Vector<T, N>
+	operator*(const T k) const
+	{
+		T	tmp[N];
+
+		for (size_t i = 0; i < N; i++) {
+			tmp[i] = (*this)[i] * k;
+		}
+		return Vector<T, N>(tmp);
+	}
+
+
+	/// Perform scalar division.
+	/// @param k The scaling value.
+	/// @return A new vector that is this vector scaled by 1/k.
+	Vector<T, N>
+	operator/(const T k) const
+	{
+		T	tmp[N];
+
+		for (size_t i = 0; i < N; i++) {
+			tmp[i] = (*this)[i] / k;
+		}
+		return Vector<T, N>(tmp);
+	}
+
+
+	/// Perform vector addition.
+	/// @param other A Vector or VectorMap.
+	/// @return The sum of the two vectors.
+	template <typename V>
+	Vector<T, N>
+	operator+(const V &other) const
+	{
+		T	tmp[N];
+
+		for (size_t i = 0; i < N; i++) {
+			tmp[i] = (*this)[i] + other[i];
+		}
+		return Vector<T, N>(tmp);
+	}
+
+
+	/// Perform vector subtraction.
+	/// @param other A Vector or VectorMap.
+	/// @return The difference of the two vectors.
+	template <typename V>
+	Vector<T, N>
+	operator-(const V &other) const
+	{
+		T	tmp[N];
+
+		for (size_t i = 0; i < N; i++) {
+			tmp[i] = (*this)[i] - other[i];
+		}
+		return Vector<T, N>(tmp);
+	}
+
+
+	/// Compare with another vector.
+	/// @param other A Vector or VectorMap.
+	/// @return True if all components are within the tolerance value.
+	template <typename V>
+	bool
+	operator==(const V &other) const
+	{
+		for (size_t i = 0; i < N; i++) {
+			if (!wr::math::WithinTolerance((*this)[i], other[i], this->epsilon)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	/// Compare with another vector for inequality.
+	/// @param other A Vector or VectorMap.
+	/// @return True if any component is outside the tolerance value.
+	template <typename V>
+	bool
+	operator!=(const V &other) const
+	{
+		return !(*this == other);
+	}
+
+
+	/// Support outputting vector maps in the form "<i, j, ...>".
+	/// @param outs An output stream.
+	/// @param vec The vector to be formatted.
+	/// @return The output stream.
+	friend std::ostream&
+	operator<<(std::ostream& outs, const VectorMap<T, N>& vec)
+	{
+		return outs << vec.vector();
+	}
+
+private:
+	const T		*base;
+	ptrdiff_t	 stride;
+	T		 epsilon;
+};
+
+
+/// @brief QuaternionMap is a read-only view of a quaternion stored as
+/// <w, x, y, z> in external memory.
+///
+/// \tparam T The element type.
+template <typename T>
+class QuaternionMap {
+public:
+	/// Map a quaternion whose components are stride elements apart.
+	///
+	/// @param data A pointer to the w component.
+	/// @param stride The distance in elements between components.
+	explicit QuaternionMap(const T *data, ptrdiff_t stride = 1) :
+		base(data), stride(stride)
+	{
+		wr::math::DefaultEpsilon(this->eps);
+	}
+
+
+	/// Set the comparison tolerance for this quaternion.
+	///
+	/// @param epsilon A tolerance value.
+	void
+	setEpsilon(T epsilon)
+	{
+		this->eps = epsilon;
+	}
+
+
+	/// Return component i, in <w, x, y, z> order.
+	///
+	/// @param i The component index.
+	/// @return The value of the component.
+	const T&
+	operator[](size_t i) const
+	{
+		return this->base[static_cast<ptrdiff_t>(i) * this->stride];
+	}
+
+
+	/// Copy the mapped quaternion into a Quaternion.
+	///
+	/// @return An owning copy of the quaternion.
+	Quaternion<T>
+	quaternion() const
+	{
+		const QuaternionMap	&q = *this;
+
+		return Quaternion<T>{q[0], q[1], q[2], q[3]};
+	}
+
+
+	/// Return the axis of rotation of this quaternion.
+	///
+	/// @return A view of the <x, y, z> components.
+	VectorMap<T, 3>
+	axis() const
+	{
+		VectorMap<T, 3>	v(this->base + this->stride, this->stride);
+
+		v.setEpsilon(this->eps);
+		return v;
+	}
+
+
+	/// Return the angle of rotation of this quaternion.
+	///
+	/// @return the w component.
+	T
+	angle() const
+	{
+		return (*this)[0];
+	}
+
+
+	/// Compute the dot product of two quaternions.
+	///
+	/// \param other A Quaternion or QuaternionMap.
+	/// \return The dot product between the two quaternions.
+	template <typename Q>
+	T
+	dot(const Q &other) const
+	{
+		return (this->angle() * other.angle()) + (this->axis() * other.axis());
+	}
+
+
+	/// Compute the norm of a quaternion.
+	///
+	/// @return A non-negative real number.
+	T
+	norm() const
+	{
+		using std::sqrt;
+
+		return sqrt(this->dot(*this));
+	}
+
+
+	/// Return the unit quaternion.
+	///
+	/// \return The unit quaternion.
+	Quaternion<T>
+	unitQuaternion() const
+	{
+		return this->quaternion() / this->norm();
+	}
+
+
+	/// Compute the conjugate of a quaternion.
+	///
+	/// @return The conjugate of this quaternion.
+	Quaternion<T>
+	conjugate() const
+	{
+		const QuaternionMap	&q = *this;
+
+		return Quaternion<T>{q[0], -q[1], -q[2], -q[3]};
+	}
+
+
+	/// Compute the inverse of a quaternion.
+	///
+	/// @return The inverse of this quaternion.
+	Quaternion<T>
+	inverse() const
+	{
+		return this->conjugate() / this->dot(*this);
+	}
+
+
+	/// Determine whether this is an identity quaternion.
+	///
+	/// \return true if this is an identity quaternion.
+	bool
+	isIdentity() const
+	{
+		return this->axis().isZero() &&
+		       math::WithinTolerance(this->angle(), (T)1.0, this->eps);
+	}
+
+
+	/// Determine whether this is a unit quaternion.
+	///
+	/// @return true if this is a unit quaternion.
+	bool
+	isUnitQuaternion() const
+	{
+		return wr::math::WithinTolerance(this->norm(), (T)1.0, this->eps);
+	}
+
+
+	/// Return the quaternion as a Vector<T, 4> in <w, x, y, z> order.
+	///
+	/// @return A vector representation of the quaternion.
+	Vector<T, 4>
+	asVector() const
+	{
+		const QuaternionMap	&q = *this;
+
+		return Vector<T, 4>{q[0], q[1], q[2], q[3]};
+	}
+
+
+	/// Rotate a vector about this quaternion.
+	///
+	/// @param v A Vector or VectorMap to be rotated.
+	/// @return The rotated vector.
+	template <typename V>
+	Vector<T, 3>
+	rotate(const V &v) const
+	{
+		return this->quaternion().rotate(Vector<T, 3>{v[0], v[1], v[2]});
+	}
+
+
+	/// Return the Euler angles for this quaternion as <yaw, pitch, roll>.
+	///
+	/// @return A vector<T, 3> containing <yaw, pitch, roll>
+	Vector<T, 3>
+	euler() const
+	{
+		return this->quaternion().euler();
+	}
+
+
+	/// Perform quaternion Hamilton multiplication.
+	///
+	/// @param other Another quaternion.
+	/// @result The Hamilton product of the two quaternions.
+	Quaternion<T>
+	operator*(const Quaternion<T> &other) const
+	{
+		return this->quaternion() * other;
+	}
+
+
+	/// Perform quaternion Hamilton multiplication.
+	///
+	/// @param other Another mapped quaternion.
+	/// @result The Hamilton product of the two quaternions.
+	Quaternion<T>
+	operator*(const QuaternionMap<T> &other) const
+	{
+		return this->quaternion() * other.quaternion();
+	}
+
+
+	/// Perform scalar multiplication.
+	///
+	/// @param k The scaling value.
+	/// @return A scaled quaternion.
+	Quaternion<T>
+	operator*(const T k) const
+	{
+		const QuaternionMap	&q = *this;
+
+		return Quaternion<T>{q[0] * k, q[1] * k, q[2] * k, q[3] * k};
+	}
+
+
+	/// Perform scalar division.
+	///
+	/// @param k The scalar divisor.
+	/// @return A scaled quaternion.
+	Quaternion<T>
+	operator/(const T k) const
+	{
+		const QuaternionMap	&q = *this;
+
+		return Quaternion<T>{q[0] / k, q[1] / k, q[2] / k, q[3] / k};
+	}
+
+
+	/// Compare with another quaternion.
+	///
+	/// @param other A Quaternion or QuaternionMap.
+	/// @return True if the two quaternions are equal within tolerance.
+	template <typename Q>
+	bool
+	operator==(const Q &other) const
+	{
+		return (this->axis() == other.axis()) &&
+		       wr::math::WithinTolerance(this->angle(), other.angle(), this->eps);
+	}
+
+
+	/// Compare with another quaternion for inequality.
+	///
+	/// @param other A Quaternion or QuaternionMap.
+	/// @return True if the two quaternions are not equal within tolerance.
+	template <typename Q>
+	bool
+	operator!=(const Q &other) const
+	{
+		return !(*this == other);
+	}
+
+
+	/// Support stream output in the form `a + <i, j, k>`.
+	///
+	/// @param outs An output stream
+	/// @param q A quaternion map
+	/// @return The output stream
+	friend std::ostream &
+	operator<<(std::ostream &outs, const QuaternionMap<T> &q)
+	{
+		return outs << q.quaternion();
+	}
+
+private:
+	const T		*base;
+	ptrdiff_t	 stride;
+	T		 eps;
+};
+
+
+/// @brief VectorArrayMap is a read-only view of an array of vectors in
+/// external memory.
+///
+/// \tparam T The element type.
+/// \tparam N The dimension of the vectors.
+template <typename T, size_t N>
+class VectorArrayMap {
+public:
+	/// Map count vectors.
+	///
+	/// @param data A pointer to the first component of the first vector.
+	/// @param count The number of vectors.
+	/// @param recordStride The distance in elements between vectors.
+	/// @param componentStride The distance in elements between the
+	///                        components of a vector.
+	VectorArrayMap(const T *data, size_t count, ptrdiff_t recordStride = N,
+		       ptrdiff_t componentStride = 1) :
+		base(data), count(count), recordStride(recordStride),
+		componentStride(componentStride) {};
+
+
+	/// Return the number of vectors in the array.
+	///
+	/// @return The number of vectors.
+	size_t	size() const { return this->count; }
+
+
+	/// Return a view of vector i.
+	///
+	/// @param i The vector index.
+	/// @return A map of the vector.
+	VectorMap<T, N>
+	operator[](size_t i) const
+	{
+		assert(i < this->count);
+		return VectorMap<T, N>(this->base + (static_cast<ptrdiff_t>(i) * this->recordStride),
+				       this->componentStride);
+	}
+
+private:
+	const T		*base;
+	size_t		 count;
+	ptrdiff_t	 recordStride;
+	ptrdiff_t	 componentStride;
+};
+
+
+/// @brief QuaternionArrayMap is a read-only view of an array of
+/// quaternions stored as <w, x, y, z> in external memory.
+///
+/// \tparam T The element type.
+template <typename T>
+class QuaternionArrayMap {
+public:
+	/// Map count quaternions.
+	///
+	/// @param data A pointer to the w component of the first quaternion.
+	/// @param count The number of quaternions.
+	/// @param recordStride The distance in elements between quaternions.
+	/// @param componentStride The distance in elements between the
+	///                        components of a quaternion.
+	QuaternionArrayMap(const T *data, size_t count, ptrdiff_t recordStride = 4,
+			   ptrdiff_t componentStride = 1) :
+		base(data), count(count), recordStride(recordStride),
+		componentStride(componentStride) {};
+
+
+	/// Return the number of quaternions in the array.
+	///
+	/// @return The number of quaternions.
+	size_t	size() const { return this->count; }
+
+
+	/// Return a view of quaternion i.
+	///
+	/// @param i The quaternion index.
+	/// @return A map of the quaternion.
+	QuaternionMap<T>
+	operator[](size_t i) const
+	{
+		assert(i < this->count);
+		return QuaternionMap<T>(this->base + (static_cast<ptrdiff_t>(i) * this->recordStride),
+					this->componentStride);
+	}
+
+private:
+	const T		*base;
+	size_t		 count;
+	ptrdiff_t	 recordStride;
+	ptrdiff_t	 componentStride;
+};
+
+
+} // namespace geom
+} // namespace wr
+
+
+#endif // __WRMATH_GEOM_MAP_H
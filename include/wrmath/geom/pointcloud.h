@@ -0,0 +1,293 @@
+/// \file pointcloud.h
+/// \brief Rigid transforms of large point arrays.
+///
+/// PointTransform converts a pose to a 3x3 matrix and translation once,
+/// then applies it to interleaved <x, y, z> arrays in chunks spread over
+/// a wr::parallel::ThreadPool.
+///
+/// Poses follow the convention of Quaternion::rotate: a point p is
+/// transformed to r* p r + t, with p as a pure quaternion.
+///
+/// Output that won't be read again soon, such as a transformed lidar
+/// frame handed to another stage, can be written with non-temporal
+/// stores to avoid evicting the input from the cache. These are used on
+/// x86-64 and ignored elsewhere.
+#ifndef __WRMATH_GEOM_POINTCLOUD_H
+#define __WRMATH_GEOM_POINTCLOUD_H
+
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define WRMATH_STREAMING_STORES
+#endif
+
+#include <wrmath/parallel.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+
+
+namespace wr {
+namespace geom {
+
+
+/// @brief PointCloudOptions controls how a point array is split up and
+/// written.
+struct PointCloudOptions {
+	/// The number of points handed to a thread at a time.
+	size_t			 chunkSize;
+
+	/// Write the output with non-temporal stores.
+	bool			 streamingStores;
+
+	/// The pool to run on; nullptr uses wr::parallel::DefaultPool().
+	parallel::ThreadPool	*pool;
+
+	/// The default options use chunks of 16384 points, ordinary stores
+	/// and the default pool.
+	PointCloudOptions() : chunkSize(16384), streamingStores(false), pool(nullptr) {};
+};
+
+
+/// Store a value with a non-temporal store where they're available.
+inline void
+StreamStore(float *dst, float v)
+{
+#if defined(WRMATH_STREAMING_STORES)
+	int32_t	bits;
+
+	std::memcpy(&bits, &v, sizeof(bits));
+	_mm_stream_si32(reinterpret_cast<int *>(dst), bits);
+#else
+	*dst = v;
+#endif
+}
+
+
+/// Store a value with a non-temporal store where they're available.
+inline void
+StreamStore(double *dst, double v)
+{
+#if defined(WRMATH_STREAMING_STORES)
+	long long	bits;
+
+	std::memcpy(&bits, &v, sizeof(bits));
+	_mm_stream_si64(reinterpret_cast<long long *>(dst), bits);
+#else
+	*dst = v;
+#endif
+}
+
+
+/// Order earlier non-temporal stores before any later stores.
+inline void
+StreamFence()
+{
+#if defined(WRMATH_STREAMING_STORES)
+	_mm_sfence();
+#endif
+}
+
+
+/// @brief PointTransform applies a rigid transform to arrays of points.
+///
+/// \tparam T A floating point type.
+template <typename T>
+class PointTransform {
+public:
+	/// The identity transform.
+	PointTransform() : coef{1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0} {};
+
+
+	/// A transform that rotates and then translates.
+	///
+	/// @param rotation A unit quaternion.
+	/// @param translation The translation applied after the rotation.
+	PointTransform(const Quaternion<T> &rotation, const Vector<T, 3> &translation)
+	{
+		this->setPose(rotation, translation);
+	}
+
+
+	/// Change the pose.
+	///
+	/// @param rotation A unit quaternion.
+	/// @param translation The translation applied after the rotation.
+	void
+	setPose(const Quaternion<T> &rotation, const Vector<T, 3> &translation)
+	{
+		assert(rotation.isUnitQuaternion());
+
+		Vector<T, 3>	axis = rotation.axis();
+		T		w = rotation.angle();
+		T		x = axis[0], y = axis[1], z = axis[2];
+
+		// The matrix of p -> r* p r.
+		this->coef[0] = 1 - 2 * ((y * y) + (z * z));
+		this->coef[1] = 2 * ((x * y) + (w * z));
+		this->coef[2] = 2 * ((x * z) - (w * y));
+		this->coef[3] = 2 * ((x * y) - (w * z));
+		this->coef[4] = 1 - 2 * ((x * x) + (z * z));
+		this->coef[5] = 2 * ((y * z) + (w * x));
+		this->coef[6] = 2 * ((x * z) + (w * y));
+		this->coef[7] = 2 * ((y * z) - (w * x));
+		this->coef[8] = 1 - 2 * ((x * x) + (y * y));
+		this->coef[9] = translation[0];
+		this->coef[10] = translation[1];
+		this->coef[11] = translation[2];
+	}
+
+
+	/// Return the transform as twelve coefficients: the row-major 3x3
+	/// rotation matrix followed by the translation.
+	///
+	/// @return The coefficients.
+	const T	*coefficients() const { return this->coef; }
+
+
+	/// Transform a single point.
+	///
+	/// @param p A point.
+	/// @return The transformed point.
+	Vector<T, 3>
+	operator()(const Vector<T, 3> &p) const
+	{
+		T	in[3] = {p[0], p[1], p[2]};
+		T	out[3];
+
+		Apply(this->coef, in, out, 1, false);
+		return Vector<T, 3>(out);
+	}
+
+
+	/// Transform an array of points, in parallel.
+	///
+	/// @param in count points as interleaved <x, y, z>.
+	/// @param out Storage for count points; it may be the same as in.
+	/// @param count The number of points.
+	/// @param opts The chunking, store and pool options.
+	void
+	apply(const T *in, T *out, size_t count,
+	      const PointCloudOptions &opts = PointCloudOptions()) const
+	{
+		const T	*c = this->coef;
+		bool	 streaming = opts.streamingStores;
+
+		parallel::ParallelFor(count, opts.chunkSize,
+		    [c, in, out, streaming](size_t begin, size_t end) {
+			Apply(c, in + (begin * 3), out + (begin * 3), end - begin, streaming);
+		}, opts.pool);
+	}
+
+
+	/// Transform an array of Vectors, in parallel.
+	///
+	/// @param in count points.
+	/// @param out Storage for count points; it may be the same as in.
+	/// @param count The number of points.
+	/// @param opts The chunking and pool options; Vector output is
+	///             always written with ordinary stores.
+	void
+	apply(const Vector<T, 3> *in, Vector<T, 3> *out, size_t count,
+	      const PointCloudOptions &opts = PointCloudOptions()) const
+	{
+		const T	*c = this->coef;
+
+		parallel::ParallelFor(count, opts.chunkSize,
+		    [c, in, out](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				T	p[3] = {in[i][0], in[i][1], in[i][2]};
+				T	q[3];
+
+				Apply(c, p, q, 1, false);
+				out[i] = Vector<T, 3>(q);
+			}
+		}, opts.pool);
+	}
+
+
+	/// Apply transform coefficients to interleaved points on the
+	/// calling thread.
+	///
+	/// @param coef Coefficients as returned by coefficients().
+	/// @param in count points as interleaved <x, y, z>.
+	/// @param out Storage for count points; it may be the same as in.
+	/// @param count The number of points.
+	/// @param streaming Write the output with non-temporal stores.
+	static void
+	Apply(const T *coef, const T *in, T *out, size_t count, bool streaming)
+	{
+		T	m0 = coef[0], m1 = coef[1], m2 = coef[2];
+		T	m3 = coef[3], m4 = coef[4], m5 = coef[5];
+		T	m6 = coef[6], m7 = coef[7], m8 = coef[8];
+		T	tx = coef[9], ty = coef[10], tz = coef[11];
+
+		if (streaming) {
+			for (size_t i = 0; i < count * 3; i += 3) {
+				T	x = in[i], y = in[i + 1], z = in[i + 2];
+
+				StreamStore(out + i, (m0 * x) + (m1 * y) + (m2 * z) + tx);
+				StreamStore(out + i + 1, (m3 * x) + (m4 * y) + (m5 * z) + ty);
+				StreamStore(out + i + 2, (m6 * x) + (m7 * y) + (m8 * z) + tz);
+			}
+			StreamFence();
+			return;
+		}
+
+		for (size_t i = 0; i < count * 3; i += 3) {
+			T	x = in[i], y = in[i + 1], z = in[i + 2];
+
+			out[i] = (m0 * x) + (m1 * y) + (m2 * z) + tx;
+			out[i + 1] = (m3 * x) + (m4 * y) + (m5 * z) + ty;
+			out[i + 2] = (m6 * x) + (m7 * y) + (m8 * z) + tz;
+		}
+	}
+
+private:
+	T	coef[12];
+};
+
+
+/// Transform an array of points with a separate pose for each run of
+/// points, such as the firing sequence of a spinning lidar. Pose i
+/// applies to points [i * posePoints, (i + 1) * posePoints), and each
+/// pose's matrix is computed once.
+///
+/// @param rotations ceil(count / posePoints) unit quaternions.
+/// @param translations ceil(count / posePoints) translations.
+/// @param posePoints The number of points per pose; it must not be zero.
+/// @param in count points as interleaved <x, y, z>.
+/// @param out Storage for count points; it may be the same as in.
+/// @param count The number of points.
+/// @param opts The store and pool options; the chunk size is ignored,
+///             since each pose's points form a chunk.
+template <typename T>
+void
+TransformPointCloud(const Quaternion<T> *rotations, const Vector<T, 3> *translations,
+		    size_t posePoints, const T *in, T *out, size_t count,
+		    const PointCloudOptions &opts = PointCloudOptions())
+{
+	assert(posePoints > 0);
+
+	bool	streaming = opts.streamingStores;
+
+	parallel::ParallelFor(count, posePoints,
+	    [rotations, translations, posePoints, in, out, streaming](size_t begin, size_t end) {
+		PointTransform<T>	pose(rotations[begin / posePoints],
+					     translations[begin / posePoints]);
+
+		PointTransform<T>::Apply(pose.coefficients(), in + (begin * 3),
+					 out + (begin * 3), end - begin, streaming);
+	}, opts.pool);
+}
+
+
+} // namespace geom
+} // namespace wr
+
+
+#endif // __WRMATH_GEOM_POINTCLOUD_H
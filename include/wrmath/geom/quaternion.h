@@ -10,6 +10,7 @@
 #include <iostream>
 #include <ostream>
 #include <wrmath/geom/vector.h>
+#include <wrmath/instrument.h>
 #include <wrmath/math.h>
 
 /// wr contains the wntrmute robotics code.
@@ -46,6 +47,7 @@ public:
 	/// The default Quaternion constructor returns an identity quaternion.
 	Quaternion() : v(Vector<T, 3>{0.0, 0.0, 0.0}), w(1.0)
 	{
+		WRMATH_COUNT("Quaternion::Quaternion()");
 		wr::math::DefaultEpsilon(this->eps);
 		v.setEpsilon(this->eps);
 	};
@@ -59,6 +61,7 @@ public:
 	/// @param _angle The angle of rotation about the axis of rotation.
 	Quaternion(Vector<T, 3> _axis, T _angle) : v(_axis), w(_angle)
 	{
+		WRMATH_COUNT("Quaternion::Quaternion(Vector<T, 3>, T)");
 		this->constrainAngle();
 		wr::math::DefaultEpsilon(this->eps);
 		v.setEpsilon(this->eps);
@@ -73,6 +76,7 @@ public:
 		v(Vector<T, 3>{vector[1], vector[2], vector[3]}),
 		w(vector[0])
 	{
+		WRMATH_COUNT("Quaternion::Quaternion(Vector<T, 4>)");
 		this->constrainAngle();
 		wr::math::DefaultEpsilon(this->eps);
 		v.setEpsilon(this->eps);
@@ -85,6 +89,7 @@ public:
 	/// @param ilst An initial set of values in the form <w, x, y, z>.
 	Quaternion(std::initializer_list<T> ilst)
 	{
+		WRMATH_COUNT("Quaternion::Quaternion(initializer_list)");
 		auto it = ilst.begin();
 
 		this->v = Vector<T, 3>{it[1], it[2], it[3]};
@@ -95,6 +100,18 @@ public:
 		v.setEpsilon(this->eps);
 	}
 
+
+#ifdef WRMATH_INSTRUMENT
+	/// In instrumented builds, copies are counted as temporaries.
+	Quaternion(const Quaternion &other) :
+		v(other.v), w(other.w), eps(other.eps)
+	{
+		WRMATH_COUNT("Quaternion::Quaternion(const Quaternion &)");
+	}
+
+	Quaternion &operator=(const Quaternion &other) = default;
+#endif
+
 	
 	/// Set the comparison tolerance for this quaternion.
 	///
@@ -134,7 +151,8 @@ public:
 	T
 	dot(const Quaternion<T> &other) const
 	{
-		double	innerProduct = this->v[0] * other.v[0];
+		WRMATH_COUNT("Quaternion::dot");
+		T	innerProduct = this->v[0] * other.v[0];
 
 		innerProduct += (this->v[1] * other.v[1]);
 		innerProduct += (this->v[2] * other.v[2]);
@@ -150,6 +168,8 @@ public:
 	T
 	norm() const
 	{
+		WRMATH_COUNT("Quaternion::norm");
+		using std::sqrt;
 		T n = 0;
 
 		n += (this->v[0] * this->v[0]);
@@ -157,7 +177,26 @@ public:
 		n += (this->v[2] * this->v[2]);
 		n += (this->w * this->w);
 
-		return std::sqrt(n);
+		WRMATH_COUNT("sqrt");
+		return sqrt(n);
+	}
+
+
+	/// Compute the squared norm of a quaternion, which is cheaper than
+	/// the norm because it doesn't need a square root.
+	///
+	/// @return A non-negative real number.
+	T
+	normSquared() const
+	{
+		WRMATH_COUNT("Quaternion::normSquared");
+		T n = 0;
+
+		n += (this->v[0] * this->v[0]);
+		n += (this->v[1] * this->v[1]);
+		n += (this->v[2] * this->v[2]);
+		n += (this->w * this->w);
+		return n;
 	}
 
 
@@ -165,8 +204,9 @@ public:
 	///
 	/// \return The unit quaternion.
 	Quaternion
-	unitQuaternion()
+	unitQuaternion() const
 	{
+		WRMATH_COUNT("Quaternion::unitQuaternion");
 		return *this / this->norm();
 	}
 
@@ -176,6 +216,7 @@ public:
 	Quaternion
 	conjugate() const
 	{
+		WRMATH_COUNT("Quaternion::conjugate");
 		return Quaternion(Vector<T, 4>{this->w, -this->v[0], -this->v[1], -this->v[2]});
 	}
 
@@ -186,6 +227,7 @@ public:
 	Quaternion
 	inverse() const
 	{
+		WRMATH_COUNT("Quaternion::inverse");
 		T _norm = this->norm();
 
 		return this->conjugate() / (_norm * _norm);
@@ -197,6 +239,7 @@ public:
 	/// \return true if this is an identity quaternion.
 	bool
 	isIdentity() const {
+		WRMATH_COUNT("Quaternion::isIdentity");
 		return this->v.isZero() &&
 		       math::WithinTolerance(this->w, (T)1.0, this->eps);
 	}
@@ -208,6 +251,7 @@ public:
 	bool
 	isUnitQuaternion() const
 	{
+		WRMATH_COUNT("Quaternion::isUnitQuaternion");
 		return wr::math::WithinTolerance(this->norm(), (T) 1.0, this->eps);
 	}
 
@@ -223,14 +267,23 @@ public:
 	}
 
 
-	/// Rotate vector v about this quaternion.
+	/// Rotate vector v about this quaternion, as q* v q with v treated
+	/// as a pure quaternion.
 	///
 	/// @param v The vector to be rotated.
 	/// @return The rotated vector.
 	Vector<T, 3>
 	rotate(Vector<T, 3> v) const
 	{
-		return (this->conjugate() * v * (*this)).axis();
+		WRMATH_COUNT("Quaternion::rotate");
+
+		// The products are expanded here rather than formed as
+		// Quaternions, whose scalar part would be wrapped as an
+		// angle.
+		T		tw = this->v * v;
+		Vector<T, 3>	tv = v * this->w - this->v.cross(v);
+
+		return this->v * tw + tv * this->w + tv.cross(this->v);
 	}
 
 
@@ -242,12 +295,15 @@ public:
 	Vector<T, 3>
 	euler() const
 	{
+		WRMATH_COUNT("Quaternion::euler");
 		T yaw, pitch, roll;
 		T a = this->w, a2 = a * a;
 		T b = this->v[0], b2 = b * b;
 		T c = this->v[1], c2 = c * c;
 		T d = this->v[2], d2 = d * d;
 
+		WRMATH_COUNT_N("atan2", 2);
+		WRMATH_COUNT("asin");
 		yaw = std::atan2(2 * ((a * b) + (c * d)), a2 - b2 - c2 + d2);
 		pitch = std::asin(2 * ((b * d) - (a * c)));
 		roll = std::atan2(2 * ((a * d) + (b * c)), a2 + b2 - c2 - d2);
@@ -263,6 +319,7 @@ public:
 	Quaternion
 	operator+(const Quaternion<T> &other) const
 	{
+		WRMATH_COUNT("Quaternion::operator+");
 		return Quaternion(this->v + other.v, this->w + other.w);
 	}
 
@@ -274,6 +331,7 @@ public:
 	Quaternion
 	operator-(const Quaternion<T> &other) const
 	{
+		WRMATH_COUNT("Quaternion::operator-");
 		return Quaternion(this->v - other.v, this->w - other.w);
 	}
 
@@ -285,6 +343,7 @@ public:
 	Quaternion
 	operator*(const T k) const
 	{
+		WRMATH_COUNT("Quaternion::operator*(T)");
 		return Quaternion(this->v * k, this->w * k);
 	}
 
@@ -296,6 +355,7 @@ public:
 	Quaternion
 	operator/(const T k) const
 	{
+		WRMATH_COUNT("Quaternion::operator/(T)");
 		return Quaternion(this->v / k, this->w / k);
 	}
 
@@ -309,8 +369,9 @@ public:
 	Quaternion
 	operator*(const Vector<T, 3> &vector) const
 	{
+		WRMATH_COUNT("Quaternion::operator*(Vector)");
 		return Quaternion(vector * this->w + this->v.cross(vector),
-				  (T) 0.0);
+				  -(this->v * vector));
 	}
 
 
@@ -321,6 +382,7 @@ public:
 	Quaternion
 	operator*(const Quaternion<T> &other) const
 	{
+		WRMATH_COUNT("Quaternion::operator*(Quaternion)");
 		T angle = (this->w * other.w) -
 			  (this->v * other.v);
 		Vector<T, 3> axis = (other.v * this->w) +
@@ -336,6 +398,7 @@ public:
 	bool
 	operator==(const Quaternion<T> &other) const
 	{
+		WRMATH_COUNT("Quaternion::operator==");
 		return (this->v == other.v) &&
 		       (wr::math::WithinTolerance(this->w, other.w, this->eps));
 	}
@@ -366,26 +429,34 @@ public:
 	}
 
 private:
-	static constexpr T minRotation = -4 * M_PI;
 	static constexpr T maxRotation = 4 * M_PI;
 
 	Vector<T, 3> v; // axis of rotation
 	T w; // angle of rotation
 	T eps;
 
+	// fmod is the identity inside (-4π, 4π), so it's only needed for
+	// angles outside that range. For types that can't represent 4π,
+	// such as Q15, the bound saturates and the angle is never touched.
 	void
 	constrainAngle()
 	{
-		if (this->w < 0.0) {
-			this->w = std::fmod(this->w, this->minRotation);
-		}
-		else {
-			this->w = std::fmod(this->w, this->maxRotation);
+		WRMATH_COUNT("Quaternion::constrainAngle");
+		using std::abs;
+		using std::fmod;
+
+		if (abs(this->w) > this->maxRotation) {
+			WRMATH_COUNT("fmod");
+			this->w = fmod(this->w, this->maxRotation);
 		}
 	}
 };
 
 
+template <typename T>
+constexpr T Quaternion<T>::maxRotation;
+
+
 ///
 /// \defgroup quaternion_aliases Quaternion type aliases.
 /// Type aliases are provided for float and double quaternions.
@@ -431,6 +502,9 @@ template <typename T>
 Quaternion<T>
 quaternion(Vector<T, 3> axis, T angle)
 {
+	WRMATH_COUNT("quaternion");
+	WRMATH_COUNT("sin");
+	WRMATH_COUNT("cos");
 	return Quaternion<T>(axis.unitVector() * std::sin(angle / (T)2.0),
 			     std::cos(angle / (T)2.0));
 }
@@ -470,6 +544,7 @@ template <typename T>
 Quaternion<T>
 LERP(Quaternion<T> p, Quaternion<T> q, T t)
 {
+	WRMATH_COUNT("LERP");
 	return (p + (q - p) * t).unitQuaternion();
 }
 
@@ -489,11 +564,14 @@ template <typename T>
 Quaternion<T>
 ShortestSLERP(Quaternion<T> p, Quaternion<T> q, T t)
 {
+	WRMATH_COUNT("ShortestSLERP");
 	assert(p.isUnitQuaternion());
 	assert(q.isUnitQuaternion());
 
 	T	dp = p.dot(q);
 	T	sign = dp < 0.0 ? -1.0 : 1.0;
+	WRMATH_COUNT("acos");
+	WRMATH_COUNT("sin");
 	T	omega = std::acos(dp * sign);
 	T	sin_omega = std::sin(omega); // Compute once.
 
@@ -501,6 +579,7 @@ ShortestSLERP(Quaternion<T> p, Quaternion<T> q, T t)
 		return LERP(p, q * sign, t);
 	}
 
+	WRMATH_COUNT_N("sin", 2);
 	return (p * std::sin((1.0 - t) * omega) / sin_omega) +
 	       (q * sign * std::sin(omega*t) / sin_omega);
 }
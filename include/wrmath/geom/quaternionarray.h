@@ -0,0 +1,405 @@
+/// \file quaternionarray.h
+/// \brief Element-wise quaternion arithmetic over arrays.
+///
+/// These apply the Hamilton product, conjugate, inverse, dot product
+/// and norm to whole arrays of quaternions, such as composing every
+/// orientation in a log with a sensor mount correction. The quaternion
+/// operators build several Vector temporaries and range-check the
+/// angle for every result; the kernels for raw arrays work on the
+/// components directly.
+///
+/// Raw arrays hold quaternions as interleaved <w, x, y, z>, as the
+/// codecs and the Wahba solvers do, and can be viewed afterwards with a
+/// QuaternionArrayMap. Arrays of more than QuaternionGrain quaternions
+/// are split across a wr::parallel::ThreadPool; smaller ones run on the
+/// calling thread. Outputs may be the same array as an input.
+///
+/// The overloads taking arrays of Quaternion are a convenience with the
+/// same threading. They gain nothing else: each operand is still copied
+/// out through axis(), and each result is built by the Quaternion
+/// constructor, with its angle check. Use raw arrays where speed
+/// matters.
+#ifndef __WRMATH_GEOM_QUATERNIONARRAY_H
+#define __WRMATH_GEOM_QUATERNIONARRAY_H
+
+
+#include <cmath>
+#include <cstddef>
+
+#include <wrmath/parallel.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+
+
+namespace wr {
+namespace geom {
+
+
+/// QuaternionGrain is the number of quaternions an array operation hands
+/// to a thread at a time. Arrays no larger than this aren't split.
+constexpr size_t	QuaternionGrain = 16384;
+
+
+namespace detail {
+
+
+// MultiplyKernel computes out[i] = a[i] b[i], where a stride of zero
+// broadcasts a single quaternion. The strides are template parameters
+// so each case compiles to its own loop.
+template <size_t SA, size_t SB, typename T>
+void
+MultiplyKernel(const T *a, const T *b, T *out, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		const T	*p = a + (i * SA);
+		const T	*q = b + (i * SB);
+		T	 w = (p[0] * q[0]) - (p[1] * q[1]) - (p[2] * q[2]) - (p[3] * q[3]);
+		T	 x = (p[0] * q[1]) + (p[1] * q[0]) + (p[2] * q[3]) - (p[3] * q[2]);
+		T	 y = (p[0] * q[2]) - (p[1] * q[3]) + (p[2] * q[0]) + (p[3] * q[1]);
+		T	 z = (p[0] * q[3]) + (p[1] * q[2]) - (p[2] * q[1]) + (p[3] * q[0]);
+		T	*r = out + (i * 4);
+
+		r[0] = w;
+		r[1] = x;
+		r[2] = y;
+		r[3] = z;
+	}
+}
+
+
+template <size_t SA, size_t SB, typename T>
+void
+Multiply(const T *a, const T *b, T *out, size_t count, parallel::ThreadPool *pool)
+{
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		MultiplyKernel<SA, SB>(a + (begin * SA), b + (begin * SB),
+				       out + (begin * 4), end - begin);
+	}, pool);
+}
+
+
+template <typename T>
+void
+Unpack(const Quaternion<T> &q, T *raw)
+{
+	Vector<T, 3>	v = q.axis();
+
+	raw[0] = q.angle();
+	raw[1] = v[0];
+	raw[2] = v[1];
+	raw[3] = v[2];
+}
+
+
+} // namespace detail
+
+
+/// Multiply two arrays of quaternions pairwise: out[i] = a[i] b[i].
+///
+/// @param a count quaternions.
+/// @param b count quaternions.
+/// @param out Storage for count quaternions.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionMultiply(const T *a, const T *b, T *out, size_t count,
+		   parallel::ThreadPool *pool = nullptr)
+{
+	detail::Multiply<4, 4>(a, b, out, count, pool);
+}
+
+
+/// Multiply a quaternion by each of an array: out[i] = p b[i].
+///
+/// @param p One quaternion.
+/// @param b count quaternions.
+/// @param out Storage for count quaternions.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionMultiplyLeft(const T *p, const T *b, T *out, size_t count,
+		       parallel::ThreadPool *pool = nullptr)
+{
+	detail::Multiply<0, 4>(p, b, out, count, pool);
+}
+
+
+/// Multiply each of an array by a quaternion: out[i] = a[i] p.
+///
+/// @param a count quaternions.
+/// @param p One quaternion.
+/// @param out Storage for count quaternions.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionMultiplyRight(const T *a, const T *p, T *out, size_t count,
+			parallel::ThreadPool *pool = nullptr)
+{
+	detail::Multiply<4, 0>(a, p, out, count, pool);
+}
+
+
+/// Conjugate an array of quaternions.
+///
+/// @param in count quaternions.
+/// @param out Storage for count quaternions.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionConjugate(const T *in, T *out, size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		for (size_t i = begin * 4; i < end * 4; i += 4) {
+			out[i] = in[i];
+			out[i + 1] = -in[i + 1];
+			out[i + 2] = -in[i + 2];
+			out[i + 3] = -in[i + 3];
+		}
+	}, pool);
+}
+
+
+/// Invert an array of non-zero quaternions: the conjugate divided by
+/// the squared norm.
+///
+/// @param in count quaternions.
+/// @param out Storage for count quaternions.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionInverse(const T *in, T *out, size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		for (size_t i = begin * 4; i < end * 4; i += 4) {
+			T	w = in[i], x = in[i + 1], y = in[i + 2], z = in[i + 3];
+			T	k = 1 / ((w * w) + (x * x) + (y * y) + (z * z));
+
+			out[i] = w * k;
+			out[i + 1] = -x * k;
+			out[i + 2] = -y * k;
+			out[i + 3] = -z * k;
+		}
+	}, pool);
+}
+
+
+/// Compute the dot products of two arrays of quaternions pairwise.
+///
+/// @param a count quaternions.
+/// @param b count quaternions.
+/// @param out Storage for count scalars.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionDot(const T *a, const T *b, T *out, size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const T	*p = a + (i * 4);
+			const T	*q = b + (i * 4);
+
+			out[i] = (p[0] * q[0]) + (p[1] * q[1]) + (p[2] * q[2]) + (p[3] * q[3]);
+		}
+	}, pool);
+}
+
+
+/// Compute the norms of an array of quaternions.
+///
+/// @param in count quaternions.
+/// @param out Storage for count scalars.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionNorm(const T *in, T *out, size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	using std::sqrt;
+
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const T	*p = in + (i * 4);
+
+			out[i] = sqrt((p[0] * p[0]) + (p[1] * p[1]) + (p[2] * p[2]) + (p[3] * p[3]));
+		}
+	}, pool);
+}
+
+
+/// Multiply two arrays of Quaternions pairwise: out[i] = a[i] b[i].
+///
+/// @param a count quaternions.
+/// @param b count quaternions.
+/// @param out Storage for count quaternions.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionMultiply(const Quaternion<T> *a, const Quaternion<T> *b, Quaternion<T> *out,
+		   size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			T	p[4], q[4], r[4];
+
+			detail::Unpack(a[i], p);
+			detail::Unpack(b[i], q);
+			detail::MultiplyKernel<0, 0>(p, q, r, 1);
+			out[i] = Quaternion<T>(Vector<T, 3>{r[1], r[2], r[3]}, r[0]);
+		}
+	}, pool);
+}
+
+
+/// Multiply each of an array of Quaternions by a quaternion:
+/// out[i] = a[i] p.
+///
+/// @param a count quaternions.
+/// @param p One quaternion.
+/// @param out Storage for count quaternions.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionMultiplyRight(const Quaternion<T> *a, const Quaternion<T> &p, Quaternion<T> *out,
+			size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	T	q[4];
+
+	detail::Unpack(p, q);
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			T	s[4], r[4];
+
+			detail::Unpack(a[i], s);
+			detail::MultiplyKernel<0, 0>(s, q, r, 1);
+			out[i] = Quaternion<T>(Vector<T, 3>{r[1], r[2], r[3]}, r[0]);
+		}
+	}, pool);
+}
+
+
+/// Multiply a quaternion by each of an array of Quaternions:
+/// out[i] = p b[i].
+///
+/// @param p One quaternion.
+/// @param b count quaternions.
+/// @param out Storage for count quaternions.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionMultiplyLeft(const Quaternion<T> &p, const Quaternion<T> *b, Quaternion<T> *out,
+		       size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	T	q[4];
+
+	detail::Unpack(p, q);
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			T	s[4], r[4];
+
+			detail::Unpack(b[i], s);
+			detail::MultiplyKernel<0, 0>(q, s, r, 1);
+			out[i] = Quaternion<T>(Vector<T, 3>{r[1], r[2], r[3]}, r[0]);
+		}
+	}, pool);
+}
+
+
+/// Conjugate an array of Quaternions.
+///
+/// @param in count quaternions.
+/// @param out Storage for count quaternions.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionConjugate(const Quaternion<T> *in, Quaternion<T> *out, size_t count,
+		    parallel::ThreadPool *pool = nullptr)
+{
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			T	p[4];
+
+			detail::Unpack(in[i], p);
+			out[i] = Quaternion<T>(Vector<T, 3>{-p[1], -p[2], -p[3]}, p[0]);
+		}
+	}, pool);
+}
+
+
+/// Invert an array of non-zero Quaternions.
+///
+/// @param in count quaternions.
+/// @param out Storage for count quaternions.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionInverse(const Quaternion<T> *in, Quaternion<T> *out, size_t count,
+		  parallel::ThreadPool *pool = nullptr)
+{
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			T	p[4];
+
+			detail::Unpack(in[i], p);
+
+			T	k = 1 / ((p[0] * p[0]) + (p[1] * p[1]) + (p[2] * p[2]) + (p[3] * p[3]));
+
+			out[i] = Quaternion<T>(Vector<T, 3>{-p[1] * k, -p[2] * k, -p[3] * k}, p[0] * k);
+		}
+	}, pool);
+}
+
+
+/// Compute the dot products of two arrays of Quaternions pairwise.
+///
+/// @param a count quaternions.
+/// @param b count quaternions.
+/// @param out Storage for count scalars.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionDot(const Quaternion<T> *a, const Quaternion<T> *b, T *out, size_t count,
+	      parallel::ThreadPool *pool = nullptr)
+{
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			out[i] = a[i].dot(b[i]);
+		}
+	}, pool);
+}
+
+
+/// Compute the norms of an array of Quaternions.
+///
+/// @param in count quaternions.
+/// @param out Storage for count scalars.
+/// @param count The number of quaternions.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+template <typename T>
+void
+QuaternionNorm(const Quaternion<T> *in, T *out, size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	parallel::ParallelFor(count, QuaternionGrain, [=](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			out[i] = in[i].norm();
+		}
+	}, pool);
+}
+
+
+} // namespace geom
+} // namespace wr
+
+
+#endif // __WRMATH_GEOM_QUATERNIONARRAY_H
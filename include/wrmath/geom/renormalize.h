@@ -0,0 +1,286 @@
+/// \file renormalize.h
+/// \brief Keeping integrated quaternions at unit length.
+///
+/// Integrating an angular rate into a quaternion, as an orientation
+/// filter does on every gyroscope reading, lets its norm creep away from
+/// one, and the orientation it represents drifts with it. Normalising
+/// exactly after every step costs a square root and a division each
+/// time, though the norm barely moves between steps.
+///
+/// When the squared norm s is close to one, q (3 - s) / 2 is a
+/// first-order Newton step towards 1/√s: it leaves an error of about
+/// three quarters of the square of the old one, needs no square root,
+/// and applied repeatedly converges quickly. A Renormalizer uses it
+/// every few steps, or sooner if a cheap check of the squared norm
+/// finds the error has grown, and falls back to an exact normalisation
+/// when the error is too large for the approximation.
+#ifndef __WRMATH_GEOM_RENORMALIZE_H
+#define __WRMATH_GEOM_RENORMALIZE_H
+
+
+#include <cmath>
+#include <cstddef>
+
+#include <wrmath/geom/quaternion.h>
+
+
+namespace wr {
+namespace geom {
+
+
+/// Scale a quaternion towards unit length with the first-order step
+/// q (3 - |q|²) / 2.
+///
+/// \param q A quaternion stored as <w, x, y, z>, scaled in place.
+template <typename T>
+void
+RenormalizeFast(T *q)
+{
+	T	n2 = (q[0] * q[0]) + (q[1] * q[1]) + (q[2] * q[2]) + (q[3] * q[3]);
+	T	k = ((T)3.0 - n2) / 2;
+
+	for (size_t i = 0; i < 4; i++) {
+		q[i] *= k;
+	}
+}
+
+
+/// Scale a quaternion to unit length, using the first-order step if its
+/// squared norm is within fastLimit of one and an exact normalisation
+/// otherwise. A zero quaternion is left alone.
+///
+/// \param q A quaternion stored as <w, x, y, z>, scaled in place.
+/// \param fastLimit The largest error in the squared norm that the
+///                  first-order step is used for.
+/// \return False if q was zero.
+template <typename T>
+bool
+Renormalize(T *q, T fastLimit)
+{
+	using std::abs;
+	using std::sqrt;
+
+	T	n2 = (q[0] * q[0]) + (q[1] * q[1]) + (q[2] * q[2]) + (q[3] * q[3]);
+	T	k;
+
+	if (abs(1 - n2) <= fastLimit) {
+		k = ((T)3.0 - n2) / 2;
+	}
+	else if (n2 > 0) {
+		k = 1 / sqrt(n2);
+	}
+	else {
+		return false;
+	}
+
+	for (size_t i = 0; i < 4; i++) {
+		q[i] *= k;
+	}
+	return true;
+}
+
+
+/// Renormalize an array of quaternions.
+///
+/// \param q count quaternions stored as <w, x, y, z>, scaled in place.
+/// \param count The number of quaternions.
+/// \param fastLimit The largest error in the squared norm that the
+///                  first-order step is used for.
+template <typename T>
+void
+RenormalizeArray(T *q, size_t count, T fastLimit)
+{
+	for (size_t i = 0; i < count; i++) {
+		Renormalize(q + (i * 4), fastLimit);
+	}
+}
+
+
+/// Return a quaternion scaled to unit length, using the first-order
+/// step if its squared norm is within fastLimit of one.
+///
+/// \param q A quaternion.
+/// \param fastLimit The largest error in the squared norm that the
+///                  first-order step is used for.
+/// \return The renormalized quaternion, or q if it's zero.
+template <typename T>
+Quaternion<T>
+Renormalize(const Quaternion<T> &q, T fastLimit)
+{
+	using std::abs;
+	using std::sqrt;
+
+	T	n2 = q.normSquared();
+
+	if (abs(1 - n2) <= fastLimit) {
+		return q * (((T)3.0 - n2) / 2);
+	}
+	if (n2 > 0) {
+		return q * (1 / sqrt(n2));
+	}
+	return q;
+}
+
+
+/// @brief RenormalizeOptions tunes a Renormalizer.
+template <typename T>
+struct RenormalizeOptions {
+	/// The number of steps between renormalizations; zero renormalizes
+	/// only when the tolerance check trips.
+	size_t	interval;
+
+	/// The largest error in the squared norm tolerated between
+	/// scheduled renormalizations; zero skips the per-step check.
+	T	tolerance;
+
+	/// The largest error in the squared norm that the first-order step
+	/// is used for; larger errors are normalised exactly.
+	T	fastLimit;
+
+	/// The defaults renormalize every 16 steps, or sooner if the
+	/// squared norm is off by more than 0.1%.
+	RenormalizeOptions() : interval(16), tolerance(1e-3), fastLimit(1e-2) {};
+};
+
+
+/// @brief Renormalizer decides when a quaternion that is being
+/// integrated step by step should be renormalized.
+///
+/// \tparam T A floating point type.
+template <typename T>
+class Renormalizer {
+public:
+	/// Create a renormalizer.
+	///
+	/// \param opts The policy to follow.
+	explicit Renormalizer(const RenormalizeOptions<T> &opts = RenormalizeOptions<T>()) :
+	    opts(opts), steps(0), fast(0), exact(0) {};
+
+
+	/// Return the policy.
+	const RenormalizeOptions<T>	&options() const { return this->opts; }
+
+	/// Change the policy, restarting the step count.
+	void
+	setOptions(const RenormalizeOptions<T> &o)
+	{
+		this->opts = o;
+		this->steps = 0;
+	}
+
+
+	/// Return the number of first-order renormalizations so far.
+	size_t	fastCount() const { return this->fast; }
+
+	/// Return the number of exact renormalizations so far.
+	size_t	exactCount() const { return this->exact; }
+
+
+	/// Count an integration step and renormalize q if it's due.
+	///
+	/// \param q The quaternion being integrated.
+	/// \return True if q was renormalized.
+	bool
+	step(Quaternion<T> &q)
+	{
+		bool	scheduled = this->tick();
+
+		if (!scheduled && !(this->opts.tolerance > 0)) {
+			return false;
+		}
+
+		T	n2 = q.normSquared();
+
+		if (!this->due(scheduled, n2)) {
+			return false;
+		}
+		q = q * this->scale(n2);
+		return true;
+	}
+
+
+	/// Count an integration step and renormalize q if it's due.
+	///
+	/// \param q A quaternion stored as <w, x, y, z>.
+	/// \return True if q was renormalized.
+	bool
+	step(T *q)
+	{
+		bool	scheduled = this->tick();
+
+		if (!scheduled && !(this->opts.tolerance > 0)) {
+			return false;
+		}
+
+		T	n2 = (q[0] * q[0]) + (q[1] * q[1]) + (q[2] * q[2]) + (q[3] * q[3]);
+
+		if (!this->due(scheduled, n2)) {
+			return false;
+		}
+
+		T	k = this->scale(n2);
+
+		for (size_t i = 0; i < 4; i++) {
+			q[i] *= k;
+		}
+		return true;
+	}
+
+private:
+	RenormalizeOptions<T>	opts;
+	size_t			steps;
+	size_t			fast;
+	size_t			exact;
+
+	// tick counts a step and reports whether a renormalization is
+	// scheduled for it.
+	bool
+	tick()
+	{
+		return this->opts.interval > 0 && ++this->steps >= this->opts.interval;
+	}
+
+	// due reports whether to renormalize a quaternion with squared
+	// norm n2, restarting the schedule if so.
+	bool
+	due(bool scheduled, T n2)
+	{
+		using std::abs;
+
+		if (!scheduled && !(abs(1 - n2) > this->opts.tolerance)) {
+			return false;
+		}
+		this->steps = 0;
+		return n2 > 0;
+	}
+
+	// scale returns the factor that renormalizes a quaternion with
+	// squared norm n2, counting which method was used.
+	T
+	scale(T n2)
+	{
+		using std::abs;
+		using std::sqrt;
+
+		if (abs(1 - n2) <= this->opts.fastLimit) {
+			this->fast++;
+			return ((T)3.0 - n2) / 2;
+		}
+		this->exact++;
+		return 1 / sqrt(n2);
+	}
+};
+
+
+/// Renormalizerd is a shorthand alias for a Renormalizer<double>.
+typedef Renormalizer<double>	Renormalizerd;
+
+/// Renormalizerf is a shorthand alias for a Renormalizer<float>.
+typedef Renormalizer<float>	Renormalizerf;
+
+
+} // namespace geom
+} // namespace wr
+
+
+#endif // __WRMATH_GEOM_RENORMALIZE_H
@@ -0,0 +1,678 @@
+/// \file rotationaveraging.h
+/// \brief Globally consistent orientations from relative rotations.
+///
+/// Rotation averaging takes a graph whose nodes are sensors or cameras
+/// with unknown orientations q_i, and whose edges are noisy
+/// measurements of their relative rotations, q_ij ≈ q_i⁻¹ q_j, so that
+/// q_j ≈ q_i q_ij: rotating by q_i and then q_ij is the same as
+/// rotating by q_j, in the sense of Quaternion::rotate. It estimates
+/// every q_i at once, spreading the inconsistencies around each cycle
+/// across its edges rather than accumulating them along a chain.
+///
+/// RotationGraph solves in two stages, following Martinec and Pajdla's
+/// chordal initialisation and Govindu's Lie-algebraic averaging, as
+/// surveyed by Hartley et al. in "Rotation Averaging" (IJCV 2013):
+///
+/// 1. The chordal L2 problem, minimising Σ w |R_j - R_ij R_i|² over
+///    unconstrained 3x3 matrices, is linear; its solution is projected
+///    onto the nearest rotations with Davenport's q-method.
+/// 2. Each refinement step linearises the rotation error of every edge
+///    in the tangent space, solves the resulting graph Laplacian system
+///    for a correction to every node, and applies it. An optional
+///    Huber loss, applied by iterative reweighting, limits the pull of
+///    outlier edges.
+///
+/// Both linear systems are sparse, with one 3x3 block per edge. They're
+/// solved by Jacobi-preconditioned conjugate gradients, with the matrix
+/// products, edge residuals and node updates split across a
+/// wr::parallel::ThreadPool. One node, the anchor, is held at the
+/// identity to fix the overall rotation.
+#ifndef __WRMATH_GEOM_ROTATIONAVERAGING_H
+#define __WRMATH_GEOM_ROTATIONAVERAGING_H
+
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <wrmath/parallel.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/quaternionarray.h>
+#include <wrmath/geom/rotator.h>
+#include <wrmath/geom/wahba.h>
+
+
+namespace wr {
+namespace geom {
+
+
+/// RotationGrain is the number of nodes or edges the rotation averaging
+/// solver hands to a thread at a time.
+constexpr size_t	RotationGrain = 1024;
+
+
+/// @brief RotationAveragingOptions tunes RotationGraph::solve.
+template <typename T>
+struct RotationAveragingOptions {
+	/// The node held at the identity.
+	size_t	anchor;
+
+	/// The most refinement steps after the chordal initialisation;
+	/// zero returns the chordal solution.
+	size_t	maxIterations;
+
+	/// Refinement stops once no node is corrected by more than this
+	/// angle, in radians.
+	T	tolerance;
+
+	/// The residual angle, in radians, beyond which an edge's weight
+	/// is reduced by a Huber loss; zero uses plain least squares.
+	T	robustScale;
+
+	/// The most conjugate gradient iterations per linear solve.
+	size_t	cgIterations;
+
+	/// The conjugate gradient solve stops when the residual falls by
+	/// this factor.
+	T	cgTolerance;
+
+	/// The defaults anchor node 0, refine up to 20 times to about the
+	/// square root of the type's precision, and use least squares.
+	RotationAveragingOptions() :
+	    anchor(0), maxIterations(20),
+	    tolerance(std::sqrt(std::numeric_limits<T>::epsilon())), robustScale(0),
+	    cgIterations(1000), cgTolerance(std::numeric_limits<T>::epsilon() * 100) {};
+};
+
+
+/// @brief RotationGraph estimates absolute orientations from relative
+/// rotation measurements.
+///
+/// \tparam T A floating point type.
+template <typename T>
+class RotationGraph {
+public:
+	/// Create a graph with no edges.
+	///
+	/// @param nodes The number of nodes.
+	explicit RotationGraph(size_t nodes) : nNodes(nodes), q(nodes * 4, 0), steps(0)
+	{
+		for (size_t n = 0; n < nodes; n++) {
+			this->q[n * 4] = 1;
+		}
+	}
+
+
+	/// Return the number of nodes.
+	size_t	nodes() const { return this->nNodes; }
+
+	/// Return the number of edges.
+	size_t	edges() const { return this->edgeW.size(); }
+
+	/// Return the number of refinement steps the last solve took.
+	size_t	iterations() const { return this->steps; }
+
+
+	/// Add a relative rotation measurement, q_j ≈ q_i q_ij.
+	///
+	/// @param i The first node.
+	/// @param j The second node, different from i.
+	/// @param qij The relative rotation as <w, x, y, z>; it's
+	///            normalised.
+	/// @param weight The measurement's weight, greater than zero.
+	/// @return False if the nodes or weight are invalid, in which case
+	///         the edge isn't added.
+	bool
+	addEdge(size_t i, size_t j, const T *qij, T weight = 1)
+	{
+		using std::sqrt;
+
+		T	n2 = (qij[0] * qij[0]) + (qij[1] * qij[1]) +
+			     (qij[2] * qij[2]) + (qij[3] * qij[3]);
+
+		if (i >= this->nNodes || j >= this->nNodes || i == j ||
+		    !(weight > 0) || !(n2 > 0)) {
+			return false;
+		}
+
+		T	k = 1 / sqrt(n2);
+
+		this->edgeI.push_back(i);
+		this->edgeJ.push_back(j);
+		for (size_t c = 0; c < 4; c++) {
+			this->edgeQ.push_back(qij[c] * k);
+		}
+		this->edgeW.push_back(weight);
+		return true;
+	}
+
+
+	/// Add a relative rotation measurement, q_j ≈ q_i q_ij.
+	///
+	/// @param i The first node.
+	/// @param j The second node, different from i.
+	/// @param qij The relative rotation; it's normalised.
+	/// @param weight The measurement's weight, greater than zero.
+	/// @return False if the nodes or weight are invalid.
+	bool
+	addEdge(size_t i, size_t j, const Quaternion<T> &qij, T weight = 1)
+	{
+		T	raw[4];
+
+		detail::Unpack(qij, raw);
+		return this->addEdge(i, j, raw, weight);
+	}
+
+
+	/// Return a node's estimated orientation.
+	///
+	/// @param i The node.
+	/// @return The unit quaternion, with w >= 0.
+	Quaternion<T>
+	orientation(size_t i) const
+	{
+		assert(i < this->nNodes);
+
+		const T	*p = &this->q[i * 4];
+
+		return Quaternion<T>(Vector<T, 3>{p[1], p[2], p[3]}, p[0]);
+	}
+
+
+	/// Return every node's estimated orientation.
+	///
+	/// @return nodes() unit quaternions as <w, x, y, z>.
+	const T	*orientations() const { return this->q.data(); }
+
+
+	/// Return the angle between an edge's measurement and the relative
+	/// rotation of the solution.
+	///
+	/// @param e The edge, in the order added.
+	/// @return The residual angle in radians.
+	T
+	edgeError(size_t e) const
+	{
+		using std::sqrt;
+
+		T	rho[3];
+
+		this->residual(e, rho);
+		return sqrt((rho[0] * rho[0]) + (rho[1] * rho[1]) + (rho[2] * rho[2]));
+	}
+
+
+	/// Estimate every node's orientation. Nodes with no path of edges
+	/// to the anchor can't be placed, and are left at the identity.
+	///
+	/// @param opts The solver options.
+	/// @param pool The pool to run on, or nullptr for DefaultPool().
+	/// @return False if some node isn't connected to the anchor.
+	bool
+	solve(const RotationAveragingOptions<T> &opts = RotationAveragingOptions<T>(),
+	      parallel::ThreadPool *pool = nullptr)
+	{
+		assert(opts.anchor < this->nNodes);
+
+		this->steps = 0;
+		for (size_t n = 0; n < this->nNodes; n++) {
+			this->q[n * 4] = 1;
+			this->q[(n * 4) + 1] = this->q[(n * 4) + 2] = this->q[(n * 4) + 3] = 0;
+		}
+
+		this->buildAdjacency();
+
+		bool	connected = this->markFixed(opts.anchor);
+
+		this->chordal(opts, pool);
+		for (size_t it = 0; it < opts.maxIterations; it++) {
+			this->steps++;
+			if (!(this->refine(opts, pool) > opts.tolerance)) {
+				break;
+			}
+		}
+		return connected;
+	}
+
+private:
+	size_t			nNodes;
+	std::vector<T>		q;		// Node orientations, <w, x, y, z>.
+	size_t			steps;
+
+	std::vector<size_t>	edgeI;
+	std::vector<size_t>	edgeJ;
+	std::vector<T>		edgeQ;		// Measurements, <w, x, y, z>.
+	std::vector<T>		edgeW;
+
+	// The adjacency lists, in compressed sparse row form: the entries
+	// for node n run from rowStart[n] to rowStart[n + 1]. Each entry
+	// names the neighbour, the edge, and whether n is the edge's j.
+	std::vector<size_t>	rowStart;
+	std::vector<size_t>	adjNode;
+	std::vector<size_t>	adjEdge;
+	std::vector<uint8_t>	adjHead;
+
+	std::vector<uint8_t>	fixed;		// The anchor and unreachable nodes.
+	std::vector<T>		weight;		// The current weight of each edge.
+	std::vector<T>		diag;		// The weighted degree of each node.
+
+	void
+	buildAdjacency()
+	{
+		size_t	m = this->edgeW.size();
+
+		this->rowStart.assign(this->nNodes + 1, 0);
+		for (size_t e = 0; e < m; e++) {
+			this->rowStart[this->edgeI[e] + 1]++;
+			this->rowStart[this->edgeJ[e] + 1]++;
+		}
+		for (size_t n = 0; n < this->nNodes; n++) {
+			this->rowStart[n + 1] += this->rowStart[n];
+		}
+
+		std::vector<size_t>	fill(this->rowStart.begin(), this->rowStart.end() - 1);
+
+		this->adjNode.resize(2 * m);
+		this->adjEdge.resize(2 * m);
+		this->adjHead.resize(2 * m);
+		for (size_t e = 0; e < m; e++) {
+			size_t	a = fill[this->edgeI[e]]++;
+			size_t	b = fill[this->edgeJ[e]]++;
+
+			this->adjNode[a] = this->edgeJ[e];
+			this->adjEdge[a] = e;
+			this->adjHead[a] = 0;
+			this->adjNode[b] = this->edgeI[e];
+			this->adjEdge[b] = e;
+			this->adjHead[b] = 1;
+		}
+	}
+
+	// markFixed fixes the anchor and every node it can't reach, and
+	// reports whether every node is reachable.
+	bool
+	markFixed(size_t anchor)
+	{
+		std::vector<size_t>	queue(1, anchor);
+		std::vector<uint8_t>	seen(this->nNodes, 0);
+
+		seen[anchor] = 1;
+		for (size_t head = 0; head < queue.size(); head++) {
+			size_t	n = queue[head];
+
+			for (size_t a = this->rowStart[n]; a < this->rowStart[n + 1]; a++) {
+				if (!seen[this->adjNode[a]]) {
+					seen[this->adjNode[a]] = 1;
+					queue.push_back(this->adjNode[a]);
+				}
+			}
+		}
+
+		this->fixed.assign(this->nNodes, 0);
+		this->fixed[anchor] = 1;
+		for (size_t n = 0; n < this->nNodes; n++) {
+			if (!seen[n]) {
+				this->fixed[n] = 1;
+			}
+		}
+		return queue.size() == this->nNodes;
+	}
+
+	void
+	setDegrees(parallel::ThreadPool *pool)
+	{
+		this->diag.assign(this->nNodes, 0);
+		parallel::ParallelFor(this->nNodes, RotationGrain, [this](size_t begin, size_t end) {
+			for (size_t n = begin; n < end; n++) {
+				T	d = 0;
+
+				for (size_t a = this->rowStart[n]; a < this->rowStart[n + 1]; a++) {
+					d += this->weight[this->adjEdge[a]];
+				}
+				this->diag[n] = d;
+			}
+		}, pool);
+	}
+
+	T
+	dot(const std::vector<T> &a, const std::vector<T> &b, size_t width,
+	    parallel::ThreadPool *pool) const
+	{
+		return parallel::ParallelReduce(this->nNodes, RotationGrain, (T)0.0,
+		    [&a, &b, width](size_t begin, size_t end, T &sum) {
+			for (size_t i = begin * width; i < end * width; i++) {
+				sum += a[i] * b[i];
+			}
+		    },
+		    [](T &x, const T &y) { x += y; }, pool);
+	}
+
+	// cg solves A x = b by preconditioned conjugate gradients, where
+	// apply computes y = A x over a range of nodes, each with width
+	// scalars, and A's diagonal blocks are diag[n] I. Fixed nodes are
+	// zero in b and stay zero in x.
+	void
+	cg(const std::function<void(const T *, T *, size_t, size_t)> &apply,
+	   const std::vector<T> &b, std::vector<T> &x, size_t width,
+	   const RotationAveragingOptions<T> &opts, parallel::ThreadPool *pool)
+	{
+		size_t		len = this->nNodes * width;
+		std::vector<T>	r(b), z(len), p(len), Ap(len);
+
+		x.assign(len, 0);
+
+		auto	precondition = [&]() {
+			parallel::ParallelFor(this->nNodes, RotationGrain, [&](size_t begin, size_t end) {
+				for (size_t n = begin; n < end; n++) {
+					T	k = this->fixed[n] || !(this->diag[n] > 0) ?
+						    (T)0.0 : 1 / this->diag[n];
+
+					for (size_t c = 0; c < width; c++) {
+						z[(n * width) + c] = r[(n * width) + c] * k;
+					}
+				}
+			}, pool);
+		};
+
+		precondition();
+		p = z;
+
+		T	rz = this->dot(r, z, width, pool);
+		T	stop = this->dot(b, b, width, pool) * opts.cgTolerance * opts.cgTolerance;
+
+		for (size_t it = 0; it < opts.cgIterations; it++) {
+			if (!(this->dot(r, r, width, pool) > stop)) {
+				break;
+			}
+
+			parallel::ParallelFor(this->nNodes, RotationGrain, [&](size_t begin, size_t end) {
+				apply(p.data(), Ap.data(), begin, end);
+			}, pool);
+
+			T	pAp = this->dot(p, Ap, width, pool);
+
+			if (!(pAp > 0)) {
+				break;
+			}
+
+			T	alpha = rz / pAp;
+
+			for (size_t i = 0; i < len; i++) {
+				x[i] += alpha * p[i];
+				r[i] -= alpha * Ap[i];
+			}
+
+			precondition();
+
+			T	rzNext = this->dot(r, z, width, pool);
+			T	beta = rzNext / rz;
+
+			rz = rzNext;
+			for (size_t i = 0; i < len; i++) {
+				p[i] = z[i] + (beta * p[i]);
+			}
+		}
+	}
+
+	// chordal solves the relaxed problem for the matrix of every node,
+	// one column per right-hand side, and projects each onto SO(3).
+	void
+	chordal(const RotationAveragingOptions<T> &opts, parallel::ThreadPool *pool)
+	{
+		size_t		m = this->edgeW.size();
+		std::vector<T>	M(m * 9);
+
+		parallel::ParallelFor(m, RotationGrain, [this, &M](size_t begin, size_t end) {
+			for (size_t e = begin; e < end; e++) {
+				Rotator<T>	r(&this->edgeQ[e * 4]);
+
+				for (size_t k = 0; k < 9; k++) {
+					M[(e * 9) + k] = r.matrix()[k];
+				}
+			}
+		}, pool);
+
+		this->weight = this->edgeW;
+		this->setDegrees(pool);
+
+		// Node state is three columns of three rows, X[n * 9 + c * 3 + r].
+		// Row n of the normal equations is
+		//   diag[n] x_n - Σ_{n = j} w M x_i - Σ_{n = i} w Mᵀ x_j,
+		// and the anchor's known identity moves to the right side.
+		auto	block = [this, &M](size_t a, size_t row, size_t col) -> T {
+			size_t	e = this->adjEdge[a];
+			T	w = this->weight[e];
+
+			return this->adjHead[a] ? w * M[(e * 9) + (row * 3) + col] :
+						  w * M[(e * 9) + (col * 3) + row];
+		};
+
+		std::vector<T>	b(this->nNodes * 9, 0);
+		std::vector<T>	x;
+
+		parallel::ParallelFor(this->nNodes, RotationGrain, [&](size_t begin, size_t end) {
+			for (size_t n = begin; n < end; n++) {
+				if (this->fixed[n]) {
+					continue;
+				}
+				for (size_t a = this->rowStart[n]; a < this->rowStart[n + 1]; a++) {
+					if (this->adjNode[a] != opts.anchor) {
+						continue;
+					}
+					for (size_t c = 0; c < 3; c++) {
+						for (size_t row = 0; row < 3; row++) {
+							b[(n * 9) + (c * 3) + row] += block(a, row, c);
+						}
+					}
+				}
+			}
+		}, pool);
+
+		this->cg([&](const T *in, T *out, size_t begin, size_t end) {
+			for (size_t n = begin; n < end; n++) {
+				T	*y = out + (n * 9);
+
+				if (this->fixed[n]) {
+					for (size_t i = 0; i < 9; i++) {
+						y[i] = 0;
+					}
+					continue;
+				}
+
+				for (size_t i = 0; i < 9; i++) {
+					y[i] = this->diag[n] * in[(n * 9) + i];
+				}
+				for (size_t a = this->rowStart[n]; a < this->rowStart[n + 1]; a++) {
+					const T	*xk = in + (this->adjNode[a] * 9);
+
+					for (size_t c = 0; c < 3; c++) {
+						for (size_t row = 0; row < 3; row++) {
+							T	s = 0;
+
+							for (size_t col = 0; col < 3; col++) {
+								s += block(a, row, col) * xk[(c * 3) + col];
+							}
+							y[(c * 3) + row] -= s;
+						}
+					}
+				}
+			}
+		}, b, x, 9, opts, pool);
+
+		// The nearest rotation to a matrix X maximises tr(Aᵀ X), which
+		// is Wahba's problem with profile matrix X: the columns of X
+		// are the body vectors, weighted by their lengths, observing
+		// the reference axes.
+		parallel::ParallelFor(this->nNodes, RotationGrain, [&](size_t begin, size_t end) {
+			const T	axes[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+			for (size_t n = begin; n < end; n++) {
+				if (this->fixed[n]) {
+					continue;
+				}
+
+				const T	*cols = &x[n * 9];
+				T	 lengths[3];
+
+				for (size_t c = 0; c < 3; c++) {
+					lengths[c] = std::sqrt((cols[c * 3] * cols[c * 3]) +
+							       (cols[(c * 3) + 1] * cols[(c * 3) + 1]) +
+							       (cols[(c * 3) + 2] * cols[(c * 3) + 2]));
+				}
+				DavenportQMethod(cols, axes, lengths, 3, &this->q[n * 4]);
+			}
+		}, pool);
+	}
+
+	// residual computes the rotation vector of q_j q_ij⁻¹ q_i⁻¹, the
+	// error of edge e expressed as a rotation applied after q_j.
+	void
+	residual(size_t e, T *rho) const
+	{
+		using std::atan2;
+		using std::sqrt;
+
+		const T	*qi = &this->q[this->edgeI[e] * 4];
+		const T	*qj = &this->q[this->edgeJ[e] * 4];
+		const T	*m = &this->edgeQ[e * 4];
+		T	 mc[4] = {m[0], -m[1], -m[2], -m[3]};
+		T	 ic[4] = {qi[0], -qi[1], -qi[2], -qi[3]};
+		T	 t[4], r[4];
+
+		detail::MultiplyKernel<0, 0>(qj, mc, t, 1);
+		detail::MultiplyKernel<0, 0>(t, ic, r, 1);
+
+		T	sign = r[0] < 0 ? (T)-1.0 : (T)1.0;
+		T	s = sqrt((r[1] * r[1]) + (r[2] * r[2]) + (r[3] * r[3]));
+		T	k = s > 0 ? 2 * atan2(s, sign * r[0]) / s : (T)2.0;
+
+		for (size_t c = 0; c < 3; c++) {
+			rho[c] = sign * k * r[c + 1];
+		}
+	}
+
+	// refine takes one Gauss-Newton step on the tangent-space problem
+	// Σ w |ρ_e + δ_j - δ_i|², updates q_n to exp(δ_n) q_n, and returns
+	// the largest correction.
+	T
+	refine(const RotationAveragingOptions<T> &opts, parallel::ThreadPool *pool)
+	{
+		size_t		m = this->edgeW.size();
+		std::vector<T>	rho(m * 3);
+
+		this->weight.resize(m);
+		parallel::ParallelFor(m, RotationGrain, [&](size_t begin, size_t end) {
+			for (size_t e = begin; e < end; e++) {
+				T	*r = &rho[e * 3];
+
+				this->residual(e, r);
+
+				T	len = std::sqrt((r[0] * r[0]) + (r[1] * r[1]) + (r[2] * r[2]));
+				T	w = this->edgeW[e];
+
+				if (opts.robustScale > 0 && len > opts.robustScale) {
+					w *= opts.robustScale / len;
+				}
+				this->weight[e] = w;
+			}
+		}, pool);
+		this->setDegrees(pool);
+
+		std::vector<T>	b(this->nNodes * 3, 0);
+		std::vector<T>	delta;
+
+		parallel::ParallelFor(this->nNodes, RotationGrain, [&](size_t begin, size_t end) {
+			for (size_t n = begin; n < end; n++) {
+				if (this->fixed[n]) {
+					continue;
+				}
+				for (size_t a = this->rowStart[n]; a < this->rowStart[n + 1]; a++) {
+					size_t	e = this->adjEdge[a];
+					T	w = this->adjHead[a] ? -this->weight[e] : this->weight[e];
+
+					for (size_t c = 0; c < 3; c++) {
+						b[(n * 3) + c] += w * rho[(e * 3) + c];
+					}
+				}
+			}
+		}, pool);
+
+		this->cg([this](const T *in, T *out, size_t begin, size_t end) {
+			for (size_t n = begin; n < end; n++) {
+				T	*y = out + (n * 3);
+
+				if (this->fixed[n]) {
+					y[0] = y[1] = y[2] = 0;
+					continue;
+				}
+
+				for (size_t c = 0; c < 3; c++) {
+					y[c] = this->diag[n] * in[(n * 3) + c];
+				}
+				for (size_t a = this->rowStart[n]; a < this->rowStart[n + 1]; a++) {
+					const T	*xk = in + (this->adjNode[a] * 3);
+					T	 w = this->weight[this->adjEdge[a]];
+
+					for (size_t c = 0; c < 3; c++) {
+						y[c] -= w * xk[c];
+					}
+				}
+			}
+		}, b, delta, 3, opts, pool);
+
+		return parallel::ParallelReduce(this->nNodes, RotationGrain, (T)0.0,
+		    [&](size_t begin, size_t end, T &largest) {
+			for (size_t n = begin; n < end; n++) {
+				if (this->fixed[n]) {
+					continue;
+				}
+
+				const T	*d = &delta[n * 3];
+				T	 angle = std::sqrt((d[0] * d[0]) + (d[1] * d[1]) + (d[2] * d[2]));
+				T	 k = angle > 0 ? std::sin(angle / 2) / angle : (T)0.5;
+				T	 dq[4] = {std::cos(angle / 2), d[0] * k, d[1] * k, d[2] * k};
+				T	*qn = &this->q[n * 4];
+				T	 r[4];
+
+				detail::MultiplyKernel<0, 0>(dq, qn, r, 1);
+
+				T	norm = std::sqrt((r[0] * r[0]) + (r[1] * r[1]) +
+							 (r[2] * r[2]) + (r[3] * r[3]));
+				T	sign = r[0] < 0 ? (T)-1.0 : (T)1.0;
+
+				for (size_t c = 0; c < 4; c++) {
+					qn[c] = sign * r[c] / norm;
+				}
+				largest = angle > largest ? angle : largest;
+			}
+		    },
+		    [](T &a, const T &b) { a = b > a ? b : a; }, pool);
+	}
+};
+
+
+/// RotationAveragingOptionsd is a shorthand alias for a
+/// RotationAveragingOptions<double>.
+typedef RotationAveragingOptions<double>	RotationAveragingOptionsd;
+
+/// RotationAveragingOptionsf is a shorthand alias for a
+/// RotationAveragingOptions<float>.
+typedef RotationAveragingOptions<float>	RotationAveragingOptionsf;
+
+/// RotationGraphd is a shorthand alias for a RotationGraph<double>.
+typedef RotationGraph<double>	RotationGraphd;
+
+/// RotationGraphf is a shorthand alias for a RotationGraph<float>.
+typedef RotationGraph<float>	RotationGraphf;
+
+
+} // namespace geom
+} // namespace wr
+
+
+#endif // __WRMATH_GEOM_ROTATIONAVERAGING_H
@@ -0,0 +1,428 @@
+/// \file stats.h
+/// \brief Statistics over arrays of vectors.
+///
+/// The reductions work directly on arrays of Vector<T, N>, or on
+/// interleaved arrays of N scalars per vector, without building a Vector
+/// temporary per element. Sums use Neumaier's compensated summation, so
+/// millions of samples can be summed without losing the low-order bits,
+/// and the covariance is accumulated with the pairwise update of Chan,
+/// Golub and LeVeque, which avoids the cancellation of the textbook
+/// sum-of-squares formula.
+///
+/// Large arrays are split into chunks of ReductionGrain vectors that are
+/// reduced in parallel and combined in a fixed tree, so results are the
+/// same whatever the number of threads.
+#ifndef __WRMATH_GEOM_STATS_H
+#define __WRMATH_GEOM_STATS_H
+
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+#include <wrmath/parallel.h>
+#include <wrmath/geom/vector.h>
+
+
+namespace wr {
+namespace geom {
+
+
+/// The number of vectors reduced as one chunk.
+static const size_t	ReductionGrain = 16384;
+
+
+/// @brief BoundingBox is an axis-aligned box given by its lowest and
+/// highest corners.
+///
+/// \tparam T A floating point type.
+/// \tparam N The number of dimensions.
+template <typename T, size_t N>
+struct BoundingBox {
+	Vector<T, N>	min;	///< The componentwise minimum.
+	Vector<T, N>	max;	///< The componentwise maximum.
+
+	/// Return the centre of the box.
+	///
+	/// @return The midpoint of min and max.
+	Vector<T, N>
+	center() const
+	{
+		return (this->min + this->max) / (T)2.0;
+	}
+
+
+	/// Return the size of the box along each axis.
+	///
+	/// @return max - min.
+	Vector<T, N>
+	extent() const
+	{
+		return this->max - this->min;
+	}
+
+
+	/// Determine whether a point lies in the box, including its
+	/// boundary.
+	///
+	/// @param p A point.
+	/// @return True if min <= p <= max componentwise.
+	bool
+	contains(const Vector<T, N> &p) const
+	{
+		for (size_t i = 0; i < N; i++) {
+			if (p[i] < this->min[i] || p[i] > this->max[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+
+/// @brief VectorReduction implements the reductions for a given way of
+/// reading component k of vector i.
+///
+/// The Sum, Centroid, Bounds and Covariance functions below are the
+/// interface; VectorReduction is shared by their overloads.
+///
+/// \tparam T A floating point type.
+/// \tparam N The number of dimensions.
+template <typename T, size_t N>
+class VectorReduction {
+public:
+	/// A compensated sum: the total and the running error term.
+	struct SumPartial {
+		std::array<T, N>	sum;
+		std::array<T, N>	error;
+	};
+
+	/// Componentwise bounds of a chunk.
+	struct BoundsPartial {
+		std::array<T, N>	lo;
+		std::array<T, N>	hi;
+	};
+
+	/// The count, mean and co-moment matrix of a chunk. Only the
+	/// upper triangle of the matrix is accumulated.
+	struct MomentsPartial {
+		size_t			n;
+		std::array<T, N>	mean;
+		std::array<T, N * N>	comoment;
+	};
+
+
+	/// Add x to a compensated sum.
+	static void
+	add(T &sum, T &error, T x)
+	{
+		using std::abs;
+
+		T	t = sum + x;
+
+		// Neumaier: recover the bits of whichever operand was
+		// smaller.
+		if (abs(sum) >= abs(x)) {
+			error += (sum - t) + x;
+		}
+		else {
+			error += (x - t) + sum;
+		}
+		sum = t;
+	}
+
+
+	/// Compute the compensated sum of count vectors.
+	template <typename Get>
+	static SumPartial
+	sum(Get get, size_t count, parallel::ThreadPool *pool)
+	{
+		SumPartial	init;
+
+		init.sum.fill(0);
+		init.error.fill(0);
+		return parallel::ParallelReduce(count, ReductionGrain, init,
+		    [&get](size_t begin, size_t end, SumPartial &p) {
+			for (size_t i = begin; i < end; i++) {
+				for (size_t k = 0; k < N; k++) {
+					add(p.sum[k], p.error[k], get(i, k));
+				}
+			}
+		    },
+		    [](SumPartial &a, const SumPartial &b) {
+			for (size_t k = 0; k < N; k++) {
+				add(a.sum[k], a.error[k], b.sum[k]);
+				a.error[k] += b.error[k];
+			}
+		    }, pool);
+	}
+
+
+	/// Compute the bounds of count vectors; count must not be zero.
+	template <typename Get>
+	static BoundsPartial
+	bounds(Get get, size_t count, parallel::ThreadPool *pool)
+	{
+		BoundsPartial	init;
+
+		for (size_t k = 0; k < N; k++) {
+			init.lo[k] = init.hi[k] = get(0, k);
+		}
+		return parallel::ParallelReduce(count, ReductionGrain, init,
+		    [&get](size_t begin, size_t end, BoundsPartial &p) {
+			for (size_t i = begin; i < end; i++) {
+				for (size_t k = 0; k < N; k++) {
+					T	x = get(i, k);
+
+					p.lo[k] = x < p.lo[k] ? x : p.lo[k];
+					p.hi[k] = x > p.hi[k] ? x : p.hi[k];
+				}
+			}
+		    },
+		    [](BoundsPartial &a, const BoundsPartial &b) {
+			for (size_t k = 0; k < N; k++) {
+				a.lo[k] = b.lo[k] < a.lo[k] ? b.lo[k] : a.lo[k];
+				a.hi[k] = b.hi[k] > a.hi[k] ? b.hi[k] : a.hi[k];
+			}
+		    }, pool);
+	}
+
+
+	/// Compute the mean and co-moment matrix of count vectors.
+	template <typename Get>
+	static MomentsPartial
+	moments(Get get, size_t count, parallel::ThreadPool *pool)
+	{
+		MomentsPartial	init;
+
+		init.n = 0;
+		init.mean.fill(0);
+		init.comoment.fill(0);
+		return parallel::ParallelReduce(count, ReductionGrain, init,
+		    [&get](size_t begin, size_t end, MomentsPartial &p) {
+			T	x[N], d[N];
+
+			// Welford's update, one vector at a time.
+			for (size_t i = begin; i < end; i++) {
+				p.n++;
+				for (size_t k = 0; k < N; k++) {
+					x[k] = get(i, k);
+					d[k] = x[k] - p.mean[k];
+					p.mean[k] += d[k] / (T)p.n;
+				}
+				for (size_t r = 0; r < N; r++) {
+					for (size_t c = r; c < N; c++) {
+						p.comoment[(r * N) + c] += d[r] * (x[c] - p.mean[c]);
+					}
+				}
+			}
+		    },
+		    [](MomentsPartial &a, const MomentsPartial &b) {
+			size_t	n = a.n + b.n;
+			T	d[N];
+
+			if (b.n == 0) {
+				return;
+			}
+
+			// Chan, Golub and LeVeque's pairwise combination.
+			T	scale = ((T)a.n * (T)b.n) / (T)n;
+			for (size_t k = 0; k < N; k++) {
+				d[k] = b.mean[k] - a.mean[k];
+				a.mean[k] += d[k] * ((T)b.n / (T)n);
+			}
+			for (size_t i = 0; i < N * N; i++) {
+				a.comoment[i] += b.comoment[i] +
+				    (d[i / N] * d[i % N] * scale);
+			}
+			a.n = n;
+		    }, pool);
+	}
+
+
+	/// Finish a compensated sum.
+	static Vector<T, N>
+	total(const SumPartial &p)
+	{
+		T	v[N];
+
+		for (size_t k = 0; k < N; k++) {
+			v[k] = p.sum[k] + p.error[k];
+		}
+		return Vector<T, N>(v);
+	}
+
+
+	/// Finish a covariance: fill in the full sample covariance matrix
+	/// from the upper triangle of the co-moments, and return the mean.
+	static Vector<T, N>
+	covariance(const MomentsPartial &p, size_t count, T *out)
+	{
+		T	div = count > 1 ? (T)(count - 1) : (T)1.0;
+
+		for (size_t r = 0; r < N; r++) {
+			for (size_t c = r; c < N; c++) {
+				out[(r * N) + c] = p.comoment[(r * N) + c] / div;
+				out[(c * N) + r] = out[(r * N) + c];
+			}
+		}
+		return Vector<T, N>(p.mean.data());
+	}
+};
+
+
+/// Sum an array of vectors.
+///
+/// @param vectors count vectors.
+/// @param count The number of vectors.
+/// @param pool The pool to run on, or nullptr for the default pool.
+/// @return The sum; a zero vector if count is zero.
+template <typename T, size_t N>
+Vector<T, N>
+Sum(const Vector<T, N> *vectors, size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	return VectorReduction<T, N>::total(VectorReduction<T, N>::sum(
+	    [vectors](size_t i, size_t k) { return vectors[i][k]; }, count, pool));
+}
+
+
+/// Sum an interleaved array of N-dimensional vectors, e.g.
+/// `Sum<3>(xyz, count)`.
+///
+/// @param data count * N scalars.
+/// @param count The number of vectors.
+/// @param pool The pool to run on, or nullptr for the default pool.
+/// @return The sum; a zero vector if count is zero.
+template <size_t N, typename T>
+Vector<T, N>
+Sum(const T *data, size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	return VectorReduction<T, N>::total(VectorReduction<T, N>::sum(
+	    [data](size_t i, size_t k) { return data[(i * N) + k]; }, count, pool));
+}
+
+
+/// Compute the centroid (mean) of an array of vectors.
+///
+/// @param vectors count vectors.
+/// @param count The number of vectors; it must not be zero.
+/// @param pool The pool to run on, or nullptr for the default pool.
+/// @return The centroid.
+template <typename T, size_t N>
+Vector<T, N>
+Centroid(const Vector<T, N> *vectors, size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	assert(count > 0);
+	return Sum(vectors, count, pool) / (T)count;
+}
+
+
+/// Compute the centroid (mean) of an interleaved array of N-dimensional
+/// vectors.
+///
+/// @param data count * N scalars.
+/// @param count The number of vectors; it must not be zero.
+/// @param pool The pool to run on, or nullptr for the default pool.
+/// @return The centroid.
+template <size_t N, typename T>
+Vector<T, N>
+Centroid(const T *data, size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	assert(count > 0);
+	return Sum<N>(data, count, pool) / (T)count;
+}
+
+
+/// Compute the bounding box, the componentwise minimum and maximum, of
+/// an array of vectors.
+///
+/// @param vectors count vectors.
+/// @param count The number of vectors; it must not be zero.
+/// @param pool The pool to run on, or nullptr for the default pool.
+/// @return The bounding box.
+template <typename T, size_t N>
+BoundingBox<T, N>
+Bounds(const Vector<T, N> *vectors, size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	assert(count > 0);
+
+	auto	p = VectorReduction<T, N>::bounds(
+	    [vectors](size_t i, size_t k) { return vectors[i][k]; }, count, pool);
+
+	return BoundingBox<T, N>{Vector<T, N>(p.lo.data()), Vector<T, N>(p.hi.data())};
+}
+
+
+/// Compute the bounding box, the componentwise minimum and maximum, of
+/// an interleaved array of N-dimensional vectors.
+///
+/// @param data count * N scalars.
+/// @param count The number of vectors; it must not be zero.
+/// @param pool The pool to run on, or nullptr for the default pool.
+/// @return The bounding box.
+template <size_t N, typename T>
+BoundingBox<T, N>
+Bounds(const T *data, size_t count, parallel::ThreadPool *pool = nullptr)
+{
+	assert(count > 0);
+
+	auto	p = VectorReduction<T, N>::bounds(
+	    [data](size_t i, size_t k) { return data[(i * N) + k]; }, count, pool);
+
+	return BoundingBox<T, N>{Vector<T, N>(p.lo.data()), Vector<T, N>(p.hi.data())};
+}
+
+
+/// Compute the sample covariance matrix of an array of vectors.
+///
+/// @param vectors count vectors.
+/// @param count The number of vectors; it must not be zero.
+/// @param covariance Storage for the N x N covariance matrix, row-major.
+///                   It is divided by count - 1, and is zero for a
+///                   single vector.
+/// @param pool The pool to run on, or nullptr for the default pool.
+/// @return The mean of the vectors.
+template <typename T, size_t N>
+Vector<T, N>
+Covariance(const Vector<T, N> *vectors, size_t count, T *covariance,
+	   parallel::ThreadPool *pool = nullptr)
+{
+	assert(count > 0);
+
+	auto	p = VectorReduction<T, N>::moments(
+	    [vectors](size_t i, size_t k) { return vectors[i][k]; }, count, pool);
+
+	return VectorReduction<T, N>::covariance(p, count, covariance);
+}
+
+
+/// Compute the sample covariance matrix of an interleaved array of
+/// N-dimensional vectors.
+///
+/// @param data count * N scalars.
+/// @param count The number of vectors; it must not be zero.
+/// @param covariance Storage for the N x N covariance matrix, row-major.
+///                   It is divided by count - 1, and is zero for a
+///                   single vector.
+/// @param pool The pool to run on, or nullptr for the default pool.
+/// @return The mean of the vectors.
+template <size_t N, typename T>
+Vector<T, N>
+Covariance(const T *data, size_t count, T *covariance,
+	   parallel::ThreadPool *pool = nullptr)
+{
+	assert(count > 0);
+
+	auto	p = VectorReduction<T, N>::moments(
+	    [data](size_t i, size_t k) { return data[(i * N) + k]; }, count, pool);
+
+	return VectorReduction<T, N>::covariance(p, count, covariance);
+}
+
+
+} // namespace geom
+} // namespace wr
+
+
+#endif // __WRMATH_GEOM_STATS_H
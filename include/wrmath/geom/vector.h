@@ -3,6 +3,7 @@
 #define __WRMATH_GEOM_VECTOR_H
 
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
@@ -10,6 +11,7 @@
 #include <ostream>
 #include <iostream>
 
+#include <wrmath/instrument.h>
 #include <wrmath/math.h>
 
 
@@ -39,7 +41,9 @@ public:
     	/// and size.
 	Vector()
 	{
-		T	unitLength = (T)1.0 / std::sqrt(N);
+		WRMATH_COUNT("Vector::Vector()");
+		WRMATH_COUNT("sqrt");
+		T	unitLength = (T)1.0 / (T)std::sqrt(N);
 		for (size_t i = 0; i < N; i++) {
 			this->arr[i] = unitLength;
 		}
@@ -53,6 +57,7 @@ public:
 	/// @param ilst An intializer list with N elements of type T.
 	Vector(std::initializer_list<T>	ilst)
 	{
+		WRMATH_COUNT("Vector::Vector(initializer_list)");
 		assert(ilst.size() == N);
 
 		wr::math::DefaultEpsilon(this->epsilon);
@@ -60,15 +65,40 @@ public:
 	}	
 
 
+	/// A vector may be created from N contiguous values, such as a
+	/// row of an array of vectors.
+	/// @param values A pointer to at least N elements of type T.
+	explicit Vector(const T *values)
+	{
+		WRMATH_COUNT("Vector::Vector(const T *)");
+		wr::math::DefaultEpsilon(this->epsilon);
+		std::copy(values, values + N, this->arr.begin());
+	}
+
+
+#ifdef WRMATH_INSTRUMENT
+	/// In instrumented builds, copies are counted as temporaries.
+	Vector(const Vector &other) : epsilon(other.epsilon), arr(other.arr)
+	{
+		WRMATH_COUNT("Vector::Vector(const Vector &)");
+	}
+
+	Vector &operator=(const Vector &other) = default;
+#endif
+
+
 	/// Compute the length of the vector.
 	/// @return The length of the vector.
 	T magnitude() const {
+		WRMATH_COUNT("Vector::magnitude");
+		using std::sqrt;
 		T	result = 0;
 
 		for (size_t i = 0; i < N; i++) {
 			result += (this->arr[i] * this->arr[i]);
 		}
-		return std::sqrt(result);
+		WRMATH_COUNT("sqrt");
+		return sqrt(result);
 	}
 
 
@@ -88,6 +118,7 @@ public:
 	bool
 	isZero() const
 	{
+		WRMATH_COUNT("Vector::isZero");
 		for (size_t i = 0; i < N; i++) {
 			if (!wr::math::WithinTolerance(this->arr[i], (T)0.0, this->epsilon)) {
 				return false;
@@ -102,6 +133,7 @@ public:
 	Vector
 	unitVector() const
 	{
+		WRMATH_COUNT("Vector::unitVector");
 		return *this / this->magnitude();
 	}
 
@@ -111,6 +143,7 @@ public:
 	bool
 	isUnitVector() const
 	{
+		WRMATH_COUNT("Vector::isUnitVector");
 		return wr::math::WithinTolerance(this->magnitude(), (T)1.0, this->epsilon);
 	}
 
@@ -121,13 +154,21 @@ public:
 	T
 	angle(const Vector<T, N> &other) const
 	{
+		WRMATH_COUNT("Vector::angle");
 		Vector<T, N>	unitA = this->unitVector();
 		Vector<T, N>	unitB = other.unitVector();
 
 		// Can't compute angles with a zero vector.
 		assert(!this->isZero());
 		assert(!other.isZero());
-		return std::acos(unitA * unitB);
+
+		// Rounding can push the dot product of parallel unit vectors
+		// just past ±1, where acos is NaN.
+		T		d = unitA * unitB;
+		d = d > (T)1.0 ? (T)1.0 : d < (T)-1.0 ? (T)-1.0 : d;
+
+		WRMATH_COUNT("acos");
+		return std::acos(d);
 	}
 
 
@@ -137,16 +178,31 @@ public:
 	bool
 	isParallel(const Vector<T, N> &other) const
 	{
+		WRMATH_COUNT("Vector::isParallel");
 		if (this->isZero() || other.isZero()) {
 			return true;
 		}
 
-		T angle = this->angle(other);
-		if (wr::math::WithinTolerance(angle, (T)0.0, this->epsilon)) {
-			return true;
+		// The angle is tested through its sine, as |a ∧ b|² <
+		// sin²(ε) |a|² |b|² with a · b > 0. Its cosine rounds to one
+		// in single precision for small angles, so acos can't resolve
+		// them.
+		T	a2 = 0, b2 = 0, ab = 0, wedge2 = 0;
+
+		for (size_t k = 0; k < N; k++) {
+			a2 += this->arr[k] * this->arr[k];
+			b2 += other.arr[k] * other.arr[k];
+			ab += this->arr[k] * other.arr[k];
+			for (size_t j = 0; j < k; j++) {
+				T	m = (this->arr[j] * other.arr[k]) - (this->arr[k] * other.arr[j]);
+
+				wedge2 += m * m;
+			}
 		}
 
-		return false;
+		T	sinEps = std::sin(this->epsilon);
+
+		return ab > 0 && wedge2 < sinEps * sinEps * a2 * b2;
 	}
 
 
@@ -157,6 +213,7 @@ public:
 	bool
 	isOrthogonal(const Vector<T, N> &other) const
 	{
+		WRMATH_COUNT("Vector::isOrthogonal");
 		if (this->isZero() || other.isZero()) {
 			return true;
 		}
@@ -172,6 +229,7 @@ public:
 	Vector
 	projectParallel(const Vector<T, N> &basis) const
 	{
+		WRMATH_COUNT("Vector::projectParallel");
 		Vector<T, N>	unit_basis = basis.unitVector();
 
 		return unit_basis * (*this * unit_basis);
@@ -184,8 +242,9 @@ public:
 	/// @return A vector that is the orthogonal projection of this onto
 	///         the basis vector.
 	Vector
-	projectOrthogonal(const Vector<T, N> &basis)
+	projectOrthogonal(const Vector<T, N> &basis) const
 	{
+		WRMATH_COUNT("Vector::projectOrthogonal");
 		Vector<T, N>	spar = this->projectParallel(basis);
 		return *this - spar;
 	}
@@ -198,6 +257,7 @@ public:
 	Vector
 	cross(const Vector<T, N> &other) const
 	{
+		WRMATH_COUNT("Vector::cross");
 		assert(N == 3);
 		return Vector<T, N> {
 			(this->arr[1] * other.arr[2]) - (other.arr[1] * this->arr[2]),
@@ -214,6 +274,7 @@ public:
 	Vector
 	operator+(const Vector<T, N> &other) const
 	{
+		WRMATH_COUNT("Vector::operator+");
 		Vector<T, N>	vec;
 
 		for (size_t i = 0; i < N; i++) {
@@ -231,6 +292,7 @@ public:
 	Vector
 	operator-(const Vector<T, N> &other) const
 	{
+		WRMATH_COUNT("Vector::operator-");
 		Vector<T, N>	vec;
 
 		for (size_t i = 0; i < N; i++) {
@@ -247,6 +309,7 @@ public:
 	Vector
 	operator*(const T k) const
 	{
+		WRMATH_COUNT("Vector::operator*(T)");
 		Vector<T, N>	vec;
 
 		for (size_t i = 0; i < N; i++) {
@@ -263,6 +326,7 @@ public:
 	Vector
 	operator/(const T k) const
 	{
+		WRMATH_COUNT("Vector::operator/(T)");
 		Vector<T, N>	vec;
 
 		for (size_t i = 0; i < N; i++) {
@@ -279,6 +343,7 @@ public:
 	T
 	operator*(const Vector<T, N> &other) const
 	{
+		WRMATH_COUNT("Vector::operator*(Vector)");
 		T	result = 0;
 
 		for (size_t i = 0; i < N; i++) {
@@ -296,6 +361,7 @@ public:
 	bool
 	operator==(const Vector<T, N> &other) const
 	{
+		WRMATH_COUNT("Vector::operator==");
 		for (size_t i = 0; i<N; i++) {
 			if (!wr::math::WithinTolerance(this->arr[i], other.arr[i], this->epsilon)) {
 				return false;
@@ -0,0 +1,594 @@
+/// \file wahba.h
+/// \brief Attitude determination from pairs of vector observations.
+///
+/// Wahba's problem is to find the rotation A that minimises
+///
+///     L(A) = ½ Σ aᵢ |bᵢ - A rᵢ|²
+///
+/// for unit vectors rᵢ in a reference frame (star catalogue directions,
+/// the local magnetic field and gravity, antenna baselines in the
+/// vehicle frame), their measurements bᵢ in the body frame, and
+/// non-negative weights aᵢ. The solvers here return the answer as a
+/// quaternion q in the sense of Quaternion::rotate, so that q* rᵢ q is
+/// as close as possible to bᵢ.
+///
+/// + DavenportQMethod finds the optimal quaternion as the dominant
+///   eigenvector of Davenport's 4x4 K matrix, using the fixed-size
+///   Jacobi solver in wrmath/math/linalg.h.
+/// + QUEST finds the same quaternion from the largest root of K's
+///   characteristic polynomial by Newton-Raphson, then solves for the
+///   eigenvector in closed form. It uses Shuster's method of sequential
+///   rotations to stay accurate for rotations near 180°, and is the
+///   fastest of the three.
+/// + TRIAD builds an orthonormal triad from the first two observations
+///   in each frame; the first observation is matched exactly, and any
+///   others are ignored.
+///
+/// The observation vectors needn't be normalised; each solver normalises
+/// them, and skips zero vectors. Arrays are interleaved <x, y, z>
+/// scalars, and quaternions are stored as <w, x, y, z>. Every solver
+/// returns the quaternion with w >= 0.
+#ifndef __WRMATH_GEOM_WAHBA_H
+#define __WRMATH_GEOM_WAHBA_H
+
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <wrmath/parallel.h>
+#include <wrmath/math/linalg.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+
+
+namespace wr {
+namespace geom {
+
+
+/// WahbaMethod selects a solver for SolveWahba.
+enum class WahbaMethod {
+	Davenport,	///< DavenportQMethod.
+	QUEST,		///< QUEST.
+	TRIAD,		///< TRIAD.
+};
+
+
+/// WahbaGrain is the number of problems a batch solve hands to a thread
+/// at a time.
+constexpr size_t	WahbaGrain = 1024;
+
+
+/// Convert a rotation matrix to the quaternion with the same rotation,
+/// in the sense of Quaternion::rotate: the matrix maps p to q* p q. The
+/// conversion is Shepperd's method, which divides by the largest
+/// quaternion component so that it's accurate for every rotation.
+///
+/// @param m A row-major 3x3 rotation matrix.
+/// @param q Storage for the quaternion as <w, x, y, z>, with w >= 0.
+template <typename T>
+void
+QuaternionFromMatrix(const T *m, T *q)
+{
+	using std::sqrt;
+
+	T	trace = m[0] + m[4] + m[8];
+	T	w2 = (T)1.0 + trace;
+	T	x2 = (T)1.0 + (2 * m[0]) - trace;
+	T	y2 = (T)1.0 + (2 * m[4]) - trace;
+	T	z2 = (T)1.0 + (2 * m[8]) - trace;
+
+	if (w2 >= x2 && w2 >= y2 && w2 >= z2) {
+		T	s = sqrt(w2) * 2;
+
+		q[0] = s / 4;
+		q[1] = (m[5] - m[7]) / s;
+		q[2] = (m[6] - m[2]) / s;
+		q[3] = (m[1] - m[3]) / s;
+	}
+	else if (x2 >= y2 && x2 >= z2) {
+		T	s = sqrt(x2) * 2;
+
+		q[0] = (m[5] - m[7]) / s;
+		q[1] = s / 4;
+		q[2] = (m[1] + m[3]) / s;
+		q[3] = (m[2] + m[6]) / s;
+	}
+	else if (y2 >= z2) {
+		T	s = sqrt(y2) * 2;
+
+		q[0] = (m[6] - m[2]) / s;
+		q[1] = (m[1] + m[3]) / s;
+		q[2] = s / 4;
+		q[3] = (m[5] + m[7]) / s;
+	}
+	else {
+		T	s = sqrt(z2) * 2;
+
+		q[0] = (m[1] - m[3]) / s;
+		q[1] = (m[2] + m[6]) / s;
+		q[2] = (m[5] + m[7]) / s;
+		q[3] = s / 4;
+	}
+
+	if (q[0] < 0) {
+		for (size_t k = 0; k < 4; k++) {
+			q[k] = -q[k];
+		}
+	}
+}
+
+
+/// @brief WahbaProfile accumulates Davenport's attitude profile matrix
+/// B = Σ aᵢ bᵢ rᵢᵀ and the total weight of a set of observations.
+///
+/// It also records whether the reference vectors determine an attitude,
+/// which needs at least two of them with non-zero weight that aren't
+/// parallel.
+template <typename T>
+struct WahbaProfile {
+	T	B[9];		///< The profile matrix, row-major.
+	T	weight;		///< The sum of the weights used.
+	bool	observable;	///< Whether the attitude is determined.
+
+	/// Accumulate n observations.
+	///
+	/// @param body n body-frame vectors.
+	/// @param ref n reference-frame vectors.
+	/// @param weights n weights, or nullptr to weight each equally.
+	/// @param n The number of observations.
+	WahbaProfile(const T *body, const T *ref, const T *weights, size_t n) :
+	    B{0, 0, 0, 0, 0, 0, 0, 0, 0}, weight(0), observable(false)
+	{
+		using std::sqrt;
+
+		T	eps = std::numeric_limits<T>::epsilon() * 64;
+		T	first[3] = {0, 0, 0};
+		bool	haveFirst = false;
+
+		for (size_t i = 0; i < n; i++) {
+			const T	*b = body + (i * 3);
+			const T	*r = ref + (i * 3);
+			T	a = weights == nullptr ? (T)1.0 : weights[i];
+			T	b2 = (b[0] * b[0]) + (b[1] * b[1]) + (b[2] * b[2]);
+			T	r2 = (r[0] * r[0]) + (r[1] * r[1]) + (r[2] * r[2]);
+
+			if (!(a > 0 && b2 > 0 && r2 > 0)) {
+				continue;
+			}
+
+			T	rinv = (T)1.0 / sqrt(r2);
+			T	scale = a / sqrt(b2) * rinv;
+
+			for (size_t j = 0; j < 3; j++) {
+				for (size_t k = 0; k < 3; k++) {
+					this->B[(j * 3) + k] += scale * b[j] * r[k];
+				}
+			}
+			this->weight += a;
+
+			T	u[3] = {r[0] * rinv, r[1] * rinv, r[2] * rinv};
+
+			if (!haveFirst) {
+				first[0] = u[0];
+				first[1] = u[1];
+				first[2] = u[2];
+				haveFirst = true;
+				continue;
+			}
+
+			T	c[3] = {
+				(first[1] * u[2]) - (first[2] * u[1]),
+				(first[2] * u[0]) - (first[0] * u[2]),
+				(first[0] * u[1]) - (first[1] * u[0]),
+			};
+
+			if ((c[0] * c[0]) + (c[1] * c[1]) + (c[2] * c[2]) > eps * eps) {
+				this->observable = true;
+			}
+		}
+	}
+
+	/// Return the trace of B, σ.
+	T	trace() const { return this->B[0] + this->B[4] + this->B[8]; }
+
+	/// Compute z = Σ aᵢ bᵢ × rᵢ from the skew-symmetric part of B.
+	///
+	/// @param z Storage for three scalars.
+	void
+	cross(T *z) const
+	{
+		z[0] = this->B[5] - this->B[7];
+		z[1] = this->B[6] - this->B[2];
+		z[2] = this->B[1] - this->B[3];
+	}
+};
+
+
+/// Solve for a quaternion whose rotation matches the observations with
+/// Davenport's q-method. The quaternion is the eigenvector of K with the
+/// largest eigenvalue, found with math::SymmetricEigen.
+///
+/// @param body n body-frame vectors.
+/// @param ref n reference-frame vectors.
+/// @param weights n weights, or nullptr to weight each equally.
+/// @param n The number of observations.
+/// @param q Storage for the quaternion as <w, x, y, z>.
+/// @return False if the observations don't determine an attitude, in
+///         which case q is the identity.
+template <typename T>
+bool
+DavenportQMethod(const T *body, const T *ref, const T *weights, size_t n, T *q)
+{
+	using std::sqrt;
+
+	WahbaProfile<T>	p(body, ref, weights, n);
+
+	q[0] = 1;
+	q[1] = q[2] = q[3] = 0;
+	if (!p.observable) {
+		return false;
+	}
+
+	// K is stored with the scalar part first, to match <w, x, y, z>:
+	// K = [σ zᵀ; z S - σI], with S = B + Bᵀ.
+	T	sigma = p.trace();
+	T	z[3];
+	T	K[16];
+	T	values[4];
+	T	V[16];
+
+	p.cross(z);
+	K[0] = sigma;
+	for (size_t j = 0; j < 3; j++) {
+		K[j + 1] = K[(j + 1) * 4] = z[j];
+		for (size_t k = 0; k < 3; k++) {
+			K[((j + 1) * 4) + k + 1] = p.B[(j * 3) + k] + p.B[(k * 3) + j];
+		}
+		K[((j + 1) * 4) + j + 1] -= sigma;
+	}
+
+	math::SymmetricEigen<4>(K, values, V);
+
+	T	sign = V[0] < 0 ? (T)-1.0 : (T)1.0;
+	T	norm = sqrt((V[0] * V[0]) + (V[4] * V[4]) + (V[8] * V[8]) + (V[12] * V[12]));
+
+	for (size_t k = 0; k < 4; k++) {
+		q[k] = sign * V[k * 4] / norm;
+	}
+	return true;
+}
+
+
+/// Solve for a quaternion whose rotation matches the observations with
+/// Shuster's QUEST algorithm.
+///
+/// @param body n body-frame vectors.
+/// @param ref n reference-frame vectors.
+/// @param weights n weights, or nullptr to weight each equally.
+/// @param n The number of observations.
+/// @param q Storage for the quaternion as <w, x, y, z>.
+/// @return False if the observations don't determine an attitude, in
+///         which case q is the identity.
+template <typename T>
+bool
+QUEST(const T *body, const T *ref, const T *weights, size_t n, T *q)
+{
+	using std::abs;
+	using std::sqrt;
+
+	WahbaProfile<T>	p(body, ref, weights, n);
+
+	q[0] = 1;
+	q[1] = q[2] = q[3] = 0;
+	if (!p.observable) {
+		return false;
+	}
+
+	// The closed-form eigenvector loses precision as the rotation
+	// approaches 180°, where its scalar part vanishes. Estimate the
+	// largest quaternion component from the diagonal of B, which is
+	// nearly λ times the attitude matrix, and if it isn't w, solve
+	// for the attitude relative to a 180° rotation about that axis
+	// instead. Applying the rotation to the reference vectors negates
+	// the other two columns of B.
+	T	sigma = p.trace();
+	T	largest = sigma;
+	size_t	axis = 0;
+
+	for (size_t k = 0; k < 3; k++) {
+		T	c = (2 * p.B[k * 4]) - sigma;
+
+		if (c > largest) {
+			largest = c;
+			axis = k + 1;
+		}
+	}
+
+	T	B[9];
+
+	for (size_t j = 0; j < 3; j++) {
+		for (size_t k = 0; k < 3; k++) {
+			T	flip = (axis != 0 && axis != k + 1) ? (T)-1.0 : (T)1.0;
+
+			B[(j * 3) + k] = flip * p.B[(j * 3) + k];
+		}
+	}
+
+	T	z[3] = {B[5] - B[7], B[6] - B[2], B[1] - B[3]};
+	T	S[9];
+
+	sigma = B[0] + B[4] + B[8];
+	for (size_t j = 0; j < 3; j++) {
+		for (size_t k = 0; k < 3; k++) {
+			S[(j * 3) + k] = B[(j * 3) + k] + B[(k * 3) + j];
+		}
+	}
+
+	T	Sz[3], S2z[3];
+
+	for (size_t j = 0; j < 3; j++) {
+		Sz[j] = (S[j * 3] * z[0]) + (S[(j * 3) + 1] * z[1]) + (S[(j * 3) + 2] * z[2]);
+	}
+	for (size_t j = 0; j < 3; j++) {
+		S2z[j] = (S[j * 3] * Sz[0]) + (S[(j * 3) + 1] * Sz[1]) + (S[(j * 3) + 2] * Sz[2]);
+	}
+
+	T	kappa = (S[0] * S[4]) - (S[1] * S[3]) +
+			(S[0] * S[8]) - (S[2] * S[6]) +
+			(S[4] * S[8]) - (S[5] * S[7]);
+	T	delta = (S[0] * ((S[4] * S[8]) - (S[5] * S[7]))) -
+			(S[1] * ((S[3] * S[8]) - (S[5] * S[6]))) +
+			(S[2] * ((S[3] * S[7]) - (S[4] * S[6])));
+	T	zz = (z[0] * z[0]) + (z[1] * z[1]) + (z[2] * z[2]);
+	T	a = (sigma * sigma) - kappa;
+	T	b = (sigma * sigma) + zz;
+	T	c = delta + (z[0] * Sz[0]) + (z[1] * Sz[1]) + (z[2] * Sz[2]);
+	T	d = (z[0] * S2z[0]) + (z[1] * S2z[1]) + (z[2] * S2z[2]);
+	T	e = (a * b) + (c * sigma) - d;
+
+	// The largest root of the characteristic equation is close to the
+	// total weight, and exactly that for consistent observations.
+	T	lambda = p.weight;
+	T	tol = std::numeric_limits<T>::epsilon() * 4 * p.weight;
+
+	for (size_t i = 0; i < 32; i++) {
+		T	l2 = lambda * lambda;
+		T	f = (l2 * l2) - ((a + b) * l2) - (c * lambda) + e;
+		T	df = (4 * l2 * lambda) - (2 * (a + b) * lambda) - c;
+
+		if (df == 0) {
+			break;
+		}
+
+		T	step = f / df;
+
+		lambda -= step;
+		if (abs(step) <= tol) {
+			break;
+		}
+	}
+
+	T	alpha = (lambda * lambda) - (sigma * sigma) + kappa;
+	T	beta = lambda - sigma;
+	T	gamma = ((lambda + sigma) * alpha) - delta;
+	T	x[3];
+
+	for (size_t j = 0; j < 3; j++) {
+		x[j] = (alpha * z[j]) + (beta * Sz[j]) + S2z[j];
+	}
+
+	T	norm = sqrt((gamma * gamma) + (x[0] * x[0]) + (x[1] * x[1]) + (x[2] * x[2]));
+
+	if (!(norm > 0)) {
+		return DavenportQMethod(body, ref, weights, n, q);
+	}
+
+	T	r[4] = {gamma / norm, x[0] / norm, x[1] / norm, x[2] / norm};
+
+	// Undo the sequential rotation: with e the 180° rotation about
+	// the chosen axis, the attitude is e ⊗ r.
+	switch (axis) {
+	case 1:
+		q[0] = -r[1]; q[1] = r[0]; q[2] = -r[3]; q[3] = r[2];
+		break;
+	case 2:
+		q[0] = -r[2]; q[1] = r[3]; q[2] = r[0]; q[3] = -r[1];
+		break;
+	case 3:
+		q[0] = -r[3]; q[1] = -r[2]; q[2] = r[1]; q[3] = r[0];
+		break;
+	default:
+		q[0] = r[0]; q[1] = r[1]; q[2] = r[2]; q[3] = r[3];
+		break;
+	}
+
+	if (q[0] < 0) {
+		for (size_t k = 0; k < 4; k++) {
+			q[k] = -q[k];
+		}
+	}
+	return true;
+}
+
+
+/// Solve for a quaternion from the first two observations with the
+/// TRIAD algorithm. The first body vector is matched exactly, and the
+/// second fixes the rotation about it.
+///
+/// @param body At least two body-frame vectors.
+/// @param ref At least two reference-frame vectors.
+/// @param q Storage for the quaternion as <w, x, y, z>.
+/// @return False if either pair of vectors is zero or parallel, in which
+///         case q is the identity.
+template <typename T>
+bool
+TRIAD(const T *body, const T *ref, T *q)
+{
+	using std::sqrt;
+
+	T	eps = std::numeric_limits<T>::epsilon() * 64;
+	T	tb[9], tr[9];
+	const T	*in[2] = {body, ref};
+	T	*out[2] = {tb, tr};
+
+	q[0] = 1;
+	q[1] = q[2] = q[3] = 0;
+
+	// Build the triad t1 = v1, t2 = v1 × v2, t3 = t1 × t2 in each frame.
+	for (size_t f = 0; f < 2; f++) {
+		const T	*v1 = in[f];
+		const T	*v2 = in[f] + 3;
+		T	*t = out[f];
+		T	n1 = (v1[0] * v1[0]) + (v1[1] * v1[1]) + (v1[2] * v1[2]);
+		T	n2 = (v2[0] * v2[0]) + (v2[1] * v2[1]) + (v2[2] * v2[2]);
+
+		if (!(n1 > 0 && n2 > 0)) {
+			return false;
+		}
+
+		T	inv1 = (T)1.0 / sqrt(n1);
+
+		t[0] = v1[0] * inv1;
+		t[1] = v1[1] * inv1;
+		t[2] = v1[2] * inv1;
+		t[3] = (v1[1] * v2[2]) - (v1[2] * v2[1]);
+		t[4] = (v1[2] * v2[0]) - (v1[0] * v2[2]);
+		t[5] = (v1[0] * v2[1]) - (v1[1] * v2[0]);
+
+		T	c2 = (t[3] * t[3]) + (t[4] * t[4]) + (t[5] * t[5]);
+
+		if (!(c2 > eps * eps * n1 * n2)) {
+			return false;
+		}
+
+		T	inv2 = (T)1.0 / sqrt(c2);
+
+		t[3] *= inv2;
+		t[4] *= inv2;
+		t[5] *= inv2;
+		t[6] = (t[1] * t[5]) - (t[2] * t[4]);
+		t[7] = (t[2] * t[3]) - (t[0] * t[5]);
+		t[8] = (t[0] * t[4]) - (t[1] * t[3]);
+	}
+
+	// A = Σ tbᵢ trᵢᵀ maps each reference axis to its body axis.
+	T	m[9];
+
+	for (size_t j = 0; j < 3; j++) {
+		for (size_t k = 0; k < 3; k++) {
+			m[(j * 3) + k] = (tb[j] * tr[k]) + (tb[3 + j] * tr[3 + k]) +
+					 (tb[6 + j] * tr[6 + k]);
+		}
+	}
+	QuaternionFromMatrix(m, q);
+	return true;
+}
+
+
+/// Solve Wahba's problem for one set of observations.
+///
+/// @param method The solver to use.
+/// @param body n body-frame vectors.
+/// @param ref n reference-frame vectors.
+/// @param weights n weights, or nullptr to weight each equally; TRIAD
+///                ignores them.
+/// @param n The number of observations.
+/// @param q Storage for the quaternion as <w, x, y, z>.
+/// @return False if the observations don't determine an attitude.
+template <typename T>
+bool
+SolveWahba(WahbaMethod method, const T *body, const T *ref, const T *weights,
+	   size_t n, T *q)
+{
+	switch (method) {
+	case WahbaMethod::Davenport:
+		return DavenportQMethod(body, ref, weights, n, q);
+	case WahbaMethod::QUEST:
+		return QUEST(body, ref, weights, n, q);
+	case WahbaMethod::TRIAD:
+		if (n < 2) {
+			q[0] = 1;
+			q[1] = q[2] = q[3] = 0;
+			return false;
+		}
+		return TRIAD(body, ref, q);
+	}
+	return false;
+}
+
+
+/// Solve Wahba's problem for one set of observations given as Vectors.
+///
+/// @param method The solver to use.
+/// @param body n body-frame vectors.
+/// @param ref n reference-frame vectors.
+/// @param weights n weights, or nullptr to weight each equally.
+/// @param n The number of observations.
+/// @param q Set to the attitude.
+/// @return False if the observations don't determine an attitude, in
+///         which case q is the identity.
+template <typename T>
+bool
+SolveWahba(WahbaMethod method, const Vector<T, 3> *body, const Vector<T, 3> *ref,
+	   const T *weights, size_t n, Quaternion<T> &q)
+{
+	std::vector<T>	b(n * 3), r(n * 3);
+	T		out[4];
+
+	for (size_t i = 0; i < n; i++) {
+		for (size_t k = 0; k < 3; k++) {
+			b[(i * 3) + k] = body[i][k];
+			r[(i * 3) + k] = ref[i][k];
+		}
+	}
+
+	bool	ok = SolveWahba(method, b.data(), r.data(), weights, n, out);
+
+	q = Quaternion<T>(Vector<T, 3>{out[1], out[2], out[3]}, out[0]);
+	return ok;
+}
+
+
+/// Solve many independent Wahba problems, such as one per vehicle per
+/// epoch, in parallel. Each problem has the same number of
+/// observations, stored one problem after another.
+///
+/// @param method The solver to use.
+/// @param body count * perProblem body-frame vectors.
+/// @param ref count * perProblem reference-frame vectors.
+/// @param weights count * perProblem weights, or nullptr to weight each
+///                equally.
+/// @param perProblem The number of observations in each problem.
+/// @param count The number of problems.
+/// @param q Storage for count quaternions as <w, x, y, z>.
+/// @param pool The pool to run on, or nullptr for DefaultPool().
+/// @return The number of problems with a determined attitude.
+template <typename T>
+size_t
+SolveWahba(WahbaMethod method, const T *body, const T *ref, const T *weights,
+	   size_t perProblem, size_t count, T *q, parallel::ThreadPool *pool = nullptr)
+{
+	size_t	stride = perProblem * 3;
+
+	return parallel::ParallelReduce(count, WahbaGrain, static_cast<size_t>(0),
+	    [=](size_t begin, size_t end, size_t &solved) {
+		for (size_t i = begin; i < end; i++) {
+			const T	*w = weights == nullptr ? nullptr : weights + (i * perProblem);
+
+			if (SolveWahba(method, body + (i * stride), ref + (i * stride),
+				       w, perProblem, q + (i * 4))) {
+				solved++;
+			}
+		}
+	    },
+	    [](size_t &a, const size_t &b) { a += b; }, pool);
+}
+
+
+} // namespace geom
+} // namespace wr
+
+
+#endif // __WRMATH_GEOM_WAHBA_H
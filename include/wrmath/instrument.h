@@ -0,0 +1,123 @@
+/// \file instrument.h
+/// \brief Optional operation counters for wrmath hot paths.
+///
+/// When WRMATH_INSTRUMENT is defined (e.g. by configuring with
+/// -DWRMATH_INSTRUMENT=ON), Vector, Quaternion and the filters count
+/// their constructor and copy calls, method calls, and calls to sqrt,
+/// fmod and the trigonometric functions. The counts can be read with
+/// Count and written out with Dump.
+///
+/// When WRMATH_INSTRUMENT is not defined, the counting macros expand to
+/// nothing and the instrumented classes are unchanged. The definition
+/// must be the same for every translation unit in a program, including
+/// the library itself.
+#ifndef __WRMATH_INSTRUMENT_H
+#define __WRMATH_INSTRUMENT_H
+
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+
+namespace wr {
+/// instrument contains the operation counters.
+namespace instrument {
+
+
+/// @brief Counter is a named event counter.
+///
+/// Counters are normally created by the WRMATH_COUNT macro as
+/// function-local statics, so each call site (and each template
+/// instantiation) has its own counter; counters with the same name are
+/// summed when reported. Counters register themselves on construction
+/// and are never destroyed before the end of the program.
+class Counter {
+public:
+	/// Create and register a counter.
+	///
+	/// \param name The event name; it must outlive the counter.
+	explicit Counter(const char *name);
+
+	Counter(const Counter &) = delete;
+	Counter &operator=(const Counter &) = delete;
+
+	/// Record n occurrences of the event.
+	///
+	/// \param n The number of occurrences.
+	void
+	increment(uint64_t n = 1)
+	{
+		this->count.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	/// Return the counter's name.
+	///
+	/// \return The event name.
+	const char	*name() const { return this->label; }
+
+	/// Return the current count.
+	///
+	/// \return The number of recorded events.
+	uint64_t	 value() const { return this->count.load(std::memory_order_relaxed); }
+
+	/// Reset the count to zero.
+	void		 reset() { this->count.store(0, std::memory_order_relaxed); }
+
+	/// Return the next registered counter.
+	///
+	/// \return The next counter, or nullptr at the end of the list.
+	const Counter	*nextCounter() const { return this->next; }
+
+	/// Return the first registered counter.
+	///
+	/// \return The most recently registered counter, or nullptr.
+	static const Counter	*first();
+
+private:
+	const char		*label;
+	std::atomic<uint64_t>	 count;
+	Counter			*next;
+};
+
+
+/// Return the total count for every counter with the given name.
+///
+/// \param name The event name, e.g. "sqrt" or "Vector::magnitude".
+/// \return The summed count.
+uint64_t	Count(const char *name);
+
+/// Reset every counter to zero.
+void		Reset();
+
+/// Write every non-zero count, summed by name and sorted, as
+/// "name count" lines.
+///
+/// \param outs The output stream.
+void		Dump(std::ostream &outs);
+
+
+} // namespace instrument
+} // namespace wr
+
+
+#ifdef WRMATH_INSTRUMENT
+
+/// Count n occurrences of the named event at this call site.
+#define WRMATH_COUNT_N(name, n)						\
+	do {								\
+		static wr::instrument::Counter	wrmathCounter_(name);	\
+		wrmathCounter_.increment(n);				\
+	} while (0)
+
+#else
+
+#define WRMATH_COUNT_N(name, n)	do { } while (0)
+
+#endif // WRMATH_INSTRUMENT
+
+/// Count one occurrence of the named event at this call site.
+#define WRMATH_COUNT(name)	WRMATH_COUNT_N(name, 1)
+
+
+#endif // __WRMATH_INSTRUMENT_H
@@ -0,0 +1,9 @@
+#ifndef __WRMATH_IO_H
+#define __WRMATH_IO_H
+
+#include <wrmath/io/codec.h>
+#include <wrmath/io/format.h>
+#include <wrmath/io/half.h>
+#include <wrmath/io/log.h>
+
+#endif // __WRMATH_IO_H
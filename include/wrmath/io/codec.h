@@ -0,0 +1,243 @@
+/// \file codec.h
+/// \brief Lossy compression of unit quaternions.
+///
+/// The smallest-three encoding relies on a unit quaternion having a
+/// norm of 1: the component with the largest magnitude can be
+/// reconstructed from the other three, so only its index (two bits) and
+/// the three remaining components need to be stored. Since q and -q
+/// represent the same rotation, the quaternion is negated if necessary
+/// so that the dropped component is positive, and because it is the
+/// largest, the remaining components lie in [-1/√2, 1/√2].
+///
+/// With b bits per component, a quaternion packs into 2 + 3b bits. The
+/// standard allocations are 10 bits (32 bits total) and 15 bits (47
+/// bits, stored in 48).
+///
+/// Packed quaternions are stored as little-endian byte sequences of
+/// SmallestThree::size() bytes, regardless of host byte order.
+#ifndef __WRMATH_IO_CODEC_H
+#define __WRMATH_IO_CODEC_H
+
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+
+
+namespace wr {
+namespace io {
+
+
+/// @brief SmallestThree implements smallest-three quaternion compression
+/// with a configurable number of bits per component.
+///
+/// The quantisation step for b bits is Δ = √2 / (2^b - 1). Each stored
+/// component is off by at most Δ/2, and reconstructing the largest
+/// component at most doubles the error norm, so the decoded quaternion
+/// is within √3·Δ of the original. The rotation angle between the
+/// original and decoded orientations is then at most 4·asin(√3·Δ / 2):
+///
+/// | bits | packed size | max angular error        |
+/// |------|-------------|--------------------------|
+/// |  10  | 4 bytes     | 4.8e-3 rad (0.27°)       |
+/// |  15  | 6 bytes     | 1.5e-4 rad (0.0086°)     |
+/// |  20  | 8 bytes     | 4.7e-6 rad (0.00027°)    |
+///
+/// In practice the typical error is a fraction of the bound;
+/// maxAngularError() returns the exact bound for a given allocation.
+///
+/// Batch pack and unpack operate on interleaved <w, x, y, z> arrays, as
+/// stored by wr::io::LogWriter.
+class SmallestThree {
+public:
+	/// Create a codec with the given number of bits per component.
+	///
+	/// \param componentBits The number of bits for each of the three
+	///                      stored components, from 2 to 20.
+	explicit SmallestThree(unsigned componentBits);
+
+
+	/// Return the number of bits per stored component.
+	///
+	/// \return The component bit allocation.
+	unsigned	bits() const { return this->componentBits; }
+
+	/// Return the number of bytes a packed quaternion occupies.
+	///
+	/// \return The packed size in bytes.
+	size_t		size() const { return this->packedSize; }
+
+	/// Return the upper bound on the rotation angle between a unit
+	/// quaternion and its decoded form.
+	///
+	/// \return The maximum angular error in radians.
+	double		maxAngularError() const;
+
+
+	/// Encode a single unit quaternion.
+	///
+	/// \param q A unit quaternion.
+	/// \return The packed code, in the low size() bytes.
+	template <typename T>
+	uint64_t
+	encode(const geom::Quaternion<T> &q) const
+	{
+		assert(q.isUnitQuaternion());
+
+		geom::Vector<T, 3>	axis = q.axis();
+		T			wxyz[4] = {q.angle(), axis[0], axis[1], axis[2]};
+
+		return this->encode(wxyz);
+	}
+
+
+	/// Decode a single packed quaternion.
+	///
+	/// \param code A code produced by encode.
+	/// \return The decoded unit quaternion.
+	template <typename T>
+	geom::Quaternion<T>
+	decode(uint64_t code) const
+	{
+		T	wxyz[4];
+
+		this->decode(code, wxyz);
+		return geom::Quaternion<T>{wxyz[0], wxyz[1], wxyz[2], wxyz[3]};
+	}
+
+
+	/// Encode a unit quaternion stored as <w, x, y, z>.
+	///
+	/// \param q Four scalars forming a unit quaternion.
+	/// \return The packed code, in the low size() bytes.
+	template <typename T>
+	uint64_t
+	encode(const T *q) const
+	{
+		T		a[4] = {std::abs(q[0]), std::abs(q[1]),
+					std::abs(q[2]), std::abs(q[3])};
+		unsigned	largest = 0;
+		T		m = a[0];
+
+		for (unsigned i = 1; i < 4; i++) {
+			bool	larger = a[i] > m;
+			largest = larger ? i : largest;
+			m = larger ? a[i] : m;
+		}
+
+		T		sign = q[largest] < 0 ? (T)-1.0 : (T)1.0;
+		T		scale = (T)this->levels / (T)(2.0 * Range);
+		uint64_t	code = largest;
+
+		for (unsigned i = 0; i < 3; i++) {
+			T	c = q[Others[largest][i]] * sign;
+			T	u = std::floor(((c + (T)Range) * scale) + (T)0.5);
+
+			u = u < 0 ? 0 : u;
+			u = u > (T)this->levels ? (T)this->levels : u;
+			code |= static_cast<uint64_t>(u) <<
+				(2 + (i * this->componentBits));
+		}
+
+		return code;
+	}
+
+
+	/// Decode a packed quaternion into <w, x, y, z>.
+	///
+	/// \param code A code produced by encode.
+	/// \param q Storage for four scalars.
+	template <typename T>
+	void
+	decode(uint64_t code, T *q) const
+	{
+		unsigned	largest = code & 3;
+		T		step = (T)(2.0 * Range) / (T)this->levels;
+		T		sum = 0;
+
+		for (unsigned i = 0; i < 3; i++) {
+			uint64_t	u = (code >> (2 + (i * this->componentBits))) &
+					    this->levels;
+			T		c = ((T)u * step) - (T)Range;
+
+			q[Others[largest][i]] = c;
+			sum += c * c;
+		}
+
+		// Quantisation can push the sum of squares slightly over 1.
+		sum = sum > 1 ? 1 : sum;
+		q[largest] = std::sqrt((T)1.0 - sum);
+	}
+
+
+	/// Pack an array of unit quaternions.
+	///
+	/// \param q count quaternions as interleaved <w, x, y, z>.
+	/// \param count The number of quaternions.
+	/// \param out Storage for count * size() bytes.
+	template <typename T>
+	void
+	pack(const T *q, size_t count, uint8_t *out) const
+	{
+		for (size_t i = 0; i < count; i++) {
+			uint64_t	code = this->encode(q + (i * 4));
+
+			for (size_t j = 0; j < this->packedSize; j++) {
+				out[j] = static_cast<uint8_t>(code >> (8 * j));
+			}
+			out += this->packedSize;
+		}
+	}
+
+
+	/// Unpack an array of quaternions.
+	///
+	/// \param in count * size() bytes produced by pack.
+	/// \param count The number of quaternions.
+	/// \param q Storage for count interleaved <w, x, y, z> quaternions.
+	template <typename T>
+	void
+	unpack(const uint8_t *in, size_t count, T *q) const
+	{
+		for (size_t i = 0; i < count; i++) {
+			uint64_t	code = 0;
+
+			for (size_t j = 0; j < this->packedSize; j++) {
+				code |= static_cast<uint64_t>(in[j]) << (8 * j);
+			}
+			this->decode(code, q + (i * 4));
+			in += this->packedSize;
+		}
+	}
+
+private:
+	/// Range is the largest magnitude of a stored component, 1/√2.
+	static constexpr double		Range = 0.70710678118654752440;
+	static const uint8_t		Others[4][3];
+
+	unsigned	componentBits;
+	uint64_t	levels;
+	size_t		packedSize;
+};
+
+
+/// SmallestThree32 returns the 32-bit codec, with 10 bits per component.
+///
+/// \return A SmallestThree codec packing into 4 bytes.
+SmallestThree	SmallestThree32();
+
+/// SmallestThree48 returns the 48-bit codec, with 15 bits per component.
+///
+/// \return A SmallestThree codec packing into 6 bytes.
+SmallestThree	SmallestThree48();
+
+
+} // namespace io
+} // namespace wr
+
+
+#endif // __WRMATH_IO_CODEC_H
@@ -0,0 +1,223 @@
+/// \file format.h
+/// \brief Allocation-free text formatting for vectors and quaternions.
+///
+/// The functions here write into a caller-supplied buffer, in the style
+/// of std::to_chars: they take the bounds of the buffer, return a
+/// pointer just past the text written, and never allocate, lock or
+/// consult the locale. They return nullptr, leaving the contents of the
+/// buffer unspecified, if the text doesn't fit. No terminating NUL is
+/// written.
+///
+/// The layout matches operator<<: a vector is written as "<x, y, z>"
+/// and a quaternion as "w + <x, y, z>". Scalars are written as printf's
+/// %g writes them, and as an ostream does by default: rounded to
+/// precision significant digits, with trailing zeros removed, in fixed
+/// point unless the exponent is below -4 or at least the precision.
+/// So 1.0 is "1", 0.0871557 is "0.0871557" and 1e-7 is "1e-07". The
+/// digits are found with floating point arithmetic rather than exactly,
+/// so a value very close to halfway between two roundings may come out
+/// one digit different from printf.
+#ifndef __WRMATH_IO_FORMAT_H
+#define __WRMATH_IO_FORMAT_H
+
+
+#include <cassert>
+#include <cstddef>
+
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+
+
+namespace wr {
+namespace io {
+
+
+/// FormatDefaultPrecision is the number of significant digits used
+/// when none is given; it matches the default ostream precision.
+constexpr unsigned	FormatDefaultPrecision = 6;
+
+/// FormatMaxPrecision is the largest supported precision.
+constexpr unsigned	FormatMaxPrecision = 15;
+
+/// FormatScalarMax is the most characters FormatScalar writes for any
+/// value and precision.
+constexpr size_t	FormatScalarMax = 32;
+
+
+/// Write a value as text.
+///
+/// \param first The start of the buffer.
+/// \param last One past the end of the buffer.
+/// \param value The value to write.
+/// \param precision The number of significant digits, at most
+///                  FormatMaxPrecision; as with %g, zero means one.
+/// \return One past the last character written, or nullptr if the text
+///         doesn't fit.
+char	*FormatScalar(char *first, char *last, double value,
+		      unsigned precision = FormatDefaultPrecision);
+
+
+/// Write an N-dimensional vector stored as N scalars, as "<x, y, z>".
+///
+/// \param first The start of the buffer.
+/// \param last One past the end of the buffer.
+/// \param v N scalars.
+/// \param precision The number of significant digits.
+/// \return One past the last character written, or nullptr if the text
+///         doesn't fit.
+template <size_t N, typename T>
+char *
+FormatVector(char *first, char *last, const T *v,
+	     unsigned precision = FormatDefaultPrecision)
+{
+	if (first == nullptr || first == last) {
+		return nullptr;
+	}
+	*first++ = '<';
+
+	for (size_t i = 0; i < N; i++) {
+		if (i > 0) {
+			if (last - first < 2) {
+				return nullptr;
+			}
+			*first++ = ',';
+			*first++ = ' ';
+		}
+
+		first = FormatScalar(first, last, static_cast<double>(v[i]), precision);
+		if (first == nullptr) {
+			return nullptr;
+		}
+	}
+
+	if (first == last) {
+		return nullptr;
+	}
+	*first++ = '>';
+	return first;
+}
+
+
+/// Write a quaternion stored as <w, x, y, z>, as "w + <x, y, z>".
+///
+/// \param first The start of the buffer.
+/// \param last One past the end of the buffer.
+/// \param q Four scalars.
+/// \param precision The number of significant digits.
+/// \return One past the last character written, or nullptr if the text
+///         doesn't fit.
+template <typename T>
+char *
+FormatQuaternion(char *first, char *last, const T *q,
+		 unsigned precision = FormatDefaultPrecision)
+{
+	first = FormatScalar(first, last, static_cast<double>(q[0]), precision);
+	if (first == nullptr || last - first < 3) {
+		return nullptr;
+	}
+	*first++ = ' ';
+	*first++ = '+';
+	*first++ = ' ';
+	return FormatVector<3>(first, last, q + 1, precision);
+}
+
+
+/// Write a Vector, as operator<< does.
+///
+/// \param first The start of the buffer.
+/// \param last One past the end of the buffer.
+/// \param v A vector.
+/// \param precision The number of significant digits.
+/// \return One past the last character written, or nullptr if the text
+///         doesn't fit.
+template <typename T, size_t N>
+char *
+Format(char *first, char *last, const geom::Vector<T, N> &v,
+       unsigned precision = FormatDefaultPrecision)
+{
+	T	arr[N];
+
+	for (size_t i = 0; i < N; i++) {
+		arr[i] = v[i];
+	}
+	return FormatVector<N>(first, last, arr, precision);
+}
+
+
+/// Write a Quaternion, as operator<< does.
+///
+/// \param first The start of the buffer.
+/// \param last One past the end of the buffer.
+/// \param q A quaternion.
+/// \param precision The number of significant digits.
+/// \return One past the last character written, or nullptr if the text
+///         doesn't fit.
+template <typename T>
+char *
+Format(char *first, char *last, const geom::Quaternion<T> &q,
+       unsigned precision = FormatDefaultPrecision)
+{
+	geom::Vector<T, 3>	axis = q.axis();
+	T			arr[4] = {q.angle(), axis[0], axis[1], axis[2]};
+
+	return FormatQuaternion(first, last, arr, precision);
+}
+
+
+/// Write an array of records, each followed by a separator, stopping at
+/// the first record that doesn't fit. A logger can flush the buffer and
+/// call again with the remaining records.
+///
+/// \param first The start of the buffer.
+/// \param last One past the end of the buffer.
+/// \param in count records of width scalars.
+/// \param count The number of records.
+/// \param width 4 for quaternions stored as <w, x, y, z>, or 2 or 3 for
+///              vectors.
+/// \param end Set to one past the last character written.
+/// \param precision The number of significant digits.
+/// \param separator The character written after each record.
+/// \return The number of records written.
+template <typename T>
+size_t
+FormatBatch(char *first, char *last, const T *in, size_t count, size_t width,
+	    char **end, unsigned precision = FormatDefaultPrecision,
+	    char separator = '\n')
+{
+	assert(width >= 2 && width <= 4);
+
+	size_t	written = 0;
+
+	for (; written < count; written++) {
+		const T	*record = in + (written * width);
+		char	*next;
+
+		switch (width) {
+		case 2:
+			next = FormatVector<2>(first, last, record, precision);
+			break;
+		case 3:
+			next = FormatVector<3>(first, last, record, precision);
+			break;
+		default:
+			next = FormatQuaternion(first, last, record, precision);
+			break;
+		}
+
+		if (next == nullptr || next == last) {
+			break;
+		}
+		*next++ = separator;
+		first = next;
+	}
+
+	*end = first;
+	return written;
+}
+
+
+} // namespace io
+} // namespace wr
+
+
+#endif // __WRMATH_IO_FORMAT_H
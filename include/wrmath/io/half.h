@@ -0,0 +1,227 @@
+/// \file half.h
+/// \brief IEEE 754 half-precision storage for vectors and quaternions.
+///
+/// Half-precision values are a storage format only: they are widened to
+/// float for any computation and narrowed back when stored. Narrowing
+/// rounds to nearest even, overflows to infinity and preserves NaN.
+///
+/// On x86, the batch conversions use the F16C instructions when the
+/// processor has them, checked once at run time, and a portable scalar
+/// implementation otherwise; no compiler flags are needed. Both produce
+/// identical results for everything but NaN payloads.
+#ifndef __WRMATH_IO_HALF_H
+#define __WRMATH_IO_HALF_H
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+
+
+namespace wr {
+namespace io {
+
+
+/// Convert a float to half precision.
+///
+/// @param f A float value.
+/// @return The nearest half-precision value, as its bit pattern.
+uint16_t	FloatToHalf(float f);
+
+/// Convert a half-precision value to float. The conversion is exact.
+///
+/// @param h A half-precision bit pattern.
+/// @return The value as a float.
+float		HalfToFloat(uint16_t h);
+
+/// Report whether the batch conversions use the F16C instructions on
+/// this processor.
+///
+/// @return True if WidenHalf and NarrowHalf are accelerated.
+bool		HalfAccelerated();
+
+/// Widen an array of half-precision values to floats.
+///
+/// @param in n half-precision values.
+/// @param out Storage for n floats.
+/// @param n The number of values.
+void		WidenHalf(const uint16_t *in, float *out, size_t n);
+
+/// Narrow an array of floats to half precision.
+///
+/// @param in n floats.
+/// @param out Storage for n half-precision values.
+/// @param n The number of values.
+void		NarrowHalf(const float *in, uint16_t *out, size_t n);
+
+
+/// @brief HalfVector stores an N-dimensional float vector in half
+/// precision.
+///
+/// A HalfVector is exactly N half-precision values with no epsilon, so
+/// arrays of them can be converted in bulk with WidenHalf and
+/// NarrowHalf, or the Widen and Narrow helpers below.
+template <size_t N>
+class HalfVector {
+public:
+	/// The default HalfVector is a zero vector.
+	HalfVector()
+	{
+		for (size_t i = 0; i < N; i++) {
+			this->arr[i] = 0;
+		}
+	}
+
+
+	/// Narrow a float vector.
+	///
+	/// @param vec The vector to store.
+	explicit HalfVector(const geom::Vector<float, N> &vec)
+	{
+		for (size_t i = 0; i < N; i++) {
+			this->arr[i] = FloatToHalf(vec[i]);
+		}
+	}
+
+
+	/// Widen to a float vector.
+	///
+	/// @return The stored vector.
+	geom::Vector<float, N>
+	widen() const
+	{
+		float	f[N];
+
+		WidenHalf(this->arr, f, N);
+		return geom::Vector<float, N>(f);
+	}
+
+
+	/// Return the bit pattern of component i.
+	///
+	/// @param i The component index.
+	/// @return The half-precision bits of the component.
+	uint16_t
+	operator[](size_t i) const
+	{
+		return this->arr[i];
+	}
+
+private:
+	uint16_t	arr[N];
+};
+
+
+/// @brief HalfQuaternion stores a float quaternion in half precision, as
+/// <w, x, y, z>.
+class HalfQuaternion {
+public:
+	/// The default HalfQuaternion is an identity quaternion.
+	HalfQuaternion() : arr{0x3c00, 0, 0, 0} {};
+
+
+	/// Narrow a float quaternion.
+	///
+	/// @param q The quaternion to store.
+	explicit HalfQuaternion(const geom::Quaternionf &q)
+	{
+		geom::Vector3f	axis = q.axis();
+
+		this->arr[0] = FloatToHalf(q.angle());
+		this->arr[1] = FloatToHalf(axis[0]);
+		this->arr[2] = FloatToHalf(axis[1]);
+		this->arr[3] = FloatToHalf(axis[2]);
+	}
+
+
+	/// Widen to a float quaternion.
+	///
+	/// @return The stored quaternion.
+	geom::Quaternionf
+	widen() const
+	{
+		float	f[4];
+
+		WidenHalf(this->arr, f, 4);
+		return geom::Quaternionf{f[0], f[1], f[2], f[3]};
+	}
+
+
+	/// Return the bit pattern of component i, in <w, x, y, z> order.
+	///
+	/// @param i The component index.
+	/// @return The half-precision bits of the component.
+	uint16_t
+	operator[](size_t i) const
+	{
+		return this->arr[i];
+	}
+
+private:
+	uint16_t	arr[4];
+};
+
+
+static_assert(sizeof(HalfVector<3>) == 6, "HalfVector must be unpadded");
+static_assert(sizeof(HalfQuaternion) == 8, "HalfQuaternion must be unpadded");
+
+
+/// Widen an array of half-precision vectors to interleaved floats.
+///
+/// @param in count vectors.
+/// @param out Storage for count * N floats.
+/// @param count The number of vectors.
+template <size_t N>
+void
+Widen(const HalfVector<N> *in, float *out, size_t count)
+{
+	WidenHalf(reinterpret_cast<const uint16_t *>(in), out, count * N);
+}
+
+
+/// Narrow interleaved floats to an array of half-precision vectors.
+///
+/// @param in count * N floats.
+/// @param out Storage for count vectors.
+/// @param count The number of vectors.
+template <size_t N>
+void
+Narrow(const float *in, HalfVector<N> *out, size_t count)
+{
+	NarrowHalf(in, reinterpret_cast<uint16_t *>(out), count * N);
+}
+
+
+/// Widen an array of half-precision quaternions to interleaved
+/// <w, x, y, z> floats.
+///
+/// @param in count quaternions.
+/// @param out Storage for count * 4 floats.
+/// @param count The number of quaternions.
+inline void
+Widen(const HalfQuaternion *in, float *out, size_t count)
+{
+	WidenHalf(reinterpret_cast<const uint16_t *>(in), out, count * 4);
+}
+
+
+/// Narrow interleaved <w, x, y, z> floats to an array of half-precision
+/// quaternions.
+///
+/// @param in count * 4 floats.
+/// @param out Storage for count quaternions.
+/// @param count The number of quaternions.
+inline void
+Narrow(const float *in, HalfQuaternion *out, size_t count)
+{
+	NarrowHalf(in, reinterpret_cast<uint16_t *>(out), count * 4);
+}
+
+
+} // namespace io
+} // namespace wr
+
+
+#endif // __WRMATH_IO_HALF_H
@@ -0,0 +1,645 @@
+/// \file log.h
+/// \brief A compact binary format for timestamped orientation streams.
+///
+/// A log file holds a single stream of either quaternions or
+/// three-dimensional vectors, along with a timestamp for each record.
+/// The layout is:
+///
+/// + a fixed 64-byte LogHeader;
+/// + a sequence of blocks, each aligned to LogAlignment bytes, holding
+///   a column of int64_t timestamps followed by a column of interleaved
+///   records (<w, x, y, z> for quaternions, <x, y, z> for vectors);
+/// + a block index of LogBlockEntry values, pointed to by the header.
+///
+/// Values are stored in native byte order; the header records an
+/// endianness marker so that a reader on a different architecture can
+/// refuse the file instead of misreading it.
+///
+/// The LogReader memory-maps the file, so that a LogBlock is a view
+/// directly into the mapped pages and can be handed to batch kernels
+/// without copying or parsing.
+#ifndef __WRMATH_IO_LOG_H
+#define __WRMATH_IO_LOG_H
+
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+
+
+namespace wr {
+/// io contains serialisation formats for wrmath types.
+namespace io {
+
+
+/// LogMagic is the four-byte signature at the start of every log file.
+constexpr char		LogMagic[4] = {'W', 'R', 'L', 'G'};
+
+/// LogVersion is the current version of the log format.
+constexpr uint16_t	LogVersion = 1;
+
+/// LogEndianMarker is written in native byte order to detect files
+/// written on a machine with a different endianness.
+constexpr uint32_t	LogEndianMarker = 0x01020304;
+
+/// LogAlignment is the alignment of blocks and columns in the file.
+constexpr size_t	LogAlignment = 64;
+
+/// LogDefaultBlockSize is the default number of records in a block.
+constexpr uint32_t	LogDefaultBlockSize = 4096;
+
+
+/// LogKind identifies the type of record stored in a log.
+enum class LogKind : uint8_t {
+	Quaternion = 1,	///< Records are quaternions stored as <w, x, y, z>.
+	Vector3    = 2,	///< Records are vectors stored as <x, y, z>.
+};
+
+
+/// LogWidth returns the number of scalars in a record of the given kind.
+///
+/// \param kind The kind of record.
+/// \return The number of scalars per record, or 0 if kind is invalid.
+size_t	LogWidth(LogKind kind);
+
+
+/// LogHeader is the fixed header at the start of a log file.
+struct LogHeader {
+	char		magic[4];	///< Always LogMagic.
+	uint32_t	endian;		///< Always LogEndianMarker.
+	uint16_t	version;	///< The format version.
+	uint8_t		scalarSize;	///< sizeof(T) for the record type.
+	uint8_t		kind;		///< The LogKind of the records.
+	uint32_t	blockSize;	///< The maximum number of records per block.
+	uint64_t	recordCount;	///< The total number of records.
+	uint64_t	blockCount;	///< The number of blocks in the index.
+	uint64_t	indexOffset;	///< The file offset of the block index.
+	uint8_t		reserved[24];
+};
+static_assert(sizeof(LogHeader) == 64, "LogHeader must be 64 bytes");
+
+
+/// LogBlockEntry describes a single block in the block index.
+struct LogBlockEntry {
+	uint64_t	offset;		///< The file offset of the block.
+	uint64_t	count;		///< The number of records in the block.
+	int64_t		first;		///< The first timestamp in the block.
+	int64_t		last;		///< The last timestamp in the block.
+};
+static_assert(sizeof(LogBlockEntry) == 32, "LogBlockEntry must be 32 bytes");
+
+
+/// LogAlign rounds n up to the next multiple of LogAlignment.
+///
+/// \param n A size or offset.
+/// \return n rounded up to a multiple of LogAlignment.
+inline uint64_t
+LogAlign(uint64_t n)
+{
+	return (n + LogAlignment - 1) & ~(uint64_t)(LogAlignment - 1);
+}
+
+
+/// LogValidHeader checks that a header describes a usable log file.
+///
+/// \param header The header read from the start of the file.
+/// \param scalarSize The size of the scalar type the caller expects.
+/// \param fileSize The size of the file in bytes.
+/// \return True if the header is well-formed, matches this machine and
+///         scalar type, and the block index lies within the file.
+bool	LogValidHeader(const LogHeader &header, size_t scalarSize,
+		       uint64_t fileSize);
+
+
+/// @brief MappedFile is a read-only memory mapping of a file.
+///
+/// MappedFile is the non-template support for LogReader, and cannot be
+/// copied.
+class MappedFile {
+public:
+	MappedFile() : base(nullptr), length(0) {};
+	~MappedFile() { this->close(); }
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	/// Map a file into memory, replacing any existing mapping.
+	///
+	/// \param path The path to the file.
+	/// \return True if the file was mapped.
+	bool		open(const std::string &path);
+
+	/// Release the mapping, if any.
+	void		close();
+
+	/// Return a pointer to the start of the mapping.
+	///
+	/// \return The mapped bytes, or nullptr if nothing is mapped.
+	const uint8_t	*data() const { return this->base; }
+
+	/// Return the size of the mapping.
+	///
+	/// \return The size of the mapped file in bytes.
+	uint64_t	 size() const { return this->length; }
+
+private:
+	const uint8_t	*base;
+	uint64_t	 length;
+};
+
+
+/// @brief LogBlock is a zero-copy view of one block in a mapped log.
+///
+/// The timestamps and values pointers refer directly to the mapped file,
+/// and are aligned to LogAlignment bytes. The view is only valid while
+/// the LogReader that produced it remains open.
+///
+/// \tparam T The scalar type of the records.
+template <typename T>
+struct LogBlock {
+	const int64_t	*timestamps;	///< count timestamps.
+	const T		*values;	///< count * width interleaved scalars.
+	size_t		 count;		///< The number of records.
+	size_t		 width;		///< The number of scalars per record.
+
+	/// Return record i as a quaternion.
+	///
+	/// \param i The record index within the block.
+	/// \return The quaternion stored at i.
+	geom::Quaternion<T>
+	quaternion(size_t i) const
+	{
+		assert(this->width == 4);
+		assert(i < this->count);
+
+		const T	*r = this->values + (i * 4);
+		return geom::Quaternion<T>{r[0], r[1], r[2], r[3]};
+	}
+
+	/// Return record i as a three-dimensional vector.
+	///
+	/// \param i The record index within the block.
+	/// \return The vector stored at i.
+	geom::Vector<T, 3>
+	vector(size_t i) const
+	{
+		assert(this->width == 3);
+		assert(i < this->count);
+
+		const T	*r = this->values + (i * 3);
+		return geom::Vector<T, 3>{r[0], r[1], r[2]};
+	}
+};
+
+
+/// @brief LogWriter writes a stream of timestamped records to a log file.
+///
+/// Records are buffered in memory until a block is full, then written as
+/// a single aligned block. The block index and final header are written
+/// when the log is closed; a log that is never closed is not readable.
+///
+/// Timestamps are opaque int64_t values in caller-defined units (e.g.
+/// nanoseconds) and should be non-decreasing for LogReader::find to be
+/// meaningful.
+///
+/// \tparam T The scalar type of the records.
+template <typename T>
+class LogWriter {
+public:
+	LogWriter() : file(nullptr), kind(LogKind::Quaternion), width(0),
+		      blockSize(0), recordCount(0), offset(0) {};
+	~LogWriter() { this->close(); }
+
+	LogWriter(const LogWriter &) = delete;
+	LogWriter &operator=(const LogWriter &) = delete;
+
+
+	/// Create a new log file, truncating any existing file.
+	///
+	/// \param path The path to the log file.
+	/// \param recordKind The kind of record the log will hold.
+	/// \param recordsPerBlock The number of records in a full block.
+	/// \return True if the file was created.
+	bool
+	open(const std::string &path, LogKind recordKind,
+	     uint32_t recordsPerBlock = LogDefaultBlockSize)
+	{
+		assert(recordsPerBlock > 0);
+		this->close();
+
+		this->width = LogWidth(recordKind);
+		if (this->width == 0) {
+			return false;
+		}
+
+		this->file = std::fopen(path.c_str(), "wb");
+		if (this->file == nullptr) {
+			return false;
+		}
+
+		this->kind = recordKind;
+		this->blockSize = recordsPerBlock;
+		this->recordCount = 0;
+		this->index.clear();
+		this->timestamps.clear();
+		this->values.clear();
+		this->timestamps.reserve(recordsPerBlock);
+		this->values.reserve(recordsPerBlock * this->width);
+
+		// The header is rewritten with the final counts on close.
+		this->offset = 0;
+		if (!this->writeHeader(0)) {
+			this->abort();
+			return false;
+		}
+		return true;
+	}
+
+
+	/// Append a quaternion record. The log must hold quaternions.
+	///
+	/// \param timestamp The timestamp of the record.
+	/// \param q The quaternion to record.
+	/// \return True if the record was accepted.
+	bool
+	write(int64_t timestamp, const geom::Quaternion<T> &q)
+	{
+		if (this->file == nullptr || this->kind != LogKind::Quaternion) {
+			return false;
+		}
+
+		geom::Vector<T, 3>	axis = q.axis();
+
+		this->timestamps.push_back(timestamp);
+		this->values.push_back(q.angle());
+		this->values.push_back(axis[0]);
+		this->values.push_back(axis[1]);
+		this->values.push_back(axis[2]);
+		return this->recorded();
+	}
+
+
+	/// Append a vector record. The log must hold vectors.
+	///
+	/// \param timestamp The timestamp of the record.
+	/// \param v The vector to record.
+	/// \return True if the record was accepted.
+	bool
+	write(int64_t timestamp, const geom::Vector<T, 3> &v)
+	{
+		if (this->file == nullptr || this->kind != LogKind::Vector3) {
+			return false;
+		}
+
+		this->timestamps.push_back(timestamp);
+		this->values.push_back(v[0]);
+		this->values.push_back(v[1]);
+		this->values.push_back(v[2]);
+		return this->recorded();
+	}
+
+
+	/// Append a batch of records that are already in the log's
+	/// interleaved layout.
+	///
+	/// \param ts count timestamps.
+	/// \param vals count * LogWidth(kind) scalars.
+	/// \param count The number of records.
+	/// \return True if all records were written.
+	bool
+	write(const int64_t *ts, const T *vals, size_t count)
+	{
+		if (this->file == nullptr) {
+			return false;
+		}
+
+		while (count > 0) {
+			size_t	room = this->blockSize - this->timestamps.size();
+			size_t	n = count < room ? count : room;
+
+			this->timestamps.insert(this->timestamps.end(), ts, ts + n);
+			this->values.insert(this->values.end(), vals,
+					    vals + (n * this->width));
+			this->recordCount += n;
+			if (this->timestamps.size() == this->blockSize &&
+			    !this->flush()) {
+				return false;
+			}
+
+			ts += n;
+			vals += n * this->width;
+			count -= n;
+		}
+		return true;
+	}
+
+
+	/// Flush any buffered records, write the block index and header,
+	/// and close the file.
+	///
+	/// \return True if the log was completed successfully.
+	bool
+	close()
+	{
+		if (this->file == nullptr) {
+			return true;
+		}
+
+		bool	ok = this->flush();
+		uint64_t	indexOffset = this->offset;
+
+		if (ok && !this->index.empty()) {
+			ok = std::fwrite(this->index.data(), sizeof(LogBlockEntry),
+					 this->index.size(), this->file) ==
+			     this->index.size();
+		}
+
+		ok = ok && this->writeHeader(indexOffset);
+		ok = (std::fclose(this->file) == 0) && ok;
+		this->file = nullptr;
+		return ok;
+	}
+
+private:
+	std::FILE			*file;
+	LogKind				 kind;
+	size_t				 width;
+	uint32_t			 blockSize;
+	uint64_t			 recordCount;
+	uint64_t			 offset;
+	std::vector<LogBlockEntry>	 index;
+	std::vector<int64_t>		 timestamps;
+	std::vector<T>			 values;
+
+	void
+	abort()
+	{
+		std::fclose(this->file);
+		this->file = nullptr;
+	}
+
+	bool
+	recorded()
+	{
+		this->recordCount++;
+		if (this->timestamps.size() == this->blockSize) {
+			return this->flush();
+		}
+		return true;
+	}
+
+	bool
+	writeHeader(uint64_t indexOffset)
+	{
+		LogHeader	header;
+
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, LogMagic, sizeof(header.magic));
+		header.endian = LogEndianMarker;
+		header.version = LogVersion;
+		header.scalarSize = sizeof(T);
+		header.kind = static_cast<uint8_t>(this->kind);
+		header.blockSize = this->blockSize;
+		header.recordCount = this->recordCount;
+		header.blockCount = this->index.size();
+		header.indexOffset = indexOffset;
+
+		if (std::fseek(this->file, 0, SEEK_SET) != 0) {
+			return false;
+		}
+		if (std::fwrite(&header, sizeof(header), 1, this->file) != 1) {
+			return false;
+		}
+		if (this->offset == 0) {
+			this->offset = LogAlign(sizeof(header));
+			return this->pad(this->offset - sizeof(header));
+		}
+		return std::fseek(this->file, 0, SEEK_END) == 0;
+	}
+
+	bool
+	pad(uint64_t n)
+	{
+		static const uint8_t	zeroes[LogAlignment] = {0};
+
+		assert(n < LogAlignment);
+		return std::fwrite(zeroes, 1, n, this->file) == n;
+	}
+
+	bool
+	flush()
+	{
+		size_t	count = this->timestamps.size();
+		if (count == 0) {
+			return true;
+		}
+
+		LogBlockEntry	entry;
+		uint64_t	tsBytes = count * sizeof(int64_t);
+		uint64_t	valBytes = this->values.size() * sizeof(T);
+
+		entry.offset = this->offset;
+		entry.count = count;
+		entry.first = this->timestamps.front();
+		entry.last = this->timestamps.back();
+
+		if (std::fwrite(this->timestamps.data(), 1, tsBytes, this->file) != tsBytes ||
+		    !this->pad(LogAlign(tsBytes) - tsBytes) ||
+		    std::fwrite(this->values.data(), 1, valBytes, this->file) != valBytes ||
+		    !this->pad(LogAlign(valBytes) - valBytes)) {
+			return false;
+		}
+
+		this->offset += LogAlign(tsBytes) + LogAlign(valBytes);
+		this->index.push_back(entry);
+		this->timestamps.clear();
+		this->values.clear();
+		return true;
+	}
+};
+
+
+/// @brief LogReader provides zero-copy access to a log file.
+///
+/// The file is memory-mapped on open; blocks are returned as LogBlock
+/// views into the mapping, so reading a log costs no more than paging
+/// it in.
+///
+/// \tparam T The scalar type of the records; it must match the type
+///           the log was written with.
+template <typename T>
+class LogReader {
+public:
+	LogReader() : header(nullptr), index(nullptr) {};
+
+	LogReader(const LogReader &) = delete;
+	LogReader &operator=(const LogReader &) = delete;
+
+
+	/// Map and validate a log file.
+	///
+	/// \param path The path to the log file.
+	/// \return True if the file is a valid log of T records.
+	bool
+	open(const std::string &path)
+	{
+		this->close();
+		if (!this->mapping.open(path)) {
+			return false;
+		}
+
+		if (this->mapping.size() < sizeof(LogHeader)) {
+			this->close();
+			return false;
+		}
+
+		this->header = reinterpret_cast<const LogHeader *>(this->mapping.data());
+		if (!LogValidHeader(*this->header, sizeof(T), this->mapping.size())) {
+			this->close();
+			return false;
+		}
+
+		this->index = reinterpret_cast<const LogBlockEntry *>(
+			this->mapping.data() + this->header->indexOffset);
+		for (uint64_t i = 0; i < this->header->blockCount; i++) {
+			if (!this->validEntry(this->index[i])) {
+				this->close();
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	/// Unmap the log. Any LogBlock views obtained from this reader
+	/// become invalid.
+	void
+	close()
+	{
+		this->mapping.close();
+		this->header = nullptr;
+		this->index = nullptr;
+	}
+
+
+	/// Return the kind of record stored in the log.
+	///
+	/// \return The LogKind of the log's records.
+	LogKind
+	kind() const
+	{
+		assert(this->header != nullptr);
+		return static_cast<LogKind>(this->header->kind);
+	}
+
+
+	/// Return the total number of records in the log.
+	///
+	/// \return The record count.
+	uint64_t
+	size() const
+	{
+		return this->header == nullptr ? 0 : this->header->recordCount;
+	}
+
+
+	/// Return the number of blocks in the log.
+	///
+	/// \return The block count.
+	size_t
+	blockCount() const
+	{
+		return this->header == nullptr ? 0 : this->header->blockCount;
+	}
+
+
+	/// Return the index entry for a block.
+	///
+	/// \param i The block number.
+	/// \return The block index entry.
+	const LogBlockEntry &
+	entry(size_t i) const
+	{
+		assert(i < this->blockCount());
+		return this->index[i];
+	}
+
+
+	/// Return a zero-copy view of a block.
+	///
+	/// \param i The block number.
+	/// \return A view of the block's timestamps and values.
+	LogBlock<T>
+	block(size_t i) const
+	{
+		const LogBlockEntry	&e = this->entry(i);
+		const uint8_t		*base = this->mapping.data() + e.offset;
+		LogBlock<T>		 view;
+
+		view.count = e.count;
+		view.width = LogWidth(this->kind());
+		view.timestamps = reinterpret_cast<const int64_t *>(base);
+		view.values = reinterpret_cast<const T *>(
+			base + LogAlign(e.count * sizeof(int64_t)));
+		return view;
+	}
+
+
+	/// Find the first block whose last timestamp is at or after the
+	/// given time, using the block index.
+	///
+	/// \param timestamp The time to search for.
+	/// \return The block number, or blockCount() if every record is
+	///         earlier than timestamp.
+	size_t
+	find(int64_t timestamp) const
+	{
+		size_t	lo = 0;
+		size_t	hi = this->blockCount();
+
+		while (lo < hi) {
+			size_t	mid = lo + ((hi - lo) / 2);
+			if (this->index[mid].last < timestamp) {
+				lo = mid + 1;
+			}
+			else {
+				hi = mid;
+			}
+		}
+		return lo;
+	}
+
+private:
+	MappedFile		 mapping;
+	const LogHeader		*header;
+	const LogBlockEntry	*index;
+
+	bool
+	validEntry(const LogBlockEntry &e) const
+	{
+		uint64_t	width = LogWidth(this->kind());
+		uint64_t	length;
+
+		if (e.count == 0 || e.count > this->header->blockSize ||
+		    e.offset % LogAlignment != 0) {
+			return false;
+		}
+
+		length = LogAlign(e.count * sizeof(int64_t)) +
+			 (e.count * width * sizeof(T));
+		return e.offset + length <= this->header->indexOffset;
+	}
+};
+
+
+} // namespace io
+} // namespace wr
+
+
+#endif // __WRMATH_IO_LOG_H
@@ -5,6 +5,10 @@
 
 #include <cmath>
 
+#include <wrmath/math/fixed.h>
+#include <wrmath/math/compare.h>
+#include <wrmath/math/linalg.h>
+
 
 namespace wr {
 /// math contains utility math functions.
@@ -48,10 +52,12 @@ void	DefaultEpsilon(float &epsilon);
 /// @param epsilon The tolerance value.
 /// @return Whether the two values are "close enough" to be considered equal.
 template <typename T>
-static T
+static bool
 WithinTolerance(T a, T b, T epsilon)
 {
-	return std::abs(a - b) < epsilon;
+	using std::abs;
+
+	return abs(a - b) < epsilon;
 }
 
 
@@ -0,0 +1,318 @@
+/// \file compare.h
+/// \brief Tolerance modes and branch-free batch comparison.
+///
+/// WithinTolerance compares against an absolute tolerance. This file
+/// adds relative and ULP (units in the last place) comparisons, and
+/// batch comparisons that test arrays of fixed-width records, such as
+/// vectors or <w, x, y, z> quaternions, and report the result as a
+/// bitmask.
+///
+/// The batch loops evaluate every component of every record without
+/// early exits, combining the results with bitwise operations, so their
+/// speed doesn't depend on the data.
+///
+/// Masks are arrays of 64-bit words: record i is bit i % 64 of word
+/// i / 64, and the unused high bits of the last word are zero.
+#ifndef __WRMATH_MATH_COMPARE_H
+#define __WRMATH_MATH_COMPARE_H
+
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+namespace wr {
+namespace math {
+
+
+/// Return whether two values are equal to within a tolerance relative to
+/// the larger of their magnitudes.
+///
+/// @param a A value.
+/// @param b A value.
+/// @param epsilon The relative tolerance, e.g. 1e-6.
+/// @return True if |a - b| <= epsilon * max(|a|, |b|).
+template <typename T>
+static bool
+WithinRelativeTolerance(T a, T b, T epsilon)
+{
+	using std::abs;
+
+	T	m = abs(a) > abs(b) ? abs(a) : abs(b);
+
+	return abs(a - b) <= epsilon * m;
+}
+
+
+/// Map a float to an integer that orders the same way, so that the
+/// difference between two mapped values is their distance in ULPs.
+inline int64_t
+OrderedBits(float f)
+{
+	int32_t	bits;
+
+	std::memcpy(&bits, &f, sizeof(bits));
+	return bits < 0 ? (int64_t)INT32_MIN - bits : (int64_t)bits;
+}
+
+
+/// Map a double to an integer that orders the same way, so that the
+/// difference between two mapped values is their distance in ULPs.
+inline int64_t
+OrderedBits(double d)
+{
+	int64_t	bits;
+
+	std::memcpy(&bits, &d, sizeof(bits));
+	return bits < 0 ? INT64_MIN - bits : bits;
+}
+
+
+/// Return the number of representable values between a and b. +0 and -0
+/// are zero ULPs apart.
+///
+/// @param a A float or double.
+/// @param b A value of the same type.
+/// @return The distance in ULPs.
+template <typename T>
+uint64_t
+ULPDistance(T a, T b)
+{
+	uint64_t	d = static_cast<uint64_t>(OrderedBits(a)) -
+			    static_cast<uint64_t>(OrderedBits(b));
+	uint64_t	nd = static_cast<uint64_t>(0) - d;
+
+	return d < nd ? d : nd;
+}
+
+
+/// Return whether two values are within a number of ULPs of each other.
+/// NaN is never within any distance of anything.
+///
+/// @param a A float or double.
+/// @param b A value of the same type.
+/// @param ulps The largest allowed distance in ULPs.
+/// @return True if the values are at most ulps apart.
+template <typename T>
+static bool
+WithinULPs(T a, T b, uint64_t ulps)
+{
+	return (a == a) && (b == b) && ULPDistance(a, b) <= ulps;
+}
+
+
+/// ToleranceMode selects how two values are compared.
+enum class ToleranceMode {
+	Absolute,	///< |a - b| < epsilon, as WithinTolerance.
+	Relative,	///< WithinRelativeTolerance(a, b, epsilon).
+	ULP,		///< WithinULPs(a, b, ulps).
+};
+
+
+/// @brief Tolerance describes a comparison for the batch functions.
+///
+/// \tparam T The type of value compared.
+template <typename T>
+struct Tolerance {
+	ToleranceMode	mode;		///< The kind of comparison.
+	T		epsilon;	///< The absolute or relative tolerance.
+	uint64_t	ulps;		///< The tolerance in ULP mode.
+
+	/// An absolute tolerance, as used by Vector and Quaternion.
+	static Tolerance	Absolute(T eps) { return Tolerance{ToleranceMode::Absolute, eps, 0}; }
+
+	/// A tolerance relative to the larger magnitude.
+	static Tolerance	Relative(T eps) { return Tolerance{ToleranceMode::Relative, eps, 0}; }
+
+	/// A tolerance in units in the last place.
+	static Tolerance	ULPs(uint64_t n) { return Tolerance{ToleranceMode::ULP, 0, n}; }
+};
+
+
+/// Return the number of mask words needed for count records.
+///
+/// @param count The number of records.
+/// @return ceil(count / 64).
+inline size_t
+MaskWords(size_t count)
+{
+	return (count + 63) / 64;
+}
+
+
+/// Test bit i of a mask.
+///
+/// @param mask A mask.
+/// @param i The record index.
+/// @return True if record i's bit is set.
+inline bool
+MaskTest(const uint64_t *mask, size_t i)
+{
+	return (mask[i / 64] >> (i % 64)) & 1;
+}
+
+
+/// Count the bits set in a mask word.
+inline unsigned
+MaskCount(uint64_t word)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountll(word);
+#else
+	unsigned	n = 0;
+
+	for (; word != 0; word &= word - 1) {
+		n++;
+	}
+	return n;
+#endif
+}
+
+
+/// Build a mask by evaluating a predicate on every record. The
+/// predicate returns 1 or 0 for record i and must not branch on the
+/// data if the loop is to stay branch-free.
+///
+/// @param count The number of records.
+/// @param mask Storage for MaskWords(count) words.
+/// @param pred Called as pred(i) for each record.
+/// @return The number of records for which the predicate was 1.
+template <typename Pred>
+size_t
+BuildMask(size_t count, uint64_t *mask, Pred pred)
+{
+	size_t	matches = 0;
+	size_t	words = MaskWords(count);
+
+	for (size_t w = 0; w < words; w++) {
+		size_t		base = w * 64;
+		size_t		n = count - base < 64 ? count - base : 64;
+		uint64_t	bits = 0;
+
+		for (size_t j = 0; j < n; j++) {
+			bits |= static_cast<uint64_t>(pred(base + j)) << j;
+		}
+		mask[w] = bits;
+		matches += MaskCount(bits);
+	}
+	return matches;
+}
+
+
+/// @brief RecordCompare implements EqualMask for each tolerance mode.
+/// W is the record width when it is known at compile time, which lets
+/// the compiler unroll the component loop, or 0 to use the width given
+/// at run time.
+template <typename T, size_t W>
+struct RecordCompare {
+	static size_t
+	absolute(const T *a, const T *b, size_t count, size_t width, T eps, uint64_t *mask)
+	{
+		width = W != 0 ? W : width;
+		return BuildMask(count, mask, [=](size_t i) {
+			using std::abs;
+
+			unsigned	ok = 1;
+
+			for (size_t k = 0; k < width; k++) {
+				ok &= static_cast<unsigned>(
+				    abs(a[(i * width) + k] - b[(i * width) + k]) < eps);
+			}
+			return ok;
+		});
+	}
+
+	static size_t
+	relative(const T *a, const T *b, size_t count, size_t width, T eps, uint64_t *mask)
+	{
+		width = W != 0 ? W : width;
+		return BuildMask(count, mask, [=](size_t i) {
+			using std::abs;
+
+			unsigned	ok = 1;
+
+			for (size_t k = 0; k < width; k++) {
+				T	x = a[(i * width) + k];
+				T	y = b[(i * width) + k];
+				T	m = abs(x) > abs(y) ? abs(x) : abs(y);
+
+				ok &= static_cast<unsigned>(abs(x - y) <= eps * m);
+			}
+			return ok;
+		});
+	}
+
+	static size_t
+	ulp(const T *a, const T *b, size_t count, size_t width, uint64_t ulps, uint64_t *mask)
+	{
+		width = W != 0 ? W : width;
+		return BuildMask(count, mask, [=](size_t i) {
+			unsigned	ok = 1;
+
+			for (size_t k = 0; k < width; k++) {
+				T	x = a[(i * width) + k];
+				T	y = b[(i * width) + k];
+
+				ok &= static_cast<unsigned>(x == x) &
+				      static_cast<unsigned>(y == y) &
+				      static_cast<unsigned>(ULPDistance(x, y) <= ulps);
+			}
+			return ok;
+		});
+	}
+
+	static size_t
+	compare(const T *a, const T *b, size_t count, size_t width,
+		const Tolerance<T> &tol, uint64_t *mask)
+	{
+		switch (tol.mode) {
+		case ToleranceMode::Absolute:
+			return absolute(a, b, count, width, tol.epsilon, mask);
+		case ToleranceMode::Relative:
+			return relative(a, b, count, width, tol.epsilon, mask);
+		case ToleranceMode::ULP:
+			return ulp(a, b, count, width, tol.ulps, mask);
+		}
+		return 0;
+	}
+};
+
+
+/// Compare two arrays of records componentwise. A record matches if
+/// every one of its components is within tolerance.
+///
+/// @param a count records of width scalars.
+/// @param b count records of width scalars.
+/// @param count The number of records.
+/// @param width The number of scalars per record, e.g. 4 for
+///              quaternions.
+/// @param tol The tolerance; ULP mode needs float or double.
+/// @param mask Storage for MaskWords(count) words.
+/// @return The number of matching records.
+template <typename T>
+size_t
+EqualMask(const T *a, const T *b, size_t count, size_t width,
+	  const Tolerance<T> &tol, uint64_t *mask)
+{
+	// The mode and the common widths are chosen once, outside the
+	// loops.
+	switch (width) {
+	case 2:
+		return RecordCompare<T, 2>::compare(a, b, count, width, tol, mask);
+	case 3:
+		return RecordCompare<T, 3>::compare(a, b, count, width, tol, mask);
+	case 4:
+		return RecordCompare<T, 4>::compare(a, b, count, width, tol, mask);
+	default:
+		return RecordCompare<T, 0>::compare(a, b, count, width, tol, mask);
+	}
+}
+
+
+} // namespace math
+} // namespace wr
+
+
+#endif // __WRMATH_MATH_COMPARE_H
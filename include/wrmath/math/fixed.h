@@ -0,0 +1,310 @@
+/// \file fixed.h
+/// \brief A saturating fixed-point scalar type.
+///
+/// Fixed is a drop-in scalar for the wr::geom::Vector and
+/// wr::geom::Quaternion templates, and for wr::filter::Madgwick, on
+/// targets that work in integer arithmetic. All arithmetic is done on
+/// the underlying integers and saturates at the limits of the type
+/// instead of wrapping.
+///
+/// Only the arithmetic operations are supported; functions that need
+/// trigonometry, such as Quaternion::euler or Vector::angle, are not
+/// available for fixed-point types.
+#ifndef __WRMATH_MATH_FIXED_H
+#define __WRMATH_MATH_FIXED_H
+
+
+#include <cstdint>
+#include <limits>
+#include <ostream>
+
+
+namespace wr {
+namespace math {
+
+
+/// FixedTraits selects the intermediate integer type used for products
+/// and quotients of a fixed-point storage type.
+///
+/// \tparam S The signed integer storage type.
+template <typename S>
+struct FixedTraits;
+
+template <>
+struct FixedTraits<int16_t> {
+	typedef int32_t		Wide;	///< Holds any product of two int16_t.
+	typedef uint32_t	UWide;	///< Unsigned counterpart of Wide.
+};
+
+template <>
+struct FixedTraits<int32_t> {
+	typedef int64_t		Wide;	///< Holds any product of two int32_t.
+	typedef uint64_t	UWide;	///< Unsigned counterpart of Wide.
+};
+
+
+/// @brief Fixed is a signed fixed-point number with F fractional bits,
+/// stored in an integer of type S.
+///
+/// Values can be constructed implicitly from floating point values, so
+/// that literals work as they do with floating-point Vectors (e.g.
+/// `Vector<Q16, 3>{1.0, 0.5, 0.25}`); conversion back to floating point
+/// is explicit so that it can't happen by accident in a computation.
+///
+/// Arrays of Fixed have the same layout as arrays of S, so buffers from
+/// integer pipelines can be reinterpreted without conversion.
+///
+/// \tparam S The signed integer storage type; int16_t or int32_t.
+/// \tparam F The number of fractional bits.
+template <typename S, int F>
+class Fixed {
+public:
+	typedef typename FixedTraits<S>::Wide	Wide;
+	typedef typename FixedTraits<S>::UWide	UWide;
+
+	/// The number of fractional bits.
+	static constexpr int	FractionalBits = F;
+
+	/// A fixed-point zero.
+	constexpr Fixed() : value(0) {};
+
+	/// Convert a floating point value, rounding to nearest and
+	/// saturating at the limits of the type. NaN converts to zero.
+	///
+	/// \param d A floating point value.
+	constexpr Fixed(double d) : value(fromDouble(d)) {};
+
+
+	/// Construct a value directly from its integer representation.
+	///
+	/// \param r The raw integer value, scaled by 2^F.
+	/// \return A fixed-point value.
+	static constexpr Fixed
+	fromRaw(S r)
+	{
+		return Fixed(r, RawTag());
+	}
+
+
+	/// Return the integer representation of this value.
+	///
+	/// \return The raw value, scaled by 2^F.
+	constexpr S	raw() const { return this->value; }
+
+	/// The largest representable value.
+	static constexpr Fixed	max() { return fromRaw(std::numeric_limits<S>::max()); }
+
+	/// The smallest representable value.
+	static constexpr Fixed	min() { return fromRaw(std::numeric_limits<S>::min()); }
+
+	/// The smallest positive value.
+	static constexpr Fixed	lsb() { return fromRaw(1); }
+
+
+	/// Convert to double.
+	explicit operator double() const
+	{
+		return static_cast<double>(this->value) / Scale;
+	}
+
+	/// Convert to float.
+	explicit operator float() const
+	{
+		return static_cast<float>(static_cast<double>(*this));
+	}
+
+
+	/// Saturate a wide intermediate result into a Fixed.
+	///
+	/// \param w A value in the same scale as the raw representation.
+	/// \return The value, clamped to the representable range.
+	static Fixed
+	saturate(Wide w)
+	{
+		if (w > static_cast<Wide>(std::numeric_limits<S>::max())) {
+			return max();
+		}
+		if (w < static_cast<Wide>(std::numeric_limits<S>::min())) {
+			return min();
+		}
+		return fromRaw(static_cast<S>(w));
+	}
+
+
+	friend Fixed
+	operator+(Fixed a, Fixed b)
+	{
+		return saturate(static_cast<Wide>(a.value) + b.value);
+	}
+
+	friend Fixed
+	operator-(Fixed a, Fixed b)
+	{
+		return saturate(static_cast<Wide>(a.value) - b.value);
+	}
+
+	friend Fixed
+	operator*(Fixed a, Fixed b)
+	{
+		Wide	p = static_cast<Wide>(a.value) * b.value;
+
+		// Round to nearest; the shift of a negative value is an
+		// arithmetic shift on every supported compiler.
+		return saturate((p + (static_cast<Wide>(1) << (F - 1))) >> F);
+	}
+
+	friend Fixed
+	operator/(Fixed a, Fixed b)
+	{
+		if (b.value == 0) {
+			return a.value < 0 ? min() : max();
+		}
+		return saturate((static_cast<Wide>(a.value) * (static_cast<Wide>(1) << F)) /
+				b.value);
+	}
+
+	Fixed
+	operator-() const
+	{
+		return saturate(-static_cast<Wide>(this->value));
+	}
+
+	Fixed &operator+=(Fixed b) { return *this = *this + b; }
+	Fixed &operator-=(Fixed b) { return *this = *this - b; }
+	Fixed &operator*=(Fixed b) { return *this = *this * b; }
+	Fixed &operator/=(Fixed b) { return *this = *this / b; }
+
+	friend bool operator==(Fixed a, Fixed b) { return a.value == b.value; }
+	friend bool operator!=(Fixed a, Fixed b) { return a.value != b.value; }
+	friend bool operator<(Fixed a, Fixed b) { return a.value < b.value; }
+	friend bool operator>(Fixed a, Fixed b) { return a.value > b.value; }
+	friend bool operator<=(Fixed a, Fixed b) { return a.value <= b.value; }
+	friend bool operator>=(Fixed a, Fixed b) { return a.value >= b.value; }
+
+
+	/// Absolute value, saturating the most negative value.
+	friend Fixed
+	abs(Fixed a)
+	{
+		return a.value < 0 ? -a : a;
+	}
+
+
+	/// Remainder of a / b, truncated toward zero like std::fmod.
+	friend Fixed
+	fmod(Fixed a, Fixed b)
+	{
+		if (b.value == 0) {
+			return Fixed();
+		}
+		return fromRaw(static_cast<S>(a.value % b.value));
+	}
+
+
+	/// Integer square root; negative values return zero.
+	friend Fixed
+	sqrt(Fixed a)
+	{
+		if (a.value <= 0) {
+			return Fixed();
+		}
+
+		// sqrt(r / 2^F) * 2^F == sqrt(r * 2^F).
+		UWide	n = static_cast<UWide>(a.value) << F;
+		UWide	root = 0;
+		UWide	bit = static_cast<UWide>(1) << ((sizeof(UWide) * 8) - 2);
+
+		while (bit > n) {
+			bit >>= 2;
+		}
+
+		while (bit != 0) {
+			if (n >= root + bit) {
+				n -= root + bit;
+				root = (root >> 1) + bit;
+			}
+			else {
+				root >>= 1;
+			}
+			bit >>= 2;
+		}
+
+		return saturate(static_cast<Wide>(root));
+	}
+
+
+	friend std::ostream &
+	operator<<(std::ostream &outs, Fixed a)
+	{
+		return outs << static_cast<double>(a);
+	}
+
+private:
+	struct RawTag {};
+
+	static constexpr double	Scale = static_cast<double>(static_cast<Wide>(1) << F);
+	static constexpr double	MaxD = static_cast<double>(std::numeric_limits<S>::max()) / Scale;
+	static constexpr double	MinD = static_cast<double>(std::numeric_limits<S>::min()) / Scale;
+
+	S	value;
+
+	constexpr Fixed(S r, RawTag) : value(r) {};
+
+	// NaN fails every comparison, and converting it to an integer is
+	// undefined, so it's caught first.
+	static constexpr S
+	fromDouble(double d)
+	{
+		return d != d ? static_cast<S>(0) :
+		       d >= MaxD ? std::numeric_limits<S>::max() :
+		       d <= MinD ? std::numeric_limits<S>::min() :
+		       static_cast<S>(d * Scale + (d < 0 ? -0.5 : 0.5));
+	}
+};
+
+template <typename S, int F>
+constexpr double Fixed<S, F>::Scale;
+
+
+/// \defgroup fixed_aliases Fixed-point type aliases.
+/// Q15 and Q31 follow the usual DSP convention of a sign bit and all
+/// fractional bits, covering [-1, 1). Q16 is a general-purpose Q15.16
+/// type for values, such as gyro rates, that exceed 1.
+
+/// \ingroup fixed_aliases
+/// A 16-bit fixed-point value in [-1, 1).
+typedef Fixed<int16_t, 15>	Q15;
+
+/// \ingroup fixed_aliases
+/// A 32-bit fixed-point value in [-1, 1).
+typedef Fixed<int32_t, 31>	Q31;
+
+/// \ingroup fixed_aliases
+/// A 32-bit fixed-point value with 16 integer and 16 fractional bits.
+typedef Fixed<int32_t, 16>	Q16;
+
+
+/// Get the default epsilon value for a fixed-point type. This is the
+/// same as the floating point tolerance, but never less than eight
+/// units in the last place, which absorbs the rounding in a handful of
+/// chained products.
+///
+/// @param epsilon The variable to store the epsilon value in.
+template <typename S, int F>
+void
+DefaultEpsilon(Fixed<S, F> &epsilon)
+{
+	Fixed<S, F>	floor = Fixed<S, F>::fromRaw(8);
+
+	epsilon = Fixed<S, F>(0.0001);
+	if (epsilon < floor) {
+		epsilon = floor;
+	}
+}
+
+
+} // namespace math
+} // namespace wr
+
+
+#endif // __WRMATH_MATH_FIXED_H
@@ -0,0 +1,204 @@
+/// \file linalg.h
+/// \brief Small dense linear algebra for fixed-size problems.
+///
+/// These solve the small systems that come up inside the estimators,
+/// such as normal equations and 4x4 eigenproblems, without a general
+/// matrix library. Matrices are row-major arrays of N * N scalars, and
+/// N is a template parameter so the loops can be unrolled.
+#ifndef __WRMATH_MATH_LINALG_H
+#define __WRMATH_MATH_LINALG_H
+
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+
+namespace wr {
+namespace math {
+
+
+/// Solve A x = b for a symmetric positive definite A by Cholesky
+/// decomposition.
+///
+/// @param a The N x N matrix; only the lower triangle is read.
+/// @param b N scalars.
+/// @param x Storage for N scalars; it may be the same as b.
+/// @return False if A isn't positive definite to within rounding, in
+///         which case x is unchanged.
+template <size_t N, typename T>
+bool
+CholeskySolve(const T *a, const T *b, T *x)
+{
+	using std::sqrt;
+
+	T	L[N * N];
+	T	y[N];
+	T	scale = 0;
+
+	for (size_t i = 0; i < N; i++) {
+		scale = a[(i * N) + i] > scale ? a[(i * N) + i] : scale;
+	}
+
+	T	tiny = scale * std::numeric_limits<T>::epsilon() * N;
+
+	for (size_t i = 0; i < N; i++) {
+		for (size_t j = 0; j <= i; j++) {
+			T	s = a[(i * N) + j];
+
+			for (size_t k = 0; k < j; k++) {
+				s -= L[(i * N) + k] * L[(j * N) + k];
+			}
+
+			if (i == j) {
+				if (!(s > tiny)) {
+					return false;
+				}
+				L[(i * N) + i] = sqrt(s);
+			}
+			else {
+				L[(i * N) + j] = s / L[(j * N) + j];
+			}
+		}
+	}
+
+	for (size_t i = 0; i < N; i++) {
+		T	s = b[i];
+
+		for (size_t k = 0; k < i; k++) {
+			s -= L[(i * N) + k] * y[k];
+		}
+		y[i] = s / L[(i * N) + i];
+	}
+
+	for (size_t i = N; i-- > 0;) {
+		T	s = y[i];
+
+		for (size_t k = i + 1; k < N; k++) {
+			s -= L[(k * N) + i] * x[k];
+		}
+		x[i] = s / L[(i * N) + i];
+	}
+	return true;
+}
+
+
+/// Compute the eigenvalues and eigenvectors of a symmetric matrix with
+/// cyclic Jacobi rotations, which is simple and accurate for the small
+/// matrices this is meant for.
+///
+/// @param a The N x N symmetric matrix.
+/// @param values Storage for the N eigenvalues, largest first.
+/// @param vectors Storage for an N x N matrix whose columns are the unit
+///                eigenvectors, in the same order as the values; vector
+///                k is vectors[i * N + k] for i from 0 to N - 1.
+template <size_t N, typename T>
+void
+SymmetricEigen(const T *a, T *values, T *vectors)
+{
+	using std::abs;
+	using std::sqrt;
+
+	T	A[N * N];
+	T	scale = 0;
+
+	for (size_t i = 0; i < N * N; i++) {
+		A[i] = a[i];
+		vectors[i] = (i % (N + 1)) == 0 ? (T)1.0 : (T)0.0;
+		scale += abs(a[i]);
+	}
+
+	T	tiny = scale * std::numeric_limits<T>::epsilon();
+
+	for (size_t sweep = 0; sweep < 32; sweep++) {
+		T	off = 0;
+
+		for (size_t i = 0; i < N; i++) {
+			for (size_t j = i + 1; j < N; j++) {
+				off += abs(A[(i * N) + j]);
+			}
+		}
+		if (!(off > tiny)) {
+			break;
+		}
+
+		for (size_t i = 0; i < N; i++) {
+			for (size_t j = i + 1; j < N; j++) {
+				T	aij = A[(i * N) + j];
+
+				if (abs(aij) <= tiny / (N * N)) {
+					continue;
+				}
+
+				T	theta = (A[(j * N) + j] - A[(i * N) + i]) / (2 * aij);
+				T	t = (T)1.0 / (abs(theta) + sqrt((theta * theta) + 1));
+
+				if (theta < 0) {
+					t = -t;
+				}
+
+				T	c = (T)1.0 / sqrt((t * t) + 1);
+				T	s = t * c;
+
+				// A' = Jᵀ A J, then V' = V J.
+				for (size_t k = 0; k < N; k++) {
+					T	ki = A[(k * N) + i];
+					T	kj = A[(k * N) + j];
+
+					A[(k * N) + i] = (c * ki) - (s * kj);
+					A[(k * N) + j] = (s * ki) + (c * kj);
+				}
+				for (size_t k = 0; k < N; k++) {
+					T	ik = A[(i * N) + k];
+					T	jk = A[(j * N) + k];
+
+					A[(i * N) + k] = (c * ik) - (s * jk);
+					A[(j * N) + k] = (s * ik) + (c * jk);
+				}
+				for (size_t k = 0; k < N; k++) {
+					T	vi = vectors[(k * N) + i];
+					T	vj = vectors[(k * N) + j];
+
+					vectors[(k * N) + i] = (c * vi) - (s * vj);
+					vectors[(k * N) + j] = (s * vi) + (c * vj);
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; i < N; i++) {
+		values[i] = A[(i * N) + i];
+	}
+
+	// Selection sort, largest first, swapping the vectors along.
+	for (size_t i = 0; i < N; i++) {
+		size_t	best = i;
+
+		for (size_t j = i + 1; j < N; j++) {
+			if (values[j] > values[best]) {
+				best = j;
+			}
+		}
+		if (best == i) {
+			continue;
+		}
+
+		T	tv = values[i];
+
+		values[i] = values[best];
+		values[best] = tv;
+		for (size_t k = 0; k < N; k++) {
+			T	t = vectors[(k * N) + i];
+
+			vectors[(k * N) + i] = vectors[(k * N) + best];
+			vectors[(k * N) + best] = t;
+		}
+	}
+}
+
+
+} // namespace math
+} // namespace wr
+
+
+#endif // __WRMATH_MATH_LINALG_H
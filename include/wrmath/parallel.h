@@ -0,0 +1,147 @@
+/// \file parallel.h
+/// \brief A small thread pool for the batch operations.
+///
+/// The batch operations split their input into chunks and hand the
+/// chunks to a ThreadPool. The calling thread always works on chunks
+/// too, so a pool with one thread runs everything inline and costs no
+/// more than a plain loop.
+#ifndef __WRMATH_PARALLEL_H
+#define __WRMATH_PARALLEL_H
+
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace wr {
+/// parallel contains the thread pool used by the batch operations.
+namespace parallel {
+
+
+/// @brief ThreadPool runs a set of numbered tasks across a fixed set of
+/// worker threads and the calling thread.
+///
+/// A pool runs one set of tasks at a time; concurrent calls to run are
+/// serialised. A task that calls run on any pool runs the nested tasks
+/// inline on its own thread, so nesting can't deadlock.
+class ThreadPool {
+public:
+	/// Start a pool.
+	///
+	/// \param threads The total number of threads to run tasks on,
+	///                including the caller of run. Zero uses the
+	///                number of hardware threads.
+	explicit ThreadPool(size_t threads = 0);
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	/// Stop the worker threads.
+	~ThreadPool();
+
+
+	/// Return the number of threads tasks run on, including the caller.
+	///
+	/// \return The number of threads.
+	size_t	size() const { return this->workers.size() + 1; }
+
+
+	/// Run tasks 0 to count - 1, returning when all have finished. The
+	/// order and thread each task runs on are unspecified.
+	///
+	/// \param count The number of tasks.
+	/// \param task The task function, called with each task number.
+	void	run(size_t count, const std::function<void(size_t)> &task);
+
+private:
+	std::vector<std::thread>		 workers;
+	std::mutex				 runLock;
+	std::mutex				 lock;
+	std::condition_variable			 wake;
+	std::condition_variable			 done;
+	const std::function<void(size_t)>	*job;
+	size_t					 jobCount;
+	std::atomic<size_t>			 next;
+	size_t					 pending;
+	uint64_t				 generation;
+	bool					 stopping;
+
+	void	work();
+	void	drain();
+};
+
+
+/// Return the shared pool used when no pool is given, with one thread
+/// per hardware thread. It is started on first use.
+///
+/// \return The default pool.
+ThreadPool	&DefaultPool();
+
+
+/// Split the range [0, count) into chunks of at most grain elements and
+/// run fn(begin, end) on each, in parallel on a pool.
+///
+/// \param count The number of elements.
+/// \param grain The largest chunk; it must not be zero.
+/// \param fn The function to run on each chunk.
+/// \param pool The pool to run on, or nullptr for DefaultPool().
+void	ParallelFor(size_t count, size_t grain,
+		    const std::function<void(size_t, size_t)> &fn,
+		    ThreadPool *pool = nullptr);
+
+
+/// Reduce the range [0, count) in parallel. Each chunk of at most grain
+/// elements is accumulated into its own copy of init, and the partial
+/// results are then combined pairwise in a fixed tree, so the result
+/// depends only on count and grain and not on the number of threads.
+///
+/// \tparam P The partial result type.
+/// \param count The number of elements.
+/// \param grain The largest chunk; it must not be zero.
+/// \param init The initial value of each partial result.
+/// \param accumulate Called as accumulate(begin, end, partial) to add
+///                   a chunk into a partial result.
+/// \param combine Called as combine(a, b) to merge partial result b
+///                into a.
+/// \param pool The pool to run on, or nullptr for DefaultPool().
+/// \return The combined result; init if count is zero.
+template <typename P, typename Accumulate, typename Combine>
+P
+ParallelReduce(size_t count, size_t grain, const P &init,
+	       Accumulate accumulate, Combine combine, ThreadPool *pool = nullptr)
+{
+	assert(grain > 0);
+
+	size_t	chunks = (count + grain - 1) / grain;
+
+	if (chunks == 0) {
+		return init;
+	}
+
+	std::vector<P>	partials(chunks, init);
+
+	ParallelFor(count, grain, [&](size_t begin, size_t end) {
+		accumulate(begin, end, partials[begin / grain]);
+	}, pool);
+
+	for (size_t step = 1; step < chunks; step *= 2) {
+		for (size_t i = 0; i + step < chunks; i += 2 * step) {
+			combine(partials[i], partials[i + step]);
+		}
+	}
+	return partials[0];
+}
+
+
+} // namespace parallel
+} // namespace wr
+
+
+#endif // __WRMATH_PARALLEL_H
@@ -0,0 +1,53 @@
+#include <wrmath/io/codec.h>
+
+
+namespace wr {
+namespace io {
+
+
+constexpr double	SmallestThree::Range;
+
+// Others lists, for each choice of dropped component, the indices of
+// the three components that are stored.
+const uint8_t	SmallestThree::Others[4][3] = {
+	{1, 2, 3},
+	{0, 2, 3},
+	{0, 1, 3},
+	{0, 1, 2},
+};
+
+
+SmallestThree::SmallestThree(unsigned bits) : componentBits(bits)
+{
+	assert(bits >= 2 && bits <= 20);
+
+	this->levels = (static_cast<uint64_t>(1) << bits) - 1;
+	this->packedSize = (2 + (3 * bits) + 7) / 8;
+}
+
+
+double
+SmallestThree::maxAngularError() const
+{
+	double	step = (2.0 * Range) / static_cast<double>(this->levels);
+
+	return 4.0 * std::asin(std::sqrt(3.0) * step / 2.0);
+}
+
+
+SmallestThree
+SmallestThree32()
+{
+	return SmallestThree(10);
+}
+
+
+SmallestThree
+SmallestThree48()
+{
+	return SmallestThree(15);
+}
+
+
+} // namespace io
+} // namespace wr
@@ -0,0 +1,192 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <wrmath/io/format.h>
+
+
+namespace wr {
+namespace io {
+
+
+static const uint64_t	Pow10[FormatMaxPrecision + 1] = {
+	1ULL,
+	10ULL,
+	100ULL,
+	1000ULL,
+	10000ULL,
+	100000ULL,
+	1000000ULL,
+	10000000ULL,
+	100000000ULL,
+	1000000000ULL,
+	10000000000ULL,
+	100000000000ULL,
+	1000000000000ULL,
+	10000000000000ULL,
+	100000000000000ULL,
+	1000000000000000ULL,
+};
+
+// writeDigits writes n in decimal, padded with leading zeros to at
+// least width digits, and returns one past the last digit.
+static char *
+writeDigits(char *out, uint64_t n, unsigned width)
+{
+	char		digits[20];
+	unsigned	len = 0;
+
+	do {
+		digits[len++] = static_cast<char>('0' + (n % 10));
+		n /= 10;
+	} while (n != 0);
+
+	while (len < width) {
+		digits[len++] = '0';
+	}
+	while (len > 0) {
+		*out++ = digits[--len];
+	}
+	return out;
+}
+
+
+// scale10 returns a * 10^k. The power is split in two so that it
+// doesn't overflow for subnormal values of a.
+static double
+scale10(double a, int k)
+{
+	return a * std::pow(10.0, k / 2) * std::pow(10.0, k - (k / 2));
+}
+
+
+// significand rounds a positive, finite value to precision significant
+// digits, returning them as an integer in [10^(precision-1), 10^precision)
+// and setting exponent to the decimal exponent of the first digit.
+static uint64_t
+significand(double a, unsigned precision, int &exponent)
+{
+	uint64_t	low = Pow10[precision - 1];
+	uint64_t	high = Pow10[precision];
+	uint64_t	digits;
+
+	exponent = static_cast<int>(std::floor(std::log10(a)));
+
+	// log10 can be off by one near powers of ten, and rounding can
+	// carry into a new digit; either way the exponent moves by one.
+	for (int tries = 0; tries < 3; tries++) {
+		digits = static_cast<uint64_t>(
+		    scale10(a, static_cast<int>(precision) - 1 - exponent) + 0.5);
+		if (digits >= high) {
+			exponent++;
+		}
+		else if (digits < low) {
+			exponent--;
+		}
+		else {
+			break;
+		}
+	}
+	if (digits >= high) {
+		digits = low;
+		exponent++;
+	}
+	return digits;
+}
+
+
+char *
+FormatScalar(char *first, char *last, double value, unsigned precision)
+{
+	assert(precision <= FormatMaxPrecision);
+
+	char	text[FormatScalarMax];
+	char	*out = text;
+
+	if (first == nullptr) {
+		return nullptr;
+	}
+
+	if (std::isnan(value)) {
+		std::memcpy(out, "nan", 3);
+		out += 3;
+	}
+	else if (std::isinf(value)) {
+		if (value < 0) {
+			*out++ = '-';
+		}
+		std::memcpy(out, "inf", 3);
+		out += 3;
+	}
+	else {
+		double	a = std::fabs(value);
+
+		if (std::signbit(value)) {
+			*out++ = '-';
+		}
+
+		if (a == 0) {
+			*out++ = '0';
+		}
+		else {
+			// As with %g, a precision of zero means one digit.
+			unsigned	p = precision == 0 ? 1 : precision;
+			int		exponent;
+			uint64_t	digits = significand(a, p, exponent);
+
+			// Trailing zeros aren't written.
+			while (p > 1 && digits % 10 == 0) {
+				digits /= 10;
+				p--;
+			}
+
+			unsigned	width = precision == 0 ? 1 : precision;
+
+			if (exponent < -4 || exponent >= static_cast<int>(width)) {
+				out = writeDigits(out, digits / Pow10[p - 1], 1);
+				if (p > 1) {
+					*out++ = '.';
+					out = writeDigits(out, digits % Pow10[p - 1], p - 1);
+				}
+				*out++ = 'e';
+				*out++ = exponent < 0 ? '-' : '+';
+				out = writeDigits(out,
+				    static_cast<uint64_t>(exponent < 0 ? -exponent : exponent), 2);
+			}
+			else if (exponent < 0) {
+				*out++ = '0';
+				*out++ = '.';
+				for (int i = exponent + 1; i < 0; i++) {
+					*out++ = '0';
+				}
+				out = writeDigits(out, digits, p);
+			}
+			else if (static_cast<unsigned>(exponent) + 1 >= p) {
+				out = writeDigits(out, digits, p);
+				for (unsigned i = p; i < static_cast<unsigned>(exponent) + 1; i++) {
+					*out++ = '0';
+				}
+			}
+			else {
+				uint64_t	split = Pow10[p - 1 - exponent];
+
+				out = writeDigits(out, digits / split, 1);
+				*out++ = '.';
+				out = writeDigits(out, digits % split,
+						  p - 1 - static_cast<unsigned>(exponent));
+			}
+		}
+	}
+
+	size_t	len = static_cast<size_t>(out - text);
+
+	if (static_cast<size_t>(last - first) < len) {
+		return nullptr;
+	}
+	std::memcpy(first, text, len);
+	return first + len;
+}
+
+
+} // namespace io
+} // namespace wr
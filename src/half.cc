@@ -0,0 +1,185 @@
+#include <cstring>
+
+// On x86 the batch conversions are compiled for F16C with a target
+// attribute, whatever the flags the library is built with, and chosen
+// at run time if the processor has it.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define WRMATH_HALF_F16C
+#include <immintrin.h>
+#endif
+
+#include <wrmath/io/half.h>
+
+
+namespace wr {
+namespace io {
+
+
+// The scalar conversions follow Fabian Giesen's branch-light
+// float/half routines, using float arithmetic to handle rounding of
+// subnormal values.
+
+static inline uint32_t
+floatBits(float f)
+{
+	uint32_t	u;
+
+	std::memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+
+static inline float
+bitsFloat(uint32_t u)
+{
+	float	f;
+
+	std::memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+
+uint16_t
+FloatToHalf(float f)
+{
+	const uint32_t	f32Infinity = 255 << 23;
+	const uint32_t	f16Max = (127 + 16) << 23;
+	const uint32_t	denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+	uint32_t	u = floatBits(f);
+	uint32_t	sign = u & 0x80000000;
+	uint16_t	h;
+
+	u ^= sign;
+	if (u >= f16Max) {
+		// Overflow becomes infinity; NaN stays a quiet NaN.
+		h = (u > f32Infinity) ? 0x7e00 : 0x7c00;
+	}
+	else if (u < (113 << 23)) {
+		// The result is subnormal or zero: let the FPU do the
+		// rounding by adding a value whose ulp is the half ulp.
+		u = floatBits(bitsFloat(u) + bitsFloat(denormMagic));
+		h = static_cast<uint16_t>(u - denormMagic);
+	}
+	else {
+		uint32_t	mantissaOdd = (u >> 13) & 1;
+
+		// Rebias the exponent and round to nearest even.
+		u += (static_cast<uint32_t>(15 - 127) << 23) + 0xfff;
+		u += mantissaOdd;
+		h = static_cast<uint16_t>(u >> 13);
+	}
+
+	return h | static_cast<uint16_t>(sign >> 16);
+}
+
+
+float
+HalfToFloat(uint16_t h)
+{
+	const uint32_t	shiftedExp = 0x7c00 << 13;
+	const float	magic = bitsFloat(113 << 23);
+	uint32_t	u = static_cast<uint32_t>(h & 0x7fff) << 13;
+	uint32_t	exp = shiftedExp & u;
+
+	u += (127 - 15) << 23;
+	if (exp == shiftedExp) {
+		// Infinity or NaN.
+		u += (128 - 16) << 23;
+	}
+	else if (exp == 0) {
+		// Zero or subnormal: renormalise.
+		u += 1 << 23;
+		u = floatBits(bitsFloat(u) - magic);
+	}
+
+	return bitsFloat(u | (static_cast<uint32_t>(h & 0x8000) << 16));
+}
+
+
+#if defined(WRMATH_HALF_F16C)
+
+// widenF16C converts whole groups of eight values and returns how many
+// it converted.
+__attribute__((target("avx,f16c")))
+static size_t
+widenF16C(const uint16_t *in, float *out, size_t n)
+{
+	size_t	i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m128i	h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+		_mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+	}
+	return i;
+}
+
+
+__attribute__((target("avx,f16c")))
+static size_t
+narrowF16C(const float *in, uint16_t *out, size_t n)
+{
+	size_t	i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m128i	h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i),
+					    _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), h);
+	}
+	return i;
+}
+
+#endif
+
+
+bool
+HalfAccelerated()
+{
+#if defined(WRMATH_HALF_F16C)
+	static const bool	f16c = []() {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+	}();
+
+	return f16c;
+#else
+	return false;
+#endif
+}
+
+
+void
+WidenHalf(const uint16_t *in, float *out, size_t n)
+{
+	size_t	i = 0;
+
+#if defined(WRMATH_HALF_F16C)
+	if (HalfAccelerated()) {
+		i = widenF16C(in, out, n);
+	}
+#endif
+
+	for (; i < n; i++) {
+		out[i] = HalfToFloat(in[i]);
+	}
+}
+
+
+void
+NarrowHalf(const float *in, uint16_t *out, size_t n)
+{
+	size_t	i = 0;
+
+#if defined(WRMATH_HALF_F16C)
+	if (HalfAccelerated()) {
+		i = narrowF16C(in, out, n);
+	}
+#endif
+
+	for (; i < n; i++) {
+		out[i] = FloatToHalf(in[i]);
+	}
+}
+
+
+} // namespace io
+} // namespace wr
@@ -0,0 +1,77 @@
+#include <cstring>
+#include <map>
+#include <string>
+
+#include <wrmath/instrument.h>
+
+
+namespace wr {
+namespace instrument {
+
+
+// Counters are pushed onto a lock-free list as they are constructed,
+// which may happen concurrently on first use.
+static std::atomic<Counter *>	counters(nullptr);
+
+
+Counter::Counter(const char *name) : label(name), count(0), next(nullptr)
+{
+	Counter	*head = counters.load(std::memory_order_relaxed);
+
+	do {
+		this->next = head;
+	} while (!counters.compare_exchange_weak(head, this,
+						 std::memory_order_release,
+						 std::memory_order_relaxed));
+}
+
+
+const Counter *
+Counter::first()
+{
+	return counters.load(std::memory_order_acquire);
+}
+
+
+uint64_t
+Count(const char *name)
+{
+	uint64_t	total = 0;
+
+	for (const Counter *c = Counter::first(); c != nullptr; c = c->nextCounter()) {
+		if (std::strcmp(c->name(), name) == 0) {
+			total += c->value();
+		}
+	}
+	return total;
+}
+
+
+void
+Reset()
+{
+	for (const Counter *c = Counter::first(); c != nullptr; c = c->nextCounter()) {
+		const_cast<Counter *>(c)->reset();
+	}
+}
+
+
+void
+Dump(std::ostream &outs)
+{
+	std::map<std::string, uint64_t>	totals;
+
+	for (const Counter *c = Counter::first(); c != nullptr; c = c->nextCounter()) {
+		if (c->value() != 0) {
+			totals[c->name()] += c->value();
+		}
+	}
+
+	for (auto it = totals.begin(); it != totals.end(); it++) {
+		outs << it->first << " " << it->second << std::endl;
+	}
+}
+
+
+} // namespace instrument
+} // namespace wr
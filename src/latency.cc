@@ -0,0 +1,197 @@
+#include <cmath>
+#include <limits>
+
+#include <wrmath/filter/latency.h>
+
+
+namespace wr {
+namespace filter {
+
+
+constexpr unsigned	LatencyHistogram::SubBucketBits;
+constexpr unsigned	LatencyHistogram::MaxValueBits;
+constexpr size_t	LatencyHistogram::BucketCount;
+
+
+static const uint64_t	SubBuckets = static_cast<uint64_t>(1) << LatencyHistogram::SubBucketBits;
+
+
+static unsigned
+highestBit(uint64_t v)
+{
+#if defined(__GNUC__)
+	return 63 - __builtin_clzll(v);
+#else
+	unsigned	m = 0;
+
+	while (v >>= 1) {
+		m++;
+	}
+	return m;
+#endif
+}
+
+
+LatencyHistogram::LatencyHistogram()
+{
+	this->reset();
+}
+
+
+size_t
+LatencyHistogram::bucket(uint64_t ns)
+{
+	// Values below 2 * SubBuckets have a bucket each; above that, the
+	// top SubBucketBits + 1 bits of the value select the bucket within
+	// its power of two.
+	if (ns < 2 * SubBuckets) {
+		return static_cast<size_t>(ns);
+	}
+	if (ns >= (static_cast<uint64_t>(1) << MaxValueBits)) {
+		return BucketCount - 1;
+	}
+
+	unsigned	e = highestBit(ns) - SubBucketBits;
+
+	return static_cast<size_t>((e * SubBuckets) + (ns >> e));
+}
+
+
+uint64_t
+LatencyHistogram::bucketLower(size_t i)
+{
+	if (i < 2 * SubBuckets) {
+		return i;
+	}
+
+	unsigned	e = static_cast<unsigned>(i / SubBuckets) - 1;
+
+	return (i - (e * SubBuckets)) << e;
+}
+
+
+uint64_t
+LatencyHistogram::bucketUpper(size_t i)
+{
+	if (i < 2 * SubBuckets) {
+		return i;
+	}
+
+	unsigned	e = static_cast<unsigned>(i / SubBuckets) - 1;
+
+	return ((i - (e * SubBuckets) + 1) << e) - 1;
+}
+
+
+void
+LatencyHistogram::record(uint64_t ns)
+{
+	this->counts[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+	this->total.fetch_add(1, std::memory_order_relaxed);
+	this->sum.fetch_add(ns, std::memory_order_relaxed);
+
+	uint64_t	cur = this->minimum.load(std::memory_order_relaxed);
+	while (ns < cur && !this->minimum.compare_exchange_weak(cur, ns,
+	    std::memory_order_relaxed)) ;
+
+	cur = this->maximum.load(std::memory_order_relaxed);
+	while (ns > cur && !this->maximum.compare_exchange_weak(cur, ns,
+	    std::memory_order_relaxed)) ;
+}
+
+
+uint64_t
+LatencyHistogram::count() const
+{
+	return this->total.load(std::memory_order_relaxed);
+}
+
+
+uint64_t
+LatencyHistogram::min() const
+{
+	uint64_t	m = this->minimum.load(std::memory_order_relaxed);
+
+	return m == std::numeric_limits<uint64_t>::max() ? 0 : m;
+}
+
+
+uint64_t
+LatencyHistogram::max() const
+{
+	return this->maximum.load(std::memory_order_relaxed);
+}
+
+
+double
+LatencyHistogram::mean() const
+{
+	uint64_t	n = this->count();
+
+	if (n == 0) {
+		return 0.0;
+	}
+	return static_cast<double>(this->sum.load(std::memory_order_relaxed)) / n;
+}
+
+
+uint64_t
+LatencyHistogram::percentile(double p) const
+{
+	uint64_t	n = this->count();
+
+	if (n == 0) {
+		return 0;
+	}
+
+	p = p < 0.0 ? 0.0 : p > 1.0 ? 1.0 : p;
+
+	uint64_t	target = static_cast<uint64_t>(std::ceil(p * n));
+	uint64_t	seen = 0;
+	uint64_t	hi = this->max();
+
+	target = target == 0 ? 1 : target;
+	for (size_t i = 0; i < BucketCount; i++) {
+		seen += this->counts[i].load(std::memory_order_relaxed);
+		if (seen >= target) {
+			uint64_t	upper = bucketUpper(i);
+
+			return (i == BucketCount - 1 || upper > hi) ? hi : upper;
+		}
+	}
+
+	// Only reachable if the buckets were updated after count() was
+	// read.
+	return hi;
+}
+
+
+void
+LatencyHistogram::reset()
+{
+	for (size_t i = 0; i < BucketCount; i++) {
+		this->counts[i].store(0, std::memory_order_relaxed);
+	}
+	this->total.store(0, std::memory_order_relaxed);
+	this->sum.store(0, std::memory_order_relaxed);
+	this->minimum.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+	this->maximum.store(0, std::memory_order_relaxed);
+}
+
+
+std::ostream &
+operator<<(std::ostream &outs, const LatencyHistogram &h)
+{
+	outs << "count=" << h.count()
+	     << " min=" << h.min()
+	     << " p50=" << h.p50()
+	     << " p99=" << h.p99()
+	     << " p999=" << h.p999()
+	     << " max=" << h.max()
+	     << " mean=" << h.mean();
+	return outs;
+}
+
+
+} // namespace filter
+} // namespace wr
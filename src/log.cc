@@ -0,0 +1,104 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <wrmath/io/log.h>
+
+
+namespace wr {
+namespace io {
+
+
+size_t
+LogWidth(LogKind kind)
+{
+	switch (kind) {
+	case LogKind::Quaternion:
+		return 4;
+	case LogKind::Vector3:
+		return 3;
+	}
+	return 0;
+}
+
+
+bool
+LogValidHeader(const LogHeader &header, size_t scalarSize, uint64_t fileSize)
+{
+	if (std::memcmp(header.magic, LogMagic, sizeof(header.magic)) != 0) {
+		return false;
+	}
+
+	if (header.endian != LogEndianMarker || header.version != LogVersion) {
+		return false;
+	}
+
+	if (header.scalarSize != scalarSize || header.blockSize == 0) {
+		return false;
+	}
+
+	if (LogWidth(static_cast<LogKind>(header.kind)) == 0) {
+		return false;
+	}
+
+	// Guard the index bounds against overflow before comparing them
+	// to the file size.
+	if (header.indexOffset < sizeof(LogHeader) ||
+	    header.indexOffset > fileSize ||
+	    header.blockCount > (fileSize - header.indexOffset) / sizeof(LogBlockEntry)) {
+		return false;
+	}
+
+	return header.indexOffset % LogAlignment == 0;
+}
+
+
+bool
+MappedFile::open(const std::string &path)
+{
+	struct stat	st;
+	void		*addr;
+	int		 fd;
+
+	this->close();
+
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+
+	if (fstat(fd, &st) == -1 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+
+	addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		return false;
+	}
+
+	// Logs are almost always read front to back.
+	madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+	this->base = static_cast<const uint8_t *>(addr);
+	this->length = st.st_size;
+	return true;
+}
+
+
+void
+MappedFile::close()
+{
+	if (this->base != nullptr) {
+		munmap(const_cast<uint8_t *>(this->base), this->length);
+	}
+
+	this->base = nullptr;
+	this->length = 0;
+}
+
+
+} // namespace io
+} // namespace wr
@@ -0,0 +1,162 @@
+#include <cassert>
+
+#include <wrmath/parallel.h>
+
+
+namespace wr {
+namespace parallel {
+
+
+// Set while a thread is running pool tasks, so that nested calls to run
+// execute inline.
+static thread_local bool	inTask = false;
+
+
+ThreadPool::ThreadPool(size_t threads) :
+	job(nullptr), jobCount(0), next(0), pending(0), generation(0),
+	stopping(false)
+{
+	if (threads == 0) {
+		threads = std::thread::hardware_concurrency();
+	}
+
+	for (size_t i = 1; i < threads; i++) {
+		this->workers.push_back(std::thread(&ThreadPool::work, this));
+	}
+}
+
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex>	guard(this->lock);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+
+	for (auto &worker : this->workers) {
+		worker.join();
+	}
+}
+
+
+void
+ThreadPool::drain()
+{
+	size_t	i;
+	bool	nested = inTask;
+
+	inTask = true;
+	while ((i = this->next.fetch_add(1, std::memory_order_relaxed)) < this->jobCount) {
+		(*this->job)(i);
+	}
+	inTask = nested;
+}
+
+
+void
+ThreadPool::work()
+{
+	uint64_t	seen = 0;
+
+	for (;;) {
+		{
+			std::unique_lock<std::mutex>	guard(this->lock);
+
+			this->wake.wait(guard, [this, seen] {
+				return this->stopping || this->generation != seen;
+			});
+			if (this->stopping) {
+				return;
+			}
+			seen = this->generation;
+		}
+
+		this->drain();
+
+		std::lock_guard<std::mutex>	guard(this->lock);
+		if (--this->pending == 0) {
+			this->done.notify_one();
+		}
+	}
+}
+
+
+void
+ThreadPool::run(size_t count, const std::function<void(size_t)> &task)
+{
+	if (count == 0) {
+		return;
+	}
+
+	if (inTask || this->workers.empty() || count == 1) {
+		bool	nested = inTask;
+
+		inTask = true;
+		for (size_t i = 0; i < count; i++) {
+			task(i);
+		}
+		inTask = nested;
+		return;
+	}
+
+	std::lock_guard<std::mutex>	serial(this->runLock);
+
+	{
+		std::lock_guard<std::mutex>	guard(this->lock);
+
+		this->job = &task;
+		this->jobCount = count;
+		this->next.store(0, std::memory_order_relaxed);
+		this->pending = this->workers.size();
+		this->generation++;
+	}
+	this->wake.notify_all();
+
+	this->drain();
+
+	std::unique_lock<std::mutex>	guard(this->lock);
+	this->done.wait(guard, [this] { return this->pending == 0; });
+	this->job = nullptr;
+}
+
+
+ThreadPool &
+DefaultPool()
+{
+	static ThreadPool	pool;
+
+	return pool;
+}
+
+
+void
+ParallelFor(size_t count, size_t grain,
+	    const std::function<void(size_t, size_t)> &fn, ThreadPool *pool)
+{
+	assert(grain > 0);
+
+	size_t	chunks = (count + grain - 1) / grain;
+
+	if (chunks <= 1) {
+		if (count > 0) {
+			fn(0, count);
+		}
+		return;
+	}
+
+	if (pool == nullptr) {
+		pool = &DefaultPool();
+	}
+
+	pool->run(chunks, [&fn, count, grain](size_t c) {
+		size_t	begin = c * grain;
+		size_t	end = begin + grain < count ? begin + grain : count;
+
+		fn(begin, end);
+	});
+}
+
+
+} // namespace parallel
+} // namespace wr
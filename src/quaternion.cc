@@ -1,5 +1,6 @@
 #include <iostream>
 #include <wrmath/geom/quaternion.h>
+#include <wrmath/instrument.h>
 
 
 namespace wr {
@@ -9,6 +10,9 @@ namespace geom {
 Quaternionf
 quaternionf(Vector3f axis, float angle)
 {
+	WRMATH_COUNT("quaternion");
+	WRMATH_COUNT("sin");
+	WRMATH_COUNT("cos");
 	return Quaternionf(axis.unitVector() * std::sin(angle / 2.0),
 			   std::cos(angle / 2.0));
 }
@@ -17,6 +21,9 @@ quaternionf(Vector3f axis, float angle)
 Quaterniond
 quaterniond(Vector3d axis, double angle)
 {
+	WRMATH_COUNT("quaternion");
+	WRMATH_COUNT("sin");
+	WRMATH_COUNT("cos");
 	return Quaterniond(axis.unitVector() * std::sin(angle / 2.0),
 			   std::cos(angle / 2.0));
 }
@@ -25,6 +32,9 @@ quaterniond(Vector3d axis, double angle)
 Quaternionf
 quaternionf_from_euler(Vector3f euler)
 {
+	WRMATH_COUNT("quaternion_from_euler");
+	WRMATH_COUNT_N("sin", 3);
+	WRMATH_COUNT_N("cos", 3);
 	float x, y, z, w;
 	euler = euler / 2.0;
 
@@ -47,6 +57,9 @@ quaternionf_from_euler(Vector3f euler)
 Quaterniond
 quaterniond_from_euler(Vector3d euler)
 {
+	WRMATH_COUNT("quaternion_from_euler");
+	WRMATH_COUNT_N("sin", 3);
+	WRMATH_COUNT_N("cos", 3);
 	double x, y, z, w;
 	euler = euler / 2.0;
 
@@ -0,0 +1,261 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/filter/calibration.h>
+#include <wrmath/math/linalg.h>
+
+using namespace std;
+using namespace wr;
+
+
+// The distortion used by the tests: raw = Winv (B u) + offset, for unit
+// vectors u. Winv is symmetric with determinant 1.2.
+static const double	Winv[9] = {
+	1.10, 0.08, -0.03,
+	0.08, 0.95, 0.05,
+	-0.03, 0.05, 1.12,
+};
+static const double	Offset[3] = {-12.0, 31.5, 7.25};
+static const double	Field = 48.0;
+
+
+static double
+det3(const double *m)
+{
+	return (m[0] * ((m[4] * m[8]) - (m[5] * m[7]))) -
+	       (m[1] * ((m[3] * m[8]) - (m[5] * m[6]))) +
+	       (m[2] * ((m[3] * m[7]) - (m[4] * m[6])));
+}
+
+
+static vector<double>
+distortedSamples(mt19937 &rng, size_t n, double noise, const double *offset = Offset)
+{
+	normal_distribution<double>	dist;
+	vector<double>			out(n * 3);
+
+	for (size_t i = 0; i < n; i++) {
+		double	u[3] = {dist(rng), dist(rng), dist(rng)};
+		double	len = sqrt((u[0] * u[0]) + (u[1] * u[1]) + (u[2] * u[2]));
+
+		for (size_t j = 0; j < 3; j++) {
+			double	v = 0;
+
+			for (size_t k = 0; k < 3; k++) {
+				v += Winv[(j * 3) + k] * u[k] * Field / len;
+			}
+			out[(i * 3) + j] = v + offset[j] + (noise * dist(rng));
+		}
+	}
+	return out;
+}
+
+
+TEST(Linalg, CholeskySolve)
+{
+	double	a[9] = {4, 2, 0.4, 2, 5, 1, 0.4, 1, 3};
+	double	x0[3] = {1, -2, 0.5};
+	double	b[3], x[3];
+
+	for (size_t i = 0; i < 3; i++) {
+		b[i] = (a[i * 3] * x0[0]) + (a[(i * 3) + 1] * x0[1]) + (a[(i * 3) + 2] * x0[2]);
+	}
+	ASSERT_TRUE(math::CholeskySolve<3>(a, b, x));
+	for (size_t i = 0; i < 3; i++) {
+		EXPECT_NEAR(x[i], x0[i], 1e-12);
+	}
+
+	double	singular[4] = {1, 1, 1, 1};
+
+	EXPECT_FALSE(math::CholeskySolve<2>(singular, b, x));
+}
+
+
+TEST(Linalg, SymmetricEigen)
+{
+	double	values[3], vectors[9];
+
+	math::SymmetricEigen<3>(Winv, values, vectors);
+	EXPECT_GE(values[0], values[1]);
+	EXPECT_GE(values[1], values[2]);
+	EXPECT_NEAR(values[0] * values[1] * values[2], det3(Winv), 1e-12);
+
+	// A v = λ v for each column.
+	for (size_t k = 0; k < 3; k++) {
+		for (size_t i = 0; i < 3; i++) {
+			double	av = 0;
+
+			for (size_t j = 0; j < 3; j++) {
+				av += Winv[(i * 3) + j] * vectors[(j * 3) + k];
+			}
+			EXPECT_NEAR(av, values[k] * vectors[(i * 3) + k], 1e-12);
+		}
+	}
+}
+
+
+TEST(MagnetometerCalibration, Ellipsoid)
+{
+	mt19937				rng(1);
+	vector<double>			raw = distortedSamples(rng, 2000, 0.0);
+	filter::MagnetometerCalibrationd	cal;
+
+	EXPECT_FALSE(cal.calibrated());
+	EXPECT_FALSE(cal.solve());
+	cal.addSamples(raw.data(), raw.size() / 3);
+	EXPECT_EQ(cal.samples(), 2000u);
+	ASSERT_TRUE(cal.solve());
+	EXPECT_TRUE(cal.calibrated());
+
+	// The corrected sphere has the volume of the ellipsoid.
+	double	expected = Field * cbrt(det3(Winv));
+
+	EXPECT_NEAR(cal.fieldStrength(), expected, 1e-6);
+	EXPECT_LT(cal.fitError(), 1e-6);
+
+	geom::Vector3d	offset = cal.offset();
+
+	for (size_t j = 0; j < 3; j++) {
+		EXPECT_NEAR(offset[j], Offset[j], 1e-6);
+	}
+
+	// W is Winv⁻¹ scaled to keep the volume.
+	double	W[9];
+
+	cal.softIron(W);
+	for (size_t i = 0; i < 3; i++) {
+		for (size_t j = 0; j < 3; j++) {
+			double	p = 0;
+
+			for (size_t k = 0; k < 3; k++) {
+				p += W[(i * 3) + k] * Winv[(k * 3) + j];
+			}
+			EXPECT_NEAR(p, i == j ? cbrt(det3(Winv)) : 0.0, 1e-9);
+		}
+	}
+
+	vector<double>	corrected(raw.size());
+
+	cal.apply(raw.data(), corrected.data(), raw.size() / 3);
+	for (size_t i = 0; i < raw.size() / 3; i += 37) {
+		geom::Vector3d	v(&corrected[i * 3]);
+
+		EXPECT_NEAR(v.magnitude(), expected, 1e-6);
+		EXPECT_EQ(cal.apply(geom::Vector3d(&raw[i * 3])), v);
+	}
+}
+
+
+TEST(MagnetometerCalibration, Noisy)
+{
+	mt19937				rng(2);
+	vector<double>			raw = distortedSamples(rng, 5000, 0.5);
+	filter::MagnetometerCalibrationd	cal;
+
+	for (size_t i = 0; i < raw.size() / 3; i++) {
+		cal.addSample(geom::Vector3d(&raw[i * 3]));
+	}
+	ASSERT_TRUE(cal.solve());
+	EXPECT_NEAR(cal.fieldStrength(), Field * cbrt(det3(Winv)), 0.2);
+	EXPECT_GT(cal.fitError(), 1e-3);
+	EXPECT_LT(cal.fitError(), 5e-2);
+	for (size_t j = 0; j < 3; j++) {
+		EXPECT_NEAR(cal.offset()[j], Offset[j], 0.1);
+	}
+}
+
+
+TEST(MagnetometerCalibration, HardIron)
+{
+	mt19937				rng(3);
+	normal_distribution<double>	dist;
+	filter::MagnetometerCalibrationd	cal;
+
+	for (int i = 0; i < 500; i++) {
+		geom::Vector3d	u = geom::Vector3d{dist(rng), dist(rng), dist(rng)}.unitVector();
+
+		cal.addSample((u * 30.0) + geom::Vector3d(Offset));
+	}
+	ASSERT_TRUE(cal.solveHardIron());
+	EXPECT_NEAR(cal.fieldStrength(), 30.0, 1e-9);
+	EXPECT_LT(cal.fitError(), 1e-6);
+	for (size_t j = 0; j < 3; j++) {
+		EXPECT_NEAR(cal.offset()[j], Offset[j], 1e-9);
+	}
+
+	double	W[9];
+
+	cal.softIron(W);
+	EXPECT_EQ(W[0], 1.0);
+	EXPECT_EQ(W[1], 0.0);
+
+	// The full fit agrees for a sphere.
+	ASSERT_TRUE(cal.solve());
+	EXPECT_NEAR(cal.fieldStrength(), 30.0, 1e-6);
+}
+
+
+TEST(MagnetometerCalibration, Planar)
+{
+	filter::MagnetometerCalibrationd	cal;
+
+	// Rotating only about z leaves the ellipsoid undetermined.
+	for (int i = 0; i < 360; i++) {
+		double	a = i * M_PI / 180.0;
+
+		cal.addSample(geom::Vector3d{20.0 * cos(a) + 3.0, 20.0 * sin(a) - 1.0, 40.0});
+	}
+	EXPECT_FALSE(cal.solve());
+	EXPECT_FALSE(cal.calibrated());
+	EXPECT_EQ(cal.apply(geom::Vector3d{1.0, 2.0, 3.0}), (geom::Vector3d{1.0, 2.0, 3.0}));
+
+	cal.reset();
+	EXPECT_EQ(cal.samples(), 0u);
+}
+
+
+TEST(MagnetometerCalibration, Forgetting)
+{
+	mt19937				rng(4);
+	double				moved[3] = {5.0, -20.0, 15.0};
+	vector<double>			before = distortedSamples(rng, 3000, 0.0);
+	vector<double>			after = distortedSamples(rng, 3000, 0.0, moved);
+	filter::MagnetometerCalibrationd	cal(0.995);
+
+	cal.addSamples(before.data(), before.size() / 3);
+	ASSERT_TRUE(cal.solve());
+	EXPECT_NEAR(cal.offset()[1], Offset[1], 1e-3);
+
+	// After the environment changes, the old samples decay away.
+	cal.addSamples(after.data(), after.size() / 3);
+	ASSERT_TRUE(cal.solve());
+	for (size_t j = 0; j < 3; j++) {
+		EXPECT_NEAR(cal.offset()[j], moved[j], 1e-3);
+	}
+}
+
+
+TEST(MagnetometerCalibration, Float)
+{
+	mt19937				rng(5);
+	vector<double>			raw = distortedSamples(rng, 1000, 0.0);
+	vector<float>			rawf(raw.begin(), raw.end());
+	filter::MagnetometerCalibrationf	cal;
+
+	cal.addSamples(rawf.data(), rawf.size() / 3);
+	ASSERT_TRUE(cal.solve());
+	EXPECT_NEAR(cal.fieldStrength(), Field * cbrt(det3(Winv)), 0.5);
+	for (size_t j = 0; j < 3; j++) {
+		EXPECT_NEAR(cal.offset()[j], Offset[j], 0.5);
+	}
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,176 @@
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/chain.h>
+
+using namespace std;
+using namespace wr;
+
+
+// An arm of three joints from a base, and a camera on a second branch
+// from the base:
+//
+//   0 base -> 1 shoulder -> 2 elbow -> 3 wrist
+//          -> 4 camera
+static geom::KinematicChaind
+testChain()
+{
+	geom::KinematicChaind	chain;
+
+	chain.addJoint(geom::KinematicChaind::NoParent,
+		       geom::quaterniond(geom::Vector3d{0, 0, 1}, 0.3),
+		       geom::Vector3d{1, 2, 0});
+	chain.addJoint(0, geom::quaterniond(geom::Vector3d{0, 1, 0}, 0.5),
+		       geom::Vector3d{0, 0, 1});
+	chain.addJoint(1, geom::quaterniond(geom::Vector3d{0, 1, 0}, -0.7),
+		       geom::Vector3d{1, 0, 0});
+	chain.addJoint(2, geom::quaterniond(geom::Vector3d{1, 0, 0}, 1.1),
+		       geom::Vector3d{0.5, 0, 0});
+	chain.addJoint(0, geom::quaterniond(geom::Vector3d{1, 1, 0}, 0.2),
+		       geom::Vector3d{0, 0.2, 0.4});
+	return chain;
+}
+
+
+// Compute a joint's world pose the slow way, with Quaternion products.
+static void
+referencePose(const geom::KinematicChaind &chain, size_t i,
+	      geom::Quaterniond &rot, geom::Vector3d &trans)
+{
+	size_t	p = chain.parent(i);
+
+	if (p == geom::KinematicChaind::NoParent) {
+		rot = chain.rotation(i);
+		trans = chain.translation(i);
+		return;
+	}
+
+	geom::Quaterniond	prot;
+	geom::Vector3d		ptrans;
+
+	referencePose(chain, p, prot, ptrans);
+	rot = chain.rotation(i) * prot;
+	trans = ptrans + prot.rotate(chain.translation(i));
+}
+
+
+static void
+expectMatchesReference(geom::KinematicChaind &chain)
+{
+	for (size_t i = 0; i < chain.size(); i++) {
+		geom::Quaterniond	rot;
+		geom::Vector3d		trans;
+
+		referencePose(chain, i, rot, trans);
+		EXPECT_EQ(chain.worldRotation(i), rot) << "joint " << i;
+		EXPECT_EQ(chain.worldTranslation(i), trans) << "joint " << i;
+	}
+}
+
+
+TEST(KinematicChain, WorldPoses)
+{
+	geom::KinematicChaind	chain = testChain();
+
+	EXPECT_EQ(chain.size(), 5u);
+	EXPECT_EQ(chain.update(), 5u);
+	EXPECT_EQ(chain.update(), 0u);
+	expectMatchesReference(chain);
+
+	geom::Vector3d	point {0.1, -0.2, 0.3};
+	geom::Quaterniond	rot;
+	geom::Vector3d		trans;
+
+	referencePose(chain, 3, rot, trans);
+	EXPECT_EQ(chain.transform(3, point), rot.rotate(point) + trans);
+}
+
+
+TEST(KinematicChain, IncrementalUpdate)
+{
+	geom::KinematicChaind	chain = testChain();
+
+	chain.update();
+
+	// A leaf recomputes only itself.
+	chain.setRotation(3, geom::quaterniond(geom::Vector3d{1, 0, 0}, -0.4));
+	EXPECT_EQ(chain.update(), 1u);
+	expectMatchesReference(chain);
+
+	// The elbow recomputes itself and the wrist, but not the camera.
+	chain.setRotation(2, geom::quaterniond(geom::Vector3d{0, 1, 0}, 0.9));
+	EXPECT_EQ(chain.update(), 2u);
+	expectMatchesReference(chain);
+
+	// The camera branch doesn't touch the arm.
+	chain.setTranslation(4, geom::Vector3d{0, 0.3, 0.4});
+	EXPECT_EQ(chain.update(), 1u);
+	expectMatchesReference(chain);
+
+	// Two changes on one branch are recomputed once.
+	chain.setRotation(1, geom::quaterniond(geom::Vector3d{0, 1, 0}, 0.1));
+	chain.setRotation(3, geom::quaterniond(geom::Vector3d{1, 0, 0}, 0.2));
+	EXPECT_EQ(chain.update(), 3u);
+	expectMatchesReference(chain);
+
+	// The base moves everything.
+	chain.setLocal(0, geom::quaterniond(geom::Vector3d{0, 0, 1}, -1.0),
+		       geom::Vector3d{3, 0, 0});
+	EXPECT_EQ(chain.update(), 5u);
+	expectMatchesReference(chain);
+}
+
+
+TEST(KinematicChain, Evaluate)
+{
+	geom::KinematicChaind	chain = testChain();
+	const size_t		configs = 4;
+	const size_t		n = chain.size();
+	vector<double>		rotations(configs * n * 4);
+	vector<double>		poses(configs * n * geom::KinematicChaind::PoseSize);
+
+	for (size_t c = 0; c < configs; c++) {
+		for (size_t i = 0; i < n; i++) {
+			geom::Quaterniond	q = geom::quaterniond(
+			    geom::Vector3d{1.0, (double)i, (double)c}, 0.1 * (c + i));
+			geom::Vector3d		axis = q.axis();
+			double			*r = &rotations[((c * n) + i) * 4];
+
+			r[0] = q.angle();
+			r[1] = axis[0];
+			r[2] = axis[1];
+			r[3] = axis[2];
+		}
+	}
+
+	chain.evaluate(rotations.data(), poses.data(), configs);
+
+	for (size_t c = 0; c < configs; c++) {
+		geom::KinematicChaind	expected = testChain();
+
+		for (size_t i = 0; i < n; i++) {
+			const double	*r = &rotations[((c * n) + i) * 4];
+			expected.setRotation(i, geom::Quaterniond{r[0], r[1], r[2], r[3]});
+		}
+
+		const double	*want = expected.worldPoses();
+		const double	*got = &poses[c * n * geom::KinematicChaind::PoseSize];
+
+		for (size_t k = 0; k < n * geom::KinematicChaind::PoseSize; k++) {
+			EXPECT_NEAR(got[k], want[k], 1e-12);
+		}
+	}
+
+	// evaluate doesn't change the chain.
+	expectMatchesReference(chain);
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
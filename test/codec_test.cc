@@ -0,0 +1,127 @@
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/io/codec.h>
+
+using namespace std;
+using namespace wr;
+
+
+// The rotation angle between two unit quaternions, treating q and -q
+// as the same rotation.
+template <typename T>
+static double
+rotationError(const T *p, const T *q)
+{
+	double	dot = 0;
+
+	for (int i = 0; i < 4; i++) {
+		dot += (double)p[i] * (double)q[i];
+	}
+	dot = std::abs(dot);
+	return 2.0 * std::acos(dot > 1.0 ? 1.0 : dot);
+}
+
+
+template <typename T>
+static vector<T>
+randomQuaternions(size_t count)
+{
+	mt19937				rng(1);
+	normal_distribution<double>	dist;
+	vector<T>			q(count * 4);
+
+	for (size_t i = 0; i < count; i++) {
+		double	c[4], n = 0;
+
+		for (int j = 0; j < 4; j++) {
+			c[j] = dist(rng);
+			n += c[j] * c[j];
+		}
+		for (int j = 0; j < 4; j++) {
+			q[(i * 4) + j] = (T)(c[j] / std::sqrt(n));
+		}
+	}
+	return q;
+}
+
+
+TEST(SmallestThree, PackedSizes)
+{
+	EXPECT_EQ(io::SmallestThree32().size(), 4u);
+	EXPECT_EQ(io::SmallestThree48().size(), 6u);
+	EXPECT_EQ(io::SmallestThree(20).size(), 8u);
+
+	EXPECT_NEAR(io::SmallestThree32().maxAngularError(), 4.789e-3, 1e-6);
+	EXPECT_NEAR(io::SmallestThree48().maxAngularError(), 1.495e-4, 1e-7);
+}
+
+
+TEST(SmallestThree, SingleQuaternion)
+{
+	io::SmallestThree	codec = io::SmallestThree48();
+	geom::Quaterniond	p = geom::quaterniond(geom::Vector3d{1.0, 2.0, 0.5}, 2.5);
+	geom::Quaterniond	q = codec.decode<double>(codec.encode(p));
+	geom::Quaterniond	identity;
+
+	EXPECT_TRUE(q.isUnitQuaternion());
+	EXPECT_EQ(p, q);
+	EXPECT_EQ(codec.decode<double>(codec.encode(identity)), identity);
+
+	// The negated quaternion is the same rotation, and decodes with
+	// its largest component positive.
+	geom::Quaterniond	n = p * -1.0;
+	EXPECT_EQ(codec.decode<double>(codec.encode(n)), p);
+}
+
+
+TEST(SmallestThree, BatchErrorBound32)
+{
+	const size_t		count = 10000;
+	io::SmallestThree	codec = io::SmallestThree32();
+	vector<float>		q = randomQuaternions<float>(count);
+	vector<uint8_t>		packed(count * codec.size());
+	vector<float>		r(count * 4);
+
+	codec.pack(q.data(), count, packed.data());
+	codec.unpack(packed.data(), count, r.data());
+
+	double	worst = 0;
+	for (size_t i = 0; i < count; i++) {
+		double	err = rotationError(&q[i * 4], &r[i * 4]);
+		worst = err > worst ? err : worst;
+	}
+	EXPECT_LT(worst, codec.maxAngularError());
+}
+
+
+TEST(SmallestThree, BatchErrorBound48)
+{
+	const size_t		count = 10000;
+	io::SmallestThree	codec = io::SmallestThree48();
+	vector<double>		q = randomQuaternions<double>(count);
+	vector<uint8_t>		packed(count * codec.size());
+	vector<double>		r(count * 4);
+
+	codec.pack(q.data(), count, packed.data());
+	codec.unpack(packed.data(), count, r.data());
+
+	double	worst = 0;
+	for (size_t i = 0; i < count; i++) {
+		double	err = rotationError(&q[i * 4], &r[i * 4]);
+		worst = err > worst ? err : worst;
+	}
+	EXPECT_LT(worst, codec.maxAngularError());
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
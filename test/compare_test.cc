@@ -0,0 +1,169 @@
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/math.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/compare.h>
+
+using namespace std;
+using namespace wr;
+
+
+TEST(Compare, Scalar)
+{
+	EXPECT_TRUE(math::WithinRelativeTolerance(1000.0, 1000.001, 1e-6));
+	EXPECT_FALSE(math::WithinRelativeTolerance(1000.0, 1000.01, 1e-6));
+	EXPECT_TRUE(math::WithinRelativeTolerance(0.0, 0.0, 1e-6));
+
+	float	one = 1.0f;
+	float	next = std::nextafter(one, 2.0f);
+
+	EXPECT_EQ(math::ULPDistance(one, next), 1u);
+	EXPECT_EQ(math::ULPDistance(0.0f, -0.0f), 0u);
+	EXPECT_EQ(math::ULPDistance(-std::numeric_limits<float>::denorm_min(),
+				    std::numeric_limits<float>::denorm_min()), 2u);
+	EXPECT_EQ(math::ULPDistance(1.0, std::nextafter(std::nextafter(1.0, 0.0), 0.0)), 2u);
+	EXPECT_TRUE(math::WithinULPs(one, next, 1));
+	EXPECT_FALSE(math::WithinULPs(one, std::nextafter(next, 2.0f), 1));
+	EXPECT_FALSE(math::WithinULPs(std::nan(""), std::nan(""), 1000));
+}
+
+
+TEST(Compare, EqualMaskMatchesQuaternion)
+{
+	const size_t			count = 200;
+	vector<double>			a(count * 4), b(count * 4);
+	vector<uint64_t>		mask(math::MaskWords(count));
+
+	for (size_t i = 0; i < a.size(); i++) {
+		a[i] = std::sin(0.3 * i);
+		// Noise straddling the default tolerance of 0.0001.
+		b[i] = a[i] + 0.0002 * std::sin(1.7 * i * i);
+	}
+
+	double	eps;
+	math::DefaultEpsilon(eps);
+
+	size_t	matches = math::EqualMask(a.data(), b.data(), count, 4,
+					  math::Tolerance<double>::Absolute(eps),
+					  mask.data());
+	size_t	expected = 0;
+
+	EXPECT_GT(matches, 0u);
+	EXPECT_LT(matches, count);
+	for (size_t i = 0; i < count; i++) {
+		geom::Quaterniond	p{a[i * 4], a[(i * 4) + 1], a[(i * 4) + 2], a[(i * 4) + 3]};
+		geom::Quaterniond	q{b[i * 4], b[(i * 4) + 1], b[(i * 4) + 2], b[(i * 4) + 3]};
+
+		EXPECT_EQ(math::MaskTest(mask.data(), i), p == q) << "record " << i;
+		expected += p == q;
+	}
+	EXPECT_EQ(matches, expected);
+
+	// The unused bits of the last word are clear.
+	EXPECT_EQ(mask.back() >> (count % 64), 0u);
+}
+
+
+TEST(Compare, Modes)
+{
+	float		a[6] = {1000.0f, 1.0f, 0.0f, 1e-30f, 1.0f, 0.0f};
+	float		b[6] = {1000.05f, 1.0f, 0.0f, 2e-30f, 1.0f, 0.0f};
+	uint64_t	mask;
+
+	EXPECT_EQ(math::EqualMask(a, b, 2, 3, math::Tolerance<float>::Absolute(0.01f), &mask), 1u);
+	EXPECT_EQ(mask, 2u);
+	EXPECT_EQ(math::EqualMask(a, b, 2, 3, math::Tolerance<float>::Relative(1e-4f), &mask), 1u);
+	EXPECT_EQ(mask, 1u);
+
+	b[0] = std::nextafter(a[0], 2000.0f);
+	b[3] = a[3];
+	EXPECT_EQ(math::EqualMask(a, b, 2, 3, math::Tolerance<float>::ULPs(1), &mask), 2u);
+	EXPECT_EQ(mask, 3u);
+	EXPECT_EQ(math::EqualMask(a, b, 2, 3, math::Tolerance<float>::ULPs(0), &mask), 1u);
+	EXPECT_EQ(mask, 2u);
+}
+
+
+// VectorPredicates checks the batch predicates against the Vector
+// methods on zero, unit, parallel, antiparallel, orthogonal and general
+// pairs.
+template <typename T>
+static void
+VectorPredicates()
+{
+	const size_t		count = 130;
+	vector<T>		a(count * 3), b(count * 3);
+	vector<uint64_t>	zero(math::MaskWords(count)), unit(math::MaskWords(count));
+	vector<uint64_t>	parallel(math::MaskWords(count)), ortho(math::MaskWords(count));
+	T			eps;
+
+	math::DefaultEpsilon(eps);
+	for (size_t i = 0; i < count; i++) {
+		geom::Vector<T, 3>	v {(T)std::sin(1.1 * i), (T)std::cos(0.7 * i), (T)std::sin(0.3 * i)};
+		geom::Vector<T, 3>	w;
+
+		switch (i % 5) {
+		case 0:	v = v * (T)0.0; w = v; break;
+		case 1:	v = v.unitVector(); w = v * (T)3.0; break;
+		case 2:	w = geom::Vector<T, 3>{1, 0, 0}.cross(v); break;
+		case 3:	w = v * (T)-1.0; break;
+		default: w = geom::Vector<T, 3>{(T)0.3, (T)-0.2, (T)0.1}; break;
+		}
+		for (size_t k = 0; k < 3; k++) {
+			a[(i * 3) + k] = v[k];
+			b[(i * 3) + k] = w[k];
+		}
+	}
+
+	geom::ZeroMask<3>(a.data(), count, eps, zero.data());
+	geom::UnitMask<3>(a.data(), count, eps, unit.data());
+	geom::ParallelMask<3>(a.data(), b.data(), count, eps, parallel.data());
+	geom::OrthogonalMask<3>(a.data(), b.data(), count, eps, ortho.data());
+
+	for (size_t i = 0; i < count; i++) {
+		geom::Vector<T, 3>	v(&a[i * 3]);
+		geom::Vector<T, 3>	w(&b[i * 3]);
+
+		EXPECT_EQ(math::MaskTest(zero.data(), i), v.isZero()) << i;
+		EXPECT_EQ(math::MaskTest(unit.data(), i), v.isUnitVector()) << i;
+		EXPECT_EQ(math::MaskTest(parallel.data(), i), v.isParallel(w)) << i;
+		EXPECT_EQ(math::MaskTest(ortho.data(), i), v.isOrthogonal(w)) << i;
+	}
+
+	vector<uint64_t>	equal(math::MaskWords(count));
+	EXPECT_EQ(geom::EqualMask<3>(a.data(), a.data(), count,
+				     math::Tolerance<T>::Absolute(eps), equal.data()),
+		  count);
+}
+
+
+TEST(Compare, VectorPredicates)
+{
+	VectorPredicates<double>();
+	VectorPredicates<float>();
+}
+
+
+TEST(Compare, ParallelFloat)
+{
+	const float		a[12] = {1, 2, 3, -1, 0.5f, 4, 1, 0, 0, 0.1f, 0.2f, 0.3f};
+	const float		b[12] = {2, 4, 6, -3, 1.5f, 12, 1, 1e-3f, 0, -0.1f, -0.2f, -0.3f};
+	uint64_t		mask;
+	float			eps;
+
+	math::DefaultEpsilon(eps);
+	EXPECT_EQ(geom::ParallelMask<3>(a, b, 4, eps, &mask), 2u);
+	EXPECT_EQ(mask, 3u);
+	EXPECT_TRUE((geom::Vector3f{1, 2, 3}).isParallel(geom::Vector3f{2, 4, 6}));
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
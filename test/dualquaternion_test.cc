@@ -0,0 +1,192 @@
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/dualquaternion.h>
+
+using namespace std;
+using namespace wr;
+
+
+static geom::DualQuaterniond
+testTransform(double angle, double x)
+{
+	return geom::DualQuaterniond(
+	    geom::quaterniond(geom::Vector3d{1.0, -2.0, 0.5}, angle),
+	    geom::Vector3d{x, 2.0, -3.0});
+}
+
+
+TEST(DualQuaternion, Identity)
+{
+	geom::DualQuaterniond	dq;
+	geom::Vector3d		p {1.0, 2.0, 3.0};
+
+	EXPECT_TRUE(dq.isUnitDualQuaternion());
+	EXPECT_EQ(dq.transform(p), p);
+	EXPECT_EQ(dq.translation(), (geom::Vector3d{0.0, 0.0, 0.0}));
+	EXPECT_EQ(dq.rotation(), geom::Quaterniond());
+}
+
+
+TEST(DualQuaternion, Transform)
+{
+	geom::Quaterniond	r = geom::quaterniond(geom::Vector3d{0.0, 1.0, 1.0}, 1.2);
+	geom::Vector3d		t {40.0, -50.0, 60.0};
+	geom::DualQuaterniond	dq(r, t);
+	geom::Vector3d		p {1.0, 2.0, 3.0};
+
+	EXPECT_TRUE(dq.isUnitDualQuaternion());
+	EXPECT_EQ(dq.rotation(), r);
+	EXPECT_EQ(dq.translation(), t);
+	EXPECT_EQ(dq.transform(p), r.rotate(p) + t);
+	EXPECT_EQ(dq.transformVector(p), r.rotate(p));
+}
+
+
+TEST(DualQuaternion, ComposeAndInverse)
+{
+	geom::DualQuaterniond	a = testTransform(0.7, 1.0);
+	geom::DualQuaterniond	b = testTransform(-2.1, 30.0);
+	geom::Vector3d		p {0.5, -1.0, 2.0};
+
+	EXPECT_EQ((a * b).transform(p), b.transform(a.transform(p)));
+	EXPECT_TRUE((a * b).isUnitDualQuaternion());
+	EXPECT_EQ(a.inverse().transform(a.transform(p)), p);
+	EXPECT_EQ(a * a.inverse(), geom::DualQuaterniond());
+}
+
+
+TEST(DualQuaternion, ScLERP)
+{
+	geom::DualQuaterniond	a = testTransform(0.2, 1.0);
+	geom::DualQuaterniond	b = testTransform(1.4, 5.0);
+
+	EXPECT_EQ(geom::ScLERP(a, b, 0.0), a);
+	EXPECT_EQ(geom::ScLERP(a, b, 1.0), b);
+
+	// Rotating about an axis through the origin while translating
+	// along it, halfway is half the angle and half the translation.
+	geom::Vector3d		axis {0.0, 0.0, 1.0};
+	geom::DualQuaterniond	c(geom::quaterniond(axis, 1.0), geom::Vector3d{0, 0, 4});
+	geom::DualQuaterniond	half = geom::ScLERP(geom::DualQuaterniond(), c, 0.5);
+
+	EXPECT_TRUE(half.isUnitDualQuaternion());
+	EXPECT_EQ(half.rotation(), geom::quaterniond(axis, 0.5));
+	EXPECT_EQ(half.translation(), (geom::Vector3d{0, 0, 2}));
+
+	// Pure translations interpolate linearly.
+	geom::DualQuaterniond	d(geom::Quaterniond(), geom::Vector3d{2, 4, 6});
+	EXPECT_EQ(geom::ScLERP(geom::DualQuaterniond(), d, 0.25).translation(),
+		  (geom::Vector3d{0.5, 1, 1.5}));
+
+	// Interpolated transforms stay rigid.
+	for (double t = 0.0; t <= 1.0; t += 0.1) {
+		EXPECT_TRUE(geom::ScLERP(a, b, t).isUnitDualQuaternion());
+	}
+}
+
+
+// ScLERPNearlyEqual interpolates halfway between two transforms whose
+// rotations differ by only delta, where the screw decomposition is
+// ill-conditioned. The screw bends away from the straight line by less
+// than delta here, so the translation should be within that of halfway,
+// plus the rounding error allowed by tolerance.
+template <typename T>
+static void
+ScLERPNearlyEqual(T delta, T tolerance)
+{
+	tolerance += delta;
+
+	geom::Vector<T, 3>	axis {0, 1, 0};
+	geom::DualQuaternion<T>	a(geom::quaternion(axis, (T)0.3), geom::Vector<T, 3>{1, 0, 2});
+	geom::DualQuaternion<T>	b(geom::quaternion(axis, (T)0.3 + delta), geom::Vector<T, 3>{4, 0, 8});
+	geom::DualQuaternion<T>	half = geom::ScLERP(a, b, (T)0.5);
+	geom::Vector<T, 3>	t = half.translation();
+
+	EXPECT_TRUE(half.isUnitDualQuaternion());
+	EXPECT_NEAR(t[0], 2.5, tolerance) << "delta " << delta;
+	EXPECT_NEAR(t[1], 0.0, tolerance) << "delta " << delta;
+	EXPECT_NEAR(t[2], 5.0, tolerance) << "delta " << delta;
+}
+
+
+TEST(DualQuaternion, ScLERPNearlyEqualRotations)
+{
+	const double	deltas[] = {1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-9, 0.0};
+
+	for (double delta : deltas) {
+		ScLERPNearlyEqual<double>(delta, 1e-9);
+		ScLERPNearlyEqual<float>((float)delta, 1e-5f);
+	}
+}
+
+
+TEST(DualQuaternion, DLB)
+{
+	geom::DualQuaterniond	dqs[3] = {
+		testTransform(0.2, 1.0),
+		testTransform(0.3, 2.0) * -1.0,	// the same transform, flipped.
+		testTransform(0.4, 3.0),
+	};
+	double			one = 1.0;
+	double			weights[3] = {0.25, 0.5, 0.25};
+
+	EXPECT_EQ(geom::DLB(dqs, &one, 1), dqs[0]);
+
+	geom::DualQuaterniond	blend = geom::DLB(dqs, weights, 3);
+
+	EXPECT_TRUE(blend.isUnitDualQuaternion());
+	EXPECT_EQ(blend.rotation(), testTransform(0.3, 2.0).rotation());
+	EXPECT_NEAR(blend.translation()[0], 2.0, 0.01);
+
+	// The batch blend matches the single blend.
+	uint32_t		indices[6] = {0, 1, 2, 2, 0, 0};
+	double			batchWeights[6] = {0.25, 0.5, 0.25, 0.5, 0.5, 0.0};
+	geom::DualQuaterniond	out[2];
+
+	geom::DLB(dqs, indices, batchWeights, 3, out, 2);
+	EXPECT_EQ(out[0], blend);
+	geom::DualQuaterniond	pair[2] = {dqs[2], dqs[0]};
+	EXPECT_EQ(out[1], geom::DLB(pair, batchWeights + 3, 2));
+}
+
+
+TEST(DualQuaternion, Batch)
+{
+	geom::DualQuaterniond	dq = testTransform(0.9, -7.0);
+	const size_t		count = 37;
+	vector<double>		in(count * 3), out(count * 3);
+
+	for (size_t i = 0; i < in.size(); i++) {
+		in[i] = std::sin((double)i);
+	}
+
+	geom::TransformPoints(dq, in.data(), out.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		geom::Vector3d	p(&in[i * 3]);
+
+		EXPECT_EQ(geom::Vector3d(&out[i * 3]), dq.transform(p));
+	}
+
+	vector<geom::DualQuaterniond>	a, b, c(count);
+	for (size_t i = 0; i < count; i++) {
+		a.push_back(testTransform(0.1 * i, (double)i));
+		b.push_back(testTransform(-0.2 * i, 1.0));
+	}
+
+	geom::Compose(a.data(), b.data(), c.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(c[i], a[i] * b[i]);
+	}
+	EXPECT_EQ(sizeof(geom::DualQuaterniond), 8 * sizeof(double));
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
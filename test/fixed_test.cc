@@ -0,0 +1,128 @@
+#include <cmath>
+#include <limits>
+#include <gtest/gtest.h>
+#include <wrmath/math.h>
+#include <wrmath/math/fixed.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/filter/madgwick.h>
+
+using namespace std;
+using namespace wr;
+
+
+TEST(Fixed, Conversions)
+{
+	math::Q15	a(0.5);
+	math::Q16	b(-3.25);
+
+	EXPECT_EQ(a.raw(), 16384);
+	EXPECT_DOUBLE_EQ(static_cast<double>(b), -3.25);
+	EXPECT_EQ(math::Q15(1.0), math::Q15::max());
+	EXPECT_EQ(math::Q15(-2.0), math::Q15::min());
+	EXPECT_EQ(math::Q31(-1.0), math::Q31::min());
+
+	// NaN becomes zero; infinities saturate.
+	EXPECT_EQ(math::Q15(std::nan("")).raw(), 0);
+	EXPECT_EQ(math::Q31(-std::nan("")).raw(), 0);
+	EXPECT_EQ(math::Q16(std::numeric_limits<double>::infinity()), math::Q16::max());
+	EXPECT_EQ(math::Q16(-std::numeric_limits<double>::infinity()), math::Q16::min());
+}
+
+
+TEST(Fixed, SaturatingArithmetic)
+{
+	math::Q15	half(0.5);
+	math::Q15	big(0.75);
+
+	EXPECT_EQ(big + big, math::Q15::max());
+	EXPECT_EQ(-big - big, math::Q15::min());
+	EXPECT_EQ(-math::Q15::min(), math::Q15::max());
+	EXPECT_EQ(half * half, math::Q15(0.25));
+	EXPECT_EQ(math::Q15(0.25) / half, half);
+	EXPECT_EQ(half / math::Q15(0.25), math::Q15::max());
+	EXPECT_EQ(half / math::Q15(), math::Q15::max());
+
+	math::Q16	c(100.5);
+	EXPECT_DOUBLE_EQ(static_cast<double>(c * math::Q16(2.0)), 201.0);
+	EXPECT_DOUBLE_EQ(static_cast<double>(fmod(c, math::Q16(3.0))), 1.5);
+}
+
+
+TEST(Fixed, SquareRoot)
+{
+	EXPECT_DOUBLE_EQ(static_cast<double>(sqrt(math::Q16(16.0))), 4.0);
+	EXPECT_DOUBLE_EQ(static_cast<double>(sqrt(math::Q15(0.25))), 0.5);
+	EXPECT_NEAR(static_cast<double>(sqrt(math::Q31(0.5))), 0.7071067811865476, 1e-9);
+	EXPECT_EQ(sqrt(math::Q16(-1.0)), math::Q16());
+}
+
+
+TEST(Fixed, Vector)
+{
+	geom::Vector<math::Q16, 3>	a {1.0, -2.0, 3.0};
+	geom::Vector<math::Q16, 3>	b {4.0, 5.0, 6.0};
+	geom::Vector<math::Q16, 3>	c {-27.0, 6.0, 13.0};
+
+	EXPECT_NEAR(static_cast<double>(a.magnitude()), 3.74165738677394, 0.0001);
+	EXPECT_EQ(a * b, math::Q16(12.0));
+	EXPECT_EQ(a.cross(b), c);
+	EXPECT_TRUE(a.unitVector().isUnitVector());
+}
+
+
+TEST(Fixed, QuaternionProduct)
+{
+	typedef geom::Quaternion<math::Q16>	Quaternionq;
+
+	Quaternionq	p {3.0, 1.0, -2.0, 1.0};
+	Quaternionq	q {2.0, -1.0, 2.0, 3.0};
+	Quaternionq	expected {8.0, -9.0, -2.0, 11.0};
+
+	EXPECT_EQ(p * q, expected);
+	EXPECT_EQ(p * Quaternionq(), p);
+}
+
+
+TEST(Fixed, QuaternionRotate)
+{
+	// A 90° rotation about the y axis, as in the floating point tests.
+	geom::Quaternion<math::Q31>	p {0.7071067811865476, 0.0, 0.7071067811865476, 0.0};
+	geom::Vector<math::Q31, 3>	v {0.5, 0.0, 0.0};
+	geom::Vector<math::Q31, 3>	vr {0.0, 0.0, 0.5};
+
+	EXPECT_TRUE(p.isUnitQuaternion());
+	EXPECT_EQ(p.rotate(v), vr);
+}
+
+
+TEST(Fixed, Madgwick)
+{
+	filter::Madgwick<math::Q16>	mf;
+	filter::Madgwickd		md;
+	geom::Vector<math::Q16, 3>	gyro {0.174533, 0.0, 0.0};
+	geom::Vector3d			gyrod {0.174533, 0.0, 0.0};
+	double				delta = 0.00917;
+
+	for (int i = 0; i < 218; i++) {
+		mf.updateAngularOrientation(gyro, delta);
+		md.updateAngularOrientation(gyrod, delta);
+	}
+
+	geom::Vector<math::Q16, 3>	axis = mf.orientation().axis();
+	geom::Vector3d			axisd = md.orientation().axis();
+
+	EXPECT_NEAR(static_cast<double>(mf.orientation().angle()),
+		    md.orientation().angle(), 0.001);
+	for (int i = 0; i < 3; i++) {
+		EXPECT_NEAR(static_cast<double>(axis[i]), axisd[i], 0.001);
+	}
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
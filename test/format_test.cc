@@ -0,0 +1,166 @@
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/io/format.h>
+
+using namespace std;
+using namespace wr;
+
+
+static string
+formatScalar(double value, unsigned precision = io::FormatDefaultPrecision)
+{
+	char	buf[io::FormatScalarMax];
+	char	*end = io::FormatScalar(buf, buf + sizeof(buf), value, precision);
+
+	return end == nullptr ? string("<overflow>") : string(buf, end);
+}
+
+
+TEST(Format, Scalars)
+{
+	EXPECT_EQ(formatScalar(0.0), "0");
+	EXPECT_EQ(formatScalar(-0.0), "-0");
+	EXPECT_EQ(formatScalar(1.0), "1");
+	EXPECT_EQ(formatScalar(-2.25), "-2.25");
+	EXPECT_EQ(formatScalar(0.1), "0.1");
+	EXPECT_EQ(formatScalar(0.707107), "0.707107");
+	EXPECT_EQ(formatScalar(0.70710678), "0.707107");
+	EXPECT_EQ(formatScalar(0.0871557), "0.0871557");
+	EXPECT_EQ(formatScalar(0.0001), "0.0001");
+	EXPECT_EQ(formatScalar(0.00001), "1e-05");
+	EXPECT_EQ(formatScalar(1e-7), "1e-07");
+	EXPECT_EQ(formatScalar(-0.0000004), "-4e-07");
+	EXPECT_EQ(formatScalar(0.9999996), "1");
+	EXPECT_EQ(formatScalar(1234.5), "1234.5");
+	EXPECT_EQ(formatScalar(100000.0), "100000");
+	EXPECT_EQ(formatScalar(999999.5), "1e+06");
+	EXPECT_EQ(formatScalar(123456789.0), "1.23457e+08");
+	EXPECT_EQ(formatScalar(3.14159265, 2), "3.1");
+	EXPECT_EQ(formatScalar(3.14159265, 0), "3");
+	EXPECT_EQ(formatScalar(0.05, 3), "0.05");
+	EXPECT_EQ(formatScalar(NAN), "nan");
+	EXPECT_EQ(formatScalar(-INFINITY), "-inf");
+	EXPECT_EQ(formatScalar(INFINITY), "inf");
+	EXPECT_EQ(formatScalar(1.5e20), "1.5e+20");
+	EXPECT_EQ(formatScalar(-2e300, 3), "-2e+300");
+	EXPECT_EQ(formatScalar(9.9999999e19, 3), "1e+20");
+	EXPECT_EQ(formatScalar(5e-324), "4.94066e-324");
+
+	// Every precision fits in FormatScalarMax.
+	for (unsigned p = 0; p <= io::FormatMaxPrecision; p++) {
+		EXPECT_NE(formatScalar(-1.2345678901234567e-300, p), "<overflow>");
+		EXPECT_NE(formatScalar(-8.7654321098765432e307, p), "<overflow>");
+		EXPECT_NE(formatScalar(-8999.123456789012345, p), "<overflow>");
+	}
+}
+
+
+TEST(Format, MatchesStream)
+{
+	geom::Vector3d		v {1.0, -0.5, 0.125};
+	geom::Vector4f		v4 {0.0f, 2.0f, -3.0f, 0.25f};
+	geom::Quaterniond	q {0.707107, 0.0, 0.707107, 0.0};
+	char			buf[128];
+	char			*end;
+	ostringstream		out;
+
+	end = io::Format(buf, buf + sizeof(buf), v);
+	ASSERT_NE(end, nullptr);
+	out << v;
+	EXPECT_EQ(string(buf, end), out.str());
+
+	out.str("");
+	end = io::Format(buf, buf + sizeof(buf), v4);
+	ASSERT_NE(end, nullptr);
+	out << v4;
+	EXPECT_EQ(string(buf, end), out.str());
+
+	out.str("");
+	end = io::Format(buf, buf + sizeof(buf), q);
+	ASSERT_NE(end, nullptr);
+	out << q;
+	EXPECT_EQ(string(buf, end), out.str());
+	EXPECT_EQ(string(buf, end), "0.707107 + <0, 0.707107, 0>");
+}
+
+
+TEST(Format, ScalarsMatchStream)
+{
+	const double	values[] = {
+		0.0871557, 1e-7, -3.0e-5, 0.000123456789, 0.5, 1.0 / 3.0,
+		-2.0 / 3.0, 12.375, 99999.95, 654321.0, 1e15, -6.02214076e23,
+		1.602176634e-19, 2.2250738585072014e-308, 1.7976931348623157e308,
+	};
+
+	for (double value : values) {
+		for (unsigned p = 1; p <= io::FormatMaxPrecision; p += 2) {
+			ostringstream	out;
+
+			out.precision(p);
+			out << value;
+			EXPECT_EQ(formatScalar(value, p), out.str()) << value << " " << p;
+		}
+	}
+}
+
+
+TEST(Format, Overflow)
+{
+	geom::Vector3d	v {1.0, 2.0, 3.0};
+	const string	expected = "<1, 2, 3>";
+	char		buf[16];
+
+	for (size_t n = 0; n < expected.size(); n++) {
+		EXPECT_EQ(io::Format(buf, buf + n, v), nullptr) << n;
+	}
+
+	char	*end = io::Format(buf, buf + expected.size(), v);
+
+	ASSERT_NE(end, nullptr);
+	EXPECT_EQ(string(buf, end), expected);
+}
+
+
+TEST(Format, Batch)
+{
+	vector<float>	q = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.5f, 0.5f, -0.5f, 0.5f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+	};
+	char		buf[64];
+	char		*end;
+
+	// The buffer holds the first two records but not the third.
+	size_t	written = io::FormatBatch(buf, buf + 50, q.data(), 3, 4, &end);
+
+	EXPECT_EQ(written, 2u);
+	EXPECT_EQ(string(buf, end), "1 + <0, 0, 0>\n0.5 + <0.5, -0.5, 0.5>\n");
+
+	written = io::FormatBatch(buf, buf + sizeof(buf), q.data() + 8, 1, 4, &end, 3, ';');
+	EXPECT_EQ(written, 1u);
+	EXPECT_EQ(string(buf, end), "0 + <1, 0, 0>;");
+
+	vector<double>	v = {1.0, 2.0, 3.0, -4.5, 5.0, 6.0};
+
+	written = io::FormatBatch(buf, buf + sizeof(buf), v.data(), 2, 3, &end);
+	EXPECT_EQ(written, 2u);
+	EXPECT_EQ(string(buf, end), "<1, 2, 3>\n<-4.5, 5, 6>\n");
+
+	written = io::FormatBatch(buf, buf + sizeof(buf), v.data(), 3, 2, &end, 6, ' ');
+	EXPECT_EQ(written, 3u);
+	EXPECT_EQ(string(buf, end), "<1, 2> <3, -4.5> <5, 6> ");
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
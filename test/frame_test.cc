@@ -0,0 +1,136 @@
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/frame.h>
+
+using namespace std;
+using namespace wr;
+
+
+static double
+dot3(const double *a, const double *b)
+{
+	return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+}
+
+
+static void
+expectOrthonormal(const double *frame)
+{
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			EXPECT_NEAR(dot3(frame + (i * 3), frame + (j * 3)),
+				    i == j ? 1.0 : 0.0, 1e-12);
+		}
+	}
+
+	// Right-handed: x × y = z.
+	geom::Vector3d	x(frame), y(frame + 3), z(frame + 6);
+	EXPECT_EQ(x.cross(y), z);
+}
+
+
+TEST(GramSchmidt, Basis)
+{
+	double	in[9] = {3.0, 1.0, 0.0, 2.0, 2.0, 0.0, 1.0, 1.0, 1.0};
+	double	out[9];
+
+	EXPECT_EQ(geom::GramSchmidt<3>(in, out, 3), 3u);
+	expectOrthonormal(out);
+
+	// The first vector only gets normalised.
+	geom::Vector3d	first(in);
+	EXPECT_EQ(geom::Vector3d(out), first.unitVector());
+
+	// Each output spans the same space as the inputs so far: the
+	// second is the unit rejection of the second input.
+	geom::Vector3d	second(in + 3);
+	EXPECT_EQ(geom::Vector3d(out + 3), second.projectOrthogonal(first).unitVector());
+}
+
+
+TEST(GramSchmidt, Dependent)
+{
+	double	in[16] = {
+		1.0, 0.0, 0.0, 0.0,
+		2.0, 0.0, 0.0, 0.0,	// parallel to the first.
+		1.0, 1.0, 0.0, 0.0,
+		0.0, 0.0, 0.0, 0.0,	// zero.
+	};
+	double	out[16];
+
+	EXPECT_EQ(geom::GramSchmidt<4>(in, out, 4), 2u);
+	EXPECT_EQ(geom::Vector4d(out + 4), (geom::Vector4d{0.0, 0.0, 0.0, 0.0}));
+	EXPECT_EQ(geom::Vector4d(out + 8), (geom::Vector4d{0.0, 1.0, 0.0, 0.0}));
+	EXPECT_EQ(geom::Vector4d(out + 12), (geom::Vector4d{0.0, 0.0, 0.0, 0.0}));
+
+	// As two sets of two, neither set has full rank; a set of the
+	// first and third does.
+	EXPECT_EQ(geom::GramSchmidt<4>(in, out, 2, 2), 0u);
+	EXPECT_EQ(geom::Vector4d(out + 8), geom::Vector4d(in + 8).unitVector());
+	EXPECT_EQ(geom::GramSchmidt<4>(in + 4, out, 1, 2), 1u);
+}
+
+
+TEST(OrthonormalFrame, Hint)
+{
+	geom::Vector3d	v {0.0, 0.0, 2.0};
+	geom::Vector3d	hint {1.0, 0.0, 1.0};
+	geom::Vector3d	x, y, z;
+
+	EXPECT_TRUE(geom::OrthonormalFrame(v, hint, x, y, z));
+	EXPECT_EQ(x, (geom::Vector3d{0.0, 0.0, 1.0}));
+	EXPECT_EQ(y, (geom::Vector3d{1.0, 0.0, 0.0}));
+	EXPECT_EQ(z, (geom::Vector3d{0.0, 1.0, 0.0}));
+
+	// A parallel hint falls back to a chosen perpendicular.
+	EXPECT_TRUE(geom::OrthonormalFrame(v, v, x, y, z));
+	EXPECT_EQ(x, (geom::Vector3d{0.0, 0.0, 1.0}));
+	EXPECT_TRUE(x.isOrthogonal(y));
+	EXPECT_TRUE(y.isUnitVector());
+	EXPECT_EQ(x.cross(y), z);
+
+	geom::Vector3d	zero {0.0, 0.0, 0.0};
+	EXPECT_FALSE(geom::OrthonormalFrame(zero, hint, x, y, z));
+	EXPECT_EQ(x, (geom::Vector3d{1.0, 0.0, 0.0}));
+}
+
+
+TEST(OrthonormalFrame, Batch)
+{
+	const size_t	count = 1000;
+	vector<double>	normals(count * 3), hints(count * 3), frames(count * 9);
+
+	for (size_t i = 0; i < normals.size(); i++) {
+		normals[i] = std::sin(0.7 * i);
+		hints[i] = std::cos(1.3 * i);
+	}
+	// Include the awkward cases of Duff's basis: normals along -z.
+	normals[0] = 0.0;
+	normals[1] = 0.0;
+	normals[2] = -1.0;
+
+	EXPECT_EQ(geom::OrthonormalFrames(normals.data(), hints.data(), frames.data(), count), count);
+	for (size_t i = 0; i < count; i++) {
+		expectOrthonormal(&frames[i * 9]);
+		EXPECT_NEAR(dot3(&frames[(i * 9) + 6], &hints[i * 3]), 0.0, 1e-12);
+	}
+
+	EXPECT_EQ(geom::OrthonormalFrames(normals.data(), (const double *)nullptr,
+					  frames.data(), count), count);
+	for (size_t i = 0; i < count; i++) {
+		expectOrthonormal(&frames[i * 9]);
+
+		geom::Vector3d	n(&normals[i * 3]);
+		EXPECT_EQ(geom::Vector3d(&frames[i * 9]), n.unitVector());
+	}
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,148 @@
+#include <cmath>
+#include <random>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/filter/gyrobias.h>
+#include <wrmath/filter/madgwick.h>
+
+using namespace std;
+using namespace wr;
+
+
+static const double	Delta = 0.01;
+static const double	Noise = 0.003;
+
+
+TEST(GyroBias, ConvergesWhenStationary)
+{
+	mt19937				rng(1);
+	normal_distribution<double>	noise(0.0, Noise);
+	geom::Vector3d			trueBias {0.004, -0.007, 0.002};
+	filter::GyroBiasEstimatord	est;
+
+	EXPECT_FALSE(est.stationary());
+	for (int i = 0; i < 3000; i++) {
+		geom::Vector3d	gyro = trueBias + geom::Vector3d{noise(rng), noise(rng), noise(rng)};
+		geom::Vector3d	out = est.update(gyro, Delta);
+
+		EXPECT_EQ(out, gyro - est.bias());
+	}
+	EXPECT_TRUE(est.stationary());
+	for (size_t i = 0; i < 3; i++) {
+		EXPECT_NEAR(est.bias()[i], trueBias[i], 5e-4);
+		EXPECT_LT(est.variance()[i], 1e-6);
+	}
+}
+
+
+TEST(GyroBias, LearnsLargeBias)
+{
+	mt19937				rng(3);
+	normal_distribution<double>	noise(0.0, Noise);
+	geom::Vector3d			trueBias {0.05, -0.03, 0.021};
+	filter::GyroBiasEstimatord	est;
+
+	for (int i = 0; i < 6000; i++) {
+		est.update(trueBias + geom::Vector3d{noise(rng), noise(rng), noise(rng)}, Delta);
+	}
+	EXPECT_TRUE(est.stationary());
+	for (size_t i = 0; i < 3; i++) {
+		EXPECT_NEAR(est.bias()[i], trueBias[i], 5e-4);
+	}
+
+	// A steady rate beyond any plausible bias is never learned.
+	est.reset();
+	for (int i = 0; i < 1000; i++) {
+		est.update(geom::Vector3d{0.2, 0.0, 0.0}, Delta);
+	}
+	EXPECT_FALSE(est.stationary());
+	EXPECT_TRUE(est.bias().isZero());
+}
+
+
+TEST(GyroBias, HoldsWhileMoving)
+{
+	mt19937				rng(2);
+	normal_distribution<double>	noise(0.0, Noise);
+	geom::Vector3d			trueBias {0.01, 0.0, -0.005};
+	filter::GyroBiasEstimatord	est;
+
+	for (int i = 0; i < 2000; i++) {
+		est.update(trueBias + geom::Vector3d{noise(rng), noise(rng), noise(rng)}, Delta);
+	}
+
+	geom::Vector3d	learned = est.bias();
+
+	// A swinging turn passes through zero rate, but never stays still
+	// for long enough to be mistaken for bias.
+	for (int i = 0; i < 1000; i++) {
+		double	rate = 0.3 * cos(i * 0.02);
+
+		est.update(trueBias + geom::Vector3d{rate, 0.5 * rate, noise(rng)}, Delta);
+		EXPECT_FALSE(est.stationary()) << i;
+	}
+	EXPECT_EQ(est.bias(), learned);
+
+	// A constant turn is steady, but too fast to be bias.
+	for (int i = 0; i < 1000; i++) {
+		est.update(trueBias + geom::Vector3d{0.2, 0.0, 0.0}, Delta);
+	}
+	EXPECT_FALSE(est.stationary());
+	EXPECT_EQ(est.bias(), learned);
+
+	est.reset();
+	EXPECT_TRUE(est.bias().isZero());
+}
+
+
+TEST(GyroBias, ArrayUpdate)
+{
+	filter::GyroBiasEstimatorf	est;
+	float				gyro[3] = {0.01f, 0.02f, -0.01f};
+
+	est.setBias(geom::Vector3f{0.01f, 0.02f, -0.01f}, 1e-8f);
+	est.update(gyro, 0.01f, gyro);
+	EXPECT_FLOAT_EQ(gyro[0], 0.0f);
+	EXPECT_FLOAT_EQ(gyro[1], 0.0f);
+	EXPECT_FLOAT_EQ(gyro[2], 0.0f);
+}
+
+
+TEST(GyroBias, MadgwickDrift)
+{
+	mt19937				rng(3);
+	normal_distribution<double>	noise(0.0, Noise);
+	geom::Vector3d			trueBias {0.005, -0.004, 0.006};
+	filter::Madgwickd		raw, compensated, known;
+	filter::GyroBiasEstimatord	est;
+	geom::Quaterniond		identity;
+
+	compensated.setBiasEstimator(&est);
+	EXPECT_EQ(compensated.biasEstimator(), &est);
+
+	// A stationary sensor for 60 seconds.
+	for (int i = 0; i < 6000; i++) {
+		geom::Vector3d	gyro = trueBias + geom::Vector3d{noise(rng), noise(rng), noise(rng)};
+
+		raw.updateAngularOrientation(gyro, Delta);
+		compensated.updateAngularOrientation(gyro, Delta);
+		known.updateAngularOrientation(gyro, trueBias, Delta);
+	}
+
+	double	rawDrift = 1.0 - fabs(raw.orientation().unitQuaternion().dot(identity));
+	double	compDrift = 1.0 - fabs(compensated.orientation().unitQuaternion().dot(identity));
+	double	knownDrift = 1.0 - fabs(known.orientation().unitQuaternion().dot(identity));
+
+	EXPECT_GT(rawDrift, 1e-3);
+	EXPECT_LT(compDrift, rawDrift / 100);
+	EXPECT_LT(knownDrift, rawDrift / 100);
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
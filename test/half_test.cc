@@ -0,0 +1,124 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/io/half.h>
+
+using namespace std;
+using namespace wr;
+
+
+TEST(Half, KnownValues)
+{
+	EXPECT_EQ(io::FloatToHalf(0.0f), 0x0000);
+	EXPECT_EQ(io::FloatToHalf(-0.0f), 0x8000);
+	EXPECT_EQ(io::FloatToHalf(1.0f), 0x3c00);
+	EXPECT_EQ(io::FloatToHalf(-2.0f), 0xc000);
+	EXPECT_EQ(io::FloatToHalf(65504.0f), 0x7bff);
+	EXPECT_EQ(io::FloatToHalf(65520.0f), 0x7c00);
+	EXPECT_EQ(io::FloatToHalf(1e9f), 0x7c00);
+	EXPECT_EQ(io::FloatToHalf(std::ldexp(1.0f, -24)), 0x0001);
+	EXPECT_EQ(io::FloatToHalf(std::ldexp(1.0f, -26)), 0x0000);
+	EXPECT_EQ(io::FloatToHalf(NAN) & 0x7e00, 0x7e00);
+
+	// 1 + 2^-11 is halfway between two halves, and rounds to even.
+	EXPECT_EQ(io::FloatToHalf(1.0f + std::ldexp(1.0f, -11)), 0x3c00);
+	EXPECT_EQ(io::FloatToHalf(1.0f + std::ldexp(3.0f, -11)), 0x3c02);
+
+	EXPECT_FLOAT_EQ(io::HalfToFloat(0x3555), 0.333251953125f);
+	EXPECT_FLOAT_EQ(io::HalfToFloat(0x0001), std::ldexp(1.0f, -24));
+	EXPECT_TRUE(std::isinf(io::HalfToFloat(0xfc00)));
+	EXPECT_TRUE(std::isnan(io::HalfToFloat(0x7e00)));
+}
+
+
+TEST(Half, RoundTripAllValues)
+{
+	vector<uint16_t>	h(65536);
+	vector<float>		f(h.size());
+	vector<uint16_t>	r(h.size());
+
+	for (size_t i = 0; i < h.size(); i++) {
+		h[i] = static_cast<uint16_t>(i);
+	}
+
+	io::WidenHalf(h.data(), f.data(), h.size());
+	io::NarrowHalf(f.data(), r.data(), f.size());
+
+	for (size_t i = 0; i < h.size(); i++) {
+		float	expected = io::HalfToFloat(h[i]);
+
+		if (std::isnan(expected)) {
+			ASSERT_TRUE(std::isnan(f[i]));
+			continue;
+		}
+		ASSERT_EQ(f[i], expected);
+		ASSERT_EQ(r[i], h[i]);
+	}
+}
+
+
+TEST(Half, BatchMatchesScalar)
+{
+	// An odd length exercises both the vector and the tail loops.
+	vector<float>		f(37);
+	vector<uint16_t>	h(f.size());
+
+	for (size_t i = 0; i < f.size(); i++) {
+		f[i] = (float)i * 0.37f - 5.0f;
+	}
+
+	io::NarrowHalf(f.data(), h.data(), f.size());
+	for (size_t i = 0; i < f.size(); i++) {
+		EXPECT_EQ(h[i], io::FloatToHalf(f[i]));
+	}
+
+	vector<float>	w(h.size());
+
+	io::WidenHalf(h.data(), w.data(), h.size());
+	for (size_t i = 0; i < h.size(); i++) {
+		EXPECT_EQ(w[i], io::HalfToFloat(h[i]));
+	}
+}
+
+
+TEST(Half, Vector)
+{
+	geom::Vector3f		v {1.0, -0.5, 3.140625};
+	io::HalfVector<3>	hv(v);
+
+	EXPECT_EQ(hv.widen(), v);
+
+	vector<float>			f {1.0, 2.0, 3.0, -4.0, -5.0, -6.0};
+	vector<io::HalfVector<3>>	hvs(2);
+	vector<float>			r(f.size());
+
+	io::Narrow(f.data(), hvs.data(), 2);
+	EXPECT_EQ(hvs[1].widen(), (geom::Vector3f{-4.0, -5.0, -6.0}));
+	io::Widen(hvs.data(), r.data(), 2);
+	EXPECT_EQ(r, f);
+}
+
+
+TEST(Half, Quaternion)
+{
+	geom::Quaternionf	q = geom::quaternionf(geom::Vector3f{1.0, 2.0, 3.0}, 0.75);
+	io::HalfQuaternion	hq(q);
+	io::HalfQuaternion	identity;
+
+	// Half precision has 11 significant bits.
+	geom::Quaternionf	r = hq.widen();
+	r.setEpsilon(0.001);
+	EXPECT_EQ(r, q);
+	EXPECT_TRUE(identity.widen().isIdentity());
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,91 @@
+#include <sstream>
+#include <gtest/gtest.h>
+#include <wrmath/instrument.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/filter/madgwick.h>
+
+using namespace std;
+using namespace wr;
+
+
+#ifndef WRMATH_INSTRUMENT
+#error "instrument_test must be built with WRMATH_INSTRUMENT"
+#endif
+
+
+TEST(Instrument, VectorCounts)
+{
+	geom::Vector3d	a {1.0, 2.0, 3.0};
+	geom::Vector3d	b {4.0, 5.0, 6.0};
+
+	instrument::Reset();
+	geom::Vector3d	c = a + b;
+
+	// operator+ default-constructs its result, which takes a sqrt.
+	EXPECT_EQ(instrument::Count("Vector::operator+"), 1u);
+	EXPECT_EQ(instrument::Count("Vector::Vector()"), 1u);
+	EXPECT_EQ(instrument::Count("sqrt"), 1u);
+
+	instrument::Reset();
+	EXPECT_DOUBLE_EQ(c.magnitude(), std::sqrt(155.0));
+	EXPECT_EQ(instrument::Count("Vector::magnitude"), 1u);
+	EXPECT_EQ(instrument::Count("sqrt"), 1u);
+	EXPECT_EQ(instrument::Count("Vector::operator+"), 0u);
+}
+
+
+TEST(Instrument, QuaternionCounts)
+{
+	geom::Quaterniond	p {3.0, 1.0, -2.0, 1.0};
+	geom::Quaterniond	q {2.0, -1.0, 2.0, 3.0};
+
+	instrument::Reset();
+	geom::Quaterniond	r = p * q;
+	(void)r;
+
+	EXPECT_EQ(instrument::Count("Quaternion::operator*(Quaternion)"), 1u);
+	EXPECT_EQ(instrument::Count("Quaternion::constrainAngle"), 1u);
+	EXPECT_EQ(instrument::Count("Vector::cross"), 1u);
+	EXPECT_EQ(instrument::Count("fmod"), 0u);
+
+	instrument::Reset();
+	p.euler();
+	EXPECT_EQ(instrument::Count("atan2"), 2u);
+	EXPECT_EQ(instrument::Count("asin"), 1u);
+
+	instrument::Reset();
+	geom::quaterniond(geom::Vector3d{0.0, 1.0, 0.0}, 1.0);
+	EXPECT_EQ(instrument::Count("quaternion"), 1u);
+	EXPECT_EQ(instrument::Count("sin"), 1u);
+	EXPECT_EQ(instrument::Count("cos"), 1u);
+}
+
+
+TEST(Instrument, MadgwickDump)
+{
+	filter::Madgwickd	mf;
+	geom::Vector3d		gyro {0.174533, 0.0, 0.0};
+
+	instrument::Reset();
+	for (int i = 0; i < 10; i++) {
+		mf.updateAngularOrientation(gyro, 0.00917);
+	}
+
+	EXPECT_EQ(instrument::Count("Madgwick::updateAngularOrientation"), 10u);
+	EXPECT_EQ(instrument::Count("Madgwick::updateFrame"), 10u);
+	EXPECT_EQ(instrument::Count("Quaternion::operator*(Quaternion)"), 10u);
+
+	stringstream	ss;
+	instrument::Dump(ss);
+	EXPECT_NE(ss.str().find("Madgwick::updateAngularOrientation 10\n"), string::npos);
+	EXPECT_EQ(ss.str().find("Madgwick::euler"), string::npos);
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/filter.h>
+
+using namespace std;
+using namespace wr;
+
+
+TEST(LatencyHistogram, Buckets)
+{
+	// Every value must fall within its bucket, and the bucket width
+	// must stay within 1/32 of the value.
+	for (uint64_t v = 0; v < 100000; v += 7) {
+		size_t	i = filter::LatencyHistogram::bucket(v);
+
+		ASSERT_LT(i, filter::LatencyHistogram::BucketCount);
+		ASSERT_LE(filter::LatencyHistogram::bucketLower(i), v);
+		ASSERT_GE(filter::LatencyHistogram::bucketUpper(i), v);
+		ASSERT_LE(filter::LatencyHistogram::bucketUpper(i) -
+			  filter::LatencyHistogram::bucketLower(i), v / 32);
+	}
+
+	// Adjacent buckets must be contiguous.
+	for (size_t i = 1; i < filter::LatencyHistogram::BucketCount; i++) {
+		ASSERT_EQ(filter::LatencyHistogram::bucketLower(i),
+			  filter::LatencyHistogram::bucketUpper(i - 1) + 1);
+	}
+
+	EXPECT_EQ(filter::LatencyHistogram::bucket(UINT64_MAX),
+		  filter::LatencyHistogram::BucketCount - 1);
+}
+
+
+TEST(LatencyHistogram, Percentiles)
+{
+	filter::LatencyHistogram	h;
+
+	EXPECT_EQ(h.count(), 0u);
+	EXPECT_EQ(h.p50(), 0u);
+	EXPECT_EQ(h.min(), 0u);
+
+	for (uint64_t v = 1; v <= 10000; v++) {
+		h.record(v * 1000);
+	}
+
+	EXPECT_EQ(h.count(), 10000u);
+	EXPECT_EQ(h.min(), 1000u);
+	EXPECT_EQ(h.max(), 10000000u);
+	EXPECT_DOUBLE_EQ(h.mean(), 5000500.0);
+	EXPECT_NEAR(h.p50(), 5000000.0, 5000000.0 / 32);
+	EXPECT_NEAR(h.p99(), 9900000.0, 9900000.0 / 32);
+	EXPECT_NEAR(h.p999(), 9990000.0, 9990000.0 / 32);
+	EXPECT_EQ(h.percentile(1.0), h.max());
+
+	h.reset();
+	EXPECT_EQ(h.count(), 0u);
+	EXPECT_EQ(h.max(), 0u);
+}
+
+
+TEST(LatencyHistogram, Tail)
+{
+	filter::LatencyHistogram	h;
+
+	for (int i = 0; i < 998; i++) {
+		h.record(std::chrono::microseconds(10));
+	}
+	h.record(std::chrono::milliseconds(5));
+	h.record(std::chrono::milliseconds(5));
+
+	EXPECT_EQ(h.p50(), h.p99());
+	EXPECT_NEAR(h.p99(), 10000.0, 10000.0 / 32);
+	EXPECT_EQ(h.p999(), 5000000u);
+}
+
+
+TEST(LatencyHistogram, Concurrent)
+{
+	filter::LatencyHistogram	h;
+	vector<thread>			threads;
+
+	for (int t = 0; t < 4; t++) {
+		threads.push_back(thread([&h, t]() {
+			for (uint64_t i = 0; i < 10000; i++) {
+				h.record(i + t);
+			}
+		}));
+	}
+	for (auto &t : threads) {
+		t.join();
+	}
+
+	EXPECT_EQ(h.count(), 40000u);
+	EXPECT_EQ(h.min(), 0u);
+	EXPECT_EQ(h.max(), 10002u);
+}
+
+
+TEST(LatencyHistogram, Madgwick)
+{
+	filter::LatencyHistogram	h;
+	filter::Madgwickd		mf;
+	geom::Vector3d			gyro {0.174533, 0.0, 0.0};
+
+	mf.updateAngularOrientation(gyro, 0.00917);
+	EXPECT_EQ(mf.latencyHistogram(), nullptr);
+
+	mf.setLatencyHistogram(&h);
+	for (int i = 0; i < 100; i++) {
+		mf.updateAngularOrientation(gyro, 0.00917);
+	}
+	EXPECT_EQ(h.count(), 100u);
+	EXPECT_LE(h.p50(), h.p999());
+	EXPECT_LE(h.p999(), h.max());
+
+	mf.setLatencyHistogram(nullptr);
+	mf.updateAngularOrientation(gyro, 0.00917);
+	EXPECT_EQ(h.count(), 100u);
+
+	stringstream	ss;
+	ss << h;
+	EXPECT_EQ(ss.str().find("count=100 "), 0u);
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,124 @@
+#include <cstdio>
+#include <string>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/io/log.h>
+
+using namespace std;
+using namespace wr;
+
+
+static string
+logPath(const char *name)
+{
+	return ::testing::TempDir() + name;
+}
+
+
+TEST(OrientationLog, QuaternionRoundTrip)
+{
+	string			path = logPath("wrmath_quaternion.log");
+	io::LogWriter<double>	writer;
+	io::LogReader<double>	reader;
+
+	// 10 records in blocks of 4 exercises a partial final block.
+	ASSERT_TRUE(writer.open(path, io::LogKind::Quaternion, 4));
+	for (int i = 0; i < 10; i++) {
+		geom::Quaterniond	q {1.0, i * 0.1, -i * 0.2, i * 0.3};
+		ASSERT_TRUE(writer.write(i * 1000, q));
+	}
+	EXPECT_FALSE(writer.write(10000, geom::Vector3d{1.0, 2.0, 3.0}));
+	ASSERT_TRUE(writer.close());
+
+	ASSERT_TRUE(reader.open(path));
+	EXPECT_EQ(reader.kind(), io::LogKind::Quaternion);
+	EXPECT_EQ(reader.size(), 10u);
+	ASSERT_EQ(reader.blockCount(), 3u);
+
+	size_t	record = 0;
+	for (size_t b = 0; b < reader.blockCount(); b++) {
+		io::LogBlock<double>	block = reader.block(b);
+
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(block.values) % io::LogAlignment, 0u);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(block.timestamps) % io::LogAlignment, 0u);
+		for (size_t i = 0; i < block.count; i++, record++) {
+			geom::Quaterniond	q {1.0, record * 0.1, -(double)record * 0.2, record * 0.3};
+
+			EXPECT_EQ(block.timestamps[i], (int64_t)record * 1000);
+			EXPECT_EQ(block.quaternion(i), q);
+			EXPECT_DOUBLE_EQ(block.values[i * 4], 1.0);
+		}
+	}
+	EXPECT_EQ(record, 10u);
+
+	EXPECT_EQ(reader.find(0), 0u);
+	EXPECT_EQ(reader.find(4000), 1u);
+	EXPECT_EQ(reader.find(3500), 1u);
+	EXPECT_EQ(reader.find(9000), 2u);
+	EXPECT_EQ(reader.find(9001), 3u);
+
+	reader.close();
+	remove(path.c_str());
+}
+
+
+TEST(OrientationLog, VectorBatchWrite)
+{
+	string			path = logPath("wrmath_vector.log");
+	io::LogWriter<float>	writer;
+	io::LogReader<float>	reader;
+	int64_t			ts[5] = {1, 2, 3, 4, 5};
+	float			vals[15];
+
+	for (int i = 0; i < 15; i++) {
+		vals[i] = (float)i;
+	}
+
+	ASSERT_TRUE(writer.open(path, io::LogKind::Vector3, 2));
+	ASSERT_TRUE(writer.write(ts, vals, 5));
+	ASSERT_TRUE(writer.write(6, geom::Vector3f{15.0, 16.0, 17.0}));
+	ASSERT_TRUE(writer.close());
+
+	ASSERT_TRUE(reader.open(path));
+	EXPECT_EQ(reader.kind(), io::LogKind::Vector3);
+	EXPECT_EQ(reader.size(), 6u);
+	ASSERT_EQ(reader.blockCount(), 3u);
+
+	io::LogBlock<float>	last = reader.block(2);
+	EXPECT_EQ(last.count, 2u);
+	EXPECT_EQ(last.timestamps[1], 6);
+	EXPECT_EQ(last.vector(0), (geom::Vector3f{12.0, 13.0, 14.0}));
+	EXPECT_EQ(last.vector(1), (geom::Vector3f{15.0, 16.0, 17.0}));
+
+	// A float log can't be read as doubles.
+	io::LogReader<double>	wrongType;
+	EXPECT_FALSE(wrongType.open(path));
+
+	reader.close();
+	remove(path.c_str());
+}
+
+
+TEST(OrientationLog, RejectsInvalidFiles)
+{
+	string			path = logPath("wrmath_invalid.log");
+	io::LogReader<double>	reader;
+	FILE			*f = fopen(path.c_str(), "wb");
+
+	ASSERT_NE(f, nullptr);
+	fputs("time,w,x,y,z\n0,1,0,0,0\n", f);
+	fclose(f);
+
+	EXPECT_FALSE(reader.open(path));
+	EXPECT_FALSE(reader.open(logPath("wrmath_does_not_exist.log")));
+	remove(path.c_str());
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
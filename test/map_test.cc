@@ -0,0 +1,140 @@
+#include <cmath>
+#include <sstream>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/map.h>
+
+using namespace std;
+using namespace wr;
+
+
+TEST(VectorMap, Interleaved)
+{
+	double				buf[] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+	geom::VectorArrayMap<double, 3>	arr(buf, 2);
+	geom::Vector3d			a {1.0, 2.0, 3.0};
+	geom::Vector3d			b {4.0, 5.0, 6.0};
+
+	ASSERT_EQ(arr.size(), 2u);
+	EXPECT_EQ(arr[0], a);
+	EXPECT_EQ(arr[1], b);
+	EXPECT_EQ(arr[0].vector(), a);
+	EXPECT_DOUBLE_EQ(arr[0] * arr[1], a * b);
+	EXPECT_DOUBLE_EQ(arr[0] * b, 32.0);
+	EXPECT_DOUBLE_EQ(arr[0].magnitude(), a.magnitude());
+	EXPECT_EQ(arr[0].cross(arr[1]), a.cross(b));
+	EXPECT_EQ(arr[0] + b, a + b);
+	EXPECT_EQ(arr[1] - arr[0], b - a);
+	EXPECT_EQ(arr[0] * 3.0, a * 3.0);
+	EXPECT_EQ(arr[0] / 2.0, a / 2.0);
+	EXPECT_EQ(arr[0].unitVector(), a.unitVector());
+	EXPECT_FALSE(arr[0].isUnitVector());
+	EXPECT_FALSE(arr[0].isZero());
+	EXPECT_DOUBLE_EQ(arr[0].angle(b), a.angle(b));
+}
+
+
+TEST(VectorMap, SoA)
+{
+	// x, x, x, y, y, y, z, z, z
+	float				buf[] = {1.0, 4.0, -2.0, 2.0, 5.0, 1.0, 3.0, 6.0, 3.0};
+	geom::VectorArrayMap<float, 3>	arr(buf, 3, 1, 3);
+	geom::Vector3f			b {4.0, 5.0, 6.0};
+	geom::Vector3f			e {-2.0, 1.0, 3.0};
+	geom::Vector3f			f {-6.0, 3.0, 9.0};
+
+	EXPECT_EQ(arr[1], b);
+	EXPECT_EQ(arr[2], e);
+	EXPECT_TRUE(arr[2].isParallel(f));
+	EXPECT_FALSE(arr[2].isOrthogonal(f));
+	EXPECT_NE(arr[1], e);
+}
+
+
+TEST(VectorMap, Parallel)
+{
+	double		d[] = {1.0, 2.0, 3.0, 2.0, 4.0, 6.0};
+	float		f[] = {1.0f, 2.0f, 3.0f, 2.0f, 4.0f, 6.0f};
+	geom::VectorMap<double, 3>	da(d), db(d + 3);
+	geom::VectorMap<float, 3>	fa(f), fb(f + 3);
+
+	EXPECT_FALSE(std::isnan(da.angle(db)));
+	EXPECT_FALSE(std::isnan(fa.angle(fb)));
+	EXPECT_TRUE(da.isParallel(db));
+	EXPECT_TRUE(fa.isParallel(fb));
+	EXPECT_TRUE(fa.isParallel(geom::Vector3f{0.5f, 1.0f, 1.5f}));
+	EXPECT_FALSE(fa.isParallel(geom::Vector3f{-1.0f, -2.0f, -3.0f}));
+}
+
+
+TEST(VectorMap, StridedRecords)
+{
+	// Each record carries a timestamp and a temperature alongside
+	// the vector.
+	struct Sample {
+		double	timestamp;
+		double	accel[3];
+		double	temperature;
+	};
+
+	Sample	samples[2] = {
+		{0.0, {4.866769214609107, 6.2356222686140566, 9.140878417029711}, 20.0},
+		{1.0, {6.135533104801077, 8.757851406697895, 0.6738031370548048}, 21.0},
+	};
+	geom::VectorArrayMap<double, 3>	arr(samples[0].accel, 2,
+					    sizeof(Sample) / sizeof(double));
+	geom::Vector3d	c {4.843812341655318, 6.9140509888133055, 0.5319465962229454};
+	geom::Vector3d	d {0.02295687295378901, -0.6784287201992489, 8.608931820806765};
+
+	EXPECT_EQ(arr[0].projectParallel(arr[1]), c);
+	EXPECT_EQ(arr[0].projectOrthogonal(arr[1]), d);
+
+	stringstream	ss;
+	ss << arr[1];
+	EXPECT_EQ(ss.str(), "<6.13553, 8.75785, 0.673803>");
+}
+
+
+TEST(QuaternionMap, Interleaved)
+{
+	double					buf[] = {3.0, 1.0, -2.0, 1.0, 2.0, -1.0, 2.0, 3.0};
+	geom::QuaternionArrayMap<double>	arr(buf, 2);
+	geom::Quaterniond			p {3.0, 1.0, -2.0, 1.0};
+	geom::Quaterniond			q {2.0, -1.0, 2.0, 3.0};
+	geom::Quaterniond			expected {8.0, -9.0, -2.0, 11.0};
+
+	EXPECT_EQ(arr[0], p);
+	EXPECT_EQ(arr[0] * arr[1], expected);
+	EXPECT_EQ(arr[0] * q, expected);
+	EXPECT_DOUBLE_EQ(arr[0].norm(), p.norm());
+	EXPECT_DOUBLE_EQ(arr[0].dot(q), p.dot(q));
+	EXPECT_EQ(arr[1].conjugate(), q.conjugate());
+	EXPECT_EQ(arr[1].inverse(), q.inverse());
+	EXPECT_EQ(arr[1].axis(), q.axis());
+	EXPECT_TRUE(arr[0].unitQuaternion().isUnitQuaternion());
+	EXPECT_FALSE(arr[0].isIdentity());
+}
+
+
+TEST(QuaternionMap, Rotate)
+{
+	geom::Quaterniond	p = geom::quaterniond(geom::Vector3d{0.0, 1.0, 0.0}, M_PI / 2);
+	geom::Vector4d		pv = p.asVector();
+	double			buf[] = {pv[0], pv[1], pv[2], pv[3]};
+	double			v[] = {1.0, 0.0, 0.0};
+	geom::QuaternionMap<double>	qm(buf);
+	geom::Vector3d		vr {0.0, 0.0, 1.0};
+
+	EXPECT_TRUE(qm.isUnitQuaternion());
+	EXPECT_EQ(qm.rotate(geom::VectorMap<double, 3>(v)), vr);
+	EXPECT_EQ(qm.euler(), p.euler());
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,74 @@
+#include <atomic>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/parallel.h>
+
+using namespace std;
+using namespace wr;
+
+
+TEST(ThreadPool, RunsEveryTaskOnce)
+{
+	for (size_t threads = 1; threads <= 4; threads++) {
+		parallel::ThreadPool	pool(threads);
+		vector<atomic<int>>	seen(1000);
+
+		EXPECT_EQ(pool.size(), threads);
+		for (int round = 0; round < 10; round++) {
+			pool.run(seen.size(), [&seen](size_t i) {
+				seen[i].fetch_add(1);
+			});
+		}
+
+		for (size_t i = 0; i < seen.size(); i++) {
+			ASSERT_EQ(seen[i].load(), 10) << "task " << i;
+		}
+	}
+}
+
+
+TEST(ThreadPool, Nested)
+{
+	parallel::ThreadPool	pool(3);
+	atomic<int>		count(0);
+
+	pool.run(4, [&pool, &count](size_t) {
+		pool.run(5, [&count](size_t) {
+			count.fetch_add(1);
+		});
+	});
+	EXPECT_EQ(count.load(), 20);
+}
+
+
+TEST(ThreadPool, ParallelFor)
+{
+	parallel::ThreadPool	pool(4);
+	vector<int>		covered(1001, 0);
+	atomic<size_t>		chunks(0);
+
+	parallel::ParallelFor(covered.size(), 100, [&](size_t begin, size_t end) {
+		EXPECT_LE(end - begin, 100u);
+		for (size_t i = begin; i < end; i++) {
+			covered[i]++;
+		}
+		chunks.fetch_add(1);
+	}, &pool);
+
+	EXPECT_EQ(chunks.load(), 11u);
+	for (size_t i = 0; i < covered.size(); i++) {
+		ASSERT_EQ(covered[i], 1);
+	}
+
+	// Empty ranges never call the function.
+	parallel::ParallelFor(0, 100, [](size_t, size_t) { FAIL(); });
+	EXPECT_GE(parallel::DefaultPool().size(), 1u);
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
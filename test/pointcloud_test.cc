@@ -0,0 +1,127 @@
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/pointcloud.h>
+
+using namespace std;
+using namespace wr;
+
+
+static vector<double>
+testPoints(size_t count)
+{
+	vector<double>	points(count * 3);
+
+	for (size_t i = 0; i < points.size(); i++) {
+		points[i] = 10.0 * std::sin(0.37 * i);
+	}
+	return points;
+}
+
+
+TEST(PointTransform, SinglePoint)
+{
+	geom::Quaterniond	r = geom::quaterniond(geom::Vector3d{1.0, 2.0, 3.0}, 0.8);
+	geom::Vector3d		t {1.0, -2.0, 0.5};
+	geom::Vector3d		p {3.0, 1.0, -4.0};
+
+	geom::PointTransform<double>	xf(r, t);
+	EXPECT_EQ(xf(p), r.rotate(p) + t);
+	EXPECT_EQ(geom::PointTransform<double>()(p), p);
+}
+
+
+TEST(PointTransform, Array)
+{
+	geom::Quaterniond		r = geom::quaterniond(geom::Vector3d{0.0, 1.0, 0.0}, -2.0);
+	geom::Vector3d			t {4.0, 5.0, 6.0};
+	geom::PointTransform<double>	xf(r, t);
+	parallel::ThreadPool		pool(4);
+	const size_t			count = 10007;
+	vector<double>			in = testPoints(count);
+
+	for (int streaming = 0; streaming < 2; streaming++) {
+		geom::PointCloudOptions	opts;
+		vector<double>		out(count * 3);
+
+		opts.chunkSize = 1000;
+		opts.streamingStores = streaming != 0;
+		opts.pool = &pool;
+		xf.apply(in.data(), out.data(), count, opts);
+
+		for (size_t i = 0; i < count; i++) {
+			geom::Vector3d	p(&in[i * 3]);
+
+			ASSERT_EQ(geom::Vector3d(&out[i * 3]), r.rotate(p) + t) << "point " << i;
+		}
+	}
+
+	// In place, with the defaults.
+	vector<double>	inPlace = in;
+	xf.apply(inPlace.data(), inPlace.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		ASSERT_EQ(geom::Vector3d(&inPlace[i * 3]), xf(geom::Vector3d(&in[i * 3])));
+	}
+
+	vector<geom::Vector3d>	vin, vout(100);
+	for (size_t i = 0; i < 100; i++) {
+		vin.push_back(geom::Vector3d(&in[i * 3]));
+	}
+	xf.apply(vin.data(), vout.data(), vin.size());
+	for (size_t i = 0; i < 100; i++) {
+		EXPECT_EQ(vout[i], xf(vin[i]));
+	}
+}
+
+
+TEST(PointTransform, PerPose)
+{
+	const size_t			count = 1000;
+	const size_t			posePoints = 64;
+	const size_t			poses = (count + posePoints - 1) / posePoints;
+	vector<geom::Quaterniond>	rotations;
+	vector<geom::Vector3d>		translations;
+	vector<double>			in = testPoints(count);
+	vector<float>			fin(in.begin(), in.end());
+	vector<float>			fout(count * 3);
+
+	for (size_t i = 0; i < poses; i++) {
+		rotations.push_back(geom::quaterniond(geom::Vector3d{0.0, 0.0, 1.0}, 0.01 * i));
+		translations.push_back(geom::Vector3d{0.1 * i, 0.0, 0.0});
+	}
+
+	vector<geom::Quaternionf>	frot;
+	vector<geom::Vector3f>		ftrans;
+	for (size_t i = 0; i < poses; i++) {
+		geom::Vector3d	axis = rotations[i].axis();
+
+		frot.push_back(geom::Quaternionf{(float)rotations[i].angle(), (float)axis[0],
+						 (float)axis[1], (float)axis[2]});
+		ftrans.push_back(geom::Vector3f{(float)translations[i][0], 0.0f, 0.0f});
+	}
+
+	geom::PointCloudOptions	opts;
+	opts.streamingStores = true;
+	geom::TransformPointCloud(frot.data(), ftrans.data(), posePoints,
+				  fin.data(), fout.data(), count, opts);
+
+	for (size_t i = 0; i < count; i++) {
+		size_t		k = i / posePoints;
+		geom::Vector3d	want = rotations[k].rotate(geom::Vector3d(&in[i * 3])) +
+				       translations[k];
+
+		for (size_t j = 0; j < 3; j++) {
+			ASSERT_NEAR(fout[(i * 3) + j], want[j], 1e-4);
+		}
+	}
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
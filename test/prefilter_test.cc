@@ -0,0 +1,216 @@
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/filter/prefilter.h>
+
+using namespace std;
+using namespace wr;
+
+
+static const double	Rate = 1000.0;
+
+
+// amplitude measures the steady-state amplitude of a biquad bank's
+// response to a sine on every channel.
+static double
+amplitude(filter::BiquadBankd &bank, double frequency)
+{
+	size_t		C = bank.channels();
+	vector<double>	frame(C);
+	double		peak = 0;
+
+	bank.reset();
+	for (size_t n = 0; n < 20000; n++) {
+		double	x = sin(2 * M_PI * frequency * n / Rate);
+
+		for (size_t c = 0; c < C; c++) {
+			frame[c] = x;
+		}
+		bank.process(frame.data(), frame.data(), 1);
+		if (n >= 10000) {
+			peak = max(peak, abs(frame[0]));
+		}
+	}
+	return peak;
+}
+
+
+TEST(Prefilter, LowPassDesign)
+{
+	filter::Biquad<double>	lp = filter::LowPassBiquad(50.0, Rate);
+
+	EXPECT_NEAR(lp.dcGain(), 1.0, 1e-12);
+	EXPECT_NEAR(lp.gain(0.0, Rate), 1.0, 1e-12);
+	EXPECT_NEAR(lp.gain(50.0, Rate), M_SQRT1_2, 1e-9);
+	EXPECT_LT(lp.gain(400.0, Rate), 0.02);
+	EXPECT_NEAR(lp.gain(499.999, Rate), 0.0, 1e-6);
+}
+
+
+TEST(Prefilter, NotchDesign)
+{
+	filter::Biquad<double>	notch = filter::NotchBiquad(120.0, Rate, 10.0);
+
+	EXPECT_NEAR(notch.dcGain(), 1.0, 1e-12);
+	EXPECT_NEAR(notch.gain(120.0, Rate), 0.0, 1e-9);
+	EXPECT_GT(notch.gain(100.0, Rate), 0.7);
+	EXPECT_GT(notch.gain(140.0, Rate), 0.7);
+}
+
+
+TEST(Prefilter, Butterworth)
+{
+	for (size_t order = 1; order <= 6; order++) {
+		filter::Biquad<double>	sections[3];
+		size_t			n = filter::ButterworthLowPass(order, 40.0, Rate, sections);
+		double			atCutoff = 1, atDouble = 1;
+
+		ASSERT_EQ(n, (order + 1) / 2);
+		for (size_t i = 0; i < n; i++) {
+			EXPECT_NEAR(sections[i].dcGain(), 1.0, 1e-12);
+			atCutoff *= sections[i].gain(40.0, Rate);
+			atDouble *= sections[i].gain(80.0, Rate);
+		}
+
+		// A Butterworth filter is 3 dB down at the cutoff for every
+		// order, and rolls off by about 6 dB per octave per order.
+		EXPECT_NEAR(atCutoff, M_SQRT1_2, 1e-9);
+		EXPECT_LT(atDouble, 1.1 / sqrt(1 + pow(2.0, 2.0 * order)));
+	}
+}
+
+
+TEST(Prefilter, BiquadBankMatchesScalar)
+{
+	const size_t		C = 7;
+	const size_t		frames = 500;
+	filter::BiquadBankd	bank(C, 2);
+	vector<double>		in(frames * C), out(frames * C);
+
+	bank.setStage(0, filter::LowPassBiquad(30.0, Rate));
+	bank.setStage(1, filter::NotchBiquad(100.0, Rate, 5.0));
+	bank.setStage(1, 3, filter::NotchBiquad(200.0, Rate, 5.0));
+	EXPECT_EQ(bank.stage(1, 3).b1, filter::NotchBiquad(200.0, Rate, 5.0).b1);
+
+	for (size_t i = 0; i < in.size(); i++) {
+		in[i] = sin(0.37 * i) + cos(0.011 * i * i);
+	}
+	bank.process(in.data(), out.data(), frames);
+
+	for (size_t c = 0; c < C; c++) {
+		filter::Biquad<double>	s[2] = {bank.stage(0, c), bank.stage(1, c)};
+		double			z1[2] = {0, 0}, z2[2] = {0, 0};
+
+		for (size_t f = 0; f < frames; f++) {
+			double	v = in[(f * C) + c];
+
+			// The same recurrence, one channel at a time.
+			for (size_t k = 0; k < 2; k++) {
+				double	y = (s[k].b0 * v) + z1[k];
+
+				z1[k] = (s[k].b1 * v) - (s[k].a1 * y) + z2[k];
+				z2[k] = (s[k].b2 * v) - (s[k].a2 * y);
+				v = y;
+			}
+			EXPECT_NEAR(out[(f * C) + c], v, 1e-12);
+		}
+	}
+}
+
+
+TEST(Prefilter, BiquadBankResponse)
+{
+	filter::BiquadBankd	bank(3, 1);
+
+	bank.setStage(0, filter::NotchBiquad(120.0, Rate, 10.0));
+	EXPECT_LT(amplitude(bank, 120.0), 1e-3);
+	EXPECT_NEAR(amplitude(bank, 10.0), 1.0, 1e-2);
+
+	bank.setStage(0, filter::LowPassBiquad(50.0, Rate));
+	EXPECT_NEAR(amplitude(bank, 50.0), M_SQRT1_2, 1e-2);
+}
+
+
+TEST(Prefilter, BiquadBankSteadyStart)
+{
+	filter::BiquadBankf	bank(3, 2);
+	float			gravity[3] = {0.1f, -0.2f, 9.81f};
+	float			frame[3];
+
+	bank.setStage(0, filter::LowPassBiquad(20.0f, 1000.0f));
+	bank.setStage(1, filter::NotchBiquad(60.0f, 1000.0f, 4.0f));
+	bank.reset(gravity);
+	for (size_t n = 0; n < 100; n++) {
+		for (size_t c = 0; c < 3; c++) {
+			frame[c] = gravity[c];
+		}
+		bank.process(frame, frame, 1);
+		for (size_t c = 0; c < 3; c++) {
+			EXPECT_NEAR(frame[c], gravity[c], 1e-3);
+		}
+	}
+}
+
+
+TEST(Prefilter, FIRBank)
+{
+	const size_t	C = 5;
+	const size_t	N = 31;
+	const size_t	frames = 200;
+	vector<double>	h(N);
+	vector<double>	in(frames * C), out(frames * C);
+
+	filter::LowPassFIR(N, 50.0, Rate, h.data());
+
+	double	sum = 0;
+
+	for (size_t k = 0; k < N; k++) {
+		sum += h[k];
+		EXPECT_NEAR(h[k], h[N - 1 - k], 1e-15);
+	}
+	EXPECT_NEAR(sum, 1.0, 1e-12);
+
+	for (size_t i = 0; i < in.size(); i++) {
+		in[i] = sin(0.21 * i) + (0.01 * i);
+	}
+
+	filter::FIRBankd	bank(C, h.data(), N);
+
+	EXPECT_EQ(bank.taps(), N);
+
+	// Process in two uneven blocks, the second in place.
+	out = in;
+	bank.process(in.data(), out.data(), 37);
+	bank.process(out.data() + (37 * C), out.data() + (37 * C), frames - 37);
+
+	for (size_t f = 0; f < frames; f++) {
+		for (size_t c = 0; c < C; c++) {
+			double	want = 0;
+
+			for (size_t k = 0; k < N && k <= f; k++) {
+				want += h[k] * in[((f - k) * C) + c];
+			}
+			EXPECT_NEAR(out[(f * C) + c], want, 1e-12);
+		}
+	}
+
+	double	dc[C] = {1, 2, 3, 4, 5};
+	double	frame[C];
+
+	bank.reset(dc);
+	for (size_t c = 0; c < C; c++) {
+		frame[c] = dc[c];
+	}
+	bank.process(frame, frame, 1);
+	for (size_t c = 0; c < C; c++) {
+		EXPECT_NEAR(frame[c], dc[c], 1e-12);
+	}
+}
+
+
+int
+main(int argc, char *argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -107,6 +107,25 @@ TEST(Quaterniond, Rotate)
 }
 
 
+TEST(Quaterniond, RotateOblique)
+{
+	// A vector that isn't perpendicular to the axis keeps its
+	// component along it, however long the vector is.
+	geom::Quaterniond	p = geom::quaterniond(geom::Vector3d{0.0, 0.0, 1.0}, M_PI / 2);
+
+	EXPECT_EQ(p.rotate(geom::Vector3d{1.0, 0.0, 1.0}), (geom::Vector3d{0.0, -1.0, 1.0}));
+	EXPECT_EQ(p.rotate(geom::Vector3d{100.0, 0.0, 100.0}), (geom::Vector3d{0.0, -100.0, 100.0}));
+
+	// Rotating by q then by r is the same as rotating by q * r.
+	geom::Quaterniond	q = geom::quaterniond(geom::Vector3d{1.0, -2.0, 0.5}, 0.7);
+	geom::Quaterniond	r = geom::quaterniond(geom::Vector3d{-0.3, 0.4, 2.0}, -1.9);
+	geom::Vector3d		v {1.5, 2.5, -3.5};
+
+	EXPECT_EQ(r.rotate(q.rotate(v)), (q * r).rotate(v));
+	EXPECT_EQ(q.conjugate().rotate(q.rotate(v)), v);
+}
+
+
 TEST(Quaterniond, ShortestSLERP)
 {
 	// Our starting point is an orientation that is yawed 45° - our
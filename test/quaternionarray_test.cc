@@ -0,0 +1,197 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/parallel.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/quaternionarray.h>
+
+using namespace std;
+using namespace wr;
+
+
+static vector<double>
+randomQuaternions(size_t count, unsigned seed)
+{
+	mt19937				rng(seed);
+	normal_distribution<double>	n;
+	vector<double>			q(count * 4);
+
+	for (size_t i = 0; i < q.size(); i++) {
+		q[i] = n(rng);
+	}
+	return q;
+}
+
+
+static geom::Quaterniond
+at(const vector<double> &q, size_t i)
+{
+	return geom::Quaterniond{q[i * 4], q[(i * 4) + 1], q[(i * 4) + 2], q[(i * 4) + 3]};
+}
+
+
+static void
+expectQuaternion(const vector<double> &q, size_t i, const geom::Quaterniond &want)
+{
+	geom::Vector3d	v = want.axis();
+
+	EXPECT_NEAR(q[i * 4], want.angle(), 1e-12) << "quaternion " << i;
+	EXPECT_NEAR(q[(i * 4) + 1], v[0], 1e-12) << "quaternion " << i;
+	EXPECT_NEAR(q[(i * 4) + 2], v[1], 1e-12) << "quaternion " << i;
+	EXPECT_NEAR(q[(i * 4) + 3], v[2], 1e-12) << "quaternion " << i;
+}
+
+
+TEST(QuaternionArray, Multiply)
+{
+	const size_t	count = 101;
+	vector<double>	a = randomQuaternions(count, 1);
+	vector<double>	b = randomQuaternions(count, 2);
+	vector<double>	out(count * 4);
+	double		p[4] = {0.5, -0.5, 0.5, 0.5};
+
+	geom::QuaternionMultiply(a.data(), b.data(), out.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		expectQuaternion(out, i, at(a, i) * at(b, i));
+	}
+
+	geom::QuaternionMultiplyLeft(p, b.data(), out.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		expectQuaternion(out, i, geom::Quaterniond{0.5, -0.5, 0.5, 0.5} * at(b, i));
+	}
+
+	geom::QuaternionMultiplyRight(a.data(), p, out.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		expectQuaternion(out, i, at(a, i) * geom::Quaterniond{0.5, -0.5, 0.5, 0.5});
+	}
+
+	// In place, into either operand.
+	vector<double>	c = a;
+
+	geom::QuaternionMultiply(c.data(), b.data(), c.data(), count);
+	geom::QuaternionMultiply(a.data(), b.data(), out.data(), count);
+	EXPECT_EQ(c, out);
+	c = b;
+	geom::QuaternionMultiply(a.data(), c.data(), c.data(), count);
+	EXPECT_EQ(c, out);
+}
+
+
+TEST(QuaternionArray, ConjugateInverse)
+{
+	const size_t	count = 64;
+	vector<double>	a = randomQuaternions(count, 3);
+	vector<double>	out(count * 4), prod(count * 4);
+
+	geom::QuaternionConjugate(a.data(), out.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		expectQuaternion(out, i, at(a, i).conjugate());
+	}
+
+	geom::QuaternionInverse(a.data(), out.data(), count);
+	geom::QuaternionMultiply(a.data(), out.data(), prod.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		expectQuaternion(out, i, at(a, i).inverse());
+		expectQuaternion(prod, i, geom::Quaterniond{1.0, 0.0, 0.0, 0.0});
+	}
+
+	geom::QuaternionInverse(a.data(), a.data(), count);
+	EXPECT_EQ(a, out);
+}
+
+
+TEST(QuaternionArray, DotNorm)
+{
+	const size_t	count = 50;
+	vector<double>	a = randomQuaternions(count, 4);
+	vector<double>	b = randomQuaternions(count, 5);
+	vector<double>	dot(count), norm(count);
+
+	geom::QuaternionDot(a.data(), b.data(), dot.data(), count);
+	geom::QuaternionNorm(a.data(), norm.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_NEAR(dot[i], at(a, i).dot(at(b, i)), 1e-12);
+		EXPECT_NEAR(norm[i], at(a, i).norm(), 1e-12);
+	}
+}
+
+
+TEST(QuaternionArray, Parallel)
+{
+	// Enough quaternions for several chunks, on a pool of four.
+	const size_t		count = (geom::QuaternionGrain * 3) + 17;
+	parallel::ThreadPool	pool(4);
+	vector<double>		a = randomQuaternions(count, 6);
+	vector<double>		b = randomQuaternions(count, 7);
+	vector<double>		serial(count * 4), threaded(count * 4);
+	vector<double>		norm(count);
+
+	for (size_t i = 0; i < count; i += geom::QuaternionGrain / 2) {
+		size_t	n = min(count - i, geom::QuaternionGrain / 2);
+
+		geom::QuaternionMultiply(a.data() + (i * 4), b.data() + (i * 4),
+					 serial.data() + (i * 4), n);
+	}
+	geom::QuaternionMultiply(a.data(), b.data(), threaded.data(), count, &pool);
+	EXPECT_EQ(serial, threaded);
+
+	geom::QuaternionNorm(threaded.data(), norm.data(), count, &pool);
+	for (size_t i = 0; i < count; i += 997) {
+		EXPECT_NEAR(norm[i], at(a, i).norm() * at(b, i).norm(), 1e-12);
+	}
+}
+
+
+TEST(QuaternionArray, QuaternionObjects)
+{
+	const size_t			count = 40;
+	vector<double>			raw = randomQuaternions(count * 2, 8);
+	vector<geom::Quaterniond>	a, b;
+	vector<geom::Quaterniond>	out(count);
+	vector<double>			scalars(count);
+	geom::Quaterniond		p {0.5, -0.5, 0.5, 0.5};
+
+	for (size_t i = 0; i < count; i++) {
+		a.push_back(at(raw, i));
+		b.push_back(at(raw, count + i));
+	}
+
+	geom::QuaternionMultiply(a.data(), b.data(), out.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(out[i], a[i] * b[i]);
+	}
+	geom::QuaternionMultiplyLeft(p, b.data(), out.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(out[i], p * b[i]);
+	}
+	geom::QuaternionMultiplyRight(a.data(), p, out.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(out[i], a[i] * p);
+	}
+	geom::QuaternionConjugate(a.data(), out.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(out[i], a[i].conjugate());
+	}
+	geom::QuaternionInverse(a.data(), out.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(out[i], a[i].inverse());
+	}
+	geom::QuaternionDot(a.data(), b.data(), scalars.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_DOUBLE_EQ(scalars[i], a[i].dot(b[i]));
+	}
+	geom::QuaternionNorm(a.data(), scalars.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_DOUBLE_EQ(scalars[i], a[i].norm());
+	}
+}
+
+
+int
+main(int argc, char *argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,149 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/renormalize.h>
+#include <wrmath/filter/madgwick.h>
+
+using namespace std;
+using namespace wr;
+
+
+static double
+normError(const double *q)
+{
+	return abs(1 - ((q[0] * q[0]) + (q[1] * q[1]) + (q[2] * q[2]) + (q[3] * q[3])));
+}
+
+
+TEST(Renormalize, Quaternion)
+{
+	const geom::Quaterniond	q {2.0, 0.0, 0.0, 0.0};
+
+	EXPECT_DOUBLE_EQ(q.normSquared(), 4.0);
+	EXPECT_EQ(q.unitQuaternion(), (geom::Quaterniond{1.0, 0.0, 0.0, 0.0}));
+}
+
+
+TEST(Renormalize, FastStep)
+{
+	double	q[4] = {0.5, 0.5, 0.5, 0.5};
+
+	// The first-order step roughly squares the error in the norm.
+	for (double scale : {1.001, 0.999, 1.01}) {
+		double	r[4];
+		double	e;
+
+		for (size_t i = 0; i < 4; i++) {
+			r[i] = q[i] * sqrt(scale);
+		}
+		e = normError(r);
+		geom::RenormalizeFast(r);
+		EXPECT_LT(normError(r), e * e);
+		EXPECT_NEAR(r[1] / r[0], 1.0, 1e-15);
+	}
+}
+
+
+TEST(Renormalize, ChoosesMethod)
+{
+	double	small[4] = {1.0005, 0.0, 0.0, 0.0};
+	double	large[4] = {0.0, 3.0, 4.0, 0.0};
+	double	zero[4] = {0.0, 0.0, 0.0, 0.0};
+
+	EXPECT_TRUE(geom::Renormalize(small, 1e-2));
+	EXPECT_LT(normError(small), 1e-5);
+
+	EXPECT_TRUE(geom::Renormalize(large, 1e-2));
+	EXPECT_NEAR(large[1], 0.6, 1e-15);
+	EXPECT_NEAR(large[2], 0.8, 1e-15);
+
+	EXPECT_FALSE(geom::Renormalize(zero, 1e-2));
+	EXPECT_EQ(zero[0], 0.0);
+
+	double	arr[8] = {1.0005, 0.0, 0.0, 0.0, 0.0, 3.0, 4.0, 0.0};
+
+	geom::RenormalizeArray(arr, 2, 1e-2);
+	EXPECT_LT(normError(arr), 1e-5);
+	EXPECT_LT(normError(arr + 4), 1e-15);
+
+	geom::Quaterniond	q = geom::Renormalize(geom::Quaterniond{0.0, 0.0, 0.0, 2.0}, 1e-2);
+
+	EXPECT_NEAR(q.normSquared(), 1.0, 1e-15);
+}
+
+
+TEST(Renormalize, Schedule)
+{
+	geom::RenormalizeOptions<double>	opts;
+
+	opts.interval = 4;
+	opts.tolerance = 0;
+
+	geom::Renormalizerd	r(opts);
+	double			q[4] = {1.0, 0.0, 0.0, 0.0};
+
+	for (int i = 1; i <= 12; i++) {
+		q[0] *= 1.0001;
+		EXPECT_EQ(r.step(q), i % 4 == 0) << "step " << i;
+	}
+	EXPECT_EQ(r.fastCount(), 3u);
+	EXPECT_EQ(r.exactCount(), 0u);
+
+	// The tolerance check renormalizes as soon as the error is too
+	// large, and restarts the schedule.
+	opts.interval = 100;
+	opts.tolerance = 1e-3;
+	r.setOptions(opts);
+	q[0] = 1.0;
+	EXPECT_FALSE(r.step(q));
+	q[0] = 1.001;
+	EXPECT_TRUE(r.step(q));
+	EXPECT_LT(normError(q), 1e-5);
+
+	// Errors beyond the fast limit are normalised exactly.
+	q[0] = 2.0;
+	EXPECT_TRUE(r.step(q));
+	EXPECT_EQ(r.exactCount(), 1u);
+	EXPECT_DOUBLE_EQ(q[0], 1.0);
+
+	geom::Quaterniond	p {1.5, 0.0, 0.0, 0.0};
+
+	EXPECT_TRUE(r.step(p));
+	EXPECT_DOUBLE_EQ(p.normSquared(), 1.0);
+}
+
+
+TEST(Renormalize, LongMadgwickRun)
+{
+	filter::Madgwickd			managed;
+	filter::Madgwickd			unmanaged;
+	geom::RenormalizeOptions<double>	off;
+	geom::Vector3d				gyro {1.0, -2.0, 4.0};
+	const double				delta = 0.01;
+
+	off.interval = 0;
+	off.tolerance = 0;
+	unmanaged.setRenormalization(off);
+
+	for (int i = 0; i < 2000; i++) {
+		managed.updateAngularOrientation(gyro, delta);
+		unmanaged.updateAngularOrientation(gyro, delta);
+		ASSERT_NEAR(managed.orientation().normSquared(), 1.0, 2e-3);
+	}
+
+	// Without renormalization the norm grows by about |ω δ / 2|² per
+	// step, enough to ruin the filter over a long run.
+	EXPECT_GT(unmanaged.orientation().norm(), 1.5);
+	EXPECT_EQ(unmanaged.renormalization().fastCount(), 0u);
+	EXPECT_GT(managed.renormalization().fastCount(), 100u);
+	EXPECT_EQ(managed.renormalization().exactCount(), 0u);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
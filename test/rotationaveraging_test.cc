@@ -0,0 +1,333 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/parallel.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/rotationaveraging.h>
+
+using namespace std;
+using namespace wr;
+
+
+static geom::Quaterniond
+randomQuaternion(mt19937 &rng)
+{
+	normal_distribution<double>	n;
+
+	return geom::Quaterniond{n(rng), n(rng), n(rng), n(rng)}.unitQuaternion();
+}
+
+
+// smallRotation returns a rotation about a random axis, with each
+// component of its rotation vector drawn with deviation sigma.
+static geom::Quaterniond
+smallRotation(mt19937 &rng, double sigma)
+{
+	normal_distribution<double>	n(0.0, sigma);
+	geom::Vector3d			v {n(rng), n(rng), n(rng)};
+	double				angle = v.magnitude();
+
+	if (angle == 0.0) {
+		return geom::Quaterniond{1.0, 0.0, 0.0, 0.0};
+	}
+	return geom::Quaterniond(v * (sin(angle / 2) / angle), cos(angle / 2));
+}
+
+
+// angleBetween returns the angle of the rotation taking a to b.
+static double
+angleBetween(const geom::Quaterniond &a, const geom::Quaterniond &b)
+{
+	double	d = fabs(a.unitQuaternion().dot(b.unitQuaternion()));
+
+	return 2 * acos(d > 1.0 ? 1.0 : d);
+}
+
+
+// Graph holds a ground truth and a set of edges joining its nodes: a
+// chain through every node, so it's connected, plus random extra edges.
+struct Graph {
+	vector<geom::Quaterniond>	truth;
+	vector<size_t>			from;
+	vector<size_t>			to;
+
+	Graph(size_t nodes, size_t extra, mt19937 &rng)
+	{
+		uniform_int_distribution<size_t>	pick(0, nodes - 1);
+
+		truth.push_back(geom::Quaterniond{1.0, 0.0, 0.0, 0.0});
+		for (size_t n = 1; n < nodes; n++) {
+			truth.push_back(randomQuaternion(rng));
+			from.push_back(n - 1);
+			to.push_back(n);
+		}
+		while (from.size() < nodes - 1 + extra) {
+			size_t	i = pick(rng), j = pick(rng);
+
+			if (i != j) {
+				from.push_back(i);
+				to.push_back(j);
+			}
+		}
+	}
+
+	geom::Quaterniond
+	relative(size_t e) const
+	{
+		return truth[from[e]].conjugate() * truth[to[e]];
+	}
+
+	double
+	rmsError(const geom::RotationGraphd &g) const
+	{
+		double	sum = 0;
+
+		for (size_t n = 0; n < truth.size(); n++) {
+			double	a = angleBetween(g.orientation(n), truth[n]);
+
+			sum += a * a;
+		}
+		return sqrt(sum / truth.size());
+	}
+};
+
+
+TEST(RotationAveraging, MeasurementConvention)
+{
+	mt19937			rng(1);
+	geom::Quaterniond	qi = randomQuaternion(rng);
+	geom::Quaterniond	qj = randomQuaternion(rng);
+	geom::RotationGraphd	g(2);
+
+	ASSERT_TRUE(g.addEdge(1, 0, qj.conjugate() * qi));
+	ASSERT_TRUE(g.solve());
+
+	// Node 0 is the anchor, so node 1 is qj relative to it.
+	EXPECT_LT(angleBetween(g.orientation(0), geom::Quaterniond{1.0, 0.0, 0.0, 0.0}), 1e-12);
+	EXPECT_LT(angleBetween(g.orientation(1), qi.conjugate() * qj), 1e-7);
+	EXPECT_LT(g.edgeError(0), 1e-7);
+}
+
+
+TEST(RotationAveraging, InvalidEdges)
+{
+	geom::RotationGraphd	g(3);
+	geom::Quaterniond	q {1.0, 0.0, 0.0, 0.0};
+
+	EXPECT_FALSE(g.addEdge(0, 0, q));
+	EXPECT_FALSE(g.addEdge(0, 3, q));
+	EXPECT_FALSE(g.addEdge(0, 1, q, 0.0));
+	EXPECT_FALSE(g.addEdge(0, 1, geom::Quaterniond{0.0, 0.0, 0.0, 0.0}));
+	EXPECT_EQ(g.edges(), 0);
+}
+
+
+TEST(RotationAveraging, ExactMeasurements)
+{
+	mt19937			rng(2);
+	Graph			truth(100, 300, rng);
+	geom::RotationGraphd	g(100);
+
+	for (size_t e = 0; e < truth.from.size(); e++) {
+		ASSERT_TRUE(g.addEdge(truth.from[e], truth.to[e], truth.relative(e)));
+	}
+
+	geom::RotationAveragingOptionsd	opts;
+
+	opts.maxIterations = 0;
+	ASSERT_TRUE(g.solve(opts));
+	EXPECT_LT(truth.rmsError(g), 1e-7);
+
+	opts.maxIterations = 20;
+	ASSERT_TRUE(g.solve(opts));
+	EXPECT_LT(truth.rmsError(g), 1e-7);
+	EXPECT_LE(g.iterations(), 2);
+}
+
+
+TEST(RotationAveraging, NoisyMeasurements)
+{
+	mt19937			rng(3);
+	Graph			truth(200, 800, rng);
+	geom::RotationGraphd	g(200);
+	vector<geom::Quaterniond>	measured;
+
+	for (size_t e = 0; e < truth.from.size(); e++) {
+		measured.push_back(truth.relative(e) * smallRotation(rng, 0.01));
+		g.addEdge(truth.from[e], truth.to[e], measured.back());
+	}
+
+	// Chaining the measurements from the anchor accumulates the noise.
+	vector<geom::Quaterniond>	chained(1, geom::Quaterniond{1.0, 0.0, 0.0, 0.0});
+	double				chainSum = 0;
+
+	for (size_t n = 1; n < 200; n++) {
+		chained.push_back(chained.back() * measured[n - 1]);
+
+		double	a = angleBetween(chained.back(), truth.truth[n]);
+
+		chainSum += a * a;
+	}
+
+	geom::RotationAveragingOptionsd	opts;
+
+	opts.maxIterations = 0;
+	ASSERT_TRUE(g.solve(opts));
+
+	double	chordal = truth.rmsError(g);
+
+	opts.maxIterations = 20;
+	ASSERT_TRUE(g.solve(opts));
+
+	double	refined = truth.rmsError(g);
+
+	EXPECT_LT(chordal, 0.02);
+	EXPECT_LT(refined, 0.02);
+	EXPECT_LT(refined, sqrt(chainSum / 199) / 5);
+	EXPECT_LT(g.iterations(), 20);
+
+	// The edge errors that remain are about the size of the noise.
+	double	cost = 0;
+
+	for (size_t e = 0; e < g.edges(); e++) {
+		cost += g.edgeError(e) * g.edgeError(e);
+	}
+	EXPECT_LT(cost, 800 * 3 * 0.01 * 0.01 * 2);
+}
+
+
+TEST(RotationAveraging, Outliers)
+{
+	mt19937				rng(4);
+	Graph				truth(100, 500, rng);
+	geom::RotationGraphd		g(100);
+	uniform_real_distribution<double>	u;
+
+	for (size_t e = 0; e < truth.from.size(); e++) {
+		geom::Quaterniond	m = truth.relative(e) * smallRotation(rng, 0.005);
+
+		// The chain stays clean so outliers can't disconnect anything.
+		if (e >= 99 && u(rng) < 0.1) {
+			m = randomQuaternion(rng);
+		}
+		g.addEdge(truth.from[e], truth.to[e], m);
+	}
+
+	geom::RotationAveragingOptionsd	opts;
+
+	ASSERT_TRUE(g.solve(opts));
+
+	double	plain = truth.rmsError(g);
+
+	opts.robustScale = 0.05;
+	opts.maxIterations = 50;
+	ASSERT_TRUE(g.solve(opts));
+
+	double	robust = truth.rmsError(g);
+
+	EXPECT_LT(robust, plain / 2);
+	EXPECT_LT(robust, 0.05);
+}
+
+
+TEST(RotationAveraging, Disconnected)
+{
+	mt19937			rng(5);
+	geom::Quaterniond	a = randomQuaternion(rng);
+	geom::Quaterniond	b = randomQuaternion(rng);
+	geom::RotationGraphd	g(5);
+
+	g.addEdge(0, 1, a);
+	g.addEdge(1, 2, b);
+	g.addEdge(3, 4, a);
+
+	EXPECT_FALSE(g.solve());
+	EXPECT_LT(angleBetween(g.orientation(1), a), 1e-7);
+	EXPECT_LT(angleBetween(g.orientation(2), a * b), 1e-7);
+	EXPECT_EQ(g.orientation(3), (geom::Quaterniond{1.0, 0.0, 0.0, 0.0}));
+	EXPECT_EQ(g.orientation(4), (geom::Quaterniond{1.0, 0.0, 0.0, 0.0}));
+}
+
+
+TEST(RotationAveraging, Anchor)
+{
+	mt19937			rng(6);
+	Graph			truth(20, 40, rng);
+	geom::RotationGraphd	g(20);
+
+	for (size_t e = 0; e < truth.from.size(); e++) {
+		g.addEdge(truth.from[e], truth.to[e], truth.relative(e));
+	}
+
+	geom::RotationAveragingOptionsd	opts;
+
+	opts.anchor = 7;
+	ASSERT_TRUE(g.solve(opts));
+	EXPECT_EQ(g.orientation(7), (geom::Quaterniond{1.0, 0.0, 0.0, 0.0}));
+	for (size_t n = 0; n < 20; n++) {
+		geom::Quaterniond	expected = truth.truth[7].conjugate() * truth.truth[n];
+
+		EXPECT_LT(angleBetween(g.orientation(n), expected), 1e-7);
+	}
+}
+
+
+TEST(RotationAveraging, PoolSizeDoesNotMatter)
+{
+	mt19937			rng(7);
+	Graph			truth(3000, 9000, rng);
+	geom::RotationGraphd	a(3000), b(3000);
+
+	for (size_t e = 0; e < truth.from.size(); e++) {
+		geom::Quaterniond	m = truth.relative(e) * smallRotation(rng, 0.01);
+
+		a.addEdge(truth.from[e], truth.to[e], m);
+		b.addEdge(truth.from[e], truth.to[e], m);
+	}
+
+	parallel::ThreadPool		one(1), four(4);
+	geom::RotationAveragingOptionsd	opts;
+
+	ASSERT_TRUE(a.solve(opts, &one));
+	ASSERT_TRUE(b.solve(opts, &four));
+	EXPECT_EQ(a.iterations(), b.iterations());
+	for (size_t i = 0; i < 3000 * 4; i++) {
+		EXPECT_EQ(a.orientations()[i], b.orientations()[i]);
+	}
+	EXPECT_LT(truth.rmsError(b), 0.02);
+}
+
+
+TEST(RotationAveraging, Float)
+{
+	mt19937			rng(8);
+	Graph			truth(50, 150, rng);
+	geom::RotationGraphf	g(50);
+
+	for (size_t e = 0; e < truth.from.size(); e++) {
+		geom::Quaterniond	m = truth.relative(e);
+		geom::Vector3d		v = m.axis();
+
+		g.addEdge(truth.from[e], truth.to[e],
+			  geom::Quaternionf{(float)m.angle(), (float)v[0], (float)v[1], (float)v[2]});
+	}
+
+	ASSERT_TRUE(g.solve());
+	for (size_t n = 0; n < 50; n++) {
+		geom::Quaternionf	q = g.orientation(n);
+		geom::Vector3f		v = q.axis();
+		geom::Quaterniond	d {q.angle(), v[0], v[1], v[2]};
+
+		EXPECT_LT(angleBetween(d, truth.truth[n]), 1e-3);
+	}
+}
+
+
+int
+main(int argc, char *argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,190 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/rotator.h>
+
+using namespace std;
+using namespace wr;
+
+
+static geom::Quaterniond
+randomQuaternion(mt19937 &rng)
+{
+	normal_distribution<double>	n;
+
+	return geom::Quaterniond{n(rng), n(rng), n(rng), n(rng)}.unitQuaternion();
+}
+
+
+static void
+expectNear(const geom::Vector3d &a, const geom::Vector3d &b, double tol)
+{
+	for (size_t k = 0; k < 3; k++) {
+		EXPECT_NEAR(a[k], b[k], tol);
+	}
+}
+
+
+TEST(Rotator, Identity)
+{
+	geom::Rotatord	r;
+	geom::Vector3d	v {1.0, -2.0, 3.0};
+
+	EXPECT_EQ(r(v), v);
+	EXPECT_EQ(r.quaternion(), (geom::Quaterniond{1.0, 0.0, 0.0, 0.0}));
+}
+
+
+TEST(Rotator, MatchesQuaternion)
+{
+	mt19937				rng(1);
+	normal_distribution<double>	n;
+
+	for (int i = 0; i < 100; i++) {
+		geom::Quaterniond	q = randomQuaternion(rng);
+		geom::Rotatord		r(q);
+		geom::Vector3d		v {n(rng), n(rng), n(rng)};
+
+		expectNear(r(v), q.rotate(v), 1e-12);
+
+		// The matrix is orthonormal with determinant one.
+		const double	*m = r.matrix();
+		double		det = m[0] * ((m[4] * m[8]) - (m[5] * m[7])) -
+				      m[1] * ((m[3] * m[8]) - (m[5] * m[6])) +
+				      m[2] * ((m[3] * m[7]) - (m[4] * m[6]));
+
+		EXPECT_NEAR(det, 1.0, 1e-12);
+	}
+}
+
+
+TEST(Rotator, NormalisesInput)
+{
+	geom::Quaterniond	q = geom::quaterniond(geom::Vector3d{0.0, 0.0, 1.0}, M_PI / 2);
+	geom::Rotatord		r(q * 3.0);
+	geom::Vector3d		v {1.0, 0.0, 0.0};
+
+	expectNear(r(v), q.rotate(v), 1e-15);
+	EXPECT_NEAR(r.quaternion().norm(), 1.0, 1e-15);
+}
+
+
+TEST(Rotator, InverseAndCompose)
+{
+	mt19937				rng(2);
+	normal_distribution<double>	n;
+
+	for (int i = 0; i < 50; i++) {
+		geom::Quaterniond	a = randomQuaternion(rng);
+		geom::Quaterniond	b = randomQuaternion(rng);
+		geom::Rotatord		ra(a), rb(b);
+		geom::Vector3d		v {n(rng), n(rng), n(rng)};
+
+		expectNear(ra.inverse()(ra(v)), v, 1e-12);
+		expectNear(ra.inverse()(v), a.conjugate().rotate(v), 1e-12);
+
+		// Composing rotates by the first, then the second, like
+		// the quaternion product.
+		geom::Rotatord	rab = ra * rb;
+
+		expectNear(rab(v), rb(ra(v)), 1e-12);
+		expectNear(rab(v), (a * b).rotate(v), 1e-12);
+		expectNear(ra.compose(rb).inverse()(rab(v)), v, 1e-12);
+	}
+}
+
+
+TEST(Rotator, Arrays)
+{
+	mt19937				rng(3);
+	normal_distribution<double>	n;
+	geom::Quaterniond		q = randomQuaternion(rng);
+	geom::Rotatord			r(q);
+	const size_t			count = 37;
+	vector<double>			in(count * 3), out(count * 3);
+	vector<geom::Vector3d>		vin, vout(count);
+
+	for (size_t i = 0; i < in.size(); i++) {
+		in[i] = n(rng);
+	}
+	for (size_t i = 0; i < count; i++) {
+		vin.push_back(geom::Vector3d(&in[i * 3]));
+	}
+
+	r.rotate(in.data(), out.data(), count);
+	r.rotate(vin.data(), vout.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		geom::Vector3d	want = q.rotate(vin[i]);
+
+		expectNear(geom::Vector3d(&out[i * 3]), want, 1e-12);
+		expectNear(vout[i], want, 1e-12);
+	}
+
+	// In place.
+	vector<double>	inPlace = in;
+
+	r.rotate(inPlace.data(), inPlace.data(), count);
+	EXPECT_EQ(inPlace, out);
+
+	// Records of <x, y, z, w> with only the vector rotated, written
+	// to a packed array.
+	vector<double>	records(count * 4), packed(count * 3);
+
+	for (size_t i = 0; i < count; i++) {
+		for (size_t k = 0; k < 3; k++) {
+			records[(i * 4) + k] = in[(i * 3) + k];
+		}
+		records[(i * 4) + 3] = (double)i;
+	}
+	r.rotate(records.data(), 4, packed.data(), 3, count);
+	EXPECT_EQ(packed, out);
+	r.rotate(records.data(), 4, records.data(), 4, count);
+	for (size_t i = 0; i < count; i++) {
+		for (size_t k = 0; k < 3; k++) {
+			EXPECT_EQ(records[(i * 4) + k], out[(i * 3) + k]);
+		}
+		EXPECT_EQ(records[(i * 4) + 3], (double)i);
+	}
+
+	// Separate coordinate arrays.
+	vector<double>	x(count), y(count), z(count);
+
+	for (size_t i = 0; i < count; i++) {
+		x[i] = in[i * 3];
+		y[i] = in[(i * 3) + 1];
+		z[i] = in[(i * 3) + 2];
+	}
+	r.rotate(x.data(), y.data(), z.data(), count);
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(x[i], out[i * 3]);
+		EXPECT_EQ(y[i], out[(i * 3) + 1]);
+		EXPECT_EQ(z[i], out[(i * 3) + 2]);
+	}
+}
+
+
+TEST(Rotator, Float)
+{
+	geom::Quaternionf	q = geom::quaternionf(geom::Vector3f{1.0f, 1.0f, 0.0f}, 0.5f);
+	geom::Rotatorf		r(q);
+	float			raw[4] = {q.angle(), q.axis()[0], q.axis()[1], q.axis()[2]};
+	geom::Rotatorf		fromRaw(raw);
+	geom::Vector3f		v {0.0f, 0.0f, 1.0f};
+	geom::Vector3f		want = (q.conjugate() * geom::Quaternionf(v, 0.0f) * q).axis();
+
+	for (size_t k = 0; k < 3; k++) {
+		EXPECT_NEAR(r(v)[k], want[k], 1e-6);
+		EXPECT_NEAR(fromRaw(v)[k], want[k], 1e-6);
+	}
+}
+
+
+int
+main(int argc, char *argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
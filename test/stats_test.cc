@@ -0,0 +1,124 @@
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/parallel.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/stats.h>
+
+using namespace std;
+using namespace wr;
+
+
+TEST(VectorStats, Small)
+{
+	vector<geom::Vector3d>	v = {
+		geom::Vector3d{1.0, 2.0, 3.0},
+		geom::Vector3d{-1.0, 4.0, 0.0},
+		geom::Vector3d{3.0, 0.0, -3.0},
+	};
+
+	EXPECT_EQ(geom::Sum(v.data(), v.size()), (geom::Vector3d{3.0, 6.0, 0.0}));
+	EXPECT_EQ(geom::Centroid(v.data(), v.size()), (geom::Vector3d{1.0, 2.0, 0.0}));
+	EXPECT_EQ(geom::Sum(v.data(), 0), (geom::Vector3d{0.0, 0.0, 0.0}));
+
+	geom::BoundingBox<double, 3>	box = geom::Bounds(v.data(), v.size());
+	EXPECT_EQ(box.min, (geom::Vector3d{-1.0, 0.0, -3.0}));
+	EXPECT_EQ(box.max, (geom::Vector3d{3.0, 4.0, 3.0}));
+	EXPECT_EQ(box.center(), (geom::Vector3d{1.0, 2.0, 0.0}));
+	EXPECT_EQ(box.extent(), (geom::Vector3d{4.0, 4.0, 6.0}));
+	EXPECT_TRUE(box.contains(v[1]));
+	EXPECT_FALSE(box.contains(geom::Vector3d{0.0, 5.0, 0.0}));
+
+	double		cov[9];
+	geom::Vector3d	mean = geom::Covariance(v.data(), v.size(), cov);
+	double		want[9] = {4.0, -4.0, -3.0, -4.0, 4.0, 3.0, -3.0, 3.0, 9.0};
+
+	EXPECT_EQ(mean, (geom::Vector3d{1.0, 2.0, 0.0}));
+	for (int i = 0; i < 9; i++) {
+		EXPECT_NEAR(cov[i], want[i], 1e-12) << "element " << i;
+	}
+
+	geom::Covariance(v.data(), 1, cov);
+	for (int i = 0; i < 9; i++) {
+		EXPECT_EQ(cov[i], 0.0);
+	}
+}
+
+
+TEST(VectorStats, CompensatedSum)
+{
+	// 0.1 isn't representable in float, and naive summation of a
+	// million of them drifts by about 1%.
+	const size_t	count = 1000000;
+	vector<float>	data(count * 2);
+
+	for (size_t i = 0; i < count; i++) {
+		data[i * 2] = 0.1f;
+		data[(i * 2) + 1] = 1.0f;
+	}
+
+	geom::Vector2f	sum = geom::Sum<2>(data.data(), count);
+	EXPECT_NEAR(sum[0], 100000.0, 0.01);
+	EXPECT_EQ(sum[1], 1000000.0f);
+}
+
+
+TEST(VectorStats, ThreadIndependent)
+{
+	const size_t	count = 100003;
+	vector<double>	data(count * 3);
+
+	for (size_t i = 0; i < data.size(); i++) {
+		data[i] = 1000.0 + std::sin(0.1 * i) * (1.0 + (i % 7));
+	}
+
+	parallel::ThreadPool	one(1);
+	parallel::ThreadPool	four(4);
+	double			cov1[9], cov4[9];
+
+	geom::Vector3d	s1 = geom::Sum<3>(data.data(), count, &one);
+	geom::Vector3d	s4 = geom::Sum<3>(data.data(), count, &four);
+	geom::Vector3d	m1 = geom::Covariance<3>(data.data(), count, cov1, &one);
+	geom::Vector3d	m4 = geom::Covariance<3>(data.data(), count, cov4, &four);
+
+	for (size_t k = 0; k < 3; k++) {
+		EXPECT_EQ(s1[k], s4[k]);
+		EXPECT_EQ(m1[k], m4[k]);
+	}
+	for (int i = 0; i < 9; i++) {
+		EXPECT_EQ(cov1[i], cov4[i]);
+	}
+
+	// Check against a straightforward two-pass computation in long
+	// double.
+	long double	mean[3] = {0, 0, 0};
+	for (size_t i = 0; i < count; i++) {
+		for (size_t k = 0; k < 3; k++) {
+			mean[k] += data[(i * 3) + k];
+		}
+	}
+	for (size_t k = 0; k < 3; k++) {
+		mean[k] /= count;
+		EXPECT_NEAR(m4[k], (double)mean[k], 1e-9);
+	}
+
+	long double	c01 = 0;
+	for (size_t i = 0; i < count; i++) {
+		c01 += (data[i * 3] - mean[0]) * (data[(i * 3) + 1] - mean[1]);
+	}
+	EXPECT_NEAR(cov4[1], (double)(c01 / (count - 1)), 1e-9);
+	EXPECT_EQ(cov4[1], cov4[3]);
+
+	geom::BoundingBox<double, 3>	box = geom::Bounds<3>(data.data(), count, &four);
+	for (size_t i = 0; i < count; i++) {
+		ASSERT_TRUE(box.contains(geom::Vector3d(&data[i * 3])));
+	}
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
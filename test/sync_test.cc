@@ -0,0 +1,311 @@
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/filter/madgwick.h>
+#include <wrmath/filter/sync.h>
+
+using namespace std;
+using namespace wr;
+
+
+static const int64_t	Millisecond = 1000000;
+
+
+// signal is a smooth test signal; linear interpolation of samples taken
+// a few milliseconds apart stays close to it.
+static void
+signal(int64_t t, double offset, double *v)
+{
+	double	s = static_cast<double>(t) * 1e-9;
+
+	v[0] = sin(s + offset);
+	v[1] = cos((2 * s) + offset);
+	v[2] = offset + (0.5 * s);
+}
+
+
+TEST(SampleBuffer, LinearInterpolation)
+{
+	filter::SampleBuffer<double, 2>	buf(4);
+	double				a[2] = {0.0, 10.0};
+	double				b[2] = {1.0, 20.0};
+	double				out[2];
+
+	EXPECT_FALSE(buf.interpolate(0, out));
+	EXPECT_TRUE(buf.push(100, a));
+	EXPECT_TRUE(buf.push(200, b));
+	EXPECT_FALSE(buf.push(200, b));
+	EXPECT_EQ(buf.dropped(), 1u);
+
+	EXPECT_TRUE(buf.interpolate(125, out));
+	EXPECT_DOUBLE_EQ(out[0], 0.25);
+	EXPECT_DOUBLE_EQ(out[1], 12.5);
+	EXPECT_TRUE(buf.interpolate(200, out));
+	EXPECT_DOUBLE_EQ(out[0], 1.0);
+	EXPECT_FALSE(buf.interpolate(99, out));
+	EXPECT_FALSE(buf.interpolate(201, out));
+}
+
+
+TEST(SampleBuffer, Bounded)
+{
+	filter::SampleBuffer<double, 1>	buf(3);
+
+	for (int64_t i = 0; i < 10; i++) {
+		double	v = static_cast<double>(i);
+
+		EXPECT_TRUE(buf.push(i * 10, &v));
+		EXPECT_LE(buf.size(), 3u);
+	}
+	EXPECT_EQ(buf.size(), 3u);
+	EXPECT_EQ(buf.dropped(), 7u);
+	EXPECT_EQ(buf.oldest(), 70);
+	EXPECT_EQ(buf.newest(), 90);
+
+	double	out;
+
+	EXPECT_TRUE(buf.interpolate(85, &out));
+	EXPECT_DOUBLE_EQ(out, 8.5);
+
+	buf.discardBefore(85);
+	EXPECT_EQ(buf.size(), 2u);
+	EXPECT_EQ(buf.oldest(), 80);
+	buf.clear();
+	EXPECT_EQ(buf.size(), 0u);
+}
+
+
+TEST(SampleBuffer, BatchMatchesSingle)
+{
+	filter::SampleBuffer<double, 3>	buf(64);
+	mt19937				rng(3);
+	uniform_int_distribution<int64_t>	jitter(-2 * Millisecond, 2 * Millisecond);
+	int64_t				t = 0;
+
+	for (int i = 0; i < 50; i++) {
+		double	v[3];
+
+		signal(t, 0.0, v);
+		buf.push(t, v);
+		t += 10 * Millisecond + jitter(rng);
+	}
+
+	vector<int64_t>	times;
+
+	for (int64_t s = buf.oldest(); s <= buf.newest(); s += 3 * Millisecond) {
+		times.push_back(s);
+	}
+
+	vector<double>	batch(times.size() * 3);
+
+	ASSERT_EQ(buf.interpolate(times.data(), times.size(), batch.data()), times.size());
+	for (size_t i = 0; i < times.size(); i++) {
+		double	single[3];
+		double	want[3];
+
+		ASSERT_TRUE(buf.interpolate(times[i], single));
+		signal(times[i], 0.0, want);
+		for (size_t k = 0; k < 3; k++) {
+			EXPECT_EQ(batch[(i * 3) + k], single[k]);
+			EXPECT_NEAR(batch[(i * 3) + k], want[k], 1e-3);
+		}
+	}
+
+	// Times past the newest sample stop the batch.
+	times.push_back(buf.newest() + 1);
+	EXPECT_EQ(buf.interpolate(times.data(), times.size(), batch.data()),
+		  times.size() - 1);
+}
+
+
+TEST(SampleBuffer, SLERP)
+{
+	filter::SampleBuffer<double, 4>	buf(8, filter::Interpolation::SLERP);
+	geom::Vector3d			axis {0.0, 0.0, 1.0};
+	geom::Quaterniond		q0 = geom::quaterniond(axis, 0.0);
+	geom::Quaterniond		q1 = geom::quaterniond(axis, M_PI / 2);
+	double				a[4] = {q0.angle(), q0.axis()[0], q0.axis()[1], q0.axis()[2]};
+	// Pushing -q1 checks that the shorter arc is taken.
+	double				b[4] = {-q1.angle(), -q1.axis()[0], -q1.axis()[1], -q1.axis()[2]};
+	double				out[4];
+
+	buf.push(0, a);
+	buf.push(100, b);
+	ASSERT_TRUE(buf.interpolate(50, out));
+
+	geom::Quaterniond	half = geom::quaterniond(axis, M_PI / 4);
+
+	EXPECT_NEAR(out[0], half.angle(), 1e-12);
+	EXPECT_NEAR(out[1], half.axis()[0], 1e-12);
+	EXPECT_NEAR(out[2], half.axis()[1], 1e-12);
+	EXPECT_NEAR(out[3], half.axis()[2], 1e-12);
+}
+
+
+TEST(SensorSynchronizer, AlignsJitteryStreams)
+{
+	const int64_t			period = 5 * Millisecond;
+	filter::SensorSynchronizerd	sync(period, 64);
+	mt19937				rng(5);
+	uniform_int_distribution<int64_t>	jitter(-Millisecond / 2, Millisecond / 2);
+	int64_t				tg = 0, ta = 3 * Millisecond, tm = 7 * Millisecond;
+	vector<filter::SyncedSample<double>>	out(16);
+	size_t				total = 0;
+	int64_t				last = -1;
+
+	for (int64_t now = 0; now < 2000 * Millisecond; now += Millisecond) {
+		double	v[3];
+
+		// Gyroscope near 1 kHz, accelerometer near 250 Hz and
+		// magnetometer near 50 Hz.
+		while (tg <= now) {
+			signal(tg, 0.0, v);
+			sync.pushGyro(tg, v);
+			tg += Millisecond + jitter(rng) / 4;
+		}
+		while (ta <= now) {
+			signal(ta, 1.0, v);
+			sync.pushAccel(ta, v);
+			ta += 4 * Millisecond + jitter(rng);
+		}
+		while (tm <= now) {
+			signal(tm, 2.0, v);
+			sync.pushMag(tm, v);
+			tm += 20 * Millisecond + jitter(rng);
+		}
+
+		size_t	n = sync.drain(out.data(), out.size());
+
+		for (size_t i = 0; i < n; i++) {
+			double	want[3];
+
+			if (last >= 0) {
+				EXPECT_EQ(out[i].time, last + period);
+			}
+			else {
+				EXPECT_GE(out[i].time, 7 * Millisecond);
+			}
+			last = out[i].time;
+			EXPECT_TRUE(out[i].magnetometer);
+
+			signal(out[i].time, 0.0, want);
+			for (size_t k = 0; k < 3; k++) {
+				EXPECT_NEAR(out[i].gyro[k], want[k], 1e-5);
+			}
+			signal(out[i].time, 1.0, want);
+			for (size_t k = 0; k < 3; k++) {
+				EXPECT_NEAR(out[i].accel[k], want[k], 1e-4);
+			}
+			signal(out[i].time, 2.0, want);
+			for (size_t k = 0; k < 3; k++) {
+				EXPECT_NEAR(out[i].mag[k], want[k], 1e-3);
+			}
+		}
+		total += n;
+
+		// The buffers stay small: each stream keeps only the samples
+		// not yet passed by the output clock.
+		EXPECT_LE(sync.gyroBuffer().size(), 30u);
+	}
+
+	// Output lags the 50 Hz magnetometer by at most one of its samples.
+	EXPECT_GT(total, 390u);
+	EXPECT_EQ(sync.skipped(), 0u);
+	EXPECT_EQ(sync.gyroBuffer().dropped(), 0u);
+}
+
+
+TEST(SensorSynchronizer, WithoutMagnetometer)
+{
+	filter::SensorSynchronizerd	sync(10, 8, false);
+	filter::SyncedSample<double>	s;
+	double				v[3] = {1.0, 2.0, 3.0};
+
+	EXPECT_FALSE(sync.next(s));
+	sync.pushGyro(0, v);
+	sync.pushGyro(10, v);
+	EXPECT_FALSE(sync.next(s));
+	sync.pushAccel(5, v);
+	ASSERT_TRUE(sync.next(s));
+	EXPECT_EQ(s.time, 5);
+	EXPECT_FALSE(s.magnetometer);
+	EXPECT_EQ(s.gyroscope(), (geom::Vector3d{1.0, 2.0, 3.0}));
+	EXPECT_EQ(s.magneticField(), (geom::Vector3d{0.0, 0.0, 0.0}));
+	EXPECT_FALSE(sync.next(s));
+
+	sync.pushGyro(20, v);
+	sync.pushAccel(20, v);
+	ASSERT_TRUE(sync.next(s));
+	EXPECT_EQ(s.time, 15);
+	EXPECT_FALSE(sync.next(s));
+}
+
+
+TEST(SensorSynchronizer, SkipsStalledStream)
+{
+	filter::SensorSynchronizerd	sync(10, 4, false);
+	filter::SyncedSample<double>	s[8];
+	double				v[3] = {0.0, 0.0, 0.0};
+
+	sync.pushGyro(0, v);
+	sync.pushAccel(0, v);
+	EXPECT_EQ(sync.drain(s, 8), 1u);
+
+	// The accelerometer stalls while the gyroscope overruns its buffer.
+	for (int64_t t = 10; t <= 100; t += 10) {
+		sync.pushGyro(t, v);
+	}
+	EXPECT_EQ(sync.drain(s, 8), 0u);
+	EXPECT_GT(sync.gyroBuffer().dropped(), 0u);
+
+	sync.pushAccel(100, v);
+	ASSERT_EQ(sync.drain(s, 8), 4u);
+	EXPECT_EQ(s[0].time, 70);
+	EXPECT_EQ(s[3].time, 100);
+	EXPECT_EQ(sync.skipped(), 6u);
+}
+
+
+TEST(SensorSynchronizer, FeedsMadgwick)
+{
+	const int64_t			period = 10 * Millisecond;
+	const double			rate = 0.5;
+	filter::SensorSynchronizerd	sync(period, 32, false);
+	filter::Madgwickd		mf;
+	filter::SyncedSample<double>	s[4];
+	double				gyro[3] = {0.0, 0.0, rate};
+	double				accel[3] = {0.0, 0.0, 1.0};
+	size_t				total = 0;
+
+	for (int64_t t = 0; t <= 1000 * Millisecond; t += 2 * Millisecond) {
+		sync.pushGyro(t, gyro);
+		if (t % (6 * Millisecond) == 0) {
+			sync.pushAccel(t, accel);
+		}
+
+		size_t	n = sync.drain(s, 4);
+
+		for (size_t i = 0; i < n; i++) {
+			mf.updateAngularOrientation(s[i].gyroscope(), static_cast<double>(period) * 1e-9);
+		}
+		total += n;
+	}
+
+	geom::Quaterniond	want = geom::quaterniond(geom::Vector3d{0.0, 0.0, 1.0},
+						     rate * static_cast<double>(total) * 1e-2);
+
+	EXPECT_EQ(total, 100u);
+	EXPECT_NEAR(abs(mf.orientation().unitQuaternion().dot(want)), 1.0, 1e-6);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,264 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/geom/quaternion.h>
+#include <wrmath/geom/rotator.h>
+#include <wrmath/geom/wahba.h>
+
+using namespace std;
+using namespace wr;
+
+
+static const geom::WahbaMethod	Methods[3] = {
+	geom::WahbaMethod::Davenport,
+	geom::WahbaMethod::QUEST,
+	geom::WahbaMethod::TRIAD,
+};
+
+
+static void
+randomQuaternion(mt19937 &rng, double *q)
+{
+	normal_distribution<double>	n;
+	double				len = 0;
+
+	for (size_t k = 0; k < 4; k++) {
+		q[k] = n(rng);
+		len += q[k] * q[k];
+	}
+	for (size_t k = 0; k < 4; k++) {
+		q[k] /= sqrt(len);
+	}
+	if (q[0] < 0) {
+		for (size_t k = 0; k < 4; k++) {
+			q[k] = -q[k];
+		}
+	}
+}
+
+
+static void
+expectSameRotation(const double *a, const double *b, double tol)
+{
+	double	d = (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]) + (a[3] * b[3]);
+
+	EXPECT_NEAR(fabs(d), 1.0, tol) << a[0] << " " << a[1] << " " << a[2] << " " << a[3]
+				       << " vs " << b[0] << " " << b[1] << " " << b[2] << " " << b[3];
+}
+
+
+static void
+observe(mt19937 &rng, const double *q, size_t n, vector<double> &body, vector<double> &ref)
+{
+	normal_distribution<double>	dist;
+
+	body.resize(n * 3);
+	ref.resize(n * 3);
+	for (size_t i = 0; i < n; i++) {
+		for (size_t k = 0; k < 3; k++) {
+			ref[(i * 3) + k] = dist(rng);
+		}
+		geom::Rotatord(q).rotate(&ref[i * 3], &body[i * 3]);
+	}
+}
+
+
+TEST(Wahba, QuaternionFromMatrix)
+{
+	mt19937	rng(1);
+
+	for (int i = 0; i < 200; i++) {
+		double	q[4], m[9], r[4];
+		double	axes[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+		randomQuaternion(rng, q);
+		for (size_t k = 0; k < 3; k++) {
+			double	col[3];
+
+			geom::Rotatord(q).rotate(axes + (k * 3), col);
+			m[k] = col[0];
+			m[3 + k] = col[1];
+			m[6 + k] = col[2];
+		}
+		geom::QuaternionFromMatrix(m, r);
+		expectSameRotation(q, r, 1e-12);
+		EXPECT_GE(r[0], 0.0);
+	}
+}
+
+
+TEST(Wahba, ExactObservations)
+{
+	mt19937		rng(2);
+	vector<double>	body, ref;
+
+	for (int i = 0; i < 100; i++) {
+		double	q[4], r[4];
+
+		randomQuaternion(rng, q);
+		observe(rng, q, 2 + (i % 5), body, ref);
+		for (auto method : Methods) {
+			ASSERT_TRUE(geom::SolveWahba(method, body.data(), ref.data(),
+						     (const double *)nullptr, body.size() / 3, r));
+			expectSameRotation(q, r, 1e-10);
+			EXPECT_GE(r[0], 0.0);
+		}
+	}
+}
+
+
+TEST(Wahba, NearHalfTurn)
+{
+	mt19937		rng(3);
+	vector<double>	body, ref;
+	double		axes[4][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {0.6, 0, 0.8}};
+
+	for (auto axis : axes) {
+		for (double angle : {M_PI, M_PI - 1e-6, M_PI - 1e-3}) {
+			double	q[4] = {cos(angle / 2), axis[0] * sin(angle / 2),
+					axis[1] * sin(angle / 2), axis[2] * sin(angle / 2)};
+			double	r[4];
+
+			observe(rng, q, 3, body, ref);
+			for (auto method : Methods) {
+				ASSERT_TRUE(geom::SolveWahba(method, body.data(), ref.data(),
+							     (const double *)nullptr, 3, r));
+				expectSameRotation(q, r, 1e-10);
+			}
+		}
+	}
+}
+
+
+TEST(Wahba, WeightedNoisy)
+{
+	mt19937				rng(4);
+	normal_distribution<double>	noise(0.0, 1e-3);
+	vector<double>			body, ref;
+	vector<double>			weights = {1.0, 4.0, 0.5, 2.0, 1.0, 0.0};
+
+	for (int i = 0; i < 50; i++) {
+		double	q[4], rd[4], rq[4], rt[4];
+
+		randomQuaternion(rng, q);
+		observe(rng, q, weights.size(), body, ref);
+		for (auto &b : body) {
+			b += noise(rng);
+		}
+
+		// The q-method and QUEST solve the same problem exactly.
+		ASSERT_TRUE(geom::DavenportQMethod(body.data(), ref.data(), weights.data(), weights.size(), rd));
+		ASSERT_TRUE(geom::QUEST(body.data(), ref.data(), weights.data(), weights.size(), rq));
+		ASSERT_TRUE(geom::TRIAD(body.data(), ref.data(), rt));
+		expectSameRotation(rd, rq, 1e-12);
+		expectSameRotation(q, rd, 1e-5);
+
+		// TRIAD matches the first observation exactly, and is
+		// otherwise only as good as the angle between the first two.
+		double	b0[3];
+		double	blen = sqrt((body[0] * body[0]) + (body[1] * body[1]) + (body[2] * body[2]));
+		double	rlen = sqrt((ref[0] * ref[0]) + (ref[1] * ref[1]) + (ref[2] * ref[2]));
+
+		geom::Rotatord(rt).rotate(ref.data(), b0);
+		for (size_t k = 0; k < 3; k++) {
+			EXPECT_NEAR(b0[k] / rlen, body[k] / blen, 1e-12);
+		}
+		expectSameRotation(q, rt, 1e-2);
+	}
+}
+
+
+TEST(Wahba, Unobservable)
+{
+	double	body[9] = {1, 0, 0, 2, 0, 0, 0, 0, 0};
+	double	ref[9] = {0, 1, 0, 0, -3, 0, 0, 0, 1};
+	double	weights[3] = {1, 1, 0};
+	double	q[4];
+
+	for (auto method : Methods) {
+		EXPECT_FALSE(geom::SolveWahba(method, body, ref, weights, 3, q));
+		EXPECT_EQ(q[0], 1.0);
+		EXPECT_FALSE(geom::SolveWahba(method, body, ref, weights, 1, q));
+	}
+
+	// The third observation makes it observable for the least-squares
+	// solvers, once it has weight.
+	weights[2] = 1;
+	body[8] = 1;
+	EXPECT_TRUE(geom::QUEST(body, ref, weights, 3, q));
+	EXPECT_TRUE(geom::DavenportQMethod(body, ref, weights, 3, q));
+}
+
+
+TEST(Wahba, Vectors)
+{
+	geom::Quaterniond	q = geom::quaternion(geom::Vector3d{1.0, 2.0, -1.0}.unitVector(), 1.2);
+	double			qa[4] = {q.angle(), q.axis()[0], q.axis()[1], q.axis()[2]};
+	geom::Vector3d		ref[3] = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.3, -0.2, 0.9}};
+	geom::Vector3d		body[3];
+	geom::Quaterniond	r;
+
+	for (size_t i = 0; i < 3; i++) {
+		double	rv[3] = {ref[i][0], ref[i][1], ref[i][2]};
+		double	bv[3];
+
+		geom::Rotatord(qa).rotate(rv, bv);
+		body[i] = geom::Vector3d(bv);
+	}
+
+	for (auto method : Methods) {
+		ASSERT_TRUE(geom::SolveWahba(method, body, ref, (const double *)nullptr, 3, r));
+		double	ra[4] = {r.angle(), r.axis()[0], r.axis()[1], r.axis()[2]};
+
+		expectSameRotation(qa, ra, 1e-10);
+	}
+}
+
+
+TEST(Wahba, Batch)
+{
+	const size_t		count = 3000, perProblem = 4;
+	mt19937			rng(5);
+	vector<double>		body, ref, truth(count * 4), out(count * 4);
+	vector<double>		b, r;
+
+	for (size_t i = 0; i < count; i++) {
+		randomQuaternion(rng, &truth[i * 4]);
+		observe(rng, &truth[i * 4], perProblem, b, r);
+		body.insert(body.end(), b.begin(), b.end());
+		ref.insert(ref.end(), r.begin(), r.end());
+	}
+
+	// Make one problem unobservable.
+	for (size_t k = 3; k < perProblem * 3; k++) {
+		ref[(7 * perProblem * 3) + k] = ref[(7 * perProblem * 3) + (k % 3)];
+	}
+
+	parallel::ThreadPool	pool(4);
+
+	for (auto method : Methods) {
+		EXPECT_EQ(geom::SolveWahba(method, body.data(), ref.data(), (const double *)nullptr,
+					   perProblem, count, out.data(), &pool), count - 1);
+		for (size_t i = 0; i < count; i++) {
+			if (i != 7 || method == geom::WahbaMethod::TRIAD) {
+				continue;
+			}
+			EXPECT_EQ(out[i * 4], 1.0);
+		}
+		for (size_t i = 0; i < count; i += 97) {
+			if (i != 7) {
+				expectSameRotation(&truth[i * 4], &out[i * 4], 1e-10);
+			}
+		}
+	}
+}
+
+
+int
+main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <wrmath/geom/vector.h>
+#include <wrmath/filter/window.h>
+
+using namespace std;
+using namespace wr;
+
+
+// The naive estimators rescan the last window samples of one component.
+static vector<double>
+lastSamples(const vector<geom::Vector3d> &stream, size_t end, size_t window, size_t k)
+{
+	vector<double>	v;
+	size_t		start = end > window ? end - window : 0;
+
+	for (size_t i = start; i < end; i++) {
+		v.push_back(stream[i][k]);
+	}
+	return v;
+}
+
+
+static vector<geom::Vector3d>
+randomStream(size_t n, unsigned seed, bool ties)
+{
+	mt19937				rng(seed);
+	normal_distribution<double>	noise(0.0, 1.0);
+	uniform_int_distribution<int>	coarse(-3, 3);
+	vector<geom::Vector3d>		stream;
+
+	for (size_t i = 0; i < n; i++) {
+		if (ties) {
+			stream.push_back(geom::Vector3d{(double)coarse(rng), (double)coarse(rng),
+							 (double)coarse(rng)});
+		}
+		else {
+			stream.push_back(geom::Vector3d{noise(rng), 9.81 + noise(rng),
+							 1000.0 + (0.01 * noise(rng))});
+		}
+	}
+	return stream;
+}
+
+
+TEST(SlidingWindow, Moments)
+{
+	for (size_t window : {1, 2, 7, 64}) {
+		vector<geom::Vector3d>	stream = randomStream(1000, 1, false);
+		filter::SlidingMoments3d	m(window);
+
+		EXPECT_EQ(m.size(), 0u);
+		for (size_t i = 0; i < stream.size(); i++) {
+			m.push(stream[i]);
+			EXPECT_EQ(m.size(), min(i + 1, window));
+			EXPECT_EQ(m.full(), i + 1 >= window);
+
+			for (size_t k = 0; k < 3; k++) {
+				vector<double>	v = lastSamples(stream, i + 1, window, k);
+				double		mean = 0, var = 0;
+
+				for (double x : v) {
+					mean += x;
+				}
+				mean /= v.size();
+				for (double x : v) {
+					var += (x - mean) * (x - mean);
+				}
+				var = v.size() > 1 ? var / (v.size() - 1) : 0;
+
+				EXPECT_NEAR(m.mean()[k], mean, 1e-9);
+				EXPECT_NEAR(m.variance()[k], var, 1e-9 * (1 + var));
+			}
+		}
+
+		m.reset();
+		EXPECT_EQ(m.size(), 0u);
+	}
+}
+
+
+TEST(SlidingWindow, MomentsStayAccurate)
+{
+	// A long stream with a large offset and a small spread would drift
+	// without the periodic recomputation.
+	filter::SlidingMoments<float, 1>	m(50);
+	mt19937					rng(2);
+	uniform_real_distribution<float>	noise(-0.01f, 0.01f);
+
+	for (size_t i = 0; i < 200000; i++) {
+		float	x = 1000.0f + noise(rng);
+
+		m.push(&x);
+	}
+
+	// The variance of a uniform distribution of width 0.02.
+	EXPECT_NEAR(m.variance()[0], 0.02 * 0.02 / 12, 1.5e-5);
+	EXPECT_NEAR(m.mean()[0], 1000.0f, 0.01f);
+}
+
+
+TEST(SlidingWindow, Extrema)
+{
+	for (bool ties : {false, true}) {
+		for (size_t window : {1, 3, 16, 100}) {
+			vector<geom::Vector3d>	stream = randomStream(800, 3, ties);
+			filter::SlidingExtrema3d	e(window);
+
+			for (size_t i = 0; i < stream.size(); i++) {
+				e.push(stream[i]);
+				EXPECT_EQ(e.size(), min(i + 1, window));
+				for (size_t k = 0; k < 3; k++) {
+					vector<double>	v = lastSamples(stream, i + 1, window, k);
+
+					EXPECT_EQ(e.min()[k], *min_element(v.begin(), v.end()));
+					EXPECT_EQ(e.max()[k], *max_element(v.begin(), v.end()));
+				}
+			}
+		}
+	}
+}
+
+
+TEST(SlidingWindow, Median)
+{
+	for (bool ties : {false, true}) {
+		for (size_t window : {1, 2, 5, 16, 99}) {
+			vector<geom::Vector3d>	stream = randomStream(800, 4, ties);
+			filter::SlidingMedian3d	m(window);
+
+			for (size_t i = 0; i < stream.size(); i++) {
+				m.push(stream[i]);
+				EXPECT_EQ(m.size(), min(i + 1, window));
+				for (size_t k = 0; k < 3; k++) {
+					vector<double>	v = lastSamples(stream, i + 1, window, k);
+					size_t		n = v.size();
+
+					sort(v.begin(), v.end());
+
+					double	want = n % 2 == 1 ? v[n / 2] : (v[(n / 2) - 1] + v[n / 2]) / 2;
+
+					ASSERT_EQ(m.median()[k], want) << "window " << window << " sample " << i;
+				}
+			}
+		}
+	}
+}
+
+
+TEST(SlidingWindow, MedianRejectsOutliers)
+{
+	filter::SlidingMedian3f		m(5);
+	filter::SlidingMoments3f	mean(5);
+
+	for (int i = 0; i < 5; i++) {
+		geom::Vector3f	x {1.0f, 2.0f, 3.0f};
+
+		if (i == 2) {
+			x = geom::Vector3f{100.0f, -100.0f, 3.0f};
+		}
+		m.push(x);
+		mean.push(x);
+	}
+	EXPECT_EQ(m.median(), (geom::Vector3f{1.0f, 2.0f, 3.0f}));
+	EXPECT_GT(mean.mean()[0], 10.0f);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""Compare two wrmath_bench JSON result files and flag regressions.
+
+Usage: bench_compare.py [--threshold PCT] [--metric cpu_time|real_time]
+                        baseline.json current.json
+
+Results are matched by benchmark name. When a run was made with
+--benchmark_repetitions, the median aggregate is used. A benchmark
+regresses when it is more than the threshold percentage slower than
+the baseline; the script exits non-zero if any benchmark regresses.
+A missing baseline, as on a fresh checkout, isn't an error: the script
+says how to record one and exits successfully.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+
+def load(path, metric):
+    with open(path) as f:
+        doc = json.load(f)
+
+    results = {}
+    medians = {}
+    for bench in doc.get("benchmarks", []):
+        if bench.get("error_occurred"):
+            continue
+        if bench.get("run_type") == "aggregate":
+            if bench.get("aggregate_name") == "median":
+                medians[bench["run_name"]] = bench[metric]
+            continue
+        # Without repetitions there is a single iteration run per name.
+        results.setdefault(bench.get("run_name", bench["name"]), bench[metric])
+
+    results.update(medians)
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="percentage slowdown treated as a regression")
+    parser.add_argument("--metric", default="cpu_time",
+                        choices=["cpu_time", "real_time"])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    args = parser.parse_args()
+
+    if not os.path.exists(args.baseline):
+        print("No benchmark baseline at %s; skipping the comparison." % args.baseline)
+        print("Record one with: wrmath_bench --benchmark_out=%s "
+              "--benchmark_out_format=json" % args.baseline)
+        return 0
+
+    baseline = load(args.baseline, args.metric)
+    current = load(args.current, args.metric)
+
+    regressions = 0
+    width = max([len(name) for name in current] + [9])
+    print("%-*s %12s %12s %8s" % (width, "benchmark", "baseline", "current", "change"))
+    for name in sorted(current):
+        if name not in baseline:
+            print("%-*s %12s %12.1f %8s" % (width, name, "-", current[name], "new"))
+            continue
+
+        old, new = baseline[name], current[name]
+        change = ((new - old) / old) * 100.0 if old > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print("%-*s %12.1f %12.1f %+7.1f%%%s" % (width, name, old, new, change, flag))
+
+    for name in sorted(set(baseline) - set(current)):
+        print("%-*s %12.1f %12s %8s" % (width, name, baseline[name], "-", "missing"))
+
+    if regressions:
+        print("%d benchmark(s) regressed by more than %.1f%%" %
+              (regressions, args.threshold), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())